@@ -0,0 +1,495 @@
+/**
+ * @file main.cpp
+ * @brief tmf-bench: throughput benchmarks for scanner, hashers and
+ *        duplicate finder
+ *
+ * Generates a synthetic tree (see TreeGenerator), then measures
+ * - FileScanner::scanDirectory() in files/s (sequential and parallel,
+ *   native and portable listing backend)
+ * - MB/s of every IHashCalculator over all generated files, and of XXH64
+ *   with each FileReader::ReadMode
+ * - DuplicateFinder::findDuplicates(): staged search time, in-memory
+ *   grouping time and peak resident memory
+ * - FileScanner::sortEntries() in entries/s for every SortOrder
+ * - NameSearch::match() for a query typed one key at a time over the
+ *   scanned names
+ *
+ * Every I/O measurement runs with a cold and a warm page cache (the
+ * in-memory grouping, sorting and name search only warm). Results are
+ * written to stdout as one JSON document; progress goes to stderr.
+ *
+ * Usage:
+ * @code
+ * tmf-bench --files 20000 --depth 4 --dup-ratio 0.3 > results.json
+ * @endcode
+ *
+ * Cold runs drop the page cache through /proc/sys/vm/drop_caches when
+ * permitted (root); otherwise the generated files are evicted with
+ * posix_fadvise(POSIX_FADV_DONTNEED), which leaves dentry and inode
+ * caches warm. The method used is reported as "cold_cache_method".
+ */
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "duplicatefinder.hpp"
+#include "filescanner.hpp"
+#include "hashfactory.hpp"
+#include "hashpipeline.hpp"
+#include "namesearch.hpp"
+#include "treegenerator.hpp"
+
+namespace {
+
+/**
+ * @brief Flat JSON object builder (numbers and strings only)
+ */
+class JsonObject {
+public:
+  JsonObject &add(const std::string &key, const std::string &value) {
+    std::string escaped;
+    for (char c : value) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+        escaped += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char buffer[8];
+        std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+        escaped += buffer;
+      } else {
+        escaped += c;
+      }
+    }
+    return raw(key, "\"" + escaped + "\"");
+  }
+
+  JsonObject &add(const std::string &key, const char *value) {
+    return add(key, std::string(value));
+  }
+
+  JsonObject &add(const std::string &key, double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return raw(key, buffer);
+  }
+
+  JsonObject &add(const std::string &key, std::uint64_t value) {
+    return raw(key, std::to_string(value));
+  }
+
+  /** @brief Appends all fields of another object */
+  JsonObject &merge(const JsonObject &other) {
+    if (!other.m_body.empty())
+      m_body += (m_body.empty() ? "" : ", ") + other.m_body;
+    return *this;
+  }
+
+  /** @brief Adds a pre-serialized JSON value */
+  JsonObject &raw(const std::string &key, const std::string &json) {
+    m_body += (m_body.empty() ? "" : ", ") + ("\"" + key + "\": ") + json;
+    return *this;
+  }
+
+  std::string str() const { return "{" + m_body + "}"; }
+
+private:
+  std::string m_body;
+};
+
+/**
+ * @brief Command line settings
+ */
+struct Options {
+  TreeSpec tree;
+  std::filesystem::path root =
+      std::filesystem::temp_directory_path() / "tmf-bench-tree";
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  unsigned runs = 3;
+  HashAlgorithm duplicate_algorithm = HashAlgorithm::XXH64;
+  bool keep = false;
+};
+
+using clock_type = std::chrono::steady_clock;
+
+double secondsSince(clock_type::time_point start) {
+  return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+/**
+ * @brief Median of the run times (robust against one noisy run)
+ */
+double median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  const std::size_t n = values.size();
+  if (n == 0)
+    return 0.0;
+  return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+/**
+ * @brief Evicts the tree from the page cache
+ * @param paths Generated files (used by the fadvise fallback)
+ * @return Method used: "drop_caches" or "fadvise"
+ */
+const char *dropCaches(const std::vector<std::string> &paths) {
+  ::sync();
+  {
+    std::ofstream drop("/proc/sys/vm/drop_caches");
+    if (drop && (drop << "3" << std::flush))
+      return "drop_caches";
+  }
+  for (const auto &path : paths) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+      ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      ::close(fd);
+    }
+  }
+  return "fadvise";
+}
+
+/**
+ * @brief Resets the peak RSS counter of this process (Linux >= 4.0)
+ */
+void resetPeakMemory() {
+  std::ofstream clear("/proc/self/clear_refs");
+  clear << "5";
+}
+
+/**
+ * @brief Peak resident set size since the last resetPeakMemory()
+ * @return Bytes (VmHWM, falling back to getrusage's lifetime maximum)
+ */
+std::uint64_t peakMemory() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    }
+  }
+  struct rusage usage;
+  ::getrusage(RUSAGE_SELF, &usage);
+  return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+/**
+ * @brief Runs one benchmark cold and warm
+ *
+ * Each cache state is measured options.runs times and reported with the
+ * median time. Warm runs follow one unmeasured warm-up run.
+ *
+ * @param name Benchmark name
+ * @param labels Fields identifying the variant (threads, algorithm)
+ * @param options Run count
+ * @param paths Files to evict for cold runs
+ * @param with_cold false for benchmarks without I/O (warm only)
+ * @param body Measured work; returns the seconds it took and may add
+ *             result fields (those of the last run are reported)
+ * @param cold_method Receives the eviction method
+ * @param results Receives one object per cache state
+ */
+void measure(const std::string &name, const JsonObject &labels, const Options &options,
+             const std::vector<std::string> &paths, bool with_cold,
+             const std::function<double(JsonObject &)> &body, const char *&cold_method,
+             std::vector<JsonObject> &results) {
+  for (bool cold : {true, false}) {
+    if (cold && !with_cold)
+      continue;
+    if (!cold) {
+      JsonObject ignored;
+      body(ignored); // warm-up run fills the page cache
+    }
+
+    std::vector<double> times;
+    JsonObject fields;
+    for (unsigned run = 0; run < options.runs; ++run) {
+      if (cold)
+        cold_method = dropCaches(paths);
+      fields = JsonObject();
+      times.push_back(body(fields));
+    }
+
+    const char *cache = cold ? "cold" : "warm";
+    JsonObject result;
+    result.add("benchmark", name).merge(labels).add("cache", cache);
+    result.add("runs", std::uint64_t(options.runs)).add("seconds", median(times));
+    result.merge(fields);
+    results.push_back(result);
+    std::cerr << name << " (" << cache << "): " << median(times) << " s" << std::endl;
+  }
+}
+
+void printUsage() {
+  std::cerr << "Usage: tmf-bench [options]\n"
+               "  --files N         number of files (default 5000)\n"
+               "  --depth N         directory levels (default 3)\n"
+               "  --fanout N        subdirectories per directory (default 4)\n"
+               "  --min-size BYTES  smallest file (default 0)\n"
+               "  --max-size BYTES  largest file (default 262144)\n"
+               "  --size-dist D     log | uniform (default log)\n"
+               "  --dup-ratio R     share of duplicate files (default 0.2)\n"
+               "  --seed N          generator seed (default 42)\n"
+               "  --runs N          runs per measurement (default 3)\n"
+               "  -t, --threads N   parallel threads (default: all cores)\n"
+               "  -a, --algorithm A hash for the duplicate search (default xxh64)\n"
+               "  --dir PATH        where to create the tree\n"
+               "  --keep            do not delete the tree afterwards\n";
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : nullptr; };
+    const char *v = nullptr;
+
+    if (arg == "--keep") {
+      options.keep = true;
+    } else if (arg == "-h" || arg == "--help") {
+      return false;
+    } else if ((v = value()) == nullptr) {
+      std::cerr << "Missing value for " << arg << "\n";
+      return false;
+    } else if (arg == "--files") {
+      options.tree.files = std::strtoull(v, nullptr, 10);
+    } else if (arg == "--depth") {
+      options.tree.depth = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+    } else if (arg == "--fanout") {
+      options.tree.fanout = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+    } else if (arg == "--min-size") {
+      options.tree.min_size = std::strtoull(v, nullptr, 10);
+    } else if (arg == "--max-size") {
+      options.tree.max_size = std::strtoull(v, nullptr, 10);
+    } else if (arg == "--size-dist") {
+      options.tree.log_sizes = std::string(v) != "uniform";
+    } else if (arg == "--dup-ratio") {
+      options.tree.duplicate_ratio = std::strtod(v, nullptr);
+    } else if (arg == "--seed") {
+      options.tree.seed = std::strtoull(v, nullptr, 10);
+    } else if (arg == "--runs") {
+      options.runs = std::max(1u, static_cast<unsigned>(std::strtoul(v, nullptr, 10)));
+    } else if (arg == "-t" || arg == "--threads") {
+      options.threads = std::max(1u, static_cast<unsigned>(std::strtoul(v, nullptr, 10)));
+    } else if (arg == "-a" || arg == "--algorithm") {
+      if (!parseHashAlgorithm(v, options.duplicate_algorithm)) {
+        std::cerr << "Unknown hash algorithm: " << v << "\n";
+        return false;
+      }
+    } else if (arg == "--dir") {
+      options.root = v;
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage();
+    return 1;
+  }
+
+  std::cerr << "Generating " << options.tree.files << " files in "
+            << options.root << " ..." << std::endl;
+  TreeStats tree = TreeGenerator(options.tree).generate(options.root);
+  if (tree.files == 0 && options.tree.files > 0) {
+    std::cerr << "Cannot create the tree in " << options.root << std::endl;
+    return 1;
+  }
+
+  const std::string root = options.root.string();
+  const char *cold_method = "none";
+  std::vector<JsonObject> results;
+
+  // Scanner: files/s, sequential and parallel, per listing backend
+  std::vector<unsigned> scan_threads{1};
+  if (options.threads > 1)
+    scan_threads.push_back(options.threads);
+  std::vector<FileScanner::Backend> backends{FileScanner::Backend::Portable};
+  if (DirentReader::isSupported())
+    backends.insert(backends.begin(), FileScanner::Backend::Native);
+  for (FileScanner::Backend backend : backends) {
+    for (unsigned threads : scan_threads) {
+      JsonObject labels;
+      labels.add("backend", backend == FileScanner::Backend::Native ? "native" : "portable")
+          .add("threads", std::uint64_t(threads));
+      measure("scan", labels, options, tree.paths, true,
+              [&](JsonObject &fields) {
+                FileScanner scanner;
+                scanner.setThreadCount(threads);
+                scanner.setBackend(backend);
+                auto start = clock_type::now();
+                auto entries = scanner.scanDirectory(root, true, false);
+                double seconds = secondsSince(start);
+                fields.add("entries", std::uint64_t(entries.size()))
+                    .add("files_per_second", entries.size() / seconds);
+                return seconds;
+              },
+              cold_method, results);
+    }
+  }
+
+  // Hashers: MB/s over every generated file; the read modes on the
+  // fastest hasher, where I/O dominates
+  const std::pair<HashAlgorithm, FileReader::ReadMode> hash_variants[] = {
+      {HashAlgorithm::FNV1A, FileReader::ReadMode::Buffered},
+      {HashAlgorithm::FNV1ALanes, FileReader::ReadMode::Buffered},
+      {HashAlgorithm::XXH64, FileReader::ReadMode::Buffered},
+      {HashAlgorithm::XXH64, FileReader::ReadMode::Uring},
+      {HashAlgorithm::XXH64, FileReader::ReadMode::UringDirect}};
+  for (const auto &[algorithm, read_mode] : hash_variants) {
+    auto hasher = createHashCalculator(algorithm, read_mode);
+    measure("hash",
+            JsonObject()
+                .add("algorithm", hasher->name())
+                .add("io", FileReader::readModeName(read_mode)),
+            options, tree.paths, true,
+            [&](JsonObject &fields) {
+              auto start = clock_type::now();
+              for (const auto &path : tree.paths) {
+                hasher->calculateHash(path);
+              }
+              double seconds = secondsSince(start);
+              fields.add("bytes", tree.bytes)
+                  .add("mb_per_second", tree.bytes / (1024.0 * 1024.0) / seconds);
+              return seconds;
+            },
+            cold_method, results);
+  }
+
+  // Duplicate finder: staged search (I/O bound) and in-memory grouping
+  FileScanner scanner;
+  scanner.setThreadCount(options.threads);
+  auto hasher = createHashCalculator(options.duplicate_algorithm);
+  JsonObject duplicate_labels;
+  duplicate_labels.add("algorithm", hasher->name())
+      .add("threads", std::uint64_t(options.threads));
+  measure("duplicates", duplicate_labels, options, tree.paths, true,
+          [&](JsonObject &fields) {
+            auto files = scanner.scanDirectory(root, true, false);
+            HashPipeline pipeline(*hasher, options.threads);
+            resetPeakMemory();
+            auto start = clock_type::now();
+            auto groups = DuplicateFinder::findDuplicates(files, pipeline);
+            double seconds = secondsSince(start);
+            fields.add("groups", std::uint64_t(groups.size()))
+                .add("wasted_bytes",
+                     std::uint64_t(DuplicateFinder::calculateWastedSpace(groups)))
+                .add("peak_rss_bytes", peakMemory());
+            return seconds;
+          },
+          cold_method, results);
+
+  // In-memory only: no cold run
+  measure("grouping", JsonObject(), options, tree.paths, false,
+          [&](JsonObject &fields) {
+            auto files = scanner.scanDirectory(root, true, false);
+            for (auto &file : files) {
+              // Synthetic digests: groups by size, no I/O
+              file.setDigest(HashDigest::fromUint64(
+                  static_cast<std::uint64_t>(file.getFileSize())));
+            }
+            resetPeakMemory();
+            auto start = clock_type::now();
+            auto groups = DuplicateFinder::findDuplicates(files);
+            double seconds = secondsSince(start);
+            fields.add("groups", std::uint64_t(groups.size()))
+                .add("peak_rss_bytes", peakMemory());
+            return seconds;
+          },
+          cold_method, results);
+
+  // Sorting a listing: in-memory only, per order
+  const auto listing = scanner.scanDirectory(root, true, false);
+  for (auto order : {FileScanner::SortOrder::Name, FileScanner::SortOrder::Size,
+                     FileScanner::SortOrder::Modified, FileScanner::SortOrder::Natural}) {
+    measure("sort", JsonObject().add("order", FileScanner::sortOrderName(order)), options,
+            tree.paths, false,
+            [&](JsonObject &fields) {
+              auto entries = listing;
+              auto start = clock_type::now();
+              FileScanner::sortEntries(entries, false, order);
+              double seconds = secondsSince(start);
+              fields.add("entries", std::uint64_t(entries.size()))
+                  .add("entries_per_second", entries.size() / seconds);
+              return seconds;
+            },
+            cold_method, results);
+  }
+
+  // Name search: every keystroke of a query refines the previous result
+  const std::string query = "file12.b";
+  measure("name_search", JsonObject().add("query", query), options, tree.paths, false,
+          [&](JsonObject &fields) {
+            NameSearch search;
+            for (const auto &info : listing) {
+              search.add(info.getName());
+            }
+            std::size_t matches = 0;
+            auto start = clock_type::now();
+            for (std::size_t length = 1; length <= query.size(); ++length) {
+              matches = search.match(query.substr(0, length)).size();
+            }
+            double seconds = secondsSince(start);
+            fields.add("entries", std::uint64_t(listing.size()))
+                .add("matches", std::uint64_t(matches))
+                .add("keystrokes_per_second", query.size() / seconds);
+            return seconds;
+          },
+          cold_method, results);
+
+  // Report
+  JsonObject config;
+  config.add("files", std::uint64_t(options.tree.files))
+      .add("depth", std::uint64_t(options.tree.depth))
+      .add("fanout", std::uint64_t(options.tree.fanout))
+      .add("min_size", options.tree.min_size)
+      .add("max_size", options.tree.max_size)
+      .add("size_distribution", options.tree.log_sizes ? "log" : "uniform")
+      .add("duplicate_ratio", options.tree.duplicate_ratio)
+      .add("seed", options.tree.seed)
+      .add("threads", std::uint64_t(options.threads))
+      .add("runs", std::uint64_t(options.runs));
+
+  JsonObject generated;
+  generated.add("files", std::uint64_t(tree.files))
+      .add("directories", std::uint64_t(tree.directories))
+      .add("duplicates", std::uint64_t(tree.duplicates))
+      .add("bytes", tree.bytes);
+
+  std::string list;
+  for (const auto &result : results) {
+    list += (list.empty() ? "\n    " : ",\n    ") + result.str();
+  }
+
+  std::cout << "{\n  \"tool\": \"tmf-bench\",\n  \"format\": 1,\n"
+            << "  \"config\": " << config.str() << ",\n"
+            << "  \"tree\": " << generated.str() << ",\n"
+            << "  \"cold_cache_method\": \"" << cold_method << "\",\n"
+            << "  \"results\": [" << list << "\n  ]\n}" << std::endl;
+
+  if (!options.keep) {
+    std::error_code ec;
+    std::filesystem::remove_all(options.root, ec);
+  }
+  return 0;
+}
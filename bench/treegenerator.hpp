@@ -0,0 +1,172 @@
+/**
+ * @file treegenerator.hpp
+ * @brief Deterministic synthetic directory trees for tmf-bench
+ */
+
+#ifndef TREEGENERATOR_HPP
+#define TREEGENERATOR_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Shape of a generated tree
+ */
+struct TreeSpec {
+  std::size_t files = 5000;            ///< Number of regular files
+  unsigned depth = 3;                  ///< Directory levels below the root
+  unsigned fanout = 4;                 ///< Subdirectories per directory
+  std::uint64_t min_size = 0;          ///< Smallest file size in bytes
+  std::uint64_t max_size = 256 * 1024; ///< Largest file size in bytes
+  bool log_sizes = true;               ///< Log-uniform (true) or uniform sizes
+  double duplicate_ratio = 0.2;        ///< Share of files copying an earlier file
+  std::uint64_t seed = 42;             ///< Same seed, same tree
+};
+
+/**
+ * @brief What generate() produced
+ */
+struct TreeStats {
+  std::size_t files = 0;
+  std::size_t directories = 0;
+  std::size_t duplicates = 0;     ///< Files whose content copies another file
+  std::uint64_t bytes = 0;
+  std::vector<std::string> paths; ///< All regular files
+};
+
+/**
+ * @class TreeGenerator
+ * @brief Writes a reproducible tree of files with a duplicate share
+ *
+ * Directories form a complete tree of the given depth and fanout; files
+ * are spread over all directories at random. Sizes follow a log-uniform
+ * (many small, few large files) or uniform distribution. A duplicate
+ * re-uses the content seed of an earlier file, so it matches it byte for
+ * byte without keeping any content in memory.
+ */
+class TreeGenerator {
+public:
+  explicit TreeGenerator(const TreeSpec &spec) : m_spec(spec) {}
+
+  /**
+   * @brief Creates the tree below root (root is removed first)
+   * @param root Directory to create
+   * @return Statistics; stats.files is 0 if the tree could not be written
+   */
+  TreeStats generate(const std::filesystem::path &root) const {
+    namespace fs = std::filesystem;
+    TreeStats stats;
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    std::vector<fs::path> dirs = createDirectories(root, stats);
+    if (dirs.empty())
+      return stats;
+
+    std::mt19937_64 rng(m_spec.seed);
+    std::uniform_int_distribution<std::size_t> pick_dir(0, dirs.size() - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    struct Original {
+      std::uint64_t size;
+      std::uint64_t content_seed;
+    };
+    std::vector<Original> originals;
+
+    for (std::size_t i = 0; i < m_spec.files; ++i) {
+      Original file{0, 0};
+      if (!originals.empty() && unit(rng) < m_spec.duplicate_ratio) {
+        std::uniform_int_distribution<std::size_t> pick(0, originals.size() - 1);
+        file = originals[pick(rng)];
+        ++stats.duplicates;
+      } else {
+        file.size = drawSize(rng);
+        file.content_seed = rng() | 1;
+        originals.push_back(file);
+      }
+
+      fs::path path = dirs[pick_dir(rng)] / ("file" + std::to_string(i) + ".bin");
+      if (!writeFile(path, file.size, file.content_seed)) {
+        stats.files = 0;
+        return stats;
+      }
+      stats.paths.push_back(path.string());
+      stats.bytes += file.size;
+      ++stats.files;
+    }
+    return stats;
+  }
+
+private:
+  TreeSpec m_spec;
+
+  std::vector<std::filesystem::path> createDirectories(const std::filesystem::path &root,
+                                                       TreeStats &stats) const {
+    std::vector<std::filesystem::path> dirs{root};
+    std::error_code ec;
+    if (!std::filesystem::create_directories(root, ec) && ec)
+      return {};
+
+    std::size_t level_begin = 0;
+    for (unsigned level = 0; level < m_spec.depth; ++level) {
+      const std::size_t level_end = dirs.size();
+      for (std::size_t d = level_begin; d < level_end; ++d) {
+        for (unsigned c = 0; c < m_spec.fanout; ++c) {
+          auto child = dirs[d] / ("dir" + std::to_string(c));
+          if (!std::filesystem::create_directory(child, ec) && ec)
+            return {};
+          dirs.push_back(child);
+        }
+      }
+      level_begin = level_end;
+    }
+    stats.directories = dirs.size() - 1; // without the root
+    return dirs;
+  }
+
+  std::uint64_t drawSize(std::mt19937_64 &rng) const {
+    const std::uint64_t lo = m_spec.min_size;
+    const std::uint64_t hi = m_spec.max_size > lo ? m_spec.max_size : lo;
+    if (!m_spec.log_sizes) {
+      return std::uniform_int_distribution<std::uint64_t>(lo, hi)(rng);
+    }
+    // Log-uniform over [lo + 1, hi + 1], shifted back by one so 0 is allowed
+    std::uniform_real_distribution<double> exponent(std::log(double(lo + 1)),
+                                                    std::log(double(hi + 1)));
+    auto size = static_cast<std::uint64_t>(std::exp(exponent(rng))) - 1;
+    return size < lo ? lo : (size > hi ? hi : size);
+  }
+
+  static bool writeFile(const std::filesystem::path &path, std::uint64_t size,
+                        std::uint64_t seed) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+      return false;
+
+    // xorshift64: cheap, and the same seed yields the same bytes
+    std::vector<std::uint64_t> block(8 * 1024);
+    std::uint64_t state = seed;
+    std::uint64_t remaining = size;
+    while (remaining > 0) {
+      for (auto &word : block) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        word = state;
+      }
+      const std::uint64_t block_bytes = block.size() * sizeof(std::uint64_t);
+      const std::uint64_t n = remaining < block_bytes ? remaining : block_bytes;
+      out.write(reinterpret_cast<const char *>(block.data()),
+                static_cast<std::streamsize>(n));
+      remaining -= n;
+    }
+    return static_cast<bool>(out);
+  }
+};
+
+#endif // TREEGENERATOR_HPP
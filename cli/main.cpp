@@ -1,13 +1,22 @@
 #include <algorithm>
+#include <cstdio>
 #include <filesystem>
 #include <functional>
 #include <iostream>
 #include <unordered_map>
 #include <vector>
 
+#include "consolidator.hpp"
+#include "duplicatefinder.hpp"
+#include "externalsizeindex.hpp"
 #include "fileinfo.hpp"
 #include "filescanner.hpp"
-#include "fnv1a.hpp"
+#include "hashfactory.hpp"
+#include "hashpipeline.hpp"
+#include "multirootscanner.hpp"
+#include "reportwriter.hpp"
+#include "scansnapshot.hpp"
+#include "stats.hpp"
 
 // Example Application
 
@@ -18,62 +27,87 @@
  * This class orchestrates a filesystem scan, collects metadata for discovered
  * files, and provides simple analyses printed to standard output:
  *  - Detection of zero-length files (potentially defective/corrupt files).
- *  - Detection and grouping of duplicate files using the FNV-1a content hash.
+ *  - Detection and grouping of duplicate files by content hash (FNV-1a by
+ *    default, selectable with -a).
  *
  * The class holds a single mutable member:
  *  - std::vector<FileInfo> allFiles: an in-memory collection of file metadata
  *    produced by FileScanner::scanDirectory.
  *
  * Responsibilities
- *  - Create and configure a FileScanner (using an FNV1A hasher instance) and
- *    invoke it to populate allFiles.
+ *  - Create a FileScanner and invoke it to populate allFiles with metadata.
  *  - Present a human-readable analysis summary on stdout:
  *      * showZeroFiles() lists files whose size is 0 bytes and prints a count.
- *      * showDuplicates() groups non-directory, non-empty files by their
- *        precomputed hash and prints groups that contain more than one entry.
+ *      * showDuplicates() runs the staged DuplicateFinder (size, sample
+ *        hash, full FNV-1a hash) and prints groups with more than one entry.
  *
  * Usage
- *  - Call run(startPath, recursiv) to perform a scan and immediately output
+ *  - Call run(startPaths, recursiv) to perform a scan and immediately output
  *    the analysis. The method prints progress and summary information to stdout.
  *
  * Public API
- *  - void run(const std::string &startPath, bool recursiv)
- *      @param startPath  Path of the directory from which the scan begins.
+ *  - void run(const std::vector<std::string> &startPaths, bool recursiv,
+ *             bool include_parent,
+ *             HashAlgorithm algorithm, unsigned threads, bool useCache,
+ *             FileReader::ReadMode readMode, FileScanner::SortOrder sortOrder)
+ *      @param startPaths Directories from which the scan begins. Several
+ *                       roots are scanned recursively by a MultiRootScanner
+ *                       (one scheduler per disk, overlapping roots once)
+ *                       and searched for duplicates together; groups
+ *                       spanning roots are marked "(across roots)".
  *      @param recursiv   If true, scan directories recursively; otherwise only
  *                       scan the top-level directory.
+ *      @param algorithm  Content hash used for duplicate detection.
+ *      @param threads    Scanner threads for recursive scans and hashing
+ *                       workers (0 = one per hardware thread).
+ *      @param useCache   Reuse digests from the persistent HashCache for
+ *                       files unchanged since an earlier run.
+ *      @param readMode   How the hasher reads file content (blocking reads,
+ *                       io_uring, or io_uring with O_DIRECT).
+ *      @param sortOrder  Order of the listed entries (name, size, mtime or
+ *                       natural).
  *      @effects Populates allFiles with results from FileScanner and prints
  *               analysis output to stdout.
- *      @note The method constructs an FNV1A hasher and a FileScanner each time
- *            it is invoked. Any exceptions raised by FileScanner (e.g. I/O
+ *      @note The method constructs a FileScanner each time it is invoked. Any exceptions raised by FileScanner (e.g. I/O
  *            errors) will propagate unless handled by the caller.
  *
+ *  - int report(const std::vector<std::string> &startPaths, bool recursiv,
+ *               HashAlgorithm algorithm, unsigned threads, bool useCache,
+ *               FileReader::ReadMode readMode, ReportWriter::Format format,
+ *               std::FILE *out)
+ *      Headless mode (--format): writes zero-byte files, duplicate groups
+ *      and totals as NDJSON or CSV to out. Zero-byte files are written
+ *      while the directory streams in and not kept; duplicate groups are
+ *      written as soon as they are final. Only files with content stay in
+ *      memory for the duplicate search.
+ *      @return Exit status (1 if the report could not be written)
+ *
  * Private helpers (behavior summarized)
  *  - void showZeroFiles() const
  *      Scans allFiles for entries reporting a size of 0 bytes, prints each
  *      candidate path with a warning marker, and prints a final count.
  *
  *  - void showDuplicates()
- *      Builds a mapping from file-hash (std::string) to a list of references
- *      to FileInfo objects. Only includes entries that:
- *        * are not directories,
- *        * have file size > 0,
- *        * have a non-empty hash.
- *      Prints a summary of the number of unique hash values and then lists
- *      each hash that maps to multiple FileInfo entries (duplicate groups),
- *      showing path and size for each file in the group.
+ *      Passes allFiles to DuplicateFinder::findDuplicates(files, pipeline),
+ *      which hashes candidates on a HashPipeline of `threads` workers.
+ *      Only files whose size and head/tail sample collide are read in full.
+ *      Lists each duplicate group, showing path and size for each file.
+ *
+ *  - void writeSnapshot(groups) const
+ *      With --snapshot, stores allFiles and the duplicate groups as a
+ *      ScanSnapshot for tfm. Written before a consolidation, which only
+ *      replaces copies by links to equal content.
  *
  * Implementation notes
- *  - The duplicate detection uses std::unordered_map<std::string,
- *    std::vector<std::reference_wrapper<const FileInfo>>> to avoid copying
- *    FileInfo objects when grouping by hash.
+ *  - DuplicateFinder groups FileInfo pointers, so no FileInfo is copied.
  *  - Output is written directly to std::cout; this class is designed for CLI
  *    usage and not for use as a library component that returns structured
  *    results.
  *  - Complexity:
  *      * Scanning: cost depends on FileScanner implementation and filesystem
  *        content.
- *      * Duplicate grouping: linear in the number of files (hash table
- *        insertions), plus linear-time printing of groups.
+ *      * Duplicate grouping: linear in the number of files for the size
+ *        stage; content is only read for size collisions.
  *
  * Thread-safety
  *  - Application is not thread-safe. It owns mutable state (allFiles) and
@@ -86,7 +120,7 @@
  *    appropriate for their use case.
  *
  * See also
- *  - FNV1A: the hashing strategy used for duplicate detection.
+ *  - createHashCalculator(): the hashing strategy used for duplicate detection.
  *  - FileScanner::scanDirectory: produces the FileInfo collection consumed by
  *    this class.
  *  - FileInfo: provides metadata accessors used by the analyses.
@@ -94,14 +128,56 @@
 class Application {
 private:
   std::vector<FileInfo> allFiles;
+  std::unique_ptr<IHashCalculator> hasher;
+  unsigned hashThreads = 0;
+  bool verifyContent = false;
+  bool consolidateCopies = false;
+  Consolidator::Method consolidateMethod = Consolidator::Method::Auto;
+  std::string scanRoot;
+  std::string snapshotPath;
+  MultiRootScanner roots;
 
 public:
-  void run(const std::string &startPath, bool recursiv, bool include_parent) {
-    FNV1A fileHash;
-    FileScanner scanner(fileHash);
+  void run(const std::vector<std::string> &startPaths, bool recursiv, bool include_parent,
+           HashAlgorithm algorithm = HashAlgorithm::FNV1A,
+           unsigned threads = 0, bool useCache = true,
+           FileReader::ReadMode readMode = FileReader::ReadMode::Buffered,
+           FileScanner::SortOrder sortOrder = FileScanner::SortOrder::Name,
+           bool verify = false, bool consolidate = false,
+           Consolidator::Method method = Consolidator::Method::Auto,
+           const std::string &snapshot = "") {
+    hasher = createHashCalculator(algorithm,
+                                  useCache ? HashCache::openDefault() : nullptr,
+                                  readMode);
+    hashThreads = threads;
+    verifyContent = verify || consolidate;
+    consolidateCopies = consolidate;
+    consolidateMethod = method;
+    scanRoot = startPaths.front();
+    snapshotPath = snapshot;
 
-    std::cout << "Scan directory: " << startPath << std::endl;
-    allFiles = scanner.scanDirectory(startPath, recursiv, include_parent);
+    if (startPaths.size() > 1) {
+      if (!addRoots(startPaths)) {
+        return;
+      }
+      for (const auto &root : roots.roots()) {
+        std::cout << "Scan directory: " << root.path << std::endl;
+      }
+      roots.setThreadCount(threads);
+      roots.scan([this](std::vector<FileInfo> &&batch) {
+        std::move(batch.begin(), batch.end(), std::back_inserter(allFiles));
+        return true;
+      });
+      FileScanner::sortEntries(allFiles, false, sortOrder);
+    } else {
+      FileScanner scanner;
+      scanner.setThreadCount(threads);
+      std::cout << "Scan directory: " << scanRoot << std::endl;
+      allFiles = scanner.scanDirectory(scanRoot, recursiv, include_parent);
+      if (sortOrder != FileScanner::SortOrder::Name) {
+        FileScanner::sortEntries(allFiles, include_parent, sortOrder);
+      }
+    }
     std::cout << "Scan finished. " << allFiles.size() << " Entries found."
               << std::endl;
 
@@ -109,7 +185,141 @@ public:
     showDuplicates();
   }
 
+  int report(const std::vector<std::string> &startPaths, bool recursiv,
+             HashAlgorithm algorithm, unsigned threads, bool useCache,
+             FileReader::ReadMode readMode, ReportWriter::Format format,
+             std::FILE *out, std::size_t memoryLimit = 0) {
+    hasher = createHashCalculator(algorithm,
+                                  useCache ? HashCache::openDefault() : nullptr,
+                                  readMode);
+    ReportWriter writer(out, format);
+    if (startPaths.size() > 1 && !addRoots(startPaths)) {
+      return 1;
+    }
+
+    if (memoryLimit > 0) {
+      return reportExternal(startPaths.front(), recursiv, threads, writer,
+                            memoryLimit);
+    }
+
+    std::uint64_t scanned = 0;
+    streamRoots(
+        startPaths.front(), recursiv, threads, [&](std::vector<FileInfo> &&batch) {
+          for (auto &info : batch) {
+            if (info.isDirectory())
+              continue;
+            ++scanned;
+            if (info.zeroFiles()) {
+              writer.zeroByteFile(info);
+            } else {
+              allFiles.push_back(std::move(info));
+            }
+          }
+          return writer.good(); // stop early if the output is gone
+        });
+
+    HashPipeline pipeline(*hasher, threads);
+    DuplicateFinder::findDuplicates(
+        allFiles, pipeline,
+        [&writer](const DuplicateFinder::DuplicateGroup &group) {
+          writer.duplicateGroup(group);
+        });
+
+    if (!writer.summary(scanned)) {
+      std::cerr << "Cannot write the report" << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
 private:
+  /**
+   * @brief Registers several -p paths with the MultiRootScanner
+   *
+   * Paths that are not directories end the run; paths overlapping an
+   * earlier root are scanned once, as part of it.
+   *
+   * @return false if a path is not a directory
+   */
+  bool addRoots(const std::vector<std::string> &startPaths) {
+    for (const auto &path : startPaths) {
+      switch (roots.addRoot(path)) {
+      case MultiRootScanner::AddResult::Invalid:
+        std::cerr << "Not a directory: " << path << std::endl;
+        return false;
+      case MultiRootScanner::AddResult::Covered:
+        std::cerr << "Already covered by another root: " << path << std::endl;
+        break;
+      case MultiRootScanner::AddResult::Added:
+        break;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Streams the scan of one path, or of all roots (addRoots())
+   *
+   * Several roots are always scanned recursively, one scheduler per disk.
+   */
+  void streamRoots(const std::string &startPath, bool recursiv, unsigned threads,
+                   const FileScanner::BatchCallback &on_batch) {
+    if (!roots.roots().empty()) {
+      roots.setThreadCount(threads);
+      roots.scan(on_batch);
+      return;
+    }
+    FileScanner scanner;
+    scanner.setThreadCount(threads);
+    scanner.scanDirectoryStreaming(startPath, recursiv, false, on_batch);
+  }
+
+  /**
+   * @brief report() within a memory ceiling (--memory-limit)
+   *
+   * Scanned entries are not kept: ExternalSizeIndex spills their records
+   * to sorted runs on disk, and only the files of colliding sizes come
+   * back, batch by batch, for the hashing stages.
+   */
+  int reportExternal(const std::string &startPath, bool recursiv, unsigned threads,
+                     ReportWriter &writer, std::size_t memoryLimit) {
+    ExternalSizeIndex index(memoryLimit);
+    std::uint64_t scanned = 0;
+    streamRoots(
+        startPath, recursiv, threads, [&](std::vector<FileInfo> &&batch) {
+          for (const auto &info : batch) {
+            if (info.isDirectory())
+              continue;
+            ++scanned;
+            if (info.zeroFiles()) {
+              writer.zeroByteFile(info);
+            } else {
+              index.add(info);
+            }
+          }
+          return writer.good() && index.good();
+        });
+
+    const bool merged = index.forEachCollision([&](std::vector<FileInfo> &&files) {
+      HashPipeline pipeline(*hasher, threads);
+      DuplicateFinder::findDuplicates(
+          files, pipeline, [&writer](const DuplicateFinder::DuplicateGroup &group) {
+            writer.duplicateGroup(group);
+          });
+      return writer.good();
+    });
+    if (!merged && !index.good()) {
+      std::cerr << "Cannot write temporary files" << std::endl;
+      return 1;
+    }
+
+    if (!writer.summary(scanned)) {
+      std::cerr << "Cannot write the report" << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
   void showZeroFiles() const {
     int corruptFileCounter = 0;
 
@@ -127,59 +337,119 @@ private:
   }
 
   void showDuplicates() {
-    std::cout << "\n--- Duplicate detection (FNV-1a Hash) ---" << std::endl;
+    std::cout << "\n--- Duplicate detection (" << hasher->name() << " Hash) ---"
+              << std::endl;
 
-    std::unordered_map<std::string,
-                       std::vector<std::reference_wrapper<const FileInfo>>>
-        hashToFile;
+    HashPipeline pipeline(*hasher, hashThreads);
+    auto groups = DuplicateFinder::findDuplicates(allFiles, pipeline);
 
-    for (const auto &info : allFiles) {
-      if (!info.isDirectory() && info.getFileSize() > 0 &&
-          !info.getHash().empty()) {
-        hashToFile[info.getHash()].push_back(std::cref(info));
-      }
-    }
+    std::cout << "Grouping complete." << std::endl;
 
-    std::cout << "Grouping complete. " << hashToFile.size()
-              << " Unique hash values ​​found." << std::endl;
+    if (verifyContent) {
+      groups = DuplicateFinder::verifyGroups(groups, hashThreads);
+      std::cout << "Byte-for-byte verification complete." << std::endl;
+    }
 
     int totalDupGroups = 0;
+    int crossRootGroups = 0;
 
-    for (const auto &paar : hashToFile) {
-      const std::vector<std::reference_wrapper<const FileInfo>> &files =
-          paar.second;
-
-      if (files.size() > 1) {
-        totalDupGroups++;
-        std::cout << "\n# DUPLICATE GROUP" << totalDupGroups
-                  << " (Hash: " << paar.first << ", " << files.size()
-                  << " files)" << std::endl;
-        // ...
-        for (const auto &fileRef : files) {
-          const FileInfo &file = fileRef.get(); // <--- Zugriff auf das Objekt
-          std::cout << "    -> Path: " << file.getPath()
-                    << " (Size: " << file.getFileSize() << " Bytes)"
-                    << std::endl;
-        }
+    for (const auto &group : groups) {
+      totalDupGroups++;
+      const bool acrossRoots = roots.roots().size() > 1 &&
+                               !MultiRootScanner::crossRoot({group}, roots).empty();
+      crossRootGroups += acrossRoots ? 1 : 0;
+      std::cout << "\n# DUPLICATE GROUP" << totalDupGroups
+                << " (Hash: " << group.hash << ", " << group.files.size()
+                << " files)" << (group.verified ? " (verified)" : "")
+                << (acrossRoots ? " (across roots)" : "") << std::endl;
+
+      for (const FileInfo *file : group.files) {
+        std::cout << "    -> Path: " << file->getPath()
+                  << " (Size: " << file->getFileSize() << " Bytes)"
+                  << std::endl;
       }
     }
 
     if (totalDupGroups == 0) {
       std::cout << "\nNo duplicate groups found." << std::endl;
     } else {
-      std::cout << "\nTotal " << totalDupGroups << " Duplicate groups found."
+      std::cout << "\nTotal " << totalDupGroups << " Duplicate groups found";
+      if (roots.roots().size() > 1) {
+        std::cout << ", " << crossRootGroups << " across roots";
+      }
+      std::cout << "." << std::endl;
+    }
+
+    if (!snapshotPath.empty()) {
+      writeSnapshot(groups);
+    }
+
+    if (consolidateCopies) {
+      consolidate(groups);
+    }
+  }
+
+  void writeSnapshot(const std::vector<DuplicateFinder::DuplicateGroup> &groups) const {
+    std::string error;
+    if (!ScanSnapshot::write(snapshotPath, scanRoot, allFiles, &groups, &error)) {
+      std::cerr << "Cannot write snapshot: " << error << std::endl;
+      return;
+    }
+    std::cout << "\nSnapshot written: " << snapshotPath << std::endl;
+  }
+
+  void consolidate(const std::vector<DuplicateFinder::DuplicateGroup> &groups) const {
+    std::cout << "\n--- Consolidation ---" << std::endl;
+
+    Consolidator consolidator(consolidateMethod, hashThreads);
+    auto result = consolidator.run(groups);
+
+    for (const auto &failure : result.failed) {
+      std::cerr << "Not linked: " << failure.path << ": " << failure.message
                 << std::endl;
     }
+    std::cout << "Linked " << result.replaced.size() << " copies ("
+              << result.hardlinked << " hardlinks, " << result.reflinked
+              << " reflinks, " << result.already_shared
+              << " already shared), " << result.reclaimed
+              << " Bytes reclaimed." << std::endl;
   }
 };
 
+/**
+ * @brief Prints the Stats counters and timers to stderr (--stats)
+ */
+static void printStats() {
+  if (!Stats::ENABLED) {
+    std::cerr << "Built without ENABLE_STATS; no statistics collected.\n";
+    return;
+  }
+  for (const auto &line : Stats::global().snapshot().lines()) {
+    std::cerr << line << '\n';
+  }
+}
+
 int main(int argc, char *argv[]) {
   Application app;
   std::string current_dir = std::filesystem::current_path();
 
   bool isRecursive = false;
   bool includeParent = false;
-  std::string startPath;
+  HashAlgorithm algorithm = HashAlgorithm::FNV1A;
+  unsigned threads = 0;
+  bool useCache = true;
+  FileReader::ReadMode readMode = FileReader::ReadMode::Buffered;
+  FileScanner::SortOrder sortOrder = FileScanner::SortOrder::Name;
+  bool reportMode = false;
+  bool showStats = false;
+  bool verify = false;
+  std::size_t memoryLimit = 0;
+  bool consolidate = false;
+  Consolidator::Method consolidateMethod = Consolidator::Method::Auto;
+  ReportWriter::Format reportFormat = ReportWriter::Format::Ndjson;
+  std::string outputPath;
+  std::string snapshotPath;
+  std::vector<std::string> startPaths;
 
   // Einfacher Argument-Parser
   for (int i = 1; i < argc; ++i) {
@@ -188,22 +458,159 @@ int main(int argc, char *argv[]) {
       isRecursive = true;
     }
 
-    if (arg == "-p" || arg == "--path") {
-      startPath = argv[i + 1];
+    if ((arg == "-p" || arg == "--path") && i + 1 < argc) {
+      startPaths.push_back(argv[i + 1]);
+      i++;
+    }
+
+    if ((arg == "-a" || arg == "--algorithm") && i + 1 < argc) {
+      if (!parseHashAlgorithm(argv[i + 1], algorithm)) {
+        std::cerr << "Unknown hash algorithm: " << argv[i + 1] << "\n";
+        return 1;
+      }
+      i++;
+    }
+
+    if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+      threads = static_cast<unsigned>(std::stoul(argv[i + 1]));
+      i++;
+    }
+
+    if (arg == "--io" && i + 1 < argc) {
+      if (!FileReader::parseReadMode(argv[i + 1], readMode)) {
+        std::cerr << "Unknown I/O mode: " << argv[i + 1] << "\n";
+        return 1;
+      }
+      i++;
+    }
+
+    if ((arg == "-s" || arg == "--sort") && i + 1 < argc) {
+      if (!FileScanner::parseSortOrder(argv[i + 1], sortOrder)) {
+        std::cerr << "Unknown sort order: " << argv[i + 1] << "\n";
+        return 1;
+      }
+      i++;
+    }
+
+    if (arg == "--format" && i + 1 < argc) {
+      if (!ReportWriter::parseFormat(argv[i + 1], reportFormat)) {
+        std::cerr << "Unknown report format: " << argv[i + 1] << "\n";
+        return 1;
+      }
+      reportMode = true;
+      i++;
+    }
+
+    if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+      outputPath = argv[i + 1];
+      i++;
+    }
+
+    if (arg == "--no-cache") {
+      useCache = false;
+    }
+
+    if (arg == "--stats") {
+      showStats = true;
+    }
+
+    if (arg == "--verify") {
+      verify = true;
+    }
+
+    if (arg == "--memory-limit" && i + 1 < argc) {
+      memoryLimit = static_cast<std::size_t>(std::stoull(argv[i + 1])) << 20;
+      i++;
+    }
+
+    if (arg == "--snapshot" && i + 1 < argc) {
+      snapshotPath = argv[i + 1];
+      i++;
+    }
+
+    if (arg == "--consolidate" && i + 1 < argc) {
+      if (!Consolidator::parseMethod(argv[i + 1], consolidateMethod)) {
+        std::cerr << "Unknown consolidation method: " << argv[i + 1] << "\n";
+        return 1;
+      }
+      consolidate = true;
       i++;
     }
 
     if (arg == "-h" || arg == "--help") {
-      std::cout << "[-p directory | -r (optional use recursive, defalt: false) ]\n";
+      std::cout << "[-p directory (repeatable: several roots are scanned "
+                   "recursively, one disk at a time each, with one duplicate "
+                   "search) | -r (optional use recursive, defalt: false) "
+                   "| -a fnv1a|fnv1a-x8|xxh64 (default: fnv1a) "
+                   "| -t threads (default: all cores) "
+                   "| --io blocking|uring|direct (default: blocking) "
+                   "| -s name|size|mtime|natural (default: name) "
+                   "| --no-cache (do not reuse hashes of unchanged files) "
+                   "| --verify (compare duplicates byte for byte) "
+                   "| --consolidate auto|hardlink|reflink (link verified "
+                   "copies to one kept file, implies --verify) "
+                   "| --format ndjson|csv (report only, for scripts) "
+                   "| -o file (report destination, default: stdout) "
+                   "| --memory-limit MiB (report only: spill the scan to "
+                   "sorted runs in $TMPDIR instead of keeping it in RAM) "
+                   "| --snapshot file (store the scan and its duplicate "
+                   "groups for tfm --snapshot) "
+                   "| --stats (print counters and phase timers to stderr) ]\n";
       return 0;
     }
   }
 
-  if (startPath == "") {
-    startPath = current_dir;
+  if (startPaths.empty()) {
+    startPaths.push_back(current_dir);
+  }
+
+  if (startPaths.size() > 1 && !snapshotPath.empty()) {
+    std::cerr << "--snapshot stores a single root\n";
+    return 1;
   }
 
-  app.run(startPath, isRecursive, includeParent);
+  // tfm looks directories up by absolute path
+  if (!snapshotPath.empty()) {
+    std::string &startPath = startPaths.front();
+    startPath = std::filesystem::absolute(startPath).lexically_normal().string();
+    if (startPath.size() > 1 && startPath.back() == '/') {
+      startPath.pop_back();
+    }
+  }
+
+  if (reportMode && !snapshotPath.empty()) {
+    std::cerr << "--snapshot cannot be combined with --format\n";
+    return 1;
+  }
+
+  if (reportMode) {
+    std::FILE *out = outputPath.empty() ? stdout : std::fopen(outputPath.c_str(), "w");
+    if (!out) {
+      std::cerr << "Cannot open " << outputPath << std::endl;
+      return 1;
+    }
+    const int status = app.report(startPaths, isRecursive, algorithm, threads, useCache,
+                                  readMode, reportFormat, out, memoryLimit);
+    if (showStats) {
+      printStats();
+    }
+    if (out != stdout && std::fclose(out) != 0) {
+      std::cerr << "Cannot write " << outputPath << std::endl;
+      return 1;
+    }
+    return status;
+  }
+
+  if (memoryLimit > 0) {
+    std::cerr << "--memory-limit needs --format (report mode)\n";
+    return 1;
+  }
+
+  app.run(startPaths, isRecursive, includeParent, algorithm, threads, useCache,
+          readMode, sortOrder, verify, consolidate, consolidateMethod, snapshotPath);
+  if (showStats) {
+    printStats();
+  }
 
   return 0;
 }
@@ -0,0 +1,83 @@
+/**
+ * @file blockhashcalculator.hpp
+ * @brief IHashCalculator base that feeds a streaming hash engine in blocks
+ */
+
+#ifndef BLOCKHASHCALCULATOR_HPP
+#define BLOCKHASHCALCULATOR_HPP
+
+#include "filereader.hpp"
+#include "ihashcalculator.hpp"
+#include "stats.hpp"
+
+/**
+ * @class BlockHashCalculator
+ * @brief Connects a streaming hash engine to FileReader
+ *
+ * The engine type must provide:
+ * - a default constructor initializing the hash state
+ * - void update(const std::uint8_t *data, std::size_t size)
+ * - HashDigest digest() const
+ * - static constexpr const char *NAME
+ *
+ * update() is called with arbitrary chunk boundaries, so the engine must
+ * return the same digest no matter how the input is split.
+ *
+ * The read mode only changes how content is fetched; digests are the same
+ * in every mode.
+ *
+ * @tparam Engine Streaming hash state (e.g. Fnv1aEngine, Xxh64Engine)
+ *
+ * @see FileReader
+ */
+template <typename Engine>
+class BlockHashCalculator : public IHashCalculator {
+public:
+  /**
+   * @brief Selects how file content is read (default: Buffered)
+   * @note Set before the calculator is shared between threads
+   */
+  void setReadMode(FileReader::ReadMode mode) { m_mode = mode; }
+
+  /** @brief Current read mode */
+  FileReader::ReadMode getReadMode() const { return m_mode; }
+
+  HashDigest calculateHash(const std::string &filePath) const override {
+    Engine engine;
+    Stats::Tally bytes(Stats::Counter::BytesHashed);
+    bool ok = FileReader::readAll(filePath, m_mode,
+                                  [&engine, &bytes](const std::uint8_t *data, std::size_t size) {
+                                    engine.update(data, size);
+                                    bytes.add(size);
+                                  });
+    TMF_STATS_ADD(FilesHashed, 1);
+    return ok ? engine.digest() : HashDigest();
+  }
+
+  /**
+   * @brief Hashes head and tail of the file
+   *
+   * Files not larger than two samples are hashed completely, so the result
+   * equals calculateHash() for them.
+   */
+  HashDigest calculateSampleHash(const std::string &filePath,
+                                 std::size_t sampleSize) const override {
+    Engine engine;
+    Stats::Tally bytes(Stats::Counter::BytesHashed);
+    bool ok = FileReader::readHeadTail(
+        filePath, sampleSize, m_mode,
+        [&engine, &bytes](const std::uint8_t *data, std::size_t size) {
+          engine.update(data, size);
+          bytes.add(size);
+        });
+    TMF_STATS_ADD(FilesHashed, 1);
+    return ok ? engine.digest() : HashDigest();
+  }
+
+  const char *name() const override { return Engine::NAME; }
+
+private:
+  FileReader::ReadMode m_mode = FileReader::ReadMode::Buffered;
+};
+
+#endif // BLOCKHASHCALCULATOR_HPP
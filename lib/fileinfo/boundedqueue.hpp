@@ -0,0 +1,102 @@
+/**
+ * @file boundedqueue.hpp
+ * @brief Blocking multi-producer/multi-consumer queue with a fixed capacity
+ */
+
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * @class BoundedQueue
+ * @brief FIFO queue that blocks producers when full and consumers when empty
+ *
+ * Used to connect pipeline stages: the capacity limits how far a fast
+ * producer can run ahead of its consumers (back-pressure), and close()
+ * tells the consumers that no more items will arrive.
+ *
+ * @tparam T Item type (moved in and out)
+ */
+template <typename T>
+class BoundedQueue {
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+  std::deque<T> m_items;
+  std::size_t m_capacity;
+  bool m_closed = false;
+
+public:
+  /**
+   * @brief Creates a queue
+   * @param capacity Maximum number of queued items (at least 1)
+   */
+  explicit BoundedQueue(std::size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+  /**
+   * @brief Appends an item, waiting while the queue is full
+   * @param item Item to append
+   * @return false if the queue was closed (item is dropped)
+   */
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_full.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+    if (m_closed)
+      return false;
+    m_items.push_back(std::move(item));
+    m_not_empty.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Removes the oldest item, waiting while the queue is empty
+   * @param item Receives the item
+   * @return false once the queue is closed and drained
+   */
+  bool pop(T &item) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_empty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+    if (m_items.empty())
+      return false;
+    item = std::move(m_items.front());
+    m_items.pop_front();
+    m_not_full.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Rejects further pushes and wakes all waiting threads
+   *
+   * Items already queued can still be popped.
+   */
+  void close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_not_empty.notify_all();
+    m_not_full.notify_all();
+  }
+
+  /**
+   * @brief Accepts pushes again after close() (no waiters may be active)
+   */
+  void reopen() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = false;
+  }
+
+  /**
+   * @brief Drops all queued items (e.g. after cancellation)
+   */
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_items.clear();
+    m_not_full.notify_all();
+  }
+};
+
+#endif // BOUNDEDQUEUE_HPP
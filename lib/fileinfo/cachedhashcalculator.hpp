@@ -0,0 +1,86 @@
+/**
+ * @file cachedhashcalculator.hpp
+ * @brief IHashCalculator decorator backed by the persistent HashCache
+ */
+
+#ifndef CACHEDHASHCALCULATOR_HPP
+#define CACHEDHASHCALCULATOR_HPP
+
+#include "hashcache.hpp"
+#include "ihashcalculator.hpp"
+#include <memory>
+
+/**
+ * @class CachedHashCalculator
+ * @brief Answers hash requests from HashCache before reading any content
+ *
+ * Each request costs one stat(2). On a hit (same device, inode, size and
+ * mtime) the cached digest is returned without opening the file; on a miss
+ * the wrapped calculator hashes the file and the result is stored, unless
+ * the file changed while it was being read.
+ *
+ * Sample and full digests are cached separately (keyed by sample size).
+ *
+ * Example usage:
+ * @code
+ * auto hasher = std::make_unique<CachedHashCalculator>(
+ *     createHashCalculator(HashAlgorithm::XXH64), HashCache::openDefault());
+ * auto groups = DuplicateFinder::findDuplicates(files, *hasher);
+ * @endcode
+ *
+ * @note Thread-safe if the wrapped calculator is (all built-in ones are)
+ * @see HashCache
+ */
+class CachedHashCalculator : public IHashCalculator {
+public:
+  /**
+   * @param inner Calculator doing the actual hashing
+   * @param cache Cache to consult; nullptr disables caching
+   */
+  CachedHashCalculator(std::unique_ptr<IHashCalculator> inner,
+                       std::shared_ptr<HashCache> cache)
+      : m_inner(std::move(inner)), m_cache(std::move(cache)) {}
+
+  HashDigest calculateHash(const std::string &filePath) const override {
+    return cached(filePath, 0,
+                  [&] { return m_inner->calculateHash(filePath); });
+  }
+
+  HashDigest calculateSampleHash(const std::string &filePath,
+                                 std::size_t sampleSize) const override {
+    return cached(filePath, static_cast<std::uint32_t>(sampleSize),
+                  [&] { return m_inner->calculateSampleHash(filePath, sampleSize); });
+  }
+
+  /** @brief Same name as the wrapped calculator (digests are identical) */
+  const char *name() const override { return m_inner->name(); }
+
+  /** @brief The cache in use, or nullptr */
+  const std::shared_ptr<HashCache> &getCache() const { return m_cache; }
+
+private:
+  std::unique_ptr<IHashCalculator> m_inner;
+  std::shared_ptr<HashCache> m_cache;
+
+  template <typename Compute>
+  HashDigest cached(const std::string &filePath, std::uint32_t sampleSize,
+                    Compute compute) const {
+    FileStamp before;
+    if (!m_cache || !FileStamp::fromPath(filePath, before))
+      return compute();
+
+    HashDigest digest;
+    if (m_cache->lookup(before, m_inner->name(), sampleSize, digest))
+      return digest;
+
+    digest = compute();
+
+    FileStamp after;
+    if (!digest.empty() && FileStamp::fromPath(filePath, after) && after == before)
+      m_cache->store(before, m_inner->name(), sampleSize, digest);
+
+    return digest;
+  }
+};
+
+#endif // CACHEDHASHCALCULATOR_HPP
@@ -0,0 +1,301 @@
+/**
+ * @file consolidator.cpp
+ * @brief Implementation of hardlink/reflink consolidation
+ */
+
+#include "consolidator.hpp"
+#include "mounttable.hpp"
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <iterator>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string errorMessage(int error) {
+  return std::error_code(error, std::generic_category()).message();
+}
+
+std::int64_t mtimeNs(const struct stat &st) {
+  return static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+/** @brief A group member with its current metadata */
+struct Member {
+  std::string path;
+  struct stat st;
+};
+
+/**
+ * @brief Unique name next to path for the replacement
+ *
+ * Hidden, and unique per process and call, so concurrent workers and
+ * other tfm instances never collide (creation uses O_EXCL / link()).
+ */
+std::string temporaryPath(const std::string &path) {
+  static std::atomic<unsigned> counter{0};
+  const std::size_t slash = path.find_last_of('/');
+  const std::string dir = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+  const std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+  return dir + "." + name + ".tmf-" + std::to_string(::getpid()) + "-" +
+         std::to_string(counter.fetch_add(1));
+}
+
+/** @return 0 or the errno of the failed step */
+int replaceWithHardlink(const Member &keep, const Member &copy) {
+  const std::string temp = temporaryPath(copy.path);
+  if (::link(keep.path.c_str(), temp.c_str()) != 0)
+    return errno;
+  if (::rename(temp.c_str(), copy.path.c_str()) != 0) {
+    const int error = errno;
+    ::unlink(temp.c_str());
+    return error;
+  }
+  return 0;
+}
+
+/**
+ * @brief Clones the kept file's extents into a new file with the copy's
+ *        metadata and renames it over the copy
+ * @return 0 or the errno of the failed step (EOPNOTSUPP without FICLONE)
+ */
+int replaceWithReflink(const Member &keep, const Member &copy) {
+#ifdef FICLONE
+  const int source = ::open(keep.path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (source < 0)
+    return errno;
+
+  const std::string temp = temporaryPath(copy.path);
+  const int target = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                            copy.st.st_mode & 07777);
+  if (target < 0) {
+    const int error = errno;
+    ::close(source);
+    return error;
+  }
+
+  int error = 0;
+  if (::ioctl(target, FICLONE, source) != 0) {
+    error = errno;
+  } else {
+    // Owner may fail for other users' files; the clone then belongs to us
+    (void)::fchown(target, copy.st.st_uid, copy.st.st_gid);
+    ::fchmod(target, copy.st.st_mode & 07777);
+    const struct timespec times[2] = {copy.st.st_atim, copy.st.st_mtim};
+    ::futimens(target, times);
+  }
+  ::close(source);
+  if (::close(target) != 0 && error == 0) {
+    error = errno;
+  }
+
+  if (error == 0 && ::rename(temp.c_str(), copy.path.c_str()) != 0) {
+    error = errno;
+  }
+  if (error != 0) {
+    ::unlink(temp.c_str());
+  }
+  return error;
+#else
+  (void)keep;
+  (void)copy;
+  return EOPNOTSUPP;
+#endif
+}
+
+/**
+ * @brief True for FICLONE errors of a file system that cannot clone here
+ *
+ * XFS without reflink=1, overlay and network mounts report EOPNOTSUPP or
+ * EINVAL (ENOTTY without the ioctl at all), EXDEV across mounts of one
+ * device.
+ */
+bool reflinkUnsupported(int error) {
+  return error == EOPNOTSUPP || error == EINVAL || error == EXDEV || error == ENOTTY;
+}
+
+} // namespace
+
+Consolidator::Consolidator(Method method, unsigned threads)
+    : m_method(method), m_thread_count(threads) {
+  if (m_thread_count == 0) {
+    m_thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+bool Consolidator::parseMethod(const std::string &name, Method &method) {
+  if (name == "auto") {
+    method = Method::Auto;
+  } else if (name == "hardlink") {
+    method = Method::Hardlink;
+  } else if (name == "reflink") {
+    method = Method::Reflink;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool Consolidator::supportsReflink(std::string_view fstype) {
+  return fstype == "btrfs" || fstype == "xfs" || fstype == "bcachefs";
+}
+
+/**
+ * @brief Consolidates groups in parallel, one group per worker at a time
+ *
+ * Per group:
+ * 1. lstat() every member; changed, vanished or special files are skipped
+ * 2. Members are bucketed by st_dev; the first of each bucket is kept
+ * 3. Every other member not yet on the kept inode is replaced; in Auto
+ *    mode a refused reflink falls back to a hardlink
+ *
+ * Results are collected per group and merged in group order.
+ */
+Consolidator::Report Consolidator::run(const std::vector<DuplicateFinder::DuplicateGroup> &groups) {
+  std::vector<Report> results(groups.size());
+  const auto mounts = MountTable::global().snapshot();
+
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> done{0};
+  std::atomic<std::size_t> replaced{0};
+  std::mutex progress_mutex;
+  Clock::time_point last_progress = Clock::now();
+
+  auto report_progress = [&] {
+    if (!m_progress)
+      return;
+    std::unique_lock<std::mutex> lock(progress_mutex, std::try_to_lock);
+    const auto now = Clock::now();
+    if (!lock.owns_lock() || now - last_progress < PROGRESS_INTERVAL)
+      return;
+    last_progress = now;
+    m_progress({done.load(std::memory_order_relaxed), groups.size(),
+                replaced.load(std::memory_order_relaxed)});
+  };
+
+  auto consolidate = [&](const DuplicateFinder::DuplicateGroup &group, Report &report) {
+    if (!group.verified) {
+      report.unverified += group.files.size();
+      return;
+    }
+
+    // 1. Current metadata
+    std::vector<Member> members;
+    members.reserve(group.files.size());
+    for (const FileInfo *file : group.files) {
+      Member member{file->getPath(), {}};
+      if (::lstat(member.path.c_str(), &member.st) != 0) {
+        report.failed.push_back({member.path, errorMessage(errno)});
+      } else if (!S_ISREG(member.st.st_mode)) {
+        report.failed.push_back({member.path, "not a regular file"});
+      } else if (member.st.st_size != file->getFileSize() ||
+                 (file->getModifiedTime() != 0 &&
+                  mtimeNs(member.st) != file->getModifiedTime())) {
+        report.failed.push_back({member.path, "changed since the scan"});
+      } else {
+        members.push_back(std::move(member));
+      }
+    }
+
+    // 2. One kept copy per file system
+    std::vector<bool> handled(members.size(), false);
+    for (std::size_t k = 0; k < members.size(); ++k) {
+      if (handled[k])
+        continue;
+      const Member &keep = members[k];
+      handled[k] = true;
+
+      Method method = m_method;
+      if (method == Method::Auto) {
+        const auto *mount = mounts->find(keep.path);
+        method = mount && supportsReflink(mount->fstype) ? Method::Reflink : Method::Hardlink;
+      }
+
+      // 3. Replace the others on the same device
+      for (std::size_t i = k + 1; i < members.size(); ++i) {
+        const Member &copy = members[i];
+        if (handled[i] || copy.st.st_dev != keep.st.st_dev)
+          continue;
+        handled[i] = true;
+
+        if (copy.st.st_ino == keep.st.st_ino) {
+          ++report.already_shared;
+          continue;
+        }
+        if (m_stop.stopRequested())
+          return;
+
+        int error = method == Method::Reflink ? replaceWithReflink(keep, copy)
+                                              : replaceWithHardlink(keep, copy);
+        if (error != 0 && m_method == Method::Auto && method == Method::Reflink &&
+            reflinkUnsupported(error)) {
+          // The file system type allows reflinks, this mount does not:
+          // hardlink this copy and the rest of the bucket
+          method = Method::Hardlink;
+          error = replaceWithHardlink(keep, copy);
+        }
+        if (error != 0) {
+          report.failed.push_back({copy.path, errorMessage(error)});
+          continue;
+        }
+        ++(method == Method::Reflink ? report.reflinked : report.hardlinked);
+        if (copy.st.st_nlink == 1) {
+          report.reclaimed += static_cast<long long>(copy.st.st_blocks) * 512;
+        }
+        report.replaced.push_back(copy.path);
+        replaced.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  auto worker = [&] {
+    for (std::size_t g = next.fetch_add(1); g < groups.size() && !m_stop.stopRequested();
+         g = next.fetch_add(1)) {
+      consolidate(groups[g], results[g]);
+      done.fetch_add(1, std::memory_order_relaxed);
+      report_progress();
+    }
+  };
+
+  const unsigned threads =
+      static_cast<unsigned>(std::min<std::size_t>(m_thread_count, groups.size()));
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < threads; ++t) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : workers) {
+    thread.join();
+  }
+
+  Report total;
+  for (auto &result : results) {
+    std::move(result.replaced.begin(), result.replaced.end(), std::back_inserter(total.replaced));
+    std::move(result.failed.begin(), result.failed.end(), std::back_inserter(total.failed));
+    total.hardlinked += result.hardlinked;
+    total.reflinked += result.reflinked;
+    total.already_shared += result.already_shared;
+    total.unverified += result.unverified;
+    total.reclaimed += result.reclaimed;
+  }
+  total.stopped = m_stop.stopRequested();
+
+  if (m_progress) {
+    m_progress({done.load(), groups.size(), replaced.load()});
+  }
+  return total;
+}
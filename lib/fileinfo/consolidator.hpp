@@ -0,0 +1,134 @@
+/**
+ * @file consolidator.hpp
+ * @brief Reclaims duplicate space by linking copies instead of deleting them
+ */
+
+#ifndef CONSOLIDATOR_HPP
+#define CONSOLIDATOR_HPP
+
+#include "duplicatefinder.hpp"
+#include "stoptoken.hpp"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class Consolidator
+ * @brief Replaces verified duplicates with links to one kept copy
+ *
+ * Every path of a group stays in place; only the storage is shared
+ * afterwards. Per group and file system (st_dev) the first member is
+ * kept and every other member is replaced:
+ * - Method::Hardlink: link() to a temporary name, then rename() over the
+ *   copy. The path then shares the kept file's inode, owner and mode.
+ * - Method::Reflink: a FICLONE clone of the kept file under a temporary
+ *   name, with the copy's owner, mode and times, renamed over the copy.
+ *   The files stay independent; only their extents are shared.
+ * - Method::Auto: reflinks on file systems that support them (btrfs, XFS,
+ *   bcachefs; see MountTable), hardlinks elsewhere. A mount whose clone
+ *   fails anyway (XFS without reflink=1, EOPNOTSUPP/EINVAL/EXDEV) gets
+ *   hardlinks, counted as such; only Method::Reflink fails there.
+ *
+ * Members are never linked across file systems, and members already
+ * sharing the kept file's inode are left alone. Only groups confirmed by
+ * DuplicateFinder::verifyGroups() are touched, and a member whose size or
+ * modification time changed since its scan is skipped.
+ *
+ * Groups are consolidated on N worker threads, one group at a time each.
+ *
+ * @code
+ * auto verified = DuplicateFinder::verifyGroups(groups);
+ * Consolidator consolidator(Consolidator::Method::Auto);
+ * auto report = consolidator.run(verified);
+ * std::cout << report.reclaimed << " bytes reclaimed\n";
+ * @endcode
+ *
+ * @note Replacing a file is atomic (rename()); a file modified between
+ *       the check and the rename loses that modification
+ */
+class Consolidator {
+public:
+  /** @brief How copies are replaced */
+  enum class Method {
+    Auto,     ///< Reflink where supported, else hardlink
+    Hardlink, ///< Shared inode
+    Reflink   ///< Shared extents (FICLONE); fails on other file systems
+  };
+
+  /** @brief A member that could not be replaced, and why */
+  struct Failure {
+    std::string path;
+    std::string message;
+  };
+
+  /** @brief Result of run() */
+  struct Report {
+    std::vector<std::string> replaced; ///< Paths now sharing the kept copy
+    std::vector<Failure> failed;       ///< Members left as they were
+    std::size_t hardlinked = 0;        ///< Replaced by hardlinks
+    std::size_t reflinked = 0;         ///< Replaced by reflinks
+    std::size_t already_shared = 0;    ///< Members already on the kept inode
+    std::size_t unverified = 0;        ///< Members of groups not verified
+    long long reclaimed = 0;           ///< Allocated bytes freed (st_blocks)
+    bool stopped = false;              ///< The stop token ended the run early
+  };
+
+  /** @brief Snapshot passed to the progress callback */
+  struct Progress {
+    std::size_t groups_done = 0;
+    std::size_t groups_total = 0;
+    std::size_t files_replaced = 0;
+  };
+
+  /**
+   * @brief Callback function type for progress notifications
+   *
+   * Invoked from worker threads, but never concurrently.
+   */
+  using ProgressCallback = std::function<void(const Progress &progress)>;
+
+  /** @brief Minimum time between two progress callbacks */
+  static constexpr std::chrono::milliseconds PROGRESS_INTERVAL{100};
+
+  /**
+   * @brief Creates a consolidator
+   * @param method How copies are replaced
+   * @param threads Worker count; 0 selects std::thread::hardware_concurrency()
+   */
+  explicit Consolidator(Method method = Method::Auto, unsigned threads = 0);
+
+  /** @brief Sets the progress callback (call before run()) */
+  void setProgressCallback(ProgressCallback progress) { m_progress = std::move(progress); }
+
+  /** @brief Ends run() after the current group of every worker */
+  void setStopToken(StopToken stop) { m_stop = std::move(stop); }
+
+  /**
+   * @brief Replaces the copies of every verified group
+   * @param groups Groups from DuplicateFinder::verifyGroups()
+   * @return Replaced and failed members, reclaimed space
+   */
+  Report run(const std::vector<DuplicateFinder::DuplicateGroup> &groups);
+
+  /**
+   * @brief Parses a method name
+   * @param name "auto", "hardlink" or "reflink"
+   * @param method Receives the method
+   * @return false for an unknown name
+   */
+  static bool parseMethod(const std::string &name, Method &method);
+
+  /** @brief True for file system types with FICLONE support */
+  static bool supportsReflink(std::string_view fstype);
+
+private:
+  Method m_method;
+  unsigned m_thread_count;
+  ProgressCallback m_progress;
+  StopToken m_stop;
+};
+
+#endif // CONSOLIDATOR_HPP
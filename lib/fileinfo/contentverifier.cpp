@@ -0,0 +1,235 @@
+/**
+ * @file contentverifier.cpp
+ * @brief Implementation of the chunked, multi-stream content comparison
+ */
+
+#include "contentverifier.hpp"
+#include "stats.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+
+namespace {
+
+/**
+ * @brief One file being compared, opened on demand
+ *
+ * The identity (device, inode) and size are taken once by stat(); a
+ * reopened descriptor must refer to the same file.
+ */
+class Stream {
+public:
+  Stream() = default;
+  ~Stream() { close(); }
+  Stream(const Stream &) = delete;
+  Stream &operator=(const Stream &) = delete;
+
+  /** @return false if the file does not exist or is no regular file */
+  bool stat(const std::string &path) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+      return false;
+    m_path = path;
+    m_size = static_cast<std::size_t>(st.st_size);
+    m_device = st.st_dev;
+    m_inode = st.st_ino;
+    return true;
+  }
+
+  std::size_t size() const { return m_size; }
+
+  bool isOpen() const { return m_fd >= 0; }
+
+  /** @return false if the file cannot be opened or was replaced */
+  bool open() {
+    if (m_fd >= 0)
+      return true;
+    m_fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0)
+      return false;
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0 || st.st_dev != m_device || st.st_ino != m_inode) {
+      close();
+      return false;
+    }
+    ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return true;
+  }
+
+  void close() {
+    if (m_fd >= 0)
+      ::close(m_fd);
+    m_fd = -1;
+  }
+
+  /** @brief Starts reading a later chunk while the current one is compared */
+  void prefetch(std::size_t offset) {
+    if (m_fd >= 0 && offset < m_size) {
+      ::posix_fadvise(m_fd, static_cast<off_t>(offset),
+                      static_cast<off_t>(std::min(ContentVerifier::CHUNK_SIZE, m_size - offset)),
+                      POSIX_FADV_WILLNEED);
+    }
+  }
+
+  /** @return false on a read error or a file shorter than offset + length */
+  bool read(std::size_t offset, std::size_t length, std::uint8_t *buffer) {
+    std::size_t done = 0;
+    while (done < length) {
+      const ssize_t n =
+          ::pread(m_fd, buffer + done, length - done, static_cast<off_t>(offset + done));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      done += static_cast<std::size_t>(n);
+    }
+    return true;
+  }
+
+private:
+  std::string m_path;
+  int m_fd = -1;
+  std::size_t m_size = 0;
+  dev_t m_device = 0;
+  ino_t m_inode = 0;
+};
+
+/** @brief Files known to be equal up to offset */
+struct Candidates {
+  std::vector<std::size_t> members;
+  std::size_t offset;
+};
+
+} // namespace
+
+/**
+ * @brief Refines sets of equal-sized files chunk by chunk
+ *
+ * Every set compares its members against its first member. Members that
+ * differ at chunk k were equal to it before k, so they are equal to each
+ * other up to k as well and form a new set starting at k.
+ *
+ * The first MAX_OPEN_FILES streams read stay open until they leave all
+ * sets; the others are opened and closed around every chunk.
+ */
+std::vector<std::vector<std::size_t>>
+ContentVerifier::partition(const std::vector<std::string> &paths, const StopToken &stop,
+                           std::vector<std::size_t> *unreadable) {
+  std::vector<std::size_t> failed;
+  std::vector<std::unique_ptr<Stream>> streams(paths.size());
+  std::map<std::size_t, std::vector<std::size_t>> bySize;
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    auto stream = std::make_unique<Stream>();
+    if (stream->stat(paths[i])) {
+      bySize[stream->size()].push_back(i);
+      streams[i] = std::move(stream);
+    } else {
+      failed.push_back(i);
+    }
+  }
+
+  std::size_t open_files = 0;
+  auto read = [&](std::size_t i, std::size_t offset, std::size_t length, std::uint8_t *buffer) {
+    Stream &stream = *streams[i];
+    const bool transient = !stream.isOpen() && open_files >= MAX_OPEN_FILES;
+    if (!stream.isOpen()) {
+      if (!stream.open())
+        return false;
+      if (!transient)
+        ++open_files;
+    }
+    const bool ok = stream.read(offset, length, buffer);
+    if (transient)
+      stream.close();
+    return ok;
+  };
+  auto release = [&](std::size_t i) {
+    if (streams[i]->isOpen()) {
+      streams[i]->close();
+      --open_files;
+    }
+  };
+
+  std::vector<Candidates> work;
+  for (auto &[size, members] : bySize) {
+    if (members.size() > 1)
+      work.push_back({std::move(members), 0});
+  }
+
+  const std::unique_ptr<std::uint8_t[]> reference(new std::uint8_t[CHUNK_SIZE]);
+  const std::unique_ptr<std::uint8_t[]> data(new std::uint8_t[CHUNK_SIZE]);
+  Stats::Tally compared(Stats::Counter::BytesCompared);
+  std::vector<std::vector<std::size_t>> sets;
+  while (!work.empty()) {
+    Candidates set = std::move(work.back());
+    work.pop_back();
+    std::vector<std::size_t> &members = set.members;
+    const std::size_t size = streams[members.front()]->size();
+
+    std::size_t offset = set.offset;
+    while (offset < size && members.size() > 1) {
+      if (stop.stopRequested())
+        return {};
+
+      const std::size_t length = std::min(CHUNK_SIZE, size - offset);
+      for (std::size_t member : members) {
+        streams[member]->prefetch(offset + CHUNK_SIZE);
+      }
+
+      if (!read(members.front(), offset, length, reference.get())) {
+        // Unreadable: retry with the next one
+        failed.push_back(members.front());
+        release(members.front());
+        members.erase(members.begin());
+        continue;
+      }
+
+      std::vector<std::size_t> kept{members.front()};
+      std::vector<std::size_t> left;
+      for (std::size_t i = 1; i < members.size(); ++i) {
+        if (!read(members[i], offset, length, data.get())) {
+          failed.push_back(members[i]);
+          release(members[i]);
+        } else if (std::memcmp(reference.get(), data.get(), length) == 0) {
+          kept.push_back(members[i]);
+        } else {
+          left.push_back(members[i]);
+        }
+      }
+      compared.add(static_cast<std::uint64_t>(length) * (kept.size() + left.size()));
+
+      if (left.size() > 1) {
+        work.push_back({std::move(left), offset});
+      } else if (left.size() == 1) {
+        release(left.front());
+      }
+      members.swap(kept);
+      offset += length;
+    }
+
+    for (std::size_t member : members) {
+      release(member);
+    }
+    if (members.size() > 1)
+      sets.push_back(std::move(members));
+  }
+
+  std::sort(sets.begin(), sets.end());
+  if (unreadable) {
+    std::sort(failed.begin(), failed.end());
+    *unreadable = std::move(failed);
+  }
+  return sets;
+}
+
+bool ContentVerifier::equal(const std::string &a, const std::string &b) {
+  return partition({a, b}).size() == 1;
+}
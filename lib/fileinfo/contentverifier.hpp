@@ -0,0 +1,67 @@
+/**
+ * @file contentverifier.hpp
+ * @brief Byte-for-byte comparison of duplicate candidates
+ */
+
+#ifndef CONTENTVERIFIER_HPP
+#define CONTENTVERIFIER_HPP
+
+#include "stoptoken.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @class ContentVerifier
+ * @brief Splits files into sets of identical content without hashing
+ *
+ * Files are read with pread() into a chunk buffer and compared chunk by
+ * chunk against the first member of their set, so every file is read as
+ * one sequential stream, all streams advance together, and the next
+ * chunk of every open stream is requested ahead (POSIX_FADV_WILLNEED)
+ * while the current one is compared. A file leaves its set at its first
+ * differing chunk; files that left together continue from that chunk
+ * among themselves, so no byte is compared twice and unique files cost
+ * only their first differing chunk.
+ *
+ * Nothing is mapped, so a file truncated meanwhile is a read error, not
+ * a SIGBUS. At most MAX_OPEN_FILES files of a call stay open; the others
+ * are opened for each chunk, so large groups need neither more
+ * descriptors nor more memory (two chunk buffers per call). A file that
+ * cannot be read, or was replaced since the call started, is reported
+ * as unreadable instead of being counted as different.
+ *
+ * @note Stateless; safe to use from several threads
+ * @see DuplicateFinder::verifyGroups()
+ */
+class ContentVerifier {
+public:
+  /** @brief Bytes compared per step and stream */
+  static constexpr std::size_t CHUNK_SIZE = 1024 * 1024;
+
+  /** @brief Files of one partition() call kept open between chunks */
+  static constexpr std::size_t MAX_OPEN_FILES = 64;
+
+  /**
+   * @brief Groups files of identical content
+   *
+   * @param paths Files to compare
+   * @param stop Ends the comparison early (the result is then empty)
+   * @param unreadable Receives the indices of files that could not be
+   *        opened or read completely, ascending (may be nullptr)
+   * @return Sets of at least two indices into paths, each in input order;
+   *         unique and unreadable files are left out
+   */
+  static std::vector<std::vector<std::size_t>>
+  partition(const std::vector<std::string> &paths, const StopToken &stop = StopToken(),
+            std::vector<std::size_t> *unreadable = nullptr);
+
+  /**
+   * @brief Checks whether two files have the same content
+   * @return false if they differ or one cannot be read
+   */
+  static bool equal(const std::string &a, const std::string &b);
+};
+
+#endif // CONTENTVERIFIER_HPP
@@ -0,0 +1,315 @@
+/**
+ * @file deletionengine.cpp
+ * @brief Implementation of the batched, descriptor-relative deletion
+ */
+
+#include "deletionengine.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/** @brief Not processed yet (stopped before the target was reached) */
+constexpr int NOT_REACHED = -1;
+
+std::string errorMessage(int error) {
+  return std::error_code(error, std::generic_category()).message();
+}
+
+/** @brief Splits a path into parent directory and entry name */
+std::pair<std::string, std::string> splitPath(const std::string &path) {
+  const std::size_t slash = path.find_last_of('/');
+  if (slash == std::string::npos)
+    return {".", path};
+  return {slash == 0 ? "/" : path.substr(0, slash), path.substr(slash + 1)};
+}
+
+/**
+ * @brief Removes a directory below parent_fd with everything beneath it
+ *
+ * Children are collected before removing them, so the listing does not
+ * change under readdir(). Symlinks are removed, never followed, also when
+ * name itself is a symlink to a directory. Removal
+ * continues after an error; error keeps the last one.
+ *
+ * @return true if the directory itself was removed
+ */
+bool removeTree(int parent_fd, const char *name, const StopToken &stop,
+                std::atomic<std::uint64_t> &removed, int &error) {
+  const int fd = ::openat(parent_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0 && (errno == ELOOP || errno == ENOTDIR)) {
+    // A symlink to a directory (scanners flag it as one), or replaced by
+    // a file meanwhile: remove the entry itself, never the link target
+    if (::unlinkat(parent_fd, name, 0) != 0) {
+      error = errno;
+      return false;
+    }
+    removed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  if (fd < 0) {
+    error = errno;
+    return false;
+  }
+  DIR *dir = ::fdopendir(fd);
+  if (!dir) {
+    error = errno;
+    ::close(fd);
+    return false;
+  }
+
+  std::vector<std::pair<std::string, bool>> children;
+  while (const dirent *entry = ::readdir(dir)) {
+    const char *child = entry->d_name;
+    if (child[0] == '.' && (child[1] == '\0' || (child[1] == '.' && child[2] == '\0')))
+      continue;
+
+    bool is_directory = entry->d_type == DT_DIR;
+    if (entry->d_type == DT_UNKNOWN) {
+      struct stat st;
+      is_directory = ::fstatat(fd, child, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+    }
+    children.emplace_back(child, is_directory);
+  }
+
+  bool complete = true;
+  for (const auto &[child, is_directory] : children) {
+    if (stop.stopRequested()) {
+      error = ECANCELED;
+      complete = false;
+      break;
+    }
+    if (is_directory) {
+      complete = removeTree(fd, child.c_str(), stop, removed, error) && complete;
+    } else if (::unlinkat(fd, child.c_str(), 0) == 0) {
+      removed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      error = errno;
+      complete = false;
+    }
+  }
+  ::closedir(dir);
+
+  if (!complete)
+    return false;
+  if (::unlinkat(parent_fd, name, AT_REMOVEDIR) != 0) {
+    error = errno;
+    return false;
+  }
+  removed.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+/** @brief True for a directory that is not a symlink to one */
+bool isRealDirectory(const std::string &path) {
+  struct stat st;
+  return ::lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/** @brief Targets sharing one parent directory */
+struct Batch {
+  std::string parent;
+  std::vector<std::size_t> targets;
+};
+
+} // namespace
+
+DeletionEngine::DeletionEngine(unsigned threads) : m_thread_count(threads) {
+  if (m_thread_count == 0) {
+    m_thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+/**
+ * @brief One FileSafety evaluation over the batch
+ *
+ * All paths are checked against the same /proc/mounts snapshot
+ * (FileSafety::checkDeletions()). Allowed entries below an allowed
+ * directory are dropped afterwards: removeTree() deletes them with their
+ * ancestor, and a separate unlinkat() on another worker would race with
+ * it and fail with ENOENT. Entries below a blocked directory stay, since
+ * FileSafety may allow them on their own, and so do entries below a
+ * symlink to a directory (only the link is removed).
+ */
+DeletionEngine::Plan DeletionEngine::plan(const std::vector<FileInfo> &files) {
+  std::vector<const FileInfo *> unique;
+  std::vector<std::string> paths;
+  std::unordered_set<std::string> seen;
+  unique.reserve(files.size());
+  paths.reserve(files.size());
+  for (const auto &file : files) {
+    if (file.isParentDir())
+      continue;
+    std::string path = file.getPath();
+    if (seen.insert(path).second) {
+      unique.push_back(&file);
+      paths.push_back(std::move(path));
+    }
+  }
+
+  const auto statuses = FileSafety::checkDeletions(paths);
+
+  Plan plan;
+  std::vector<std::size_t> allowed;
+  std::unordered_set<std::string_view> directories;
+  for (std::size_t i = 0; i < unique.size(); ++i) {
+    switch (statuses[i]) {
+    case FileSafety::DeletionStatus::WarningRemovableMedia:
+      plan.removable_media = true;
+      [[fallthrough]];
+    case FileSafety::DeletionStatus::Allowed:
+      allowed.push_back(i);
+      if (unique[i]->isDirectory() && isRealDirectory(paths[i])) {
+        directories.insert(paths[i]);
+      }
+      break;
+    default:
+      plan.blocked.push_back({paths[i], FileSafety::getStatusMessage(statuses[i], paths[i])});
+      break;
+    }
+  }
+
+  auto belowDirectory = [&directories](std::string_view path) {
+    for (std::size_t slash = path.find_last_of('/');
+         slash != std::string_view::npos && slash != 0;
+         slash = path.find_last_of('/', slash - 1)) {
+      if (directories.count(path.substr(0, slash)))
+        return true;
+    }
+    return false;
+  };
+
+  plan.targets.reserve(allowed.size());
+  for (std::size_t i : allowed) {
+    if (!directories.empty() && belowDirectory(paths[i]))
+      continue;
+    plan.targets.push_back(*unique[i]);
+    if (!unique[i]->isDirectory()) {
+      plan.bytes += unique[i]->getFileSize();
+    }
+  }
+  return plan;
+}
+
+/**
+ * @brief Deletes the plan's targets, one parent directory per work item
+ *
+ * Workers take the next batch from a shared counter, open its parent
+ * directory once and unlink every target relative to it.
+ */
+DeletionEngine::Report DeletionEngine::run(const Plan &plan) {
+  const std::size_t total = plan.targets.size();
+
+  std::vector<std::string> paths(total);
+  std::vector<std::string> names(total);
+  std::vector<Batch> batches;
+  std::unordered_map<std::string, std::size_t> batchOf;
+  for (std::size_t i = 0; i < total; ++i) {
+    paths[i] = plan.targets[i].getPath();
+    auto [parent, name] = splitPath(paths[i]);
+    names[i] = std::move(name);
+    auto [it, inserted] = batchOf.emplace(parent, batches.size());
+    if (inserted) {
+      batches.push_back({std::move(parent), {}});
+    }
+    batches[it->second].targets.push_back(i);
+  }
+
+  std::vector<int> errors(total, NOT_REACHED);
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> done{0};
+  std::atomic<std::uint64_t> removed{0};
+  std::mutex progress_mutex;
+  Clock::time_point last_progress = Clock::now();
+
+  auto report_progress = [&] {
+    if (!m_progress)
+      return;
+    std::unique_lock<std::mutex> lock(progress_mutex, std::try_to_lock);
+    const auto now = Clock::now();
+    if (!lock.owns_lock() || now - last_progress < PROGRESS_INTERVAL)
+      return;
+    last_progress = now;
+    m_progress({done.load(std::memory_order_relaxed), total,
+                removed.load(std::memory_order_relaxed)});
+  };
+
+  auto worker = [&] {
+    for (std::size_t b = next.fetch_add(1); b < batches.size() && !m_stop.stopRequested();
+         b = next.fetch_add(1)) {
+      const Batch &batch = batches[b];
+      const int dir_fd = ::open(batch.parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+      if (dir_fd < 0) {
+        const int error = errno;
+        for (std::size_t t : batch.targets) {
+          errors[t] = error;
+        }
+        done.fetch_add(batch.targets.size(), std::memory_order_relaxed);
+        report_progress();
+        continue;
+      }
+
+      for (std::size_t t : batch.targets) {
+        if (m_stop.stopRequested())
+          break;
+        int error = 0;
+        if (plan.targets[t].isDirectory()) {
+          removeTree(dir_fd, names[t].c_str(), m_stop, removed, error);
+        } else if (::unlinkat(dir_fd, names[t].c_str(), 0) == 0) {
+          removed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          error = errno;
+        }
+        errors[t] = error;
+        done.fetch_add(1, std::memory_order_relaxed);
+        report_progress();
+      }
+      ::close(dir_fd);
+    }
+  };
+
+  const unsigned threads =
+      static_cast<unsigned>(std::min<std::size_t>(m_thread_count, batches.size()));
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < threads; ++t) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : workers) {
+    thread.join();
+  }
+
+  Report report;
+  report.items_removed = removed.load();
+  for (std::size_t i = 0; i < total; ++i) {
+    if (errors[i] == 0) {
+      report.deleted.push_back(std::move(paths[i]));
+    } else if (errors[i] == NOT_REACHED || errors[i] == ECANCELED) {
+      report.stopped = true;
+    } else {
+      report.failed.push_back({std::move(paths[i]), errorMessage(errors[i])});
+    }
+  }
+  report.stopped = report.stopped || m_stop.stopRequested();
+
+  if (m_progress) {
+    m_progress({done.load(), total, report.items_removed});
+  }
+  return report;
+}
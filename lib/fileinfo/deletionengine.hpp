@@ -0,0 +1,131 @@
+/**
+ * @file deletionengine.hpp
+ * @brief Batched, parallel deletion of files and directory trees
+ */
+
+#ifndef DELETIONENGINE_HPP
+#define DELETIONENGINE_HPP
+
+#include "fileinfo.hpp"
+#include "filesafety.hpp"
+#include "stoptoken.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @class DeletionEngine
+ * @brief Deletes a batch of entries after one safety pass
+ *
+ * Usage pattern:
+ * 1. plan() runs FileSafety over the whole batch with one mount snapshot
+ *    and separates blocked entries (no deletion yet, so the caller can
+ *    ask for confirmation with the result)
+ * 2. run() deletes the allowed entries on N worker threads
+ *
+ * Entries are grouped by parent directory. A worker opens the parent once
+ * and removes its entries with unlinkat() relative to that descriptor, so
+ * no path is resolved again per file. Directories are removed
+ * recursively through openat()/unlinkat(), never following symlinks; a
+ * symlink to a directory is removed as a link.
+ *
+ * Example usage:
+ * @code
+ * DeletionEngine engine;
+ * auto plan = DeletionEngine::plan(marked);
+ * if (confirm(plan)) {
+ *   auto report = engine.run(plan);
+ *   std::cout << report.deleted.size() << " deleted\n";
+ * }
+ * @endcode
+ *
+ * @see FileSafety::checkDeletions()
+ */
+class DeletionEngine {
+public:
+  /** @brief An entry that was not deleted, and why */
+  struct Failure {
+    std::string path;
+    std::string message;
+  };
+
+  /** @brief Result of the safety pass */
+  struct Plan {
+    std::vector<FileInfo> targets;  ///< Entries allowed for deletion
+    std::vector<Failure> blocked;   ///< Entries FileSafety refused
+    bool removable_media = false;   ///< Some target is on removable media
+    long long bytes = 0;            ///< Total size of the file targets
+  };
+
+  /**
+   * @brief Result of run()
+   *
+   * Targets not reached after a stop are in neither list.
+   */
+  struct Report {
+    std::vector<std::string> deleted; ///< Targets removed, in plan order
+    std::vector<Failure> failed;      ///< Targets that could not be removed
+    std::uint64_t items_removed = 0;  ///< Removed entries incl. directory contents
+    bool stopped = false;             ///< The stop token ended the run early
+  };
+
+  /** @brief Snapshot passed to the progress callback */
+  struct Progress {
+    std::size_t targets_done = 0;    ///< Targets finished (deleted or failed)
+    std::size_t targets_total = 0;   ///< Targets of the plan
+    std::uint64_t items_removed = 0; ///< Removed entries so far
+  };
+
+  /**
+   * @brief Callback function type for progress notifications
+   *
+   * Invoked from worker threads, but never concurrently.
+   */
+  using ProgressCallback = std::function<void(const Progress &progress)>;
+
+  /** @brief Minimum time between two progress callbacks */
+  static constexpr std::chrono::milliseconds PROGRESS_INTERVAL{100};
+
+  /**
+   * @brief Creates an engine
+   * @param threads Worker count; 0 selects std::thread::hardware_concurrency()
+   */
+  explicit DeletionEngine(unsigned threads = 0);
+
+  /** @brief Sets the progress callback (call before run()) */
+  void setProgressCallback(ProgressCallback progress) { m_progress = std::move(progress); }
+
+  /** @brief Ends run() after the current entry of every worker */
+  void setStopToken(StopToken stop) { m_stop = std::move(stop); }
+
+  /**
+   * @brief Safety pass over a batch
+   *
+   * Entries FileSafety blocks move to Plan::blocked; removable media only
+   * sets Plan::removable_media. Parent-directory entries (".."),
+   * duplicate paths and allowed entries below an allowed directory target
+   * (deleted with it; a symlink to a directory covers nothing) are
+   * dropped.
+   *
+   * @param files Entries to delete
+   * @return Targets, blocked entries and totals
+   */
+  static Plan plan(const std::vector<FileInfo> &files);
+
+  /**
+   * @brief Deletes the targets of a plan
+   * @param plan Result of plan()
+   * @return Deleted and failed targets
+   */
+  Report run(const Plan &plan);
+
+private:
+  unsigned m_thread_count;
+  ProgressCallback m_progress;
+  StopToken m_stop;
+};
+
+#endif // DELETIONENGINE_HPP
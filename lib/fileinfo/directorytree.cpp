@@ -0,0 +1,236 @@
+/**
+ * @file directorytree.cpp
+ * @brief Implementation of the per-directory size aggregation
+ */
+
+#include "directorytree.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+DirectoryTree::DirectoryTree(std::string root) {
+  while (root.size() > 1 && root.back() == '/') {
+    root.pop_back();
+  }
+  m_ids.emplace(root, 0);
+  m_nodes.emplace_back();
+  m_nodes.back().path = std::move(root);
+}
+
+bool DirectoryTree::intern(const std::string &path, NodeId &id) {
+  const auto it = m_ids.find(path);
+  if (it != m_ids.end()) {
+    id = it->second;
+    return true;
+  }
+
+  const std::string &root = m_nodes[0].path;
+  const bool below = root == "/" ? path.size() > 1 && path[0] == '/'
+                                 : path.size() > root.size() + 1 &&
+                                       path.compare(0, root.size(), root) == 0 &&
+                                       path[root.size()] == '/';
+  if (!below)
+    return false;
+
+  const std::size_t slash = path.rfind('/');
+  NodeId parent;
+  if (!intern(slash == 0 ? std::string("/") : path.substr(0, slash), parent))
+    return false;
+
+  id = static_cast<NodeId>(m_nodes.size());
+  m_nodes.emplace_back();
+  m_nodes.back().path = path;
+  m_nodes.back().parent = parent;
+  m_nodes[parent].children.push_back(id);
+  ++m_nodes[parent].own.directories;
+  m_ids.emplace(path, id);
+  return true;
+}
+
+void DirectoryTree::count(NodeId id, const FileInfo &entry) {
+  Totals &own = m_nodes[id].own;
+  const long long size = entry.getFileSize();
+  ++own.files;
+  own.size += size;
+  if (size == 0) {
+    ++own.zero_files;
+  }
+
+  // Further links of an inode take no space of their own
+  long long bytes = entry.getAllocatedSize();
+  if (entry.hasInode()) {
+    const auto inode = entry.getInode();
+    if (inode.links > 1 && !m_linked.emplace(inode.device, inode.inode).second) {
+      bytes = 0;
+    }
+  }
+  own.bytes += bytes;
+  if (entry.isDuplicate()) {
+    own.duplicate_bytes += bytes;
+  }
+}
+
+void DirectoryTree::add(const FileInfo &entry) {
+  if (entry.isParentDir())
+    return;
+
+  NodeId id;
+  if (entry.isDirectory()) {
+    intern(entry.getPath(), id);
+  } else if (intern(entry.getDirectory(), id)) {
+    count(id, entry);
+  }
+}
+
+void DirectoryTree::add(const std::vector<FileInfo> &batch) {
+  // Scanners emit the entries of a directory together
+  const std::string *last_dir = nullptr;
+  NodeId last_id = 0;
+  bool last_known = false;
+
+  for (const FileInfo &entry : batch) {
+    if (entry.isParentDir() || entry.isDirectory()) {
+      add(entry);
+      continue;
+    }
+    const std::string &dir = entry.getDirectory();
+    if (last_dir != &dir && (!last_dir || *last_dir != dir)) {
+      last_known = intern(dir, last_id);
+    }
+    last_dir = &dir;
+    if (last_known) {
+      count(last_id, entry);
+    }
+  }
+}
+
+void DirectoryTree::setDuplicates(const std::vector<FileInfo> &files) {
+  for (Node &node : m_nodes) {
+    node.own.duplicate_bytes = 0;
+  }
+
+  std::set<std::pair<std::uint64_t, std::uint64_t>> linked;
+  for (const FileInfo &file : files) {
+    NodeId id;
+    if (!file.isDuplicate() || file.isDirectory() || !intern(file.getDirectory(), id))
+      continue;
+    if (file.hasInode()) {
+      const auto inode = file.getInode();
+      if (inode.links > 1 && !linked.emplace(inode.device, inode.inode).second)
+        continue;
+    }
+    m_nodes[id].own.duplicate_bytes += file.getAllocatedSize();
+  }
+}
+
+/**
+ * @brief Sums one subtree; children have larger ids than their parent
+ *        but are not contiguous, so the subtree is walked in pre-order
+ *        and summed backwards (children before parents)
+ */
+void DirectoryTree::sumSubtree(NodeId id) {
+  std::vector<NodeId> order{id};
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    const auto &children = m_nodes[order[i]].children;
+    order.insert(order.end(), children.begin(), children.end());
+  }
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    Node &node = m_nodes[*it];
+    node.total = node.own;
+    for (NodeId child : node.children) {
+      node.total.add(m_nodes[child].total);
+    }
+  }
+}
+
+/**
+ * @brief Sums the tree bottom-up
+ *
+ * Implementation details:
+ * 1. Below PARALLEL_THRESHOLD nodes (or with one thread) every child of
+ *    the root is one subtree
+ * 2. Otherwise the root's children are expanded breadth-first until
+ *    there are 4 subtrees per thread (or only leaves); expanded nodes are
+ *    remembered for step 4
+ * 3. Workers take subtrees from a shared counter and sum each one alone;
+ *    subtrees are disjoint, so no node is written twice
+ * 4. The expanded nodes and the root are summed in reverse
+ *    breadth-first order, which visits children before their parents
+ */
+void DirectoryTree::rollUp(unsigned threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // 1./2. Subtrees for the workers
+  std::vector<NodeId> above{root()};
+  std::vector<NodeId> subtrees = m_nodes[root()].children;
+  if (threads > 1 && m_nodes.size() >= PARALLEL_THRESHOLD) {
+    while (subtrees.size() < std::size_t{threads} * 4) {
+      std::vector<NodeId> next;
+      bool expanded = false;
+      for (NodeId id : subtrees) {
+        const auto &children = m_nodes[id].children;
+        if (children.empty()) {
+          next.push_back(id);
+        } else {
+          above.push_back(id);
+          next.insert(next.end(), children.begin(), children.end());
+          expanded = true;
+        }
+      }
+      subtrees.swap(next);
+      if (!expanded)
+        break;
+    }
+  } else {
+    threads = 1;
+  }
+
+  // 3. Disjoint subtrees in parallel
+  std::atomic<std::size_t> next{0};
+  auto worker = [&] {
+    for (std::size_t i = next.fetch_add(1); i < subtrees.size(); i = next.fetch_add(1)) {
+      sumSubtree(subtrees[i]);
+    }
+  };
+  std::vector<std::thread> workers;
+  const auto thread_count = std::min<std::size_t>(threads, subtrees.size());
+  for (std::size_t t = 1; t < thread_count; ++t) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : workers) {
+    thread.join();
+  }
+
+  // 4. The nodes above the subtrees
+  for (auto it = above.rbegin(); it != above.rend(); ++it) {
+    Node &node = m_nodes[*it];
+    node.total = node.own;
+    for (NodeId child : node.children) {
+      node.total.add(m_nodes[child].total);
+    }
+  }
+}
+
+bool DirectoryTree::find(const std::string &path, NodeId &id) const {
+  const auto it = m_ids.find(path);
+  if (it == m_ids.end())
+    return false;
+  id = it->second;
+  return true;
+}
+
+std::vector<DirectoryTree::NodeId> DirectoryTree::childrenBySize(NodeId id) const {
+  std::vector<NodeId> children = m_nodes[id].children;
+  std::sort(children.begin(), children.end(), [this](NodeId a, NodeId b) {
+    const Node &x = m_nodes[a];
+    const Node &y = m_nodes[b];
+    if (x.total.bytes != y.total.bytes)
+      return x.total.bytes > y.total.bytes;
+    return x.path < y.path;
+  });
+  return children;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file directorytree.hpp
+ * @brief Cumulative sizes per directory, collected from a recursive scan
+ */
+
+#ifndef DIRECTORYTREE_HPP
+#define DIRECTORYTREE_HPP
+
+#include "fileinfo.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class DirectoryTree
+ * @brief Aggregates the entries of a recursive scan per directory ("du")
+ *
+ * Built while a scan streams its batches, so the sizes of a whole tree
+ * cost no second walk:
+ * 1. add() counts every file into the node of its directory (the node's
+ *    own totals); nodes of missing parents are created on the way, so the
+ *    batch order does not matter
+ * 2. rollUp() sums the own totals bottom-up into every node's subtree
+ *    totals. Disjoint subtrees are summed on N worker threads, the nodes
+ *    above them afterwards.
+ *
+ * Bytes are allocated bytes (FileInfo::getAllocatedSize()), and a file
+ * with several hardlinks in the tree is counted once, at the first path
+ * added, as du does. The file count counts every path.
+ *
+ * Duplicate bytes are the allocated bytes of files carrying
+ * FileInfo::Duplicate; they can be filled in later with setDuplicates()
+ * once a duplicate search over the scanned files has finished.
+ *
+ * @code
+ * DirectoryTree tree(root);
+ * scanner.scanDirectoryStreaming(root, true, false, [&](std::vector<FileInfo> &&batch) {
+ *   tree.add(batch);
+ *   return true;
+ * });
+ * tree.rollUp();
+ * for (auto id : tree.childrenBySize(tree.root())) { ... }
+ * @endcode
+ *
+ * @note Not thread-safe; rollUp() uses threads of its own
+ */
+class DirectoryTree {
+public:
+  /** @brief Node handle; the root is 0, parents have smaller ids */
+  using NodeId = std::uint32_t;
+
+  /** @brief Sizes and counts of a directory or subtree */
+  struct Totals {
+    long long bytes = 0;           ///< Allocated bytes (hardlinks once)
+    long long size = 0;            ///< Apparent bytes (file sizes)
+    long long duplicate_bytes = 0; ///< Allocated bytes of duplicates
+    std::uint64_t files = 0;       ///< Non-directory entries
+    std::uint64_t zero_files = 0;  ///< Empty regular files
+    std::uint64_t directories = 0; ///< Subdirectories
+
+    void add(const Totals &other) {
+      bytes += other.bytes;
+      size += other.size;
+      duplicate_bytes += other.duplicate_bytes;
+      files += other.files;
+      zero_files += other.zero_files;
+      directories += other.directories;
+    }
+  };
+
+  /** @brief A directory of the tree */
+  struct Node {
+    std::string path;
+    NodeId parent = 0;             ///< Unused for the root
+    std::vector<NodeId> children;  ///< Subdirectories, in creation order
+    Totals own;                    ///< Entries directly in this directory
+    Totals total;                  ///< Whole subtree, valid after rollUp()
+  };
+
+  /** @brief Subtree count from which rollUp() uses worker threads */
+  static constexpr std::size_t PARALLEL_THRESHOLD = 4096;
+
+  /**
+   * @brief Creates a tree holding only its root
+   * @param root Scanned directory; entries outside of it are ignored
+   */
+  explicit DirectoryTree(std::string root);
+
+  /**
+   * @brief Counts one scanned entry
+   *
+   * Directories get a node; files count into their directory. The parent
+   * entry (..) and entries outside the root are ignored.
+   *
+   * @param entry Entry of a recursive scan below the root
+   */
+  void add(const FileInfo &entry);
+
+  /**
+   * @brief Counts a streamed batch (see add(const FileInfo &))
+   *
+   * Consecutive entries of one directory cost one lookup.
+   */
+  void add(const std::vector<FileInfo> &batch);
+
+  /**
+   * @brief Recomputes the duplicate bytes from a searched listing
+   *
+   * Resets the duplicate bytes of every node, then counts the entries
+   * carrying FileInfo::Duplicate. Call rollUp() afterwards.
+   *
+   * @param files Entries after DuplicateFinder::findDuplicates()
+   */
+  void setDuplicates(const std::vector<FileInfo> &files);
+
+  /**
+   * @brief Computes the subtree totals of every node
+   * @param threads Worker count; 0 selects std::thread::hardware_concurrency()
+   */
+  void rollUp(unsigned threads = 0);
+
+  /** @brief The scanned directory */
+  NodeId root() const { return 0; }
+
+  /** @brief Node of a valid id */
+  const Node &node(NodeId id) const { return m_nodes[id]; }
+
+  /** @brief Number of directories including the root */
+  std::size_t size() const { return m_nodes.size(); }
+
+  /**
+   * @brief Looks up the node of a directory
+   * @param path Directory path as scanned (no trailing slash but for "/")
+   * @param id Receives the node on success
+   * @return false if the directory is not part of the tree
+   */
+  bool find(const std::string &path, NodeId &id) const;
+
+  /**
+   * @brief Subdirectories of a node, largest subtree first
+   * @return Ids ordered by total bytes (descending), then by path
+   */
+  std::vector<NodeId> childrenBySize(NodeId id) const;
+
+private:
+  /** @return false outside the root; else the node, created with its parents */
+  bool intern(const std::string &path, NodeId &id);
+  void count(NodeId id, const FileInfo &entry);
+  void sumSubtree(NodeId id);
+
+  std::vector<Node> m_nodes;
+  std::unordered_map<std::string, NodeId> m_ids;
+  std::set<std::pair<std::uint64_t, std::uint64_t>> m_linked; ///< Counted multi-link inodes
+};
+
+#endif // DIRECTORYTREE_HPP
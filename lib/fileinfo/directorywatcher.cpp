@@ -0,0 +1,222 @@
+/**
+ * @file directorywatcher.cpp
+ * @brief inotify based directory watching (Linux only)
+ */
+
+#include "directorywatcher.hpp"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <unordered_map>
+#endif
+
+DirectoryWatcher::DirectoryWatcher(EventCallback on_events)
+    : m_on_events(std::move(on_events)) {}
+
+std::string DirectoryWatcher::getDirectory() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_dir;
+}
+
+#if defined(__linux__)
+
+namespace {
+
+/** @brief Events that change the listing of the watched directory */
+constexpr std::uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                     IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                     IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR |
+                                     IN_EXCL_UNLINK;
+
+/** @brief A batch is delivered at the latest after this long */
+constexpr auto MAX_BATCH_AGE = 4 * DirectoryWatcher::DEBOUNCE;
+
+DirectoryWatcher::Event::Type typeOf(std::uint32_t mask) {
+  using Type = DirectoryWatcher::Event::Type;
+  if (mask & (IN_CREATE | IN_MOVED_TO))
+    return Type::Created;
+  if (mask & (IN_DELETE | IN_MOVED_FROM))
+    return Type::Deleted;
+  return Type::Modified;
+}
+
+} // namespace
+
+DirectoryWatcher::~DirectoryWatcher() {
+  if (m_thread.joinable()) {
+    const char stop = 0;
+    while (::write(m_wake_fds[1], &stop, 1) < 0 && errno == EINTR) {
+    }
+    m_thread.join();
+  }
+  for (int fd : {m_inotify_fd, m_wake_fds[0], m_wake_fds[1]}) {
+    if (fd >= 0)
+      ::close(fd);
+  }
+}
+
+bool DirectoryWatcher::isSupported() { return true; }
+
+/**
+ * @brief Creates the inotify instance and starts the thread (once)
+ */
+bool DirectoryWatcher::start() {
+  if (m_thread.joinable())
+    return true;
+  if (m_inotify_fd < 0) {
+    m_inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify_fd < 0)
+      return false;
+  }
+  if (m_wake_fds[0] < 0 && ::pipe2(m_wake_fds, O_CLOEXEC) != 0)
+    return false;
+  m_thread = std::thread(&DirectoryWatcher::run, this);
+  return true;
+}
+
+bool DirectoryWatcher::watch(const std::string &dir) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_generation;
+  if (!start())
+    return false;
+
+  if (m_wd >= 0) {
+    ::inotify_rm_watch(m_inotify_fd, m_wd);
+  }
+  m_wd = ::inotify_add_watch(m_inotify_fd, dir.c_str(), WATCH_MASK);
+  m_dir = m_wd >= 0 ? dir : std::string();
+  return m_wd >= 0;
+}
+
+void DirectoryWatcher::unwatch() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_generation;
+  if (m_wd >= 0) {
+    ::inotify_rm_watch(m_inotify_fd, m_wd);
+    m_wd = -1;
+  }
+  m_dir.clear();
+}
+
+/**
+ * @brief Watcher thread: reads, coalesces and delivers events
+ *
+ * A batch is delivered once no event arrived for DEBOUNCE, or when its
+ * first event is MAX_BATCH_AGE old (a directory that never calms down
+ * still gets updates). Within a batch the last event per path wins,
+ * except that a Modified after a Created stays Created. Events of a
+ * previous directory (other watch descriptor or generation) are dropped.
+ */
+void DirectoryWatcher::run() {
+  using clock = std::chrono::steady_clock;
+
+  std::vector<Event> pending;
+  std::unordered_map<std::string, std::size_t> index; // path -> pending slot
+  unsigned pending_generation = 0;
+  clock::time_point first_event;
+  clock::time_point last_event;
+
+  alignas(inotify_event) char buffer[16 * 1024];
+
+  for (;;) {
+    int timeout = -1;
+    if (!pending.empty()) {
+      const auto now = clock::now();
+      const auto deadline = std::min(last_event + DEBOUNCE, first_event + MAX_BATCH_AGE);
+      timeout = deadline <= now
+                    ? 0
+                    : static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                           deadline - now)
+                                           .count()) +
+                          1;
+    }
+
+    pollfd fds[2] = {{m_inotify_fd, POLLIN, 0}, {m_wake_fds[0], POLLIN, 0}};
+    const int ready = ::poll(fds, 2, timeout);
+    if (ready < 0 && errno != EINTR)
+      return;
+    if (fds[1].revents)
+      return; // destructor
+
+    if (ready > 0 && (fds[0].revents & POLLIN)) {
+      const ssize_t bytes = ::read(m_inotify_fd, buffer, sizeof(buffer));
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (pending_generation != m_generation) {
+        pending.clear();
+        index.clear();
+        pending_generation = m_generation;
+      }
+
+      for (ssize_t offset = 0; offset < bytes;) {
+        const auto *ev = reinterpret_cast<const inotify_event *>(buffer + offset);
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+
+        Event event{Event::Type::Overflow, m_dir};
+        if (ev->mask & IN_Q_OVERFLOW) {
+          // wd is -1: all watches lost events
+        } else if (ev->wd != m_wd || (ev->mask & IN_IGNORED)) {
+          continue;
+        } else if (!(ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF))) {
+          if (ev->len == 0)
+            continue; // event on the directory itself (e.g. IN_ATTRIB)
+          event.type = typeOf(ev->mask);
+          event.path = m_dir == "/" ? "/" + std::string(ev->name)
+                                    : m_dir + "/" + std::string(ev->name);
+        }
+        if (m_dir.empty())
+          continue;
+
+        if (pending.empty())
+          first_event = clock::now();
+        last_event = clock::now();
+
+        auto [it, inserted] = index.emplace(event.path, pending.size());
+        if (inserted) {
+          pending.push_back(std::move(event));
+        } else if (!(event.type == Event::Type::Modified &&
+                     pending[it->second].type == Event::Type::Created)) {
+          pending[it->second].type = event.type;
+        }
+      }
+    }
+
+    // Deadline reached: deliver unless the directory changed meanwhile
+    if (!pending.empty() && clock::now() >= std::min(last_event + DEBOUNCE,
+                                                     first_event + MAX_BATCH_AGE)) {
+      bool current;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        current = pending_generation == m_generation;
+      }
+      std::vector<Event> batch;
+      batch.swap(pending);
+      index.clear();
+      if (current && m_on_events) {
+        m_on_events(std::move(batch));
+      }
+    }
+  }
+}
+
+#else // !__linux__
+
+DirectoryWatcher::~DirectoryWatcher() = default;
+
+bool DirectoryWatcher::isSupported() { return false; }
+
+bool DirectoryWatcher::start() { return false; }
+
+bool DirectoryWatcher::watch(const std::string &) { return false; }
+
+void DirectoryWatcher::unwatch() {}
+
+void DirectoryWatcher::run() {}
+
+#endif
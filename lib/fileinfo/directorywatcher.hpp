@@ -0,0 +1,104 @@
+/**
+ * @file directorywatcher.hpp
+ * @brief Change notifications for the listed directory (inotify)
+ */
+
+#ifndef DIRECTORYWATCHER_HPP
+#define DIRECTORYWATCHER_HPP
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class DirectoryWatcher
+ * @brief Reports entries created, deleted or modified in one directory
+ *
+ * Watches a single directory (not its subdirectories, matching the
+ * non-recursive listing of the TUI) with inotify on a background thread.
+ * Events arriving within DEBOUNCE of each other are delivered as one batch,
+ * with at most one event per path (the last one seen), so extracting an
+ * archive or a burst of writes costs one model update instead of hundreds.
+ *
+ * If the kernel event queue overflowed, or the watched directory itself
+ * was deleted or moved, a single Overflow event is delivered: the listing
+ * can no longer be patched and must be rescanned.
+ *
+ * On platforms without inotify isSupported() returns false and watch()
+ * does nothing.
+ *
+ * @note The callback runs on the watcher thread
+ * @see ListingPatch
+ */
+class DirectoryWatcher {
+public:
+  /** @brief Quiet time that ends a batch of events */
+  static constexpr std::chrono::milliseconds DEBOUNCE{50};
+
+  /** @brief One change in the watched directory */
+  struct Event {
+    enum class Type {
+      Created,  ///< Entry created or moved in
+      Deleted,  ///< Entry deleted or moved away
+      Modified, ///< Content written or metadata changed
+      Overflow  ///< Events were lost; path is the watched directory
+    };
+
+    Type type;
+    std::string path; ///< Full path of the entry
+  };
+
+  /** @brief Receives a batch of events (on the watcher thread) */
+  using EventCallback = std::function<void(std::vector<Event> &&events)>;
+
+  /**
+   * @brief Creates an idle watcher
+   * @param on_events Receives the event batches
+   */
+  explicit DirectoryWatcher(EventCallback on_events);
+
+  /** @brief Stops the watcher thread */
+  ~DirectoryWatcher();
+
+  DirectoryWatcher(const DirectoryWatcher &) = delete;
+  DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+
+  /** @brief True if this build can watch directories */
+  static bool isSupported();
+
+  /**
+   * @brief Watches dir instead of the previously watched directory
+   *
+   * Pending events of the previous directory are discarded. Starts the
+   * watcher thread on first use.
+   *
+   * @param dir Directory to watch
+   * @return false if dir cannot be watched (not supported, no permission,
+   *         inotify watch limit reached)
+   */
+  bool watch(const std::string &dir);
+
+  /** @brief Stops watching; pending events are discarded */
+  void unwatch();
+
+  /** @brief Directory currently watched, empty if none */
+  std::string getDirectory() const;
+
+private:
+  EventCallback m_on_events;
+  mutable std::mutex m_mutex;  ///< Guards m_dir, m_wd and m_generation
+  std::string m_dir;
+  int m_wd = -1;               ///< inotify watch descriptor of m_dir
+  unsigned m_generation = 0;   ///< Bumped by watch()/unwatch()
+  int m_inotify_fd = -1;
+  int m_wake_fds[2] = {-1, -1}; ///< Self-pipe that ends the thread
+  std::thread m_thread;
+
+  bool start();
+  void run();
+};
+
+#endif // DIRECTORYWATCHER_HPP
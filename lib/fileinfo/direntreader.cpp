@@ -0,0 +1,185 @@
+/**
+ * @file direntreader.cpp
+ * @brief getdents64/statx directory listing (Linux only)
+ */
+
+#include "direntreader.hpp"
+#include "stats.hpp"
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#endif
+
+DirentReader::DirentReader() = default;
+DirentReader::~DirentReader() = default;
+
+#if defined(__linux__)
+
+namespace {
+
+/** @brief Record layout returned by getdents64(2) */
+struct LinuxDirent64 {
+  std::uint64_t d_ino;
+  std::int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+/** @brief Set once statx() reported ENOSYS (kernel older than 4.11) */
+std::atomic<bool> g_statx_missing{false};
+
+/**
+ * @brief Stats an entry relative to its directory
+ * @param dir_fd Open directory
+ * @param name Entry name
+ * @param follow Follow a symlink at name
+ * @param entry Receives mode, size, identity, blocks and mtime
+ * @param calls Counts the syscalls
+ * @return false if the entry cannot be stat'ed
+ */
+bool statEntry(int dir_fd, const char *name, bool follow, DirentReader::Entry &entry,
+               std::uint64_t &calls) {
+  const int flags = follow ? 0 : AT_SYMLINK_NOFOLLOW;
+  ++calls;
+
+#ifdef STATX_SIZE
+  if (!g_statx_missing.load(std::memory_order_relaxed)) {
+    struct statx stx;
+    const unsigned mask = STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_INO | STATX_NLINK |
+                          STATX_BLOCKS | STATX_MTIME;
+    if (::statx(dir_fd, name, flags | AT_STATX_SYNC_AS_STAT, mask, &stx) == 0) {
+      entry.mode = stx.stx_mode;
+      entry.size = stx.stx_size;
+      entry.inode = stx.stx_ino;
+      entry.device = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+      entry.links = stx.stx_nlink;
+      entry.blocks = stx.stx_blocks;
+      entry.mtime_ns = static_cast<std::int64_t>(stx.stx_mtime.tv_sec) * 1000000000 +
+                       stx.stx_mtime.tv_nsec;
+      return true;
+    }
+    if (errno != ENOSYS)
+      return false;
+    g_statx_missing.store(true, std::memory_order_relaxed);
+    ++calls;
+  }
+#endif
+
+  struct stat st;
+  if (::fstatat(dir_fd, name, &st, flags) != 0)
+    return false;
+  entry.mode = st.st_mode;
+  entry.size = static_cast<std::uint64_t>(st.st_size);
+  entry.inode = st.st_ino;
+  entry.device = st.st_dev;
+  entry.links = static_cast<std::uint32_t>(st.st_nlink);
+  entry.blocks = static_cast<std::uint64_t>(st.st_blocks);
+  entry.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                   st.st_mtim.tv_nsec;
+  return true;
+}
+
+/**
+ * @brief Fills the type-dependent fields of an entry
+ *
+ * Mirrors FileScanner::processEntry(): directories are taken from d_type,
+ * regular files and symlinks are stat'ed (following links), other types
+ * are reported without metadata.
+ */
+void classify(int dir_fd, const char *name, unsigned char d_type, DirentReader::Entry &entry,
+              std::uint64_t &stat_calls) {
+  switch (d_type) {
+  case DT_DIR:
+    entry.is_directory = true;
+    return;
+  case DT_REG:
+    entry.has_stat = statEntry(dir_fd, name, true, entry, stat_calls);
+    return;
+  case DT_LNK:
+    entry.is_symlink = true;
+    entry.has_stat = statEntry(dir_fd, name, true, entry, stat_calls);
+    return;
+  case DT_UNKNOWN:
+    // File system without d_type: one lstat, and a stat for symlinks
+    if (!statEntry(dir_fd, name, false, entry, stat_calls))
+      return;
+    if (S_ISLNK(entry.mode)) {
+      entry.is_symlink = true;
+      entry.has_stat = statEntry(dir_fd, name, true, entry, stat_calls);
+    } else {
+      entry.is_directory = S_ISDIR(entry.mode);
+      entry.has_stat = true;
+    }
+    return;
+  default:
+    return; // FIFO, socket, device: neither size nor permissions needed
+  }
+}
+
+} // namespace
+
+bool DirentReader::isSupported() { return true; }
+
+DirentReader::Cursor::~Cursor() {
+  if (fd >= 0)
+    ::close(fd);
+  Stats::Tally(Stats::Counter::GetdentsCalls).add(getdents_calls);
+  Stats::Tally(Stats::Counter::StatCalls).add(stat_calls);
+}
+
+bool DirentReader::open(const std::string &dir, Cursor &cursor) {
+  cursor.fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (cursor.fd < 0)
+    return false;
+  if (!m_buffer)
+    m_buffer.reset(new char[BUFFER_SIZE]);
+  return true;
+}
+
+bool DirentReader::next(Cursor &cursor, Entry &entry) {
+  for (;;) {
+    if (cursor.offset >= cursor.bytes) {
+      cursor.bytes = ::syscall(SYS_getdents64, cursor.fd, m_buffer.get(), BUFFER_SIZE);
+      cursor.offset = 0;
+      ++cursor.getdents_calls;
+      if (cursor.bytes <= 0)
+        return false; // end of directory or error
+    }
+
+    const auto *dirent =
+        reinterpret_cast<const LinuxDirent64 *>(m_buffer.get() + cursor.offset);
+    cursor.offset += dirent->d_reclen;
+
+    const char *name = dirent->d_name;
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+      continue;
+
+    entry = Entry{};
+    entry.name = std::string_view(name, std::strlen(name));
+    entry.inode = dirent->d_ino;
+    classify(cursor.fd, name, dirent->d_type, entry, cursor.stat_calls);
+    return true;
+  }
+}
+
+#else // !__linux__
+
+bool DirentReader::isSupported() { return false; }
+
+DirentReader::Cursor::~Cursor() = default;
+
+bool DirentReader::open(const std::string &, Cursor &) { return false; }
+
+bool DirentReader::next(Cursor &, Entry &) { return false; }
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file direntreader.hpp
+ * @brief Linux fast path for directory listing (getdents64 + statx)
+ */
+
+#ifndef DIRENTREADER_HPP
+#define DIRENTREADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @class DirentReader
+ * @brief Lists a directory with getdents64(2) and statx(2)
+ *
+ * Reads directory entries in large getdents64 batches and uses d_type to
+ * classify them: directories need no further syscall. Regular files and
+ * symlinks get one statx() relative to the directory descriptor (no path
+ * walk) that asks only for type, mode, size, identity, blocks and mtime. Other entry
+ * types (FIFOs, sockets, devices) are not stat'ed at all. File systems
+ * reporting DT_UNKNOWN fall back to an lstat-like statx per entry.
+ *
+ * list() is a template over the visitor, so the caller's per-entry work is
+ * inlined into the listing loop; only reading and stat'ing an entry
+ * (next()) is a call into the translation unit.
+ *
+ * On kernels without statx, fstatat(2) is used instead. On platforms other
+ * than Linux isSupported() returns false and FileScanner uses its
+ * std::filesystem backend.
+ *
+ * @note Not thread-safe: one reader per thread (the entry buffer is reused
+ *       across directories)
+ * @see FileScanner::Backend
+ */
+class DirentReader {
+public:
+  /** @brief getdents64 buffer size (entries per syscall ~ size / 32) */
+  static constexpr std::size_t BUFFER_SIZE = 128 * 1024;
+
+  /** @brief One directory entry with the metadata FileScanner needs */
+  struct Entry {
+    std::string_view name;   ///< File name (valid during the visitor call)
+    bool is_directory;       ///< Real directory (not a symlink to one)
+    bool is_symlink;         ///< Entry itself is a symlink
+    bool has_stat;           ///< The fields below are valid (else only inode)
+    std::uint32_t mode;      ///< st_mode, symlinks followed
+    std::uint64_t size;      ///< Size in bytes, symlinks followed
+    std::uint64_t inode;     ///< Inode number (d_ino, st_ino once stat'ed)
+    std::uint64_t device;    ///< st_dev, symlinks followed
+    std::uint32_t links;     ///< st_nlink, symlinks followed
+    std::uint64_t blocks;    ///< st_blocks (512-byte units), symlinks followed
+    std::int64_t mtime_ns;   ///< Modification time in ns since the epoch
+  };
+
+  DirentReader();
+  ~DirentReader();
+
+  DirentReader(const DirentReader &) = delete;
+  DirentReader &operator=(const DirentReader &) = delete;
+
+  /** @brief True if this build has the Linux fast path */
+  static bool isSupported();
+
+  /**
+   * @brief Lists one directory
+   * @param dir Directory path
+   * @param visit Called as bool(const Entry &) for every entry except "."
+   *        and "..", in directory order; returning false stops listing
+   * @return false if the visitor stopped the listing; an unreadable
+   *         directory lists as empty and returns true
+   */
+  template <typename Visit> bool list(const std::string &dir, Visit &&visit);
+
+private:
+  /** @brief Open directory and read position of one list() call */
+  struct Cursor {
+    int fd = -1;
+    long bytes = 0;                    ///< Valid bytes in the buffer
+    long offset = 0;                   ///< Next record in the buffer
+    std::uint64_t getdents_calls = 0;
+    std::uint64_t stat_calls = 0;
+
+    Cursor() = default;
+    Cursor(const Cursor &) = delete;
+    Cursor &operator=(const Cursor &) = delete;
+    /** @brief Closes the directory and adds the syscall counts to Stats */
+    ~Cursor();
+  };
+
+  std::unique_ptr<char[]> m_buffer;
+
+  /** @brief Opens a directory; false if it cannot be read */
+  bool open(const std::string &dir, Cursor &cursor);
+
+  /** @brief Reads and classifies the next entry; false at the end */
+  bool next(Cursor &cursor, Entry &entry);
+};
+
+template <typename Visit>
+bool DirentReader::list(const std::string &dir, Visit &&visit) {
+  Cursor cursor;
+  if (!open(dir, cursor))
+    return true;
+
+  Entry entry;
+  while (next(cursor, entry)) {
+    if (!visit(static_cast<const Entry &>(entry)))
+      return false;
+  }
+  return true;
+}
+
+#endif // DIRENTREADER_HPP
@@ -0,0 +1,365 @@
+/**
+ * @file duplicatefinder.cpp
+ * @brief Implementation of the staged duplicate detection engine
+ *
+ * Scan results only carry metadata. This file narrows them down to real
+ * duplicates in stages of increasing I/O cost, so that most files are
+ * never read at all.
+ */
+
+#include "duplicatefinder.hpp"
+#include "contentverifier.hpp"
+#include "hashpipeline.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+/** @brief (device, inode) of a file; only meaningful if hasInode() */
+using InodeKey = std::pair<std::uint64_t, std::uint64_t>;
+
+InodeKey inodeKey(const FileInfo& file) {
+    const auto inode = file.getInode();
+    return {inode.device, inode.inode};
+}
+
+/** @brief True for paths of an inode with further hardlinks */
+bool isLinked(const FileInfo& file) { return file.getInode().links > 1; }
+
+/** @brief Hardlinks left out of the search, by the candidate of their inode */
+using Links = std::unordered_map<const FileInfo*, std::vector<FileInfo*>>;
+
+/**
+ * @brief Final grouping of one candidate bucket by full digest
+ *
+ * Marks the members of every group of two or more files as duplicates and
+ * stores their digest. Collapsed hardlinks follow their candidate into
+ * its group.
+ *
+ * @param candidate Files of one bucket (same size and sample)
+ * @param digests Full digests of the bucket's files, in the same order
+ * @param links Hardlinks collapsed in stage 1
+ * @return Groups of the bucket, ordered by digest
+ */
+std::vector<DuplicateFinder::DuplicateGroup>
+groupBucket(const std::vector<FileInfo*>& candidate, const HashDigest* digests,
+            const Links& links) {
+    // Ordered map keeps the group order stable between runs
+    std::map<HashDigest, std::vector<FileInfo*>> hashMap;
+    for (std::size_t i = 0; i < candidate.size(); ++i) {
+        if (!digests[i].empty()) {
+            hashMap[digests[i]].push_back(candidate[i]);
+        }
+    }
+
+    std::vector<DuplicateFinder::DuplicateGroup> groups;
+    for (auto& [hash, fileList] : hashMap) {
+        if (fileList.size() < 2) {
+            continue;
+        }
+
+        DuplicateFinder::DuplicateGroup group;
+        group.hash = hash.toHex();
+        DuplicateFinder::WastedSpace waste;
+
+        auto join = [&](FileInfo* file) {
+            file->setDigest(hash);
+            file->setDuplicate(true);
+            group.files.push_back(file);
+            waste.add(*file);
+        };
+        for (auto* file : fileList) {
+            join(file);
+            auto it = links.find(file);
+            if (it != links.end()) {
+                std::for_each(it->second.begin(), it->second.end(), join);
+            }
+        }
+
+        group.wastedSpace = waste.total;
+        groups.push_back(std::move(group));
+    }
+    return groups;
+}
+
+} // namespace
+
+void DuplicateFinder::WastedSpace::add(const FileInfo& file) {
+    if (file.hasInode() && !inodes.insert(inodeKey(file)).second) {
+        return; // another path of a counted inode
+    }
+    if (empty) {
+        empty = false; // the kept copy
+        return;
+    }
+    total += file.getAllocatedSize();
+}
+
+/**
+ * @brief Staged duplicate detection on the calling thread
+ *
+ * Runs the same stages as the pipeline overload with a single worker.
+ *
+ * @param files Vector of FileInfo to analyze (will be modified!)
+ * @param hasher Hash implementation used for samples and full hashes
+ * @return Vector of duplicate groups
+ */
+std::vector<DuplicateFinder::DuplicateGroup>
+DuplicateFinder::findDuplicates(std::vector<FileInfo>& files,
+                                const IHashCalculator& hasher) {
+    HashPipeline pipeline(hasher, 1);
+    return findDuplicates(files, pipeline);
+}
+
+/**
+ * @brief Staged duplicate detection (size -> sample hash -> full hash)
+ *
+ * Stage 1 buckets all non-empty regular files by size. Of the paths of a
+ * multiply linked inode (st_nlink > 1) only the first becomes a
+ * candidate; the others wait in a side table and join its group at the
+ * end. Only buckets with more than one member continue. Stage 2 splits
+ * large files by a head/tail sample hash. Stage 3 computes the full
+ * content hash for everything that still collides and builds the final
+ * groups.
+ *
+ * All candidates of a stage are handed to the pipeline in one batch, so
+ * the workers stay busy across bucket boundaries. In stage 3 the files of
+ * a bucket are submitted together; the result callback that delivers the
+ * bucket's last digest groups it and passes its groups to on_group.
+ *
+ * Files that cannot be read (empty digest) are dropped from their bucket.
+ * Only files that end up in a group get their digest stored via
+ * FileInfo::setDigest(); the hex form is built once per group.
+ *
+ * @param files Vector of FileInfo to analyze (will be modified!)
+ * @param pipeline Hashing stage used for samples and full hashes
+ * @param on_group Optional; receives every group once it is final
+ * @return Vector of duplicate groups (bucket order, independent of the
+ *         hashing order); empty if the pipeline was cancelled
+ *
+ * @see HashPipeline::hashAll()
+ * @see groupBucket()
+ */
+std::vector<DuplicateFinder::DuplicateGroup>
+DuplicateFinder::findDuplicates(std::vector<FileInfo>& files, HashPipeline& pipeline,
+                                const GroupCallback& on_group) {
+    TMF_STATS_TIMER(DuplicateSearch);
+
+    // Stage 1: group by size (no I/O), one candidate per inode
+    std::unordered_map<long long, std::vector<FileInfo*>> sizeMap;
+    std::map<InodeKey, FileInfo*> linkedInodes;
+    Links links;
+    std::size_t collapsed = 0;
+    for (auto& info : files) {
+        if (info.isDirectory() || info.isParentDir() || info.getFileSize() <= 0) {
+            continue;
+        }
+        if (isLinked(info)) {
+            auto [it, added] = linkedInodes.emplace(inodeKey(info), &info);
+            if (!added) {
+                links[it->second].push_back(&info);
+                ++collapsed;
+                continue;
+            }
+        }
+        sizeMap[info.getFileSize()].push_back(&info);
+    }
+    TMF_STATS_ADD(LinksCollapsed, collapsed);
+
+    // Stage 2: split size collisions by head/tail sample
+    std::vector<std::vector<FileInfo*>> candidates;
+    std::vector<FileInfo*> sampleFiles;
+    for (auto& [size, fileList] : sizeMap) {
+        if (fileList.size() < 2) {
+            continue;
+        }
+
+        if (size <= static_cast<long long>(2 * SAMPLE_SIZE)) {
+            candidates.push_back(std::move(fileList));
+        } else {
+            sampleFiles.insert(sampleFiles.end(), fileList.begin(), fileList.end());
+        }
+    }
+
+    pipeline.setSampleSize(SAMPLE_SIZE);
+    std::vector<HashDigest> samples;
+    {
+        TMF_STATS_TIMER(SampleHash);
+        TMF_STATS_ADD(SampledFiles, sampleFiles.size());
+        samples = pipeline.hashAll(sampleFiles, HashPipeline::Mode::Sample);
+    }
+    if (pipeline.isCancelled()) {
+        return {};
+    }
+
+    // Samples only collide within the same size bucket
+    std::map<std::pair<long long, HashDigest>, std::vector<FileInfo*>> sampleMap;
+    for (std::size_t i = 0; i < sampleFiles.size(); ++i) {
+        if (!samples[i].empty()) {
+            sampleMap[{sampleFiles[i]->getFileSize(), samples[i]}].push_back(sampleFiles[i]);
+        }
+    }
+    for (auto& [key, sampleList] : sampleMap) {
+        if (sampleList.size() > 1) {
+            candidates.push_back(std::move(sampleList));
+        }
+    }
+
+    // Stage 3: full content hash; a bucket is grouped once its last digest is in
+    std::vector<FileInfo*> fullFiles;
+    std::vector<std::size_t> bucketOf;
+    std::vector<std::size_t> bucketStart;
+    for (std::size_t bucket = 0; bucket < candidates.size(); ++bucket) {
+        bucketStart.push_back(fullFiles.size());
+        fullFiles.insert(fullFiles.end(), candidates[bucket].begin(), candidates[bucket].end());
+        bucketOf.insert(bucketOf.end(), candidates[bucket].size(), bucket);
+    }
+
+    std::vector<HashDigest> digests(fullFiles.size());
+    std::vector<std::size_t> remaining;
+    for (const auto& candidate : candidates) {
+        remaining.push_back(candidate.size());
+    }
+    std::vector<std::vector<DuplicateGroup>> bucketGroups(candidates.size());
+    std::mutex mutex;
+
+    if (!fullFiles.empty()) {
+        TMF_STATS_TIMER(FullHash);
+        TMF_STATS_ADD(FullHashedFiles, fullFiles.size());
+        pipeline.start(HashPipeline::Mode::Full,
+                       [&](std::size_t index, FileInfo*, const HashDigest& digest) {
+                           std::lock_guard<std::mutex> lock(mutex);
+                           digests[index] = digest;
+                           const std::size_t bucket = bucketOf[index];
+                           if (--remaining[bucket] > 0) {
+                               return;
+                           }
+                           bucketGroups[bucket] = groupBucket(
+                               candidates[bucket], digests.data() + bucketStart[bucket], links);
+                           if (on_group) {
+                               for (const auto& group : bucketGroups[bucket]) {
+                                   on_group(group);
+                               }
+                           }
+                       });
+        for (FileInfo* file : fullFiles) {
+            if (!pipeline.submit(file)) {
+                break;
+            }
+        }
+        pipeline.finish();
+    }
+    if (pipeline.isCancelled()) {
+        return {};
+    }
+
+    std::vector<DuplicateGroup> groups;
+    for (auto& bucket : bucketGroups) {
+        std::move(bucket.begin(), bucket.end(), std::back_inserter(groups));
+    }
+    return groups;
+}
+
+/**
+ * @brief Byte-for-byte confirmation, one group per worker at a time
+ *
+ * Groups are independent, so workers take the next unverified group from
+ * a shared counter; the file streams of one group are compared together
+ * by a single worker (see ContentVerifier::partition()). Only the first
+ * path of a multiply linked inode is compared; its links take its set.
+ * If any file of a group could not be read, the unconfirmed files of
+ * that group keep their duplicate mark: their partner may be the file
+ * that could not be read.
+ */
+std::vector<DuplicateFinder::DuplicateGroup>
+DuplicateFinder::verifyGroups(const std::vector<DuplicateGroup>& groups, unsigned threads,
+                              const StopToken& stop) {
+    TMF_STATS_TIMER(Verify);
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, groups.size()));
+
+    std::vector<std::vector<DuplicateGroup>> results(groups.size());
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        for (std::size_t g = next.fetch_add(1); g < groups.size() && !stop.stopRequested();
+             g = next.fetch_add(1)) {
+            const DuplicateGroup& group = groups[g];
+            std::vector<std::string> paths;
+            std::vector<std::size_t> pathOf(group.files.size());
+            std::map<InodeKey, std::size_t> linkedInodes;
+            paths.reserve(group.files.size());
+            for (std::size_t i = 0; i < group.files.size(); ++i) {
+                const FileInfo* file = group.files[i];
+                if (isLinked(*file)) {
+                    auto [it, added] = linkedInodes.emplace(inodeKey(*file), paths.size());
+                    if (!added) {
+                        pathOf[i] = it->second;
+                        continue;
+                    }
+                }
+                pathOf[i] = paths.size();
+                paths.push_back(file->getPath());
+            }
+
+            std::vector<std::size_t> unreadable;
+            const auto sets = ContentVerifier::partition(paths, stop, &unreadable);
+            if (stop.stopRequested()) {
+                return;
+            }
+            std::vector<std::size_t> setOf(paths.size(), sets.size());
+            for (std::size_t k = 0; k < sets.size(); ++k) {
+                for (std::size_t p : sets[k]) {
+                    setOf[p] = k;
+                }
+            }
+
+            std::vector<DuplicateGroup> split(sets.size());
+            std::vector<WastedSpace> waste(sets.size());
+            for (std::size_t i = 0; i < group.files.size(); ++i) {
+                const std::size_t k = setOf[pathOf[i]];
+                const bool confirmed = k < sets.size();
+                group.files[i]->setVerified(confirmed);
+                if (!confirmed) {
+                    // Only a file that was read and differs is known to be unique
+                    if (unreadable.empty()) {
+                        group.files[i]->setDuplicate(false);
+                    }
+                    continue;
+                }
+                split[k].files.push_back(group.files[i]);
+                waste[k].add(*group.files[i]);
+            }
+            for (std::size_t k = 0; k < sets.size(); ++k) {
+                split[k].hash = group.hash;
+                split[k].verified = true;
+                split[k].wastedSpace = waste[k].total;
+            }
+            results[g] = std::move(split);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    std::vector<DuplicateGroup> verified;
+    if (stop.stopRequested()) {
+        return verified;
+    }
+    for (auto& split : results) {
+        std::move(split.begin(), split.end(), std::back_inserter(verified));
+    }
+    return verified;
+}
@@ -2,9 +2,17 @@
 #define DUPLICATEFINDER_HPP
 
 #include "fileinfo.hpp"
+#include "ihashcalculator.hpp"
+#include "stoptoken.hpp"
+#include <cstddef>
+#include <functional>
 #include <vector>
 #include <unordered_map>
+#include <set>
 #include <string>
+#include <utility>
+
+class HashPipeline;
 
 /**
  * @brief Service for duplicate file detection based on file hashes
@@ -16,17 +24,24 @@
  * - Calculate wasted disk space from duplicates
  * - Group duplicates by hash for further processing
  *
- * @note Files must have valid hash values set before calling findDuplicates()
+ * Two entry points exist:
+ * - findDuplicates(files) groups entries whose hashes are already set
+ * - findDuplicates(files, hasher) runs the staged engine, which computes
+ *   hashes only where they are needed (see below)
+ *
  * @note Only regular files (not directories) are considered for duplication
  * @note Zero-byte files are ignored
+ * @note Hardlinks of one inode are hashed once and waste no space (see
+ *       WastedSpace)
  *
- * @see FileInfo::setHash()
+ * @see FileInfo::setDigest()
  * @see DuplicateGroup
  *
  * Example usage:
  * @code
- * std::vector<FileInfo> files = scanner.scanDirectory("/path");
- * auto groups = DuplicateFinder::findDuplicates(files);
+ * FNV1A hasher;
+ * std::vector<FileInfo> files = scanner.scanDirectory("/path", true, false);
+ * auto groups = DuplicateFinder::findDuplicates(files, hasher);
  * long long wasted = DuplicateFinder::calculateWastedSpace(groups);
  * std::cout << "Wasted space: " << wasted << " bytes\n";
  * @endcode
@@ -36,8 +51,91 @@ public:
     struct DuplicateGroup {
         std::string hash;
         std::vector<FileInfo*> files;
-        long long wastedSpace = 0;  // Total size - 1 file (keep original)
+        long long wastedSpace = 0;  // Allocated size of all inodes but the first
+        bool verified = false;      // Confirmed byte for byte (see verifyGroups())
     };
+
+    /**
+     * @brief Disk space freed by deleting all but one file of a group
+     *
+     * The first file added is kept. Every later file counts with its
+     * allocated size (FileInfo::getAllocatedSize(), st_blocks), unless it
+     * is a hardlink of an inode already added: deleting it frees nothing.
+     *
+     * @code
+     * DuplicateFinder::WastedSpace waste;
+     * for (const FileInfo* file : group.files) waste.add(*file);
+     * group.wastedSpace = waste.total;
+     * @endcode
+     */
+    struct WastedSpace {
+        long long total = 0;
+        bool empty = true;
+        std::set<std::pair<std::uint64_t, std::uint64_t>> inodes; ///< (device, inode) added
+
+        /** @brief Adds a member of the group */
+        void add(const FileInfo& file);
+    };
+
+    /**
+     * @brief Receives a duplicate group as soon as it is final
+     *
+     * Invoked from hashing threads, but never concurrently. The group's
+     * file pointers stay valid as long as the searched vector does.
+     */
+    using GroupCallback = std::function<void(const DuplicateGroup& group)>;
+
+    /** @brief Bytes read from head and tail of a file in the sample stage */
+    static constexpr std::size_t SAMPLE_SIZE = 4096;
+
+    /**
+     * @brief Staged duplicate detection on metadata-only scan results
+     *
+     * Reads as little file content as possible:
+     * 1. Group candidates by getFileSize(); hardlinks of one inode are
+     *    collapsed to one candidate, then unique sizes are dropped
+     * 2. Hash head and tail (SAMPLE_SIZE bytes each) of size collisions
+     * 3. Full content hash only where size and sample still collide
+     *
+     * The collapsed links join the group of their inode afterwards, so
+     * every path is reported, but an inode is read only once and a size
+     * whose files all share one inode is not read at all.
+     *
+     * Files of up to 2 * SAMPLE_SIZE bytes skip stage 2, because their
+     * sample already covers the whole content. The full hash of grouped files
+     * is stored via FileInfo::setDigest() and duplicates are marked as in
+     * findDuplicates().
+     *
+     * @param files Vector of FileInfo to analyze (will be modified!)
+     * @param hasher Hash implementation used for samples and full hashes
+     * @return Vector of duplicate groups
+     *
+     * @note Implementation is in duplicatefinder.cpp
+     */
+    static std::vector<DuplicateGroup> findDuplicates(std::vector<FileInfo>& files,
+                                                      const IHashCalculator& hasher);
+
+    /**
+     * @brief Staged duplicate detection with a parallel hashing stage
+     *
+     * Same stages as above; the sample and full hashes are computed by the
+     * pipeline's workers. Progress and cancellation are configured on the
+     * pipeline by the caller.
+     *
+     * A candidate bucket (same size and sample) is grouped as soon as its
+     * last full hash is in, and its groups are handed to on_group right
+     * away, while other buckets are still being hashed.
+     *
+     * @param files Vector of FileInfo to analyze (will be modified!)
+     * @param pipeline Hashing stage (see HashPipeline)
+     * @param on_group Optional; receives every group once it is final
+     * @return Vector of duplicate groups; empty if the pipeline was cancelled
+     *
+     * @note Implementation is in duplicatefinder.cpp
+     */
+    static std::vector<DuplicateGroup> findDuplicates(std::vector<FileInfo>& files,
+                                                      HashPipeline& pipeline,
+                                                      const GroupCallback& on_group = nullptr);
     
     /**
      * @brief Find duplicates and mark them in the vector
@@ -45,14 +143,14 @@ public:
      * @return Vector of duplicate groups
      */
     static std::vector<DuplicateGroup> findDuplicates(std::vector<FileInfo>& files) {
-        std::unordered_map<std::string, std::vector<FileInfo*>> hashMap;
+        std::unordered_map<HashDigest, std::vector<FileInfo*>, HashDigestHasher> hashMap;
         
         // Group by hash
         for (auto& info : files) {
             if (!info.isDirectory() && 
                 info.getFileSize() > 0 && 
-                !info.getHash().empty()) {
-                hashMap[info.getHash()].push_back(&info);
+                !info.getDigest().empty()) {
+                hashMap[info.getDigest()].push_back(&info);
             }
         }
         
@@ -61,7 +159,7 @@ public:
         for (auto& [hash, fileList] : hashMap) {
             if (fileList.size() > 1) {
                 DuplicateGroup group;
-                group.hash = hash;
+                group.hash = hash.toHex();
                 
                 for (auto* file : fileList) {
                     file->setDuplicate(true);  // Mark as duplicate
@@ -69,8 +167,11 @@ public:
                 }
                 
                 // Calculate wasted space (keep 1, rest is waste)
-                group.wastedSpace = 
-                    (fileList.size() - 1) * fileList[0]->getFileSize();
+                WastedSpace waste;
+                for (const auto* file : fileList) {
+                    waste.add(*file);
+                }
+                group.wastedSpace = waste.total;
                 
                 groups.push_back(group);
             }
@@ -79,6 +180,31 @@ public:
         return groups;
     }
     
+    /**
+     * @brief Confirms duplicate groups by comparing their content
+     *
+     * Hash equality is overwhelmingly likely to mean equal content, but
+     * before files are deleted it can be made certain: every group is
+     * compared byte for byte by ContentVerifier, several groups at a time.
+     * A group whose files are not all equal is split into its verified
+     * subsets; files that match no other member lose their duplicate mark.
+     * Confirmed files get FileInfo::setVerified(true). Hardlinks of one
+     * inode are read once and share its result. Files that could not be
+     * read are not counted as different: they, and the unconfirmed files
+     * of their group, stay marked as duplicates but unverified.
+     *
+     * @param groups Groups from findDuplicates() (their files are modified)
+     * @param threads Groups compared at once; 0 selects
+     *        std::thread::hardware_concurrency()
+     * @param stop Ends verification early (the result is then empty)
+     * @return Verified groups, in the order of the groups they came from
+     *
+     * @note Implementation is in duplicatefinder.cpp
+     */
+    static std::vector<DuplicateGroup> verifyGroups(const std::vector<DuplicateGroup>& groups,
+                                                    unsigned threads = 0,
+                                                    const StopToken& stop = StopToken());
+
     /**
      * @brief Calculate total wasted space
      */
@@ -0,0 +1,436 @@
+/**
+ * @file externalsizeindex.cpp
+ * @brief Implementation of the spilling size-collision search
+ */
+
+#include "externalsizeindex.hpp"
+#include "stats.hpp"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+#include <tuple>
+
+namespace {
+
+using Record = ExternalSizeIndex::Record;
+
+/** @brief Merge order: size, then device and inode so hardlinks are adjacent */
+bool lessRecord(const Record &a, const Record &b) {
+  return std::tie(a.size, a.inode.device, a.inode.inode) <
+         std::tie(b.size, b.inode.device, b.inode.inode);
+}
+
+bool sameInode(const Record &a, const Record &b) {
+  return a.inode.inode != 0 && a.inode.inode == b.inode.inode &&
+         a.inode.device == b.inode.device;
+}
+
+bool writeAll(int fd, const void *data, std::size_t size) {
+  const char *bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    const ssize_t n = ::write(fd, bytes, size);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    bytes += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+bool readAll(int fd, void *data, std::size_t size, std::uint64_t offset) {
+  char *bytes = static_cast<char *>(data);
+  while (size > 0) {
+    const ssize_t n = ::pread(fd, bytes, size, static_cast<off_t>(offset));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    bytes += n;
+    size -= static_cast<std::size_t>(n);
+    offset += static_cast<std::uint64_t>(n);
+  }
+  return true;
+}
+
+/**
+ * @brief Sequential reader of one sorted run with a fixed record buffer
+ */
+class RunCursor {
+public:
+  RunCursor(int fd, std::uint64_t first, std::uint64_t records, std::size_t buffer_records)
+      : m_fd(fd), m_first(first), m_records(records), m_buffer(buffer_records) {}
+
+  /** @brief Current record; valid while !done() */
+  const Record &current() const { return m_buffer[m_pos]; }
+
+  bool done() const { return m_pos >= m_filled; }
+
+  /** @return false on a read error */
+  bool advance() {
+    if (++m_pos < m_filled)
+      return true;
+    return refill();
+  }
+
+  bool refill() {
+    const std::uint64_t left = m_records - m_read;
+    m_filled = static_cast<std::size_t>(std::min<std::uint64_t>(left, m_buffer.size()));
+    m_pos = 0;
+    if (m_filled == 0)
+      return true;
+    if (!readAll(m_fd, m_buffer.data(), m_filled * sizeof(Record),
+                 (m_first + m_read) * sizeof(Record))) {
+      m_filled = 0;
+      return false;
+    }
+    m_read += m_filled;
+    return true;
+  }
+
+private:
+  int m_fd;
+  std::uint64_t m_first;
+  std::uint64_t m_records;
+  std::uint64_t m_read = 0;
+  std::vector<Record> m_buffer;
+  std::size_t m_filled = 0;
+  std::size_t m_pos = 0;
+};
+
+/**
+ * @brief k-way merge of sorted runs of one file (min-heap of cursors)
+ */
+class RunMerger {
+  /** @brief Heap order: the cursor with the smallest record on top */
+  struct Greater {
+    const std::vector<RunCursor> *cursors;
+    bool operator()(std::size_t a, std::size_t b) const {
+      return lessRecord((*cursors)[b].current(), (*cursors)[a].current());
+    }
+  };
+
+public:
+  RunMerger(int fd, std::size_t buffer_records) : m_fd(fd), m_buffer_records(buffer_records) {}
+
+  /** @return false on a read error */
+  bool add(std::uint64_t first, std::uint64_t records) {
+    m_cursors.emplace_back(m_fd, first, records, m_buffer_records);
+    if (!m_cursors.back().refill())
+      return false;
+    if (!m_cursors.back().done()) {
+      m_heap.push_back(m_cursors.size() - 1);
+      std::push_heap(m_heap.begin(), m_heap.end(), Greater{&m_cursors});
+    }
+    return true;
+  }
+
+  /** @return false at the end of all runs or on a read error (failed()) */
+  bool next(Record &record) {
+    if (m_heap.empty())
+      return false;
+    std::pop_heap(m_heap.begin(), m_heap.end(), Greater{&m_cursors});
+    const std::size_t top = m_heap.back();
+    record = m_cursors[top].current();
+    if (!m_cursors[top].advance()) {
+      m_failed = true;
+      m_heap.clear();
+      return false;
+    }
+    if (m_cursors[top].done()) {
+      m_heap.pop_back();
+    } else {
+      std::push_heap(m_heap.begin(), m_heap.end(), Greater{&m_cursors});
+    }
+    return true;
+  }
+
+  bool failed() const { return m_failed; }
+
+private:
+  int m_fd;
+  std::size_t m_buffer_records;
+  std::vector<RunCursor> m_cursors;
+  std::vector<std::size_t> m_heap;
+  bool m_failed = false;
+
+};
+
+} // namespace
+
+ExternalSizeIndex::ExternalSizeIndex(std::size_t memory_limit, const std::string &temp_dir)
+    : m_memory_limit(std::max(memory_limit, MIN_MEMORY)), m_temp_dir(temp_dir) {
+  m_run_capacity = m_memory_limit / 2 / sizeof(Record);
+  if (m_temp_dir.empty()) {
+    std::error_code ec;
+    m_temp_dir = std::filesystem::temp_directory_path(ec).native();
+    if (ec)
+      m_temp_dir = "/tmp";
+  }
+}
+
+ExternalSizeIndex::~ExternalSizeIndex() {
+  if (m_run_fd >= 0)
+    ::close(m_run_fd);
+  if (m_path_fd >= 0)
+    ::close(m_path_fd);
+}
+
+/**
+ * @brief Opens an unnamed read/write file in m_temp_dir
+ *
+ * O_TMPFILE needs Linux 3.11 and file system support; otherwise a
+ * mkstemp() file is unlinked right away.
+ */
+int ExternalSizeIndex::openTemporary() {
+#ifdef O_TMPFILE
+  const int fd = ::open(m_temp_dir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+  if (fd >= 0)
+    return fd;
+#endif
+  std::string name = m_temp_dir + "/.tmf-spill-XXXXXX";
+  const int tmp = ::mkstemp(name.data());
+  if (tmp >= 0) {
+    ::unlink(name.c_str());
+    ::fcntl(tmp, F_SETFD, FD_CLOEXEC);
+  }
+  return tmp;
+}
+
+bool ExternalSizeIndex::add(const FileInfo &file) {
+  if (!m_good || file.isDirectory() || file.isParentDir() || file.getFileSize() <= 0)
+    return m_good;
+
+  if (m_path_fd < 0) {
+    m_path_fd = openTemporary();
+    if (m_path_fd < 0)
+      return m_good = false;
+  }
+
+  // Path: 4-byte length, then the bytes
+  Record record;
+  record.size = file.getFileSize();
+  record.mtime_ns = file.getModifiedTime();
+  record.inode = file.getInode();
+  record.path = m_path_offset;
+
+  const std::size_t before = m_path_buffer.size();
+  file.appendPath(m_path_buffer.append(sizeof(std::uint32_t), '\0'));
+  const auto length =
+      static_cast<std::uint32_t>(m_path_buffer.size() - before - sizeof(std::uint32_t));
+  std::copy_n(reinterpret_cast<const char *>(&length), sizeof(length), &m_path_buffer[before]);
+  m_path_offset += m_path_buffer.size() - before;
+
+  const std::size_t path_buffer_limit = std::min<std::size_t>(1 << 20, m_memory_limit / 8);
+  if (m_path_buffer.size() >= path_buffer_limit) {
+    if (!writeAll(m_path_fd, m_path_buffer.data(), m_path_buffer.size()))
+      return m_good = false;
+    m_path_buffer.clear();
+  }
+
+  m_run.push_back(record);
+  ++m_records_added;
+  if (m_run.size() >= m_run_capacity)
+    return spillRun();
+  return true;
+}
+
+/** @brief Sorts the current run and appends it to the run file */
+bool ExternalSizeIndex::spillRun() {
+  std::sort(m_run.begin(), m_run.end(), lessRecord);
+  if (m_run_fd < 0) {
+    m_run_fd = openTemporary();
+    if (m_run_fd < 0)
+      return m_good = false;
+  }
+  if (!writeAll(m_run_fd, m_run.data(), m_run.size() * sizeof(Record)))
+    return m_good = false;
+  m_runs.push_back({m_run_records, m_run.size()});
+  m_run_records += m_run.size();
+  ++m_spilled;
+  m_run.clear();
+  TMF_STATS_ADD(RunsSpilled, 1);
+  return true;
+}
+
+/**
+ * @brief Merges every MERGE_FAN_IN consecutive runs into one
+ *
+ * The merged runs go to a new run file, which replaces the old one.
+ * Memory: a quarter of the ceiling for the input buffers (shared by the
+ * MERGE_FAN_IN runs of a group), a quarter for the output buffer.
+ */
+bool ExternalSizeIndex::mergePass() {
+  const int out = openTemporary();
+  if (out < 0)
+    return m_good = false;
+
+  const std::size_t buffer_records =
+      std::max<std::size_t>(1, m_memory_limit / 4 / MERGE_FAN_IN / sizeof(Record));
+  std::vector<Record> output;
+  output.reserve(std::max<std::size_t>(1, m_memory_limit / 4 / sizeof(Record)));
+  std::vector<Run> merged;
+  std::uint64_t emitted = 0;
+  bool ok = true;
+
+  auto flush = [&]() {
+    ok = ok && writeAll(out, output.data(), output.size() * sizeof(Record));
+    output.clear();
+    return ok;
+  };
+
+  for (std::size_t first = 0; ok && first < m_runs.size(); first += MERGE_FAN_IN) {
+    const std::size_t last = std::min(first + MERGE_FAN_IN, m_runs.size());
+    RunMerger merger(m_run_fd, buffer_records);
+    for (std::size_t i = first; ok && i < last; ++i) {
+      ok = merger.add(m_runs[i].first, m_runs[i].records);
+    }
+
+    Run run{emitted, 0};
+    Record record;
+    while (ok && merger.next(record)) {
+      output.push_back(record);
+      ++run.records;
+      if (output.size() == output.capacity())
+        flush();
+    }
+    ok = ok && !merger.failed();
+    emitted += run.records;
+    merged.push_back(run);
+  }
+  if (ok && !output.empty())
+    flush();
+
+  if (!ok) {
+    ::close(out);
+    return m_good = false;
+  }
+  ::close(m_run_fd);
+  m_run_fd = out;
+  m_run_records = emitted;
+  m_runs = std::move(merged);
+  ++m_merge_passes;
+  return true;
+}
+
+bool ExternalSizeIndex::readPath(std::uint64_t offset, std::string &path) const {
+  std::uint32_t length = 0;
+  if (!readAll(m_path_fd, &length, sizeof(length), offset))
+    return false;
+  path.resize(length);
+  return readAll(m_path_fd, path.data(), length, offset + sizeof(length));
+}
+
+/**
+ * @brief Merges the runs and groups them by size
+ *
+ * More than MERGE_FAN_IN runs are first reduced by mergePass(). Memory: a
+ * quarter of the ceiling for the merge buffers (shared by all runs), a
+ * quarter for the batch being built. A single run never written to disk
+ * is sorted and walked in place.
+ */
+bool ExternalSizeIndex::forEachCollision(const BatchCallback &on_batch) {
+  if (!m_good)
+    return false;
+  if (m_path_fd >= 0 && !m_path_buffer.empty()) {
+    if (!writeAll(m_path_fd, m_path_buffer.data(), m_path_buffer.size()))
+      return m_good = false;
+    m_path_buffer.clear();
+    m_path_buffer.shrink_to_fit();
+  }
+
+  // Record source: the run in memory, or a k-way merge of the spilled runs
+  std::unique_ptr<RunMerger> merger;
+  std::size_t in_memory = 0;
+
+  if (!m_runs.empty()) {
+    if (!m_run.empty() && !spillRun())
+      return false;
+    std::vector<Record>().swap(m_run);
+
+    while (m_runs.size() > MERGE_FAN_IN) {
+      if (!mergePass())
+        return false;
+    }
+
+    const std::size_t buffer_records =
+        std::max<std::size_t>(1, m_memory_limit / 4 / m_runs.size() / sizeof(Record));
+    merger = std::make_unique<RunMerger>(m_run_fd, buffer_records);
+    for (const Run &run : m_runs) {
+      if (!merger->add(run.first, run.records))
+        return m_good = false;
+    }
+  } else {
+    std::sort(m_run.begin(), m_run.end(), lessRecord);
+  }
+
+  auto next = [&](Record &record) {
+    if (merger)
+      return merger->next(record);
+    if (in_memory >= m_run.size())
+      return false;
+    record = m_run[in_memory++];
+    return true;
+  };
+
+  // Size groups of two or more inodes, collected into batches
+  const std::size_t batch_limit = m_memory_limit / 4;
+  std::vector<FileInfo> batch;
+  auto arena = std::make_shared<PathArena>();
+  std::size_t batch_bytes = 0;
+  std::vector<Record> group;
+  std::string path;
+
+  auto flush_batch = [&]() {
+    if (batch.empty())
+      return true;
+    const bool go_on = on_batch(std::move(batch));
+    batch = {};
+    arena = std::make_shared<PathArena>();
+    batch_bytes = 0;
+    return go_on;
+  };
+
+  auto take_group = [&]() {
+    std::size_t inodes = 0;
+    for (std::size_t i = 0; i < group.size(); ++i) {
+      if (i == 0 || !sameInode(group[i - 1], group[i]))
+        ++inodes;
+    }
+    if (inodes < 2)
+      return true;
+
+    for (const Record &record : group) {
+      if (!readPath(record.path, path))
+        return m_good = false;
+      batch.emplace_back(arena, path, record.size, 0,
+                         record.inode.inode != 0 ? &record.inode : nullptr);
+      batch.back().setModifiedTime(record.mtime_ns);
+      batch_bytes += sizeof(FileInfo) + path.size() + sizeof(PathArena::Inode);
+    }
+    return batch_bytes < batch_limit || flush_batch();
+  };
+
+  Record record;
+  while (next(record)) {
+    if (!group.empty() && group.front().size != record.size) {
+      if (!take_group())
+        return false;
+      group.clear();
+    }
+    group.push_back(record);
+  }
+  if (merger && merger->failed())
+    return m_good = false;
+  if (!group.empty() && !take_group())
+    return false;
+  return flush_batch();
+}
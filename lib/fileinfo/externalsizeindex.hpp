@@ -0,0 +1,156 @@
+/**
+ * @file externalsizeindex.hpp
+ * @brief Size-collision search over more files than fit in memory
+ */
+
+#ifndef EXTERNALSIZEINDEX_HPP
+#define EXTERNALSIZEINDEX_HPP
+
+#include "fileinfo.hpp"
+#include "patharena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @class ExternalSizeIndex
+ * @brief Finds the files sharing a size within a fixed memory ceiling
+ *
+ * Stage 1 of the duplicate search (grouping by size) normally needs every
+ * scanned entry in memory. This index keeps a fixed-size record per file
+ * instead (size, mtime, PathArena::Inode and the offset of its path) and
+ * spills when the ceiling is reached:
+ * 1. add() appends the path to an anonymous temporary file and the record
+ *    to an in-memory run
+ * 2. A full run is sorted by (size, device, inode) and appended to the
+ *    run file
+ * 3. forEachCollision() first merges groups of MERGE_FAN_IN runs into one
+ *    (as many passes as needed), then merges the remaining runs (k-way)
+ *    in size order and hands the sizes shared by two or more distinct
+ *    inodes to the caller as FileInfo batches, with their paths read back
+ *    from the spill file
+ *
+ * The fan-in bounds the merge: however many runs a small ceiling on a
+ * large tree produces, every merge buffer holds a useful number of
+ * records. Runs share one file, so no descriptor is opened per run.
+ *
+ * A batch holds whole size groups and stays below the ceiling unless a
+ * single size group is larger, so DuplicateFinder::findDuplicates() can
+ * run on each batch independently. Sizes whose paths all share one inode
+ * (hardlinks) are not delivered.
+ *
+ * All temporary files are unlinked at creation (O_TMPFILE, else mkstemp()
+ * plus unlink()), so nothing is left behind after a crash. As long as
+ * everything fits into one run, nothing is written but the paths.
+ *
+ * @code
+ * ExternalSizeIndex index(256 << 20);
+ * scanner.scanDirectoryStreaming(root, true, false, [&](std::vector<FileInfo> &&batch) {
+ *   for (const auto &info : batch) index.add(info);
+ *   return index.good();
+ * });
+ * index.forEachCollision([&](std::vector<FileInfo> &&files) {
+ *   DuplicateFinder::findDuplicates(files, pipeline, on_group);
+ *   return true;
+ * });
+ * @endcode
+ *
+ * @note Not thread-safe; one writer, then one forEachCollision() pass
+ */
+class ExternalSizeIndex {
+public:
+  /** @brief Spilled per file: everything stage 1 needs, plus where the path is */
+  struct Record {
+    long long size = 0;
+    std::int64_t mtime_ns = 0;
+    PathArena::Inode inode;   ///< All zero if the scanner had none
+    std::uint64_t path = 0;   ///< Offset of the path in the path spill file
+  };
+
+  /** @brief Smallest accepted ceiling */
+  static constexpr std::size_t MIN_MEMORY = 1 << 20;
+
+  /** @brief Runs merged at once; more runs take extra merge passes */
+  static constexpr std::size_t MERGE_FAN_IN = 64;
+
+  /**
+   * @brief Receives a batch of colliding files
+   * @return false to end forEachCollision() early
+   */
+  using BatchCallback = std::function<bool(std::vector<FileInfo> &&files)>;
+
+  /**
+   * @brief Creates an empty index
+   * @param memory_limit Ceiling in bytes for runs, merge buffers and
+   *        batches (at least MIN_MEMORY)
+   * @param temp_dir Directory of the temporary files; empty selects
+   *        std::filesystem::temp_directory_path()
+   */
+  explicit ExternalSizeIndex(std::size_t memory_limit, const std::string &temp_dir = "");
+  ~ExternalSizeIndex();
+
+  ExternalSizeIndex(const ExternalSizeIndex &) = delete;
+  ExternalSizeIndex &operator=(const ExternalSizeIndex &) = delete;
+
+  /**
+   * @brief Adds a scanned entry
+   *
+   * Directories, the parent entry and empty files are ignored.
+   *
+   * @return false once a temporary file could not be written
+   */
+  bool add(const FileInfo &file);
+
+  /**
+   * @brief Delivers the size collisions in ascending size order
+   * @param on_batch Receives batches of whole size groups
+   * @return false on a read error or if on_batch stopped
+   */
+  bool forEachCollision(const BatchCallback &on_batch);
+
+  /** @brief False once a temporary file failed */
+  bool good() const { return m_good; }
+
+  /** @brief Files added */
+  std::uint64_t size() const { return m_records_added; }
+
+  /** @brief Sorted runs written to disk so far (before merge passes) */
+  std::size_t spilledRuns() const { return m_spilled; }
+
+  /** @brief Merge passes forEachCollision() needed before its final merge */
+  std::size_t mergePasses() const { return m_merge_passes; }
+
+private:
+  /** @brief A sorted run in m_run_fd */
+  struct Run {
+    std::uint64_t first = 0;   ///< Index of its first record in the file
+    std::uint64_t records = 0;
+  };
+
+  int openTemporary();
+  bool spillRun();
+  bool mergePass();
+  bool readPath(std::uint64_t offset, std::string &path) const;
+
+  std::size_t m_memory_limit;
+  std::string m_temp_dir;
+  bool m_good = true;
+
+  std::vector<Record> m_run;      ///< Current run, sorted when spilled
+  std::size_t m_run_capacity = 0; ///< Records per run (half the ceiling)
+  std::vector<Run> m_runs;        ///< Spilled runs
+  int m_run_fd = -1;              ///< Run file, runs back to back
+  std::uint64_t m_run_records = 0;///< Records in the run file
+  std::size_t m_spilled = 0;
+  std::size_t m_merge_passes = 0;
+
+  int m_path_fd = -1;             ///< Path spill file
+  std::string m_path_buffer;      ///< Pending path bytes
+  std::uint64_t m_path_offset = 0;///< Size of the path file incl. the buffer
+  std::uint64_t m_records_added = 0;
+};
+
+#endif // EXTERNALSIZEINDEX_HPP
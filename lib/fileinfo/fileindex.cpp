@@ -0,0 +1,367 @@
+/**
+ * @file fileindex.cpp
+ * @brief Implementation of the listing index and its views
+ */
+
+#include "fileindex.hpp"
+#include "duplicatefinder.hpp"
+#include "filescanner.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+/**
+ * @brief Drops all entries; new ids continue after the old ones, so ids
+ *        held by callers (e.g. a posted search result) become invalid
+ */
+void FileIndex::clear() {
+  const std::size_t next_id = m_entries.size();
+  m_entries.clear();
+  m_live.clear();
+  m_order.clear();
+  m_sorted_by_size = false;
+  m_groups.clear();
+  m_paths.clear();
+  m_paths_built = false;
+  m_label_arena = PathArena();
+  m_labels[0].clear();
+  m_labels[1].clear();
+  m_duplicates_known = false;
+  m_id_base = static_cast<Id>(m_id_base + next_id);
+  invalidateViews();
+}
+
+void FileIndex::append(std::vector<FileInfo> &&entries) {
+  m_entries.reserve(m_entries.size() + entries.size());
+  m_live.reserve(m_live.size() + entries.size());
+  m_order.reserve(m_order.size() + entries.size());
+  for (auto &info : entries) {
+    m_order.push_back(addEntry(std::move(info)));
+  }
+  invalidateViews();
+}
+
+/**
+ * @brief Sorts slot numbers with FileScanner::sortIndices() (precomputed
+ *        keys, radix and parallel sort for large listings)
+ */
+void FileIndex::sort(bool include_parent) {
+  std::vector<std::uint32_t> slots;
+  slots.reserve(m_order.size());
+  for (Id id : m_order) {
+    slots.push_back(static_cast<std::uint32_t>(local(id)));
+  }
+  FileScanner::sortIndices(m_entries, slots, include_parent);
+  for (std::size_t i = 0; i < slots.size(); ++i) {
+    m_order[i] = static_cast<Id>(m_id_base + slots[i]);
+  }
+  m_sorted_by_size = false;
+  invalidateViews();
+}
+
+void FileIndex::sortBySize(const std::function<long long(const FileInfo &)> &size_of) {
+  sort(true);
+  std::vector<long long> sizes(m_entries.size(), 0);
+  for (Id id : m_order) {
+    sizes[local(id)] = at(id).isParentDir() ? -1 : size_of(at(id));
+  }
+  std::stable_sort(m_order.begin(), m_order.end(), [this, &sizes](Id a, Id b) {
+    const long long x = sizes[local(a)];
+    const long long y = sizes[local(b)];
+    if ((x < 0) != (y < 0))
+      return x < 0; // parent first
+    return x > y;
+  });
+  m_sorted_by_size = true;
+  invalidateViews();
+}
+
+FileIndex::Id FileIndex::insert(FileInfo info, bool include_parent) {
+  const Id id = addEntry(std::move(info));
+  if (m_sorted_by_size) {
+    // Not ordered by entryLess(): a binary search would be meaningless
+    m_order.push_back(id);
+  } else {
+    auto it = std::lower_bound(m_order.begin(), m_order.end(), id,
+                               [this, include_parent](Id a, Id b) {
+                                 return FileScanner::entryLess(at(a), at(b), include_parent);
+                               });
+    m_order.insert(it, id);
+  }
+  invalidateViews();
+  return id;
+}
+
+bool FileIndex::remove(const std::string &path) {
+  return remove(std::vector<std::string>{path}) == 1;
+}
+
+/**
+ * @brief Removes every path first, then compacts once
+ *
+ * Removed ids only lose their m_live bit and their path entry while the
+ * paths are looked up; m_order and the touched duplicate groups are
+ * compacted in one pass each afterwards, and the views are invalidated
+ * once. Removing k of n entries costs O(n + k) instead of O(n * k).
+ */
+std::size_t FileIndex::remove(const std::vector<std::string> &paths) {
+  std::vector<HashDigest> touched;
+  std::size_t removed = 0;
+  for (const auto &path : paths) {
+    Id id;
+    if (!find(path, id))
+      continue;
+
+    FileInfo &info = m_entries[local(id)];
+    if (groupable(info))
+      touched.push_back(info.getDigest());
+    info.setDuplicate(false);
+    info.setVerified(false);
+    m_live[local(id)] = 0;
+
+    const std::size_t hash = pathHash(path);
+    for (auto [it, end] = m_paths.equal_range(hash); it != end; ++it) {
+      if (it->second == id) {
+        m_paths.erase(it);
+        break;
+      }
+    }
+    ++removed;
+  }
+  if (removed == 0)
+    return 0;
+
+  auto dead = [this](Id id) { return !m_live[local(id)]; };
+  m_order.erase(std::remove_if(m_order.begin(), m_order.end(), dead), m_order.end());
+
+  for (const HashDigest &digest : touched) {
+    auto group = m_groups.find(digest);
+    if (group == m_groups.end())
+      continue; // already compacted
+    std::vector<Id> &members = group->second;
+    members.erase(std::remove_if(members.begin(), members.end(), dead), members.end());
+    if (members.size() == 1) {
+      m_entries[local(members.front())].setDuplicate(false);
+      m_entries[local(members.front())].setVerified(false);
+    }
+    if (members.empty()) {
+      m_groups.erase(group);
+    }
+  }
+  invalidateViews();
+  return removed;
+}
+
+bool FileIndex::find(const std::string &path, Id &id) const {
+  if (!m_paths_built) {
+    m_paths.reserve(m_order.size());
+    for (Id entry : m_order) {
+      m_paths.emplace(pathHash(at(entry).getPath()), entry);
+    }
+    m_paths_built = true;
+  }
+
+  // Compare the name first: no allocation for hash collisions
+  const std::size_t slash = path.rfind('/');
+  const std::string_view name = slash == std::string::npos
+                                    ? std::string_view(path)
+                                    : std::string_view(path).substr(slash + 1);
+  for (auto [it, end] = m_paths.equal_range(pathHash(path)); it != end; ++it) {
+    const FileInfo &info = at(it->second);
+    if (info.getName() == name && info.getPath() == path) {
+      id = it->second;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Builds the label into the arena on first use (one copy, no
+ *        allocation per call afterwards)
+ */
+std::string_view FileIndex::label(Id id, bool full_path) const {
+  std::vector<PathArena::NameRef> &labels = m_labels[full_path ? 1 : 0];
+  if (labels.size() < m_entries.size()) {
+    labels.resize(m_entries.size(), NO_LABEL);
+  }
+
+  PathArena::NameRef &ref = labels[local(id)];
+  if (ref.chunk == NO_LABEL.chunk) {
+    m_label_buffer.clear();
+    if (full_path) {
+      at(id).appendPath(m_label_buffer);
+    } else {
+      at(id).appendDisplayName(m_label_buffer);
+    }
+    ref = m_label_arena.addName(m_label_buffer);
+  }
+  return m_label_arena.name(ref);
+}
+
+void FileIndex::setDigest(Id id, const HashDigest &digest) {
+  if (!contains(id) || at(id).getDigest() == digest)
+    return;
+  leaveGroup(id);
+  m_entries[local(id)].setDigest(digest);
+  joinGroup(id);
+  invalidateViews(false); // names and order unchanged
+}
+
+void FileIndex::setVerified(Id id, bool verified) {
+  if (contains(id) && at(id).isDuplicate()) {
+    m_entries[local(id)].setVerified(verified);
+  }
+}
+
+void FileIndex::setNameFilter(std::string_view query) {
+  if (query == m_name_filter)
+    return;
+  m_name_filter = std::string(query);
+  m_views_valid[static_cast<std::size_t>(View::Matches)] = false;
+}
+
+/**
+ * @brief Builds a filtered view on first use after a change
+ *
+ * Duplicates and ZeroBytes: one pass over the listing order, reading only
+ * flags and sizes. Matches: the NameSearch index over the names in
+ * listing order is built once per listing change, then the name filter
+ * is matched against it (refining the previous query's result).
+ */
+const std::vector<FileIndex::Id> &FileIndex::view(View view) const {
+  if (view == View::All)
+    return m_order;
+
+  const auto slot = static_cast<std::size_t>(view);
+  if (!m_views_valid[slot] && view == View::Matches) {
+    std::vector<Id> &ids = m_views[slot];
+    ids.clear();
+    if (!m_names_built) {
+      m_names.clear();
+      m_name_ids.clear();
+      m_names.reserve(m_order.size(), m_order.size() * 16);
+      for (Id id : m_order) {
+        const FileInfo &info = at(id);
+        if (info.isParentDir())
+          continue;
+        m_names.add(info.getName());
+        m_name_ids.push_back(id);
+      }
+      m_names_built = true;
+    }
+    for (std::uint32_t position : m_names.match(m_name_filter)) {
+      ids.push_back(m_name_ids[position]);
+    }
+    m_views_valid[slot] = true;
+  } else if (!m_views_valid[slot]) {
+    std::vector<Id> &ids = m_views[slot];
+    ids.clear();
+    for (Id id : m_order) {
+      const FileInfo &info = at(id);
+      const bool match = view == View::Duplicates
+                             ? info.isDuplicate()
+                             : info.zeroFiles() && !info.isParentDir();
+      if (match)
+        ids.push_back(id);
+    }
+    m_views_valid[slot] = true;
+  }
+  return m_views[slot];
+}
+
+std::vector<FileInfo> FileIndex::snapshot(std::vector<Id> *ids) const {
+  std::vector<FileInfo> copy;
+  copy.reserve(m_order.size());
+  for (Id id : m_order) {
+    copy.push_back(at(id));
+  }
+  if (ids)
+    *ids = m_order;
+  return copy;
+}
+
+long long FileIndex::wastedSpace() const {
+  long long total = 0;
+  for (const auto &[digest, members] : m_groups) {
+    DuplicateFinder::WastedSpace waste;
+    for (Id id : members) {
+      waste.add(at(id));
+    }
+    total += waste.total;
+  }
+  return total;
+}
+
+FileIndex::Id FileIndex::addEntry(FileInfo &&info) {
+  const Id id = static_cast<Id>(m_id_base + m_entries.size());
+  info.setDuplicate(false);
+  m_entries.push_back(std::move(info));
+  m_live.push_back(1);
+  joinGroup(id);
+  if (m_paths_built) {
+    m_paths.emplace(pathHash(at(id).getPath()), id);
+  }
+  return id;
+}
+
+/**
+ * @brief Adds an entry to its digest group; the group turns duplicate at two
+ */
+void FileIndex::joinGroup(Id id) {
+  FileInfo &info = m_entries[local(id)];
+  if (!groupable(info))
+    return;
+
+  std::vector<Id> &members = m_groups[info.getDigest()];
+  members.push_back(id);
+  if (members.size() == 2) {
+    m_entries[local(members.front())].setDuplicate(true);
+  }
+  if (members.size() >= 2) {
+    info.setDuplicate(true);
+  }
+}
+
+/**
+ * @brief Removes an entry from its digest group; a last member is unmarked
+ */
+void FileIndex::leaveGroup(Id id) {
+  FileInfo &info = m_entries[local(id)];
+  info.setDuplicate(false);
+  info.setVerified(false);
+  if (!groupable(info))
+    return;
+
+  auto group = m_groups.find(info.getDigest());
+  if (group == m_groups.end())
+    return;
+  std::vector<Id> &members = group->second;
+  members.erase(std::remove(members.begin(), members.end(), id), members.end());
+  if (members.size() == 1) {
+    m_entries[local(members.front())].setDuplicate(false);
+    m_entries[local(members.front())].setVerified(false);
+  }
+  if (members.empty()) {
+    m_groups.erase(group);
+  }
+}
+
+void FileIndex::invalidateViews(bool names) {
+  for (std::size_t i = 1; i < VIEW_COUNT; ++i) {
+    m_views_valid[i] = false;
+  }
+  if (names)
+    m_names_built = false;
+}
+
+/** @brief Same candidates as DuplicateFinder: non-empty files with a digest */
+bool FileIndex::groupable(const FileInfo &info) {
+  return !info.isDirectory() && !info.isParentDir() && info.getFileSize() > 0 &&
+         !info.getDigest().empty();
+}
+
+std::size_t FileIndex::pathHash(const std::string &path) {
+  return std::hash<std::string_view>()(path);
+}
@@ -0,0 +1,252 @@
+/**
+ * @file fileindex.hpp
+ * @brief Owning store of a listing with cached filtered views
+ */
+
+#ifndef FILEINDEX_HPP
+#define FILEINDEX_HPP
+
+#include "fileinfo.hpp"
+#include "hashdigest.hpp"
+#include "namesearch.hpp"
+#include "patharena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class FileIndex
+ * @brief Holds every entry of a listing once and serves views as id lists
+ *
+ * Entries are addressed by a stable Id (never reused while the index
+ * lives), so views and callers can refer to them without copying FileInfo.
+ * A view is a list of ids in listing order:
+ * - View::All: every entry
+ * - View::Duplicates: files whose digest group has at least two members
+ * - View::ZeroBytes: empty regular files
+ * - View::Matches: entries whose name matches setNameFilter()
+ *
+ * Duplicate groups (digest -> members) are kept up to date by append(),
+ * insert(), remove() and setDigest(), including the FileInfo::Duplicate flag, so no
+ * search runs again after a change. Filtered views are built on first use
+ * after a change (one pass over the ids) and cached; switching views does
+ * not touch the entries at all.
+ *
+ * Row labels (label()) are built on first use into an arena owned by the
+ * index and returned as views, so moving through a listing allocates
+ * nothing once the rows were shown. clear() releases the entries, their
+ * labels and the lookup tables of a listing in one step.
+ *
+ * @note Not thread-safe; used from the UI thread
+ * @see DuplicateFinder
+ */
+class FileIndex {
+public:
+  /** @brief Stable entry handle */
+  using Id = std::uint32_t;
+
+  /** @brief Filtered views */
+  enum class View { All, Duplicates, ZeroBytes, Matches };
+
+  /** @brief Number of views */
+  static constexpr std::size_t VIEW_COUNT = 4;
+
+  /** @brief Removes all entries (ids are not reused afterwards either) */
+  void clear();
+
+  /**
+   * @brief Appends entries at the end of the listing order
+   *
+   * Digests already set on the entries join their duplicate groups.
+   *
+   * @param entries Entries to take over
+   */
+  void append(std::vector<FileInfo> &&entries);
+
+  /**
+   * @brief Sorts the listing order with FileScanner::sortEntries() rules
+   * @param include_parent If true, the parent directory (..) sorts first
+   */
+  void sort(bool include_parent);
+
+  /**
+   * @brief Sorts the listing order by a size, largest first
+   *
+   * The parent directory (..) stays first; equal sizes keep the order of
+   * sort(). Until the next sort(), insert() appends (sizes are not kept
+   * per entry); sort by size again to place inserted entries.
+   *
+   * @param size_of Size of an entry, e.g. the cumulative size of a
+   *        directory (see DirectoryTree); called once per entry
+   */
+  void sortBySize(const std::function<long long(const FileInfo &)> &size_of);
+
+  /**
+   * @brief Inserts one entry at its sorted position
+   *
+   * Binary search in the sort() order; after sortBySize() the entry is
+   * appended instead.
+   *
+   * @param info Entry to add
+   * @param include_parent Sort flag the listing was sorted with
+   * @return Id of the new entry
+   */
+  Id insert(FileInfo info, bool include_parent);
+
+  /**
+   * @brief Removes the entry with the given path
+   *
+   * Its duplicate group shrinks; a remaining single member is no longer
+   * a duplicate. No file is read.
+   *
+   * @return true if an entry was removed
+   */
+  bool remove(const std::string &path);
+
+  /**
+   * @brief Removes the entries of several paths at once
+   *
+   * Same as remove() per path, but the listing order and the duplicate
+   * groups are compacted once for the whole batch (linear in the listing
+   * size, not per path). Unknown paths are skipped.
+   *
+   * @param paths Full paths
+   * @return Number of entries removed
+   */
+  std::size_t remove(const std::vector<std::string> &paths);
+
+  /**
+   * @brief Looks up an entry by path
+   * @param path Full path
+   * @param id Receives the id on success
+   * @return false if no entry has this path
+   */
+  bool find(const std::string &path, Id &id) const;
+
+  /** @brief True if id refers to an entry that was not removed */
+  bool contains(Id id) const {
+    return id >= m_id_base && local(id) < m_live.size() && m_live[local(id)];
+  }
+
+  /** @brief Entry of a valid id */
+  const FileInfo &at(Id id) const { return m_entries[local(id)]; }
+
+  /**
+   * @brief Row label of an entry: display name or full path
+   * @param id Valid id
+   * @param full_path If true, the full path instead of the display name
+   * @return View valid until the next clear()
+   */
+  std::string_view label(Id id, bool full_path) const;
+
+  /**
+   * @brief Sets the content digest of an entry and regroups it
+   * @param id Entry to update
+   * @param digest New digest (empty removes it from its group)
+   */
+  void setDigest(Id id, const HashDigest &digest);
+
+  /**
+   * @brief Marks a duplicate as confirmed by content comparison
+   *
+   * Only duplicates carry the flag; leaving a group (see setDigest())
+   * clears it.
+   *
+   * @param id Entry to update
+   * @param verified New state of FileInfo::Verified
+   */
+  void setVerified(Id id, bool verified);
+
+  /**
+   * @brief Ids of a view in listing order
+   * @return Reference valid until the next modification
+   */
+  const std::vector<Id> &view(View view) const;
+
+  /**
+   * @brief Sets the query of View::Matches
+   *
+   * The names of the listing are packed into a NameSearch on first use
+   * after a change. While the listing is unchanged, a query extending the
+   * previous one only filters its matches, and a shortened one returns
+   * the stored result (see NameSearch::match()).
+   *
+   * @param query Words a name must all contain; "^word" for a prefix.
+   *        The parent directory (..) never matches
+   */
+  void setNameFilter(std::string_view query);
+
+  /** @brief Query of View::Matches */
+  const std::string &nameFilter() const { return m_name_filter; }
+
+  /** @brief Number of entries */
+  std::size_t size() const { return m_order.size(); }
+
+  /** @brief True if there are no entries */
+  bool empty() const { return m_order.empty(); }
+
+  /**
+   * @brief Copies all entries in listing order (for background work)
+   * @param ids If not nullptr, receives the id of every copied entry
+   */
+  std::vector<FileInfo> snapshot(std::vector<Id> *ids = nullptr) const;
+
+  /** @brief Allocated bytes of all but one inode of every duplicate group */
+  long long wastedSpace() const;
+
+  /**
+   * @brief Marks that a duplicate search covered this listing
+   *
+   * Entries added later take part once their digest is set. Cleared by
+   * clear().
+   */
+  void setDuplicatesKnown(bool known) { m_duplicates_known = known; }
+
+  /** @brief True once a duplicate search covered this listing */
+  bool duplicatesKnown() const { return m_duplicates_known; }
+
+private:
+  std::vector<FileInfo> m_entries; ///< Slot per id (removed slots stay)
+  std::vector<std::uint8_t> m_live;
+  Id m_id_base = 0;        ///< Id of m_entries[0]; grows with clear()
+  std::vector<Id> m_order; ///< Listing order of the live ids
+  bool m_sorted_by_size = false; ///< m_order is from sortBySize(), not sort()
+  bool m_duplicates_known = false;
+
+  std::unordered_map<HashDigest, std::vector<Id>, HashDigestHasher> m_groups;
+
+  /** @brief Path hash -> ids; built on first lookup */
+  mutable std::unordered_multimap<std::size_t, Id> m_paths;
+  mutable bool m_paths_built = false;
+
+  /** @brief Labels built so far; NO_LABEL where none was built yet */
+  static constexpr PathArena::NameRef NO_LABEL{0xFFFFFFFF, 0, 0};
+  mutable PathArena m_label_arena;
+  mutable std::vector<PathArena::NameRef> m_labels[2]; ///< Display name, full path
+  mutable std::string m_label_buffer;
+
+  mutable std::vector<Id> m_views[VIEW_COUNT];
+  mutable bool m_views_valid[VIEW_COUNT] = {true, false, false, false};
+
+  /** @brief Names of m_name_ids for View::Matches; built on first use */
+  std::string m_name_filter;
+  mutable NameSearch m_names;
+  mutable std::vector<Id> m_name_ids;
+  mutable bool m_names_built = false;
+
+  std::size_t local(Id id) const { return id - m_id_base; }
+  Id addEntry(FileInfo &&info);
+  void joinGroup(Id id);
+  void leaveGroup(Id id);
+  /** @param names False if the listing order and names did not change */
+  void invalidateViews(bool names = true);
+  static bool groupable(const FileInfo &info);
+  static std::size_t pathHash(const std::string &path);
+};
+
+#endif // FILEINDEX_HPP
@@ -1,7 +1,14 @@
 #ifndef FILE_INFO_HPP
 #define FILE_INFO_HPP
 
+#include "hashdigest.hpp"
+#include "patharena.hpp"
+
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
 
 /**
  * @brief Represents file system entry information for the terminal file manager.
@@ -9,32 +16,71 @@
  * This class encapsulates metadata about files and directories, including path,
  * size, hash, and various state flags. It provides methods for retrieving formatted
  * information suitable for display in a terminal interface with color coding.
+ *
+ * Memory layout: the path is stored as a directory id plus a name reference
+ * into a PathArena shared by all entries of a scan, the hash is a fixed-size
+ * binary HashDigest and all flags share one byte, so an entry needs no heap
+ * allocation of its own. Type and permission bits are captured once at scan
+ * time; rendering never queries the file system.
+ *
+ * Scanners also capture a regular file's identity (device, inode, link
+ * count) and allocated blocks; the record lives behind the name in the
+ * arena (PathArena::Inode), so hardlinks can be recognized without
+ * growing the entry.
  */
 class FileInfo {
+public:
+  /** @brief Entry flags, captured at scan time (see FileInfo(arena, ...)) */
+  enum Flags : std::uint8_t {
+    Directory = 1 << 0,  ///< Entry is a directory
+    Parent = 1 << 1,     ///< Entry represents the parent directory (..)
+    Executable = 1 << 2, ///< Regular file with owner execute permission
+    Duplicate = 1 << 3,  ///< Marked by DuplicateFinder
+    WholePath = 1 << 4,  ///< Name holds the whole path (e.g. "/")
+    Verified = 1 << 5,   ///< Duplicate confirmed byte for byte
+    HasInode = 1 << 6    ///< PathArena::Inode record stored behind the name
+  };
+
 private:
-  std::string m_path;         ///< Full path to the file or directory
-  long long m_size;           ///< Size in bytes (0 for directories)
-  std::string m_hash;         ///< Hash value for duplicate detection
-  bool m_isDir;               ///< True if this is a directory
-  bool m_isDuplicate = false; ///< True if marked as duplicate
-  bool m_isParent = false;    ///< True if this represents the parent directory (..)
-  // bool m_broken = false;      ///< True if the file/link is broken
+  std::shared_ptr<const PathArena> m_arena; ///< Storage of directory and name
+  long long m_size;                         ///< Size in bytes (0 for directories)
+  std::int64_t m_mtime_ns = 0;              ///< Modification time, 0 if unknown
+  PathArena::DirId m_dir = 0;               ///< Parent directory in m_arena
+  PathArena::NameRef m_name;                ///< File name in m_arena
+  std::uint8_t m_flags = 0;                 ///< Combination of Flags
+  HashDigest m_digest;                      ///< Hash value for duplicate detection
+
+  bool hasFlag(Flags flag) const { return (m_flags & flag) != 0; }
 
   /**
    * @brief Checks if the file has executable permissions.
    * @return True if the file is executable by the owner, false otherwise.
    * @note Always returns false for directories.
    */
-  bool isExecutable() const {
-    if (m_isDir)
-      return false;
+  bool isExecutable() const { return hasFlag(Executable); }
 
-    namespace fs = std::filesystem;
-    try {
-      auto perms = fs::status(m_path).permissions();
-      return (perms & fs::perms::owner_exec) != fs::perms::none;
-    } catch (...) {
-      return false;
+  /**
+   * @brief Stores a path in an arena, split into directory and name
+   */
+  void assignPath(PathArena &arena, std::string_view path, const PathArena::Inode *inode) {
+    const std::size_t slash = path.rfind('/');
+    auto add_name = [&](std::string_view name) {
+      if (!inode)
+        return arena.addName(name);
+      m_flags |= HasInode;
+      return arena.addName(name, *inode);
+    };
+    if (slash == std::string_view::npos) {
+      m_dir = arena.internDirectory("");
+      m_name = add_name(path);
+    } else if (slash + 1 == path.size()) {
+      // Root or trailing slash: no file name component
+      m_dir = arena.internDirectory("");
+      m_name = arena.addName(path);
+      m_flags |= WholePath;
+    } else {
+      m_dir = arena.internDirectory(slash == 0 ? path.substr(0, 1) : path.substr(0, slash));
+      m_name = add_name(path.substr(slash + 1));
     }
   }
 
@@ -45,16 +91,70 @@ public:
    * @param s Size in bytes (should be 0 for directories).
    * @param isDir True if this is a directory.
    * @param isParent True if this represents the parent directory (..), defaults to false.
+   *
+   * @note Allocates a private PathArena; scanners use the arena constructor
    */
   FileInfo(const std::string &p, long long s, bool isDir, bool isParent = false)
-      : m_path(p), m_size(s), m_hash(""), m_isDir(isDir), m_isParent(isParent) {
+      : m_size(s) {
+    auto arena = std::make_shared<PathArena>();
+    m_flags = static_cast<std::uint8_t>((isDir ? Directory : 0) | (isParent ? Parent : 0));
+    assignPath(*arena, p, nullptr);
+    m_arena = std::move(arena);
+  }
+
+  /**
+   * @brief Constructs a FileInfo object in a shared arena.
+   * @param arena Arena of the current scan (the name is copied into it)
+   * @param path Full path to the file or directory.
+   * @param s Size in bytes (should be 0 for directories).
+   * @param flags Combination of Flags (Directory, Parent, Executable)
+   * @param inode Identity of a regular file, stored in the arena (optional)
+   */
+  FileInfo(const std::shared_ptr<PathArena> &arena, std::string_view path, long long s,
+           std::uint8_t flags, const PathArena::Inode *inode = nullptr)
+      : m_size(s), m_flags(flags) {
+    assignPath(*arena, path, inode);
+    m_arena = arena;
   }
 
   /**
    * @brief Gets the full path to the file or directory.
-   * @return Constant reference to the path string.
+   * @return Path string, assembled from directory and name.
+   */
+  std::string getPath() const {
+    std::string path;
+    appendPath(path);
+    return path;
+  }
+
+  /**
+   * @brief Appends the full path to a string (no allocation if it has room).
+   * @param out String to append to
+   */
+  void appendPath(std::string &out) const {
+    std::string_view name = getName();
+    const std::string &dir = m_arena->directory(m_dir);
+    if (!dir.empty()) {
+      out.reserve(out.size() + dir.size() + 1 + name.size());
+      out += dir;
+      if (dir.back() != '/')
+        out += '/';
+    }
+    out += name;
+  }
+
+  /**
+   * @brief Gets the file name (last path component) without allocating.
+   * @return View into the shared arena; valid as long as this entry is.
+   */
+  std::string_view getName() const { return m_arena->name(m_name); }
+
+  /**
+   * @brief Gets the parent directory of the entry without allocating.
+   * @return Path without trailing slash ("/" for the root, empty for a
+   *         bare name); shared by every entry of that directory.
    */
-  const std::string &getPath() const { return m_path; }
+  const std::string &getDirectory() const { return m_arena->directory(m_dir); }
 
   /**
    * @brief Gets the file size in bytes.
@@ -62,17 +162,77 @@ public:
    */
   long long getFileSize() const { return m_size; }
 
+  /**
+   * @brief Gets the modification time captured at scan time.
+   * @return Nanoseconds since the epoch, 0 if unknown (directories are not
+   *         stat'ed by the scanners).
+   */
+  std::int64_t getModifiedTime() const { return m_mtime_ns; }
+
+  /**
+   * @brief Sets the modification time.
+   * @param mtime_ns Nanoseconds since the epoch.
+   */
+  void setModifiedTime(std::int64_t mtime_ns) { m_mtime_ns = mtime_ns; }
+
+  /**
+   * @brief Checks if the scanner captured device and inode.
+   * @return True for regular files from a scan, false otherwise.
+   */
+  bool hasInode() const { return hasFlag(HasInode); }
+
+  /**
+   * @brief Gets the identity captured at scan time.
+   * @return Device, inode, link count and blocks; all 0 if !hasInode().
+   */
+  PathArena::Inode getInode() const {
+    return hasInode() ? m_arena->inode(m_name) : PathArena::Inode();
+  }
+
+  /**
+   * @brief Checks if two entries are paths of the same file (hardlinks).
+   * @return True if both identities are known and equal.
+   */
+  bool sameInode(const FileInfo &other) const {
+    if (!hasInode() || !other.hasInode())
+      return false;
+    const auto a = getInode();
+    const auto b = other.getInode();
+    return a.inode == b.inode && a.device == b.device;
+  }
+
+  /**
+   * @brief Gets the disk space allocated to the file.
+   * @return st_blocks * 512 if captured at scan time, else getFileSize()
+   *         (sparse files allocate less, small files a whole block).
+   */
+  long long getAllocatedSize() const {
+    return hasInode() ? static_cast<long long>(getInode().blocks) * 512 : m_size;
+  }
+
   /**
    * @brief Gets the hash value used for duplicate detection.
-   * @return Constant reference to the hash string.
+   * @return Uppercase hex string, empty if no hash was set.
    */
-  const std::string &getHash() const { return m_hash; }
+  std::string getHash() const { return m_digest.toHex(); }
+
+  /**
+   * @brief Gets the binary hash value.
+   * @return Digest, empty if no hash was set.
+   */
+  const HashDigest &getDigest() const { return m_digest; }
 
   /**
    * @brief Checks if this entry is a directory.
    * @return True if directory, false if file.
    */
-  bool isDirectory() const { return m_isDir; }
+  bool isDirectory() const { return hasFlag(Directory); }
+
+  /**
+   * @brief Gets all flags, e.g. to store the entry (see ScanSnapshot).
+   * @return Combination of Flags
+   */
+  std::uint8_t getFlags() const { return m_flags; }
 
   /**
    * @brief Gets the display name for terminal output.
@@ -80,25 +240,33 @@ public:
    *         plain filename for files, or full path for root/current directory.
    */
   std::string getDisplayName() const {
-    if (m_isParent)
-      return ".."; // <-- Parent Dir
-
-    std::filesystem::path p(m_path);
-    std::string name = p.filename().string();
+    std::string name;
+    appendDisplayName(name);
+    return name;
+  }
 
-    if (name.empty() && m_isDir) {
-      // Root or current dir
-      return p.string();
+  /**
+   * @brief Appends the display name (see getDisplayName()) to a string.
+   * @param out String to append to
+   */
+  void appendDisplayName(std::string &out) const {
+    if (hasFlag(Parent)) {
+      out += ".."; // <-- Parent Dir
+      return;
     }
 
-    return m_isDir ? name + "/" : name;
+    out += getName();
+    // Root or current dir keep their name as is
+    if (isDirectory() && !hasFlag(WholePath)) {
+      out += '/';
+    }
   }
 
   /**
    * @brief Checks if this entry represents the parent directory.
    * @return True if this is the parent directory (..), false otherwise.
    */
-  bool isParentDir() const { return m_isParent; }
+  bool isParentDir() const { return hasFlag(Parent); }
 
   /**
    * @brief Gets the color code for terminal display.
@@ -106,11 +274,11 @@ public:
    *         4 (blue) for directories, 2 (green) for executables, 7 (white) for normal files.
    */
   int getColorCode() const {
-    if (m_size == 0 && !m_isDir)
+    if (m_size == 0 && !isDirectory())
       return 1; // Red: 0-Byte Files
-    if (m_isDuplicate)
+    if (isDuplicate())
       return 3; // Yellow: duplicate
-    if (m_isDir)
+    if (isDirectory())
       return 4; // Blue: Directories
     if (isExecutable())
       return 2; // Green: Executables
@@ -121,25 +289,47 @@ public:
    * @brief Checks if this file is marked as a duplicate.
    * @return True if marked as duplicate, false otherwise.
    */
-  bool isDuplicate() const { return m_isDuplicate; }
+  bool isDuplicate() const { return hasFlag(Duplicate); }
 
   /**
    * @brief Sets the duplicate flag for this file.
    * @param dup True to mark as duplicate, false otherwise.
    */
-  void setDuplicate(bool dup) { m_isDuplicate = dup; }
+  void setDuplicate(bool dup) {
+    m_flags = static_cast<std::uint8_t>(dup ? m_flags | Duplicate : m_flags & ~Duplicate);
+  }
+
+  /**
+   * @brief Checks if this duplicate was confirmed by content comparison.
+   * @return True if DuplicateFinder::verifyGroups() confirmed it.
+   */
+  bool isVerified() const { return hasFlag(Verified); }
+
+  /**
+   * @brief Sets the verified flag for this file.
+   * @param verified True once the content was compared byte for byte.
+   */
+  void setVerified(bool verified) {
+    m_flags = static_cast<std::uint8_t>(verified ? m_flags | Verified : m_flags & ~Verified);
+  }
 
   /**
    * @brief Sets the hash value for duplicate detection.
-   * @param hash The hash string to set.
+   * @param hash The hash as hex string (see HashDigest::fromHex()).
+   */
+  void setHash(const std::string &hash) { m_digest = HashDigest::fromHex(hash); }
+
+  /**
+   * @brief Sets the binary hash value.
+   * @param digest The digest to store.
    */
-  void setHash(const std::string &hash) { m_hash = hash; }
+  void setDigest(const HashDigest &digest) { m_digest = digest; }
 
   /**
    * @brief Checks if this is a zero-byte file (not a directory).
    * @return True if this is a file with size 0, false otherwise.
    */
-  bool zeroFiles() const { return (m_size == 0 && !m_isDir); }
+  bool zeroFiles() const { return (m_size == 0 && !isDirectory()); }
 };
 
 #endif // FILE_INFO_HPP
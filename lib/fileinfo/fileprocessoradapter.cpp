@@ -3,8 +3,9 @@
 /**
  * @brief Scans a directory and returns file information for all contained files
  *
- * Creates a FileScanner instance with an FNV1A hasher and delegates the
- * scanning operation to scan the directory at the adapter's configured path.
+ * Creates a FileScanner instance and delegates the scanning operation to
+ * scan the directory at the adapter's configured path. The scan is
+ * metadata-only; hashing happens in findDuplicates().
  *
  * @param include_parent_dir Whether to include the parent directory (..) in
  * results
@@ -17,14 +18,41 @@
  * @return std::vector<FileInfo> Vector containing FileInfo objects for each
  * file found during the scan
  *
- * @note The function creates a new FNV1A hasher and FileScanner for each call
+ * @note The function creates a new FileScanner for each call
  */
 std::vector<FileInfo>
 FileProcessorAdapter::scanDirectory(bool include_parent_dir, bool recursive,
                                     ProgressCallback progress) {
 
-  FNV1A hasher;
-  FileScanner scanner(hasher);
+  FileScanner scanner;
+  scanner.setStopToken(m_stop);
 
   return scanner.scanDirectory(m_path, recursive, include_parent_dir, progress);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Scans the directory and delivers the entries in batches
+ *
+ * Entries arrive unsorted, in batches of up to
+ * FileScanner::DEFAULT_BATCH_SIZE; FileScanner::sortEntries() restores the
+ * order of scanDirectory() once all batches are in.
+ *
+ * @param include_parent_dir Whether to deliver the parent directory (..)
+ *                           with the first batch
+ * @param recursive If true, recursively scan subdirectories
+ * @param on_batch Receives the batches; returning false stops the scan
+ * @param progress Optional callback with the current count of processed items
+ *
+ * @return Number of delivered entries
+ */
+std::size_t
+FileProcessorAdapter::scanDirectoryStreaming(bool include_parent_dir, bool recursive,
+                                             const FileScanner::BatchCallback &on_batch,
+                                             ProgressCallback progress) {
+
+  FileScanner scanner;
+  scanner.setStopToken(m_stop);
+
+  return scanner.scanDirectoryStreaming(m_path, recursive, include_parent_dir,
+                                        on_batch, progress);
+}
@@ -4,8 +4,9 @@
 
 #include "duplicatefinder.hpp"
 #include "filescanner.hpp"
-#include "fnv1a.hpp"
+#include "hashfactory.hpp"
 #include <filesystem>
+#include <memory>
 
 /**
  * @brief Adapter to bridge old FileProcessor interface with new lib
@@ -13,14 +14,28 @@
 class FileProcessorAdapter {
 private:
   std::filesystem::path m_path;
-  FNV1A m_hasher;
-  FileScanner m_scanner;
+  std::unique_ptr<IHashCalculator> m_hasher;
+  StopToken m_stop;
 
 public:
   using ProgressCallback = std::function<void(int)>;
   
-  FileProcessorAdapter(const std::filesystem::path &path)
-      : m_path(path), m_scanner(m_hasher) {}
+  /**
+   * @param path Directory to work on
+   * @param algorithm Content hash for duplicate detection
+   * @param cache Persistent digest cache (see HashCache::openDefault());
+   *        nullptr hashes without caching
+   */
+  FileProcessorAdapter(const std::filesystem::path &path,
+                       HashAlgorithm algorithm = HashAlgorithm::FNV1A,
+                       std::shared_ptr<HashCache> cache = nullptr)
+      : m_path(path), m_hasher(createHashCalculator(algorithm, std::move(cache))) {}
+
+  /**
+   * @brief Stops scans of this adapter once the token is stopped
+   * @see FileScanner::setStopToken()
+   */
+  void setStopToken(StopToken stop) { m_stop = std::move(stop); }
 
     // recursive as parameter
   std::vector<FileInfo> scanDirectory(
@@ -28,9 +43,19 @@ public:
       bool recursive = false,  // default false!
       ProgressCallback progress = nullptr);
 
+  /**
+   * @brief Scans the directory and delivers unsorted entries in batches
+   * @see FileScanner::scanDirectoryStreaming()
+   */
+  std::size_t scanDirectoryStreaming(
+      bool include_parent_dir,
+      bool recursive,
+      const FileScanner::BatchCallback &on_batch,
+      ProgressCallback progress = nullptr);
+
   std::vector<DuplicateFinder::DuplicateGroup>
   findDuplicates(std::vector<FileInfo> &files) {
-    return DuplicateFinder::findDuplicates(files);
+    return DuplicateFinder::findDuplicates(files, *m_hasher);
   }
 };
 
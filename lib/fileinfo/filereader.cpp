@@ -0,0 +1,226 @@
+/**
+ * @file filereader.cpp
+ * @brief Implementation of block and mmap based file reading
+ */
+
+#include "filereader.hpp"
+#include "uringreader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <vector>
+
+namespace {
+
+/** @brief Closes a file descriptor when leaving scope */
+struct FdGuard {
+  int fd;
+  ~FdGuard() {
+    if (fd >= 0)
+      ::close(fd);
+  }
+};
+
+/** @brief Per-thread read buffer, allocated once per thread */
+std::uint8_t *threadBuffer() {
+  thread_local std::vector<std::uint8_t> buffer(FileReader::BLOCK_SIZE);
+  return buffer.data();
+}
+
+/**
+ * @brief pread() loop that tolerates short reads and EINTR
+ * @return Number of bytes read, or -1 on error
+ */
+ssize_t preadFull(int fd, std::uint8_t *buf, std::size_t size, off_t offset) {
+  std::size_t done = 0;
+  while (done < size) {
+    ssize_t n = ::pread(fd, buf + done, size - done, offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    if (n == 0)
+      break;
+    done += static_cast<std::size_t>(n);
+  }
+  return static_cast<ssize_t>(done);
+}
+
+} // namespace
+
+/**
+ * @brief Reads a whole file in BLOCK_SIZE chunks
+ *
+ * Large files are mapped read-only; the mapping is released before
+ * returning. If mmap() fails (e.g. on some FUSE filesystems) the function
+ * falls back to read(2).
+ *
+ * @param path File to read
+ * @param consume Receives the content chunk by chunk
+ * @return true if the whole file was read, false on error
+ */
+bool FileReader::readAll(const std::string &path, const BlockConsumer &consume) {
+  FdGuard guard{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (guard.fd < 0)
+    return false;
+
+  struct stat st;
+  if (::fstat(guard.fd, &st) != 0)
+    return false;
+
+  const auto size = static_cast<std::size_t>(st.st_size);
+
+  if (S_ISREG(st.st_mode) && size >= MMAP_THRESHOLD) {
+    void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, guard.fd, 0);
+    if (map != MAP_FAILED) {
+      ::madvise(map, size, MADV_SEQUENTIAL);
+      const auto *data = static_cast<const std::uint8_t *>(map);
+      for (std::size_t offset = 0; offset < size; offset += BLOCK_SIZE) {
+        std::size_t n = size - offset < BLOCK_SIZE ? size - offset : BLOCK_SIZE;
+        consume(data + offset, n);
+      }
+      ::munmap(map, size);
+      return true;
+    }
+  }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+  ::posix_fadvise(guard.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  std::uint8_t *buffer = threadBuffer();
+  while (true) {
+    ssize_t n = ::read(guard.fd, buffer, BLOCK_SIZE);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    if (n == 0)
+      break;
+    consume(buffer, static_cast<std::size_t>(n));
+  }
+
+  return true;
+}
+
+/**
+ * @brief Reads head and tail of a file with two pread() calls
+ *
+ * @param path File to read
+ * @param sampleSize Bytes to read from each end (at most BLOCK_SIZE)
+ * @param consume Receives head, then tail
+ * @return true on success, false on error or if the file shrank meanwhile
+ */
+bool FileReader::readHeadTail(const std::string &path, std::size_t sampleSize,
+                              const BlockConsumer &consume) {
+  if (sampleSize == 0 || sampleSize > BLOCK_SIZE)
+    return false;
+
+  FdGuard guard{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (guard.fd < 0)
+    return false;
+
+  struct stat st;
+  if (::fstat(guard.fd, &st) != 0)
+    return false;
+
+  const auto size = static_cast<std::size_t>(st.st_size);
+  std::uint8_t *buffer = threadBuffer();
+
+  // Whole file fits into the sample window: pass it exactly once
+  if (size <= 2 * sampleSize) {
+    for (std::size_t offset = 0; offset < size; offset += BLOCK_SIZE) {
+      std::size_t want = size - offset < BLOCK_SIZE ? size - offset : BLOCK_SIZE;
+      ssize_t n = preadFull(guard.fd, buffer, want, static_cast<off_t>(offset));
+      if (n != static_cast<ssize_t>(want))
+        return false;
+      consume(buffer, want);
+    }
+    return true;
+  }
+
+  for (std::size_t offset : {std::size_t(0), size - sampleSize}) {
+    ssize_t n = preadFull(guard.fd, buffer, sampleSize, static_cast<off_t>(offset));
+    if (n != static_cast<ssize_t>(sampleSize))
+      return false;
+    consume(buffer, sampleSize);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Reads a whole file through io_uring if the mode asks for it
+ *
+ * Falls back to the buffered readAll() whenever UringReader reports
+ * Unsupported; that is decided before the first chunk reaches consume, so
+ * the consumer never sees content twice.
+ */
+bool FileReader::readAll(const std::string &path, ReadMode mode, const BlockConsumer &consume) {
+  if (mode != ReadMode::Buffered) {
+    if (UringReader *uring = UringReader::forThread()) {
+      switch (uring->readAll(path, mode == ReadMode::UringDirect, consume)) {
+      case UringReader::Result::Ok:
+        return true;
+      case UringReader::Result::Error:
+        return false;
+      case UringReader::Result::Unsupported:
+        break;
+      }
+    }
+  }
+  return readAll(path, consume);
+}
+
+/**
+ * @brief Reads head and tail through io_uring if the mode asks for it
+ *
+ * Both ranges are submitted together, so the two reads overlap.
+ */
+bool FileReader::readHeadTail(const std::string &path, std::size_t sampleSize, ReadMode mode,
+                              const BlockConsumer &consume) {
+  if (mode != ReadMode::Buffered) {
+    if (UringReader *uring = UringReader::forThread()) {
+      switch (uring->readHeadTail(path, sampleSize, mode == ReadMode::UringDirect, consume)) {
+      case UringReader::Result::Ok:
+        return true;
+      case UringReader::Result::Error:
+        return false;
+      case UringReader::Result::Unsupported:
+        break;
+      }
+    }
+  }
+  return readHeadTail(path, sampleSize, consume);
+}
+
+bool FileReader::parseReadMode(const std::string &name, ReadMode &mode) {
+  if (name == "blocking") {
+    mode = ReadMode::Buffered;
+  } else if (name == "uring") {
+    mode = ReadMode::Uring;
+  } else if (name == "direct") {
+    mode = ReadMode::UringDirect;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char *FileReader::readModeName(ReadMode mode) {
+  switch (mode) {
+  case ReadMode::Uring:
+    return "uring";
+  case ReadMode::UringDirect:
+    return "direct";
+  case ReadMode::Buffered:
+  default:
+    return "blocking";
+  }
+}
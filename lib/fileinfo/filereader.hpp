@@ -0,0 +1,109 @@
+/**
+ * @file filereader.hpp
+ * @brief Large-block and memory-mapped file content reading for hashers
+ */
+
+#ifndef FILEREADER_HPP
+#define FILEREADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * @class FileReader
+ * @brief Streams file content to a consumer in large blocks
+ *
+ * Replaces per-byte std::ifstream reads in the hash implementations:
+ * - Files of at least MMAP_THRESHOLD bytes are memory-mapped and handed to
+ *   the consumer in BLOCK_SIZE slices (MADV_SEQUENTIAL read-ahead)
+ * - Smaller files are read with read(2) into a per-thread buffer
+ * - ReadMode::Uring keeps several reads in flight through io_uring, and
+ *   ReadMode::UringDirect additionally bypasses the page cache (O_DIRECT)
+ *
+ * All functions are thread-safe; every thread uses its own buffer.
+ *
+ * @see BlockHashCalculator
+ */
+class FileReader {
+public:
+  /** @brief Receives consecutive chunks of file content */
+  using BlockConsumer = std::function<void(const std::uint8_t *data, std::size_t size)>;
+
+  /** @brief Size of the chunks handed to the consumer */
+  static constexpr std::size_t BLOCK_SIZE = 256 * 1024;
+
+  /** @brief Files of at least this size are memory-mapped */
+  static constexpr std::size_t MMAP_THRESHOLD = 1024 * 1024;
+
+  /**
+   * @brief How file content is fetched
+   *
+   * The io_uring modes fall back to Buffered where io_uring is unavailable
+   * (non-Linux builds, old kernels, seccomp) and for non-regular files.
+   */
+  enum class ReadMode {
+    Buffered,   ///< mmap or read(2), one request at a time (default)
+    Uring,      ///< io_uring, UringReader::QUEUE_DEPTH reads in flight
+    UringDirect ///< Like Uring with O_DIRECT: leaves the page cache alone
+  };
+
+  /**
+   * @brief Reads a whole file and passes it to consume in order
+   * @param path File to read
+   * @param consume Called once per chunk, never with size 0
+   * @return true if the whole file was read, false on any I/O error
+   */
+  static bool readAll(const std::string &path, const BlockConsumer &consume);
+
+  /**
+   * @brief Reads the first and last sampleSize bytes of a file
+   *
+   * Used for sample hashes. The head is passed before the tail. Files not
+   * larger than 2 * sampleSize are passed completely, exactly once.
+   *
+   * @param path File to read
+   * @param sampleSize Bytes to read from each end
+   * @param consume Called with head and tail data
+   * @return true on success, false on any I/O error
+   */
+  static bool readHeadTail(const std::string &path, std::size_t sampleSize,
+                           const BlockConsumer &consume);
+
+  /**
+   * @brief readAll() with a selectable read mode
+   * @param path File to read
+   * @param mode How to fetch the content
+   * @param consume Called once per chunk, never with size 0
+   * @return true if the whole file was read, false on any I/O error
+   */
+  static bool readAll(const std::string &path, ReadMode mode, const BlockConsumer &consume);
+
+  /**
+   * @brief readHeadTail() with a selectable read mode
+   * @param path File to read
+   * @param sampleSize Bytes to read from each end
+   * @param mode How to fetch the content
+   * @param consume Called with head and tail data
+   * @return true on success, false on any I/O error
+   */
+  static bool readHeadTail(const std::string &path, std::size_t sampleSize, ReadMode mode,
+                           const BlockConsumer &consume);
+
+  /**
+   * @brief Parses a read mode name as used on the command line
+   *
+   * Accepted names are "blocking", "uring" and "direct".
+   *
+   * @param name Name to parse
+   * @param mode Receives the mode on success
+   * @return true if the name is known, false otherwise
+   */
+  static bool parseReadMode(const std::string &name, ReadMode &mode);
+
+  /** @brief Command line name of a read mode (inverse of parseReadMode()) */
+  static const char *readModeName(ReadMode mode);
+};
+
+#endif // FILEREADER_HPP
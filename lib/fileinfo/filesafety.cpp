@@ -7,10 +7,10 @@
  */
 
 #include "filesafety.hpp"
-#include <fstream>
-#include <sstream>
+#include <climits>
 #include <cstdlib>
 #include <sys/vfs.h>
+#include <unordered_map>
 
 /**
  * @brief Critical system paths that should never be deleted
@@ -25,6 +25,79 @@ const std::unordered_set<std::string> FileSafety::CRITICAL_PATHS = {
     "/bin", "/sbin", "/opt", "/srv", "/tmp"
 };
 
+namespace {
+
+/**
+ * @brief Checks a filesystem magic number against the protected types
+ * @see FileSafety::isProtectedFilesystem()
+ */
+bool isProtectedMagic(long f_type) {
+    // Magic numbers for protected filesystem types
+    // See: /usr/include/linux/magic.h
+    const long PROTECTED_FS[] = {
+        0x9fa0,       // PROC_SUPER_MAGIC (procfs)
+        0x62656572,   // SYSFS_MAGIC (sysfs)
+        0x01021994,   // TMPFS_MAGIC (tmpfs)
+        0x858458f6,   // RAMFS_MAGIC (ramfs)
+        0x3434,       // DEVPTS_SUPER_MAGIC (devpts)
+        0x73636673,   // SECURITYFS_MAGIC (securityfs)
+        0x27e0eb,     // CGROUP_SUPER_MAGIC (cgroup)
+        0x63677270,   // CGROUP2_SUPER_MAGIC (cgroup2)
+    };
+
+    for (auto magic : PROTECTED_FS) {
+        if (f_type == magic) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Path with its parent directory resolved by realpath()
+ *
+ * The entry itself is not resolved: deleting a symlink removes the link,
+ * not its target. Resolving the parent makes a path reached through a
+ * symlinked directory (~/ramdisk/x with ~/ramdisk -> /dev/shm) count for
+ * the mount it really lies on.
+ *
+ * @param path Absolute path to check
+ * @param parents Resolved parents of earlier paths of a batch (may be null)
+ * @return Resolved path, empty if the parent cannot be resolved
+ */
+std::string resolveParent(const std::string& path,
+                          std::unordered_map<std::string, std::string>* parents) {
+    const std::size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos || path == "/") {
+        return path;
+    }
+    const std::string parent = slash == 0 ? "/" : path.substr(0, slash);
+
+    auto resolve = [](const std::string& dir) {
+        char buffer[PATH_MAX];
+        return ::realpath(dir.c_str(), buffer) ? std::string(buffer) : std::string();
+    };
+    std::string real;
+    if (parents) {
+        auto [it, inserted] = parents->try_emplace(parent);
+        if (inserted) {
+            it->second = resolve(parent);
+        }
+        real = it->second;
+    } else {
+        real = resolve(parent);
+    }
+    if (real.empty()) {
+        return real;
+    }
+    if (real.back() != '/') {
+        real += '/';
+    }
+    return real.append(path, slash + 1, std::string::npos);
+}
+
+} // namespace
+
 /**
  * @brief Checks whether a path is safe to delete
  *
@@ -46,36 +119,88 @@ const std::unordered_set<std::string> FileSafety::CRITICAL_PATHS = {
  * @see getStatusMessage()
  */
 FileSafety::DeletionStatus FileSafety::checkDeletion(const std::string& path) {
+    return checkDeletion(path, *MountTable::global().snapshot());
+}
+
+/**
+ * @brief Same checks as checkDeletion(path), against a given mount snapshot
+ *
+ * Needs one realpath() of the parent directory besides getenv(): mount
+ * point, file system type and removable flag then come from the snapshot.
+ *
+ * @see checkDeletions()
+ */
+FileSafety::DeletionStatus FileSafety::checkDeletion(const std::string& path,
+                                                     const MountTable::Snapshot& mounts) {
+    return checkResolved(path, resolveParent(path, nullptr), mounts);
+}
+
+/**
+ * @brief Runs the checks on a path and its resolved form
+ *
+ * System paths and the home directory are blocked under either name. The
+ * mount checks use the resolved path; without one (parent missing or
+ * unreadable) statfs() on the path decides, failing safe.
+ */
+FileSafety::DeletionStatus FileSafety::checkResolved(const std::string& path,
+                                                     const std::string& real,
+                                                     const MountTable::Snapshot& mounts) {
     // Check in order of severity
 
     // 1. System paths
-    if (isSystemPath(path)) {
+    if (isSystemPath(path) || isSystemPath(real)) {
         return DeletionStatus::BlockedSystemPath;
     }
 
     // 2. User home
-    if (isUserHome(path)) {
+    if (isUserHome(path) || isUserHome(real)) {
         return DeletionStatus::BlockedHome;
     }
 
     // 3. Virtual filesystems (proc, sys, etc.)
-    if (isProtectedFilesystem(path)) {
+    if (real.empty() ? isProtectedFilesystem(path) : isProtectedFilesystem(real, mounts)) {
         return DeletionStatus::BlockedVirtualFS;
     }
 
+    const std::string& located = real.empty() ? path : real;
+
     // 4. Mount points
-    if (isMountPoint(path)) {
+    if (isMountPoint(located, mounts)) {
         return DeletionStatus::BlockedMountPoint;
     }
 
     // 5. Removable media (warning, not blocked)
-    if (isRemovableMedia(path)) {
+    if (isRemovableMedia(located, mounts)) {
         return DeletionStatus::WarningRemovableMedia;
     }
 
     return DeletionStatus::Allowed;
 }
 
+/**
+ * @brief Checks a batch of paths against one mount snapshot
+ *
+ * Every parent directory is resolved once, so a batch costs one
+ * realpath() per directory rather than per path.
+ *
+ * @param paths The filesystem paths to check
+ * @return Status of every path, in input order
+ *
+ * @see checkDeletion()
+ */
+std::vector<FileSafety::DeletionStatus>
+FileSafety::checkDeletions(const std::vector<std::string>& paths) {
+    const auto mounts = MountTable::global().snapshot();
+
+    std::unordered_map<std::string, std::string> parents;
+    std::vector<DeletionStatus> statuses;
+    statuses.reserve(paths.size());
+    for (const auto& path : paths) {
+        statuses.push_back(checkResolved(path, resolveParent(path, &parents), *mounts));
+    }
+    return statuses;
+}
+
 /**
  * @brief Converts a DeletionStatus to a human-readable message
  *
@@ -152,19 +277,15 @@ bool FileSafety::isUserHome(const std::string& path) {
  *
  * @return true if the path is a mount point, false otherwise
  *
- * @see getMountPoints()
- * @note Reads mount information from /proc/mounts
+ * @see MountTable
+ * @note Uses the cached mount table (binary search, no parsing)
  */
 bool FileSafety::isMountPoint(const std::string& path) {
-    auto mounts = getMountPoints();
-
-    for (const auto& mount : mounts) {
-        if (mount.mountpoint == path) {
-            return true;
-        }
-    }
+    return isMountPoint(path, *MountTable::global().snapshot());
+}
 
-    return false;
+bool FileSafety::isMountPoint(const std::string& path, const MountTable::Snapshot& mounts) {
+    return mounts.isMountPoint(path);
 }
 
 /**
@@ -200,128 +321,82 @@ bool FileSafety::isProtectedFilesystem(const std::string& path) {
         return true;  // On error, assume protected
     }
 
-    // Magic numbers for protected filesystem types
-    // See: /usr/include/linux/magic.h
-    const long PROTECTED_FS[] = {
-        0x9fa0,       // PROC_SUPER_MAGIC (procfs)
-        0x62656572,   // SYSFS_MAGIC (sysfs)
-        0x01021994,   // TMPFS_MAGIC (tmpfs)
-        0x858458f6,   // RAMFS_MAGIC (ramfs)
-        0x3434,       // DEVPTS_SUPER_MAGIC (devpts)
-        0x73636673,   // SECURITYFS_MAGIC (securityfs)
-        0x27e0eb,     // CGROUP_SUPER_MAGIC (cgroup)
-        0x63677270,   // CGROUP2_SUPER_MAGIC (cgroup2)
-    };
-
-    for (auto magic : PROTECTED_FS) {
-        if (fs_info.f_type == magic) {
-            return true;
-        }
-    }
+    return isProtectedMagic(fs_info.f_type);
+}
 
-    return false;
+/**
+ * @brief Same check using the file system type of the containing mount
+ *
+ * @return true if the mount is protected or no mount contains the path
+ *         (fail-safe behavior)
+ */
+bool FileSafety::isProtectedFilesystem(const std::string& path,
+                                       const MountTable::Snapshot& mounts) {
+    const auto* mount = mounts.find(path);
+    return !mount || isProtectedMagic(mount->fs_magic);
 }
 
 /**
  * @brief Checks if a path is on removable media
  *
  * Determines whether the given path resides on removable media such as USB
- * drives, SD cards, or external hard drives. The function uses two methods:
- * 1. Checks if the mount point is under typical removable media paths
+ * drives, SD cards, or external hard drives, by the mount containing it
+ * (longest mounted prefix). A mount counts as removable if:
+ * 1. its mount point is under typical removable media paths
  *    (/media, /mnt, /run/media)
- * 2. For SCSI devices (/dev/sd*), queries sysfs to check the removable flag
+ * 2. or sysfs flags its block device (or the partition's disk) removable
  *
  * @param path The filesystem path to check
  *
  * @return true if the path is on removable media, false otherwise
  *
- * @see getMountPoints()
- * @see MountInfo
+ * @see MountTable::Snapshot::find()
  *
- * @note For /dev/sd* devices, reads from /sys/block/sdX/removable to
- *       determine if the device is removable (1) or fixed (0)
+ * @note The sysfs flag is read once per device when the mount table is
+ *       loaded, not per path
  * @note This check generates a warning rather than blocking deletion
  */
 bool FileSafety::isRemovableMedia(const std::string& path) {
-    auto mounts = getMountPoints();
-
-    for (const auto& mount : mounts) {
-        // Check if path is on this mount
-        if (path.find(mount.mountpoint) == 0) {
-            if (mount.is_removable) {
-                return true;
-            }
-
-            // Additional check: Query sysfs for removable flag
-            if (mount.device.find("/dev/sd") == 0) {
-                // e.g. /dev/sda1 → /sys/block/sda/removable
-                std::string device_name = mount.device.substr(5, 3);  // "sda"
-                std::string sysfs_path = "/sys/block/" + device_name + "/removable";
-
-                std::ifstream removable_file(sysfs_path);
-                if (removable_file.is_open()) {
-                    int removable = 0;
-                    removable_file >> removable;
-                    if (removable == 1) {
-                        return true;
-                    }
-                }
-            }
-        }
-    }
+    return isRemovableMedia(path, *MountTable::global().snapshot());
+}
 
-    return false;
+bool FileSafety::isRemovableMedia(const std::string& path,
+                                  const MountTable::Snapshot& mounts) {
+    const auto* mount = mounts.find(path);
+    return mount && mount->removable;
 }
 
 /**
  * @brief Retrieves information about all currently mounted filesystems
  *
- * Parses /proc/mounts to extract information about all mounted filesystems
- * in the system. For each mount, determines whether it's the root filesystem
- * and whether it appears to be removable media based on the mount point path.
+ * Lists the cached mount table (MountTable), which is re-read from
+ * /proc/self/mountinfo only after the kernel reported a change. For each
+ * mount, determines whether it's the root filesystem and whether it is
+ * removable media.
  *
  * @return std::vector<MountInfo> Vector containing information about each
- *         mounted filesystem. Returns empty vector if /proc/mounts cannot
- *         be opened.
+ *         mounted filesystem, ordered by mount point. Returns empty vector
+ *         if /proc is not available.
  *
  * @see MountInfo
- *
- * @note Mount points under /media, /mnt, or /run/media are flagged as
- *       potentially removable
- * @note This function reads from /proc/mounts which requires read access
- *       to the proc filesystem
+ * @see MountTable
  *
  * Each MountInfo entry contains:
  * - device: The device path (e.g., /dev/sda1)
  * - mountpoint: Where the device is mounted (e.g., /home)
  * - fstype: Filesystem type (e.g., ext4, ntfs, vfat)
  * - is_root: Whether this is the root filesystem (/)
- * - is_removable: Whether the mount point suggests removable media
+ * - is_removable: Mount point under /media, /mnt, /run/media, or a
+ *   removable block device
  */
 std::vector<FileSafety::MountInfo> FileSafety::getMountPoints() {
-    std::vector<MountInfo> mounts;
-    std::ifstream mounts_file("/proc/mounts");
-
-    if (!mounts_file.is_open()) {
-        return mounts;  // Return empty on error
-    }
+    const auto snapshot = MountTable::global().snapshot();
 
-    std::string line;
-    while (std::getline(mounts_file, line)) {
-        std::istringstream iss(line);
-        MountInfo info;
-        std::string options, dump, pass;
-
-        iss >> info.device >> info.mountpoint >> info.fstype >> options >> dump >> pass;
-
-        // Determine flags
-        info.is_root = (info.mountpoint == "/");
-        info.is_removable = (info.mountpoint.find("/media") == 0 ||
-                             info.mountpoint.find("/mnt") == 0 ||
-                             info.mountpoint.find("/run/media") == 0);
-
-        mounts.push_back(info);
+    std::vector<MountInfo> mounts;
+    mounts.reserve(snapshot->mounts().size());
+    for (const auto& mount : snapshot->mounts()) {
+        mounts.push_back({mount.device, mount.mountpoint, mount.fstype, mount.removable,
+                          mount.mountpoint == "/"});
     }
-
     return mounts;
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #ifndef FILESAFETY_HPP
 #define FILESAFETY_HPP
 
+#include "mounttable.hpp"
 #include <string>
 #include <vector>
 #include <unordered_set>
@@ -33,6 +34,22 @@ public:
      * @return DeletionStatus indicating if/why deletion is blocked
      */
     static DeletionStatus checkDeletion(const std::string& path);
+
+    /**
+     * @brief Check a path against a mount snapshot taken by the caller
+     * @param path Full path to check
+     * @param mounts Snapshot of MountTable::global()
+     * @return DeletionStatus indicating if/why deletion is blocked
+     */
+    static DeletionStatus checkDeletion(const std::string& path,
+                                        const MountTable::Snapshot& mounts);
+
+    /**
+     * @brief Check a batch of paths against one mount table snapshot
+     * @param paths Full paths to check
+     * @return Status of every path, in the same order
+     */
+    static std::vector<DeletionStatus> checkDeletions(const std::vector<std::string>& paths);
     
     /**
      * @brief Get human-readable message for deletion status
@@ -53,24 +70,47 @@ public:
      * @brief Check if path is a mount point
      */
     static bool isMountPoint(const std::string& path);
+
+    /**
+     * @brief Check if path is one of the given mount points
+     */
+    static bool isMountPoint(const std::string& path, const MountTable::Snapshot& mounts);
     
     /**
      * @brief Check if path is on a virtual/protected filesystem
      */
     static bool isProtectedFilesystem(const std::string& path);
+
+    /**
+     * @brief Check if the mount containing path is a virtual/protected filesystem
+     */
+    static bool isProtectedFilesystem(const std::string& path,
+                                      const MountTable::Snapshot& mounts);
     
     /**
      * @brief Check if path is on removable media (USB, etc.)
      */
     static bool isRemovableMedia(const std::string& path);
+
+    /**
+     * @brief Check if path is on removable media of the given mounts
+     */
+    static bool isRemovableMedia(const std::string& path, const MountTable::Snapshot& mounts);
     
     /**
-     * @brief Get all mount points from /proc/mounts
+     * @brief Get all mount points (cached, see MountTable)
      */
     static std::vector<MountInfo> getMountPoints();
 
 private:
     static const std::unordered_set<std::string> CRITICAL_PATHS;
+
+    /**
+     * @brief Checks of checkDeletion() on a path and its resolved form
+     * @param real Path with the parent resolved, empty if unresolvable
+     */
+    static DeletionStatus checkResolved(const std::string& path, const std::string& real,
+                                        const MountTable::Snapshot& mounts);
 };
 
 #endif // FILESAFETY_HPP
\ No newline at end of file
@@ -8,8 +8,18 @@
  */
 
 #include "filescanner.hpp"
+#include "scanpolicies.hpp"
+#include "stats.hpp"
+
+#include <sys/stat.h>
+
 #include <algorithm>
+#include <deque>
+#include <chrono>
 #include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string_view>
 
 /**
  * @brief Scans a directory and collects file information
@@ -18,6 +28,9 @@
  * for all entries. The function supports progress callbacks for long operations
  * and can optionally include the parent directory (..) in the results.
  *
+ * Recursive scans run on a work-stealing thread pool when more than one
+ * thread is configured (see setThreadCount()).
+ *
  * Progress callbacks are invoked periodically during scanning:
  * - Every 100 items in recursive mode
  * - Every 10 items in non-recursive mode
@@ -45,8 +58,8 @@
  * @see sortEntries()
  * @see ProgressCallback
  *
- * @note Exceptions during directory iteration are caught and ignored (empty
- * catch block)
+ * @note Unreadable directories are skipped; a missing dir_path yields an
+ * empty result
  * @note Parent directory is only included in non-recursive mode to avoid
  * confusion
  * @note Progress callback receives item count, not percentage
@@ -57,98 +70,906 @@ FileScanner::scanDirectory(const std::filesystem::path &dir_path,
                            ProgressCallback progress) {
 
   std::vector<FileInfo> results;
+
+  if (recursive && m_thread_count > 1) {
+    // A single batch (batch_size 0) keeps the scan in one arena per
+    // thread; parallel workers deliver one batch each, which are merged.
+    scanDirectoryStreaming(
+        dir_path, recursive, include_parent_dir,
+        [&results](std::vector<FileInfo> &&batch) {
+          if (results.empty()) {
+            results = std::move(batch);
+          } else {
+            results.reserve(results.size() + batch.size());
+            std::move(batch.begin(), batch.end(), std::back_inserter(results));
+          }
+          return true;
+        },
+        std::move(progress), 0);
+  } else {
+    // Straight into results, one arena, no batch bookkeeping per entry
+    TMF_STATS_TIMER(Scan);
+    CollectSink sink(results);
+    scanSequential(dir_path, recursive, include_parent_dir, sink, progress);
+  }
+
+  // Sorting order: ".." first, then folders, then files (alphabetical)
+  sortEntries(results, include_parent_dir);
+
+  return results;
+}
+
+/**
+ * @brief Collects entries of one thread and hands them out in batches
+ *
+ * Starts a new PathArena after every delivered batch, so the consumer
+ * owns the arena of each batch it receives and may read it while the
+ * scan continues.
+ */
+class FileScanner::Batch {
+public:
+  using clock = std::chrono::steady_clock;
+
+  Batch(const BatchCallback &emit, std::size_t batch_size)
+      : m_emit(emit), m_batch_size(batch_size),
+        m_arena(std::make_shared<PathArena>()), m_started(clock::now()) {}
+
+  std::vector<FileInfo> &entries() { return m_entries; }
+  const std::shared_ptr<PathArena> &arena() const { return m_arena; }
+
+  /**
+   * @brief Delivers the batch if it is full or has waited long enough
+   * @return false if the consumer stopped the scan
+   */
+  bool added() {
+    if (m_batch_size == 0)
+      return true;
+    if (m_entries.size() < m_batch_size && clock::now() - m_started < BATCH_INTERVAL)
+      return true;
+    return flush();
+  }
+
+  /**
+   * @brief Delivers the collected entries (if any)
+   * @return false if the consumer stopped the scan
+   */
+  bool flush() {
+    m_started = clock::now();
+    if (m_entries.empty())
+      return true;
+
+    std::vector<FileInfo> batch;
+    batch.swap(m_entries);
+    m_delivered += batch.size();
+    if (m_batch_size != 0) {
+      m_entries.reserve(m_batch_size);
+      m_arena = std::make_shared<PathArena>();
+    }
+    return m_emit(std::move(batch));
+  }
+
+  std::size_t delivered() const { return m_delivered; }
+
+private:
+  const BatchCallback &m_emit;
+  std::size_t m_batch_size;
+  std::vector<FileInfo> m_entries;
+  std::shared_ptr<PathArena> m_arena;
+  clock::time_point m_started;
+  std::size_t m_delivered = 0;
+};
+
+/**
+ * @brief Lists one directory into a batch
+ *
+ * Native backend: DirentReader supplies type, size and mode, so entries
+ * are built without any further syscall (directories cost none at all).
+ * Portable backend: directory_iterator plus processEntry().
+ *
+ * Both backends classify alike: symlinks are followed for type, size and
+ * permissions, but only real directories are collected for recursion.
+ *
+ * @param dir Directory to list
+ * @param batch Sink receiving the entries
+ * @param reader DirentReader of the calling thread, nullptr for Portable
+ * @param subdirs Receives subdirectories to descend into (may be nullptr)
+ * @param on_entry Called after each entry; returning false stops
+ * @return false if the listing was stopped
+ */
+template <typename Sink, typename OnEntry>
+bool FileScanner::listDirectory(const std::string &dir, Sink &batch,
+                                DirentReader *reader,
+                                std::vector<std::string> *subdirs,
+                                OnEntry &&on_entry) const {
+  TMF_STATS_ADD(DirectoriesListed, 1);
+  Stats::Tally listed(Stats::Counter::EntriesListed);
+  if (reader) {
+    std::string path;
+    return reader->list(dir, [&](const DirentReader::Entry &entry) {
+      path.assign(dir);
+      if (path.empty() || path.back() != '/')
+        path += '/';
+      path.append(entry.name.data(), entry.name.size());
+
+      long long size = 0;
+      std::int64_t mtime_ns = 0;
+      std::uint8_t flags = 0;
+      bool regular = false;
+      if (entry.is_directory) {
+        flags |= FileInfo::Directory;
+      } else if (entry.has_stat) {
+        mtime_ns = entry.mtime_ns;
+        if (S_ISDIR(entry.mode)) {
+          flags |= FileInfo::Directory; // symlink to a directory
+        } else if (S_ISREG(entry.mode)) {
+          regular = true;
+          size = static_cast<long long>(entry.size);
+          if (entry.mode & S_IXUSR) {
+            flags |= FileInfo::Executable;
+          }
+        }
+      }
+
+      const PathArena::Inode inode{entry.device, entry.inode, entry.blocks, entry.links};
+      batch.entries().emplace_back(batch.arena(), path, size, flags,
+                                   regular ? &inode : nullptr);
+      batch.entries().back().setModifiedTime(mtime_ns);
+      if (subdirs && entry.is_directory) {
+        subdirs->push_back(path);
+      }
+      listed.add();
+      return on_entry();
+    });
+  }
+
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+  for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+    const auto &entry = *it;
+    processEntry(entry, batch.entries(), batch.arena());
+
+    std::error_code type_ec;
+    if (subdirs && entry.is_directory(type_ec) && !entry.is_symlink(type_ec)) {
+      subdirs->push_back(entry.path().native());
+    }
+    listed.add();
+    if (!on_entry())
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Scans a directory and delivers the entries in batches
+ *
+ * Progress callbacks are invoked periodically during scanning:
+ * - Every 100 items in recursive mode
+ * - Every 10 items in non-recursive mode
+ * - Once at the end with the final count
+ *
+ * Recursive scans run on a work-stealing thread pool when more than one
+ * thread is configured (see setThreadCount()); the sequential recursive
+ * scan walks depth-first with an explicit stack. Unreadable directories
+ * are skipped in both.
+ *
+ * @param dir_path The directory path to scan (e.g., /home/users/foobar)
+ * @param recursive If true, recursively scan all subdirectories
+ * @param include_parent_dir If true and non-recursive, deliver the parent
+ *                           directory (..) with the first batch
+ * @param on_batch Receives the batches; returning false stops the scan
+ * @param progress Optional callback for progress updates (item count)
+ * @param batch_size Maximum entries per batch, 0 for a single batch
+ *
+ * @return Number of delivered entries
+ */
+std::size_t FileScanner::scanDirectoryStreaming(
+    const std::filesystem::path &dir_path, bool recursive,
+    bool include_parent_dir, const BatchCallback &on_batch,
+    ProgressCallback progress, std::size_t batch_size) {
+  TMF_STATS_TIMER(Scan);
+
+  if (recursive && m_thread_count > 1) {
+    if (progress) {
+      return scanRecursiveParallel(dir_path, on_batch, batch_size,
+                                   CallbackProgress{progress});
+    }
+    return scanRecursiveParallel(dir_path, on_batch, batch_size, NoProgress());
+  }
+
+  Batch batch(on_batch, batch_size);
+  return scanSequential(dir_path, recursive, include_parent_dir, batch, progress);
+}
+
+/**
+ * @brief Maps the runtime options to one of four scanWith() instantiations
+ */
+template <typename Sink>
+std::size_t FileScanner::scanSequential(const std::filesystem::path &dir_path,
+                                        bool recursive, bool include_parent_dir,
+                                        Sink &sink, const ProgressCallback &progress) {
+  if (recursive) {
+    if (progress) {
+      return scanWith<RecursiveWalk>(dir_path, include_parent_dir, sink,
+                                     CallbackProgress{progress});
+    }
+    return scanWith<RecursiveWalk>(dir_path, include_parent_dir, sink, NoProgress());
+  }
+  if (progress) {
+    return scanWith<FlatWalk>(dir_path, include_parent_dir, sink, CallbackProgress{progress});
+  }
+  return scanWith<FlatWalk>(dir_path, include_parent_dir, sink, NoProgress());
+}
+
+/**
+ * @brief Sequential scan: depth-first with an explicit stack
+ *
+ * Only the stop token and the shared progress counter are checked per
+ * entry at runtime; progress reports and descending into subdirectories
+ * exist only in the instantiations that use them.
+ *
+ * @param dir_path The directory path to scan
+ * @param include_parent_dir If true and Walk is flat, add the parent (..)
+ * @param sink Receives the entries
+ * @param progress Progress policy
+ * @return Number of delivered entries
+ */
+template <typename Walk, typename Progress, typename Sink>
+std::size_t FileScanner::scanWith(const std::filesystem::path &dir_path,
+                                  bool include_parent_dir, Sink &sink,
+                                  Progress progress) {
+  std::unique_ptr<DirentReader> reader;
+  if (usesNativeBackend()) {
+    reader = std::make_unique<DirentReader>();
+  }
   int count = 0;
 
   // Add parent directory if requested (non-recursive only)
-  if (include_parent_dir && !recursive) {
-    auto parent_path = dir_path.parent_path();
-    results.emplace_back(parent_path.string(), 0, true, true);
+  if constexpr (!Walk::RECURSIVE) {
+    if (include_parent_dir) {
+      auto parent_path = dir_path.parent_path();
+      sink.entries().emplace_back(sink.arena(), parent_path.native(), 0,
+                                  FileInfo::Directory | FileInfo::Parent);
+    }
   }
 
-  try {
-    if (recursive) {
-      for (const auto &entry :
-           std::filesystem::recursive_directory_iterator(dir_path)) {
-        processEntry(entry, results);
+  auto on_entry = [&]() {
+    if (m_stop.stopRequested()) {
+      return false;
+    }
+    if (m_progress_counter) {
+      m_progress_counter->fetch_add(1, std::memory_order_relaxed);
+    }
+    if constexpr (Progress::ENABLED) {
+      if (++count % Walk::PROGRESS_STEP == 0) {
+        progress.report(count);
+      }
+    }
+    return sink.added();
+  };
+
+  bool more = !m_stop.stopRequested();
+  std::vector<std::string> pending{dir_path.native()};
+  while (more && !pending.empty()) {
+    std::string dir = std::move(pending.back());
+    pending.pop_back();
+    more = listDirectory(dir, sink, reader.get(), Walk::RECURSIVE ? &pending : nullptr,
+                         on_entry);
+  }
+
+  // Final callback
+  progress.report(count);
+
+  if (more) {
+    sink.flush();
+  }
+  return sink.delivered();
+}
+
+namespace {
+
+/**
+ * @brief Directory queue owned by one worker of the parallel scan
+ *
+ * The owner pushes and pops at the back (depth-first, good cache
+ * locality); thieves take from the front, where the oldest and usually
+ * largest subtrees are.
+ */
+struct WorkQueue {
+  std::mutex mutex;
+  std::deque<std::string> dirs;
 
-        // Call progress callback
-        if (progress && ++count % 100 == 0) { // Update every 100 items
-          progress(count);
+  void push(std::string dir) {
+    std::lock_guard<std::mutex> lock(mutex);
+    dirs.push_back(std::move(dir));
+  }
+
+  bool pop(std::string &dir) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (dirs.empty())
+      return false;
+    dir = std::move(dirs.back());
+    dirs.pop_back();
+    return true;
+  }
+
+  bool steal(std::string &dir) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (dirs.empty())
+      return false;
+    dir = std::move(dirs.front());
+    dirs.pop_front();
+    return true;
+  }
+};
+
+} // namespace
+
+/**
+ * @brief Recursive scan on a work-stealing thread pool
+ *
+ * Termination: pending counts directories that were queued but not yet
+ * fully listed. A directory's children are counted before the directory
+ * itself is released, so pending only reaches 0 once the whole tree has
+ * been listed. A consumer returning false sets stopped, which ends all
+ * workers after their current entry.
+ *
+ * Like the sequential scan, symlinks to directories are reported but not
+ * followed.
+ *
+ * @param dir_path Root directory to scan
+ * @param on_batch Receives the batches of all workers, serialized by a mutex
+ * @param batch_size Maximum entries per batch, 0 for one batch per worker
+ * @param progress Progress policy, serialized by a mutex
+ * @return Number of delivered entries
+ */
+template <typename Progress>
+std::size_t FileScanner::scanRecursiveParallel(const std::filesystem::path &dir_path,
+                                               const BatchCallback &on_batch,
+                                               std::size_t batch_size,
+                                               Progress progress) {
+  const unsigned thread_count = m_thread_count;
+  std::vector<WorkQueue> queues(thread_count);
+  std::atomic<std::size_t> pending{1};
+  std::atomic<std::size_t> delivered{0};
+  std::atomic<bool> stopped{false};
+  std::atomic<int> count{0};
+  std::mutex progress_mutex;
+  std::mutex batch_mutex;
+
+  // One writer per arena: every worker fills batches of its own
+  const BatchCallback emit = [&](std::vector<FileInfo> &&entries) {
+    std::lock_guard<std::mutex> lock(batch_mutex);
+    if (stopped.load(std::memory_order_relaxed))
+      return false;
+    delivered.fetch_add(entries.size(), std::memory_order_relaxed);
+    if (!on_batch(std::move(entries))) {
+      stopped.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  };
+
+  queues[0].push(dir_path.native());
+
+  auto worker = [&](unsigned id) {
+    Batch batch(emit, batch_size);
+    std::unique_ptr<DirentReader> reader;
+    if (usesNativeBackend()) {
+      reader = std::make_unique<DirentReader>();
+    }
+    std::vector<std::string> subdirs;
+    std::string dir;
+    unsigned idle_rounds = 0;
+
+    auto on_entry = [&]() {
+      if (m_stop.stopRequested()) {
+        stopped.store(true, std::memory_order_relaxed);
+        return false;
+      }
+
+      // Publish new subdirectories right away so idle workers can steal
+      for (auto &subdir : subdirs) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        queues[id].push(std::move(subdir));
+      }
+      subdirs.clear();
+
+      if (m_progress_counter) {
+        m_progress_counter->fetch_add(1, std::memory_order_relaxed);
+      }
+
+      if constexpr (Progress::ENABLED) {
+        int current = count.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (current % RecursiveWalk::PROGRESS_STEP == 0) {
+          std::lock_guard<std::mutex> lock(progress_mutex);
+          progress.report(current);
         }
       }
-    } else {
-      for (const auto &entry : std::filesystem::directory_iterator(dir_path)) {
-        processEntry(entry, results);
 
-        if (progress && ++count % 10 == 0) { // Update every 10 items
-          progress(count);
+      return batch.added();
+    };
+
+    while (pending.load(std::memory_order_acquire) > 0 &&
+           !stopped.load(std::memory_order_relaxed)) {
+      if (m_stop.stopRequested()) {
+        stopped.store(true, std::memory_order_relaxed);
+        break;
+      }
+      bool found = queues[id].pop(dir);
+      for (unsigned i = 1; !found && i < thread_count; ++i) {
+        found = queues[(id + i) % thread_count].steal(dir);
+      }
+      if (!found) {
+        // Hand out what we have before waiting for more directories
+        if (!batch.entries().empty() && batch_size != 0) {
+          batch.flush();
+        }
+        // Back off while other workers are still producing directories
+        if (++idle_rounds < 64) {
+          std::this_thread::yield();
+        } else {
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        continue;
+      }
+      idle_rounds = 0;
+
+      listDirectory(dir, batch, reader.get(), &subdirs, on_entry);
+      for (auto &subdir : subdirs) { // collected after a stop
+        pending.fetch_add(1, std::memory_order_relaxed);
+        queues[id].push(std::move(subdir));
+      }
+      subdirs.clear();
+
+      pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    batch.flush();
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (unsigned id = 0; id < thread_count; ++id) {
+    threads.emplace_back(worker, id);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Final callback
+  progress.report(count.load());
+
+  return delivered.load();
+}
+
+/**
+ * @brief Processes a single directory entry and adds it to results
+ *
+ * Directories are recognized from the type cached by the directory
+ * iterator (d_type), without a syscall. Everything else, including
+ * symlinks, gets one stat(2) that follows links like the previous
+ * file_size()/status() pair and yields size, execute bit, identity and
+ * allocated blocks at once.
+ *
+ * @param entry The filesystem directory entry to process
+ * @param results Vector to append the FileInfo object to
+ * @param arena String storage shared by the entries of this scan
+ */
+void FileScanner::processEntry(const std::filesystem::directory_entry &entry,
+                               std::vector<FileInfo> &results,
+                               const std::shared_ptr<PathArena> &arena) const {
+  const std::string &path = entry.path().native();
+  long long size = 0;
+  std::int64_t mtime_ns = 0;
+  std::uint8_t flags = 0;
+  struct stat st;
+  bool regular = false;
+
+  std::error_code ec;
+  if (entry.symlink_status(ec).type() == std::filesystem::file_type::directory) {
+    flags |= FileInfo::Directory;
+  } else {
+    if (::stat(path.c_str(), &st) == 0) {
+      mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 +
+                 st.st_mtim.tv_nsec;
+      if (S_ISDIR(st.st_mode)) {
+        flags |= FileInfo::Directory;
+      } else if (S_ISREG(st.st_mode)) {
+        regular = true;
+        size = static_cast<long long>(st.st_size);
+        if (st.st_mode & S_IXUSR) {
+          flags |= FileInfo::Executable;
         }
       }
     }
+  }
 
-    // Final callback
-    if (progress) {
-      progress(count);
+  PathArena::Inode inode;
+  if (regular) {
+    inode = {st.st_dev, st.st_ino, static_cast<std::uint64_t>(st.st_blocks),
+             static_cast<std::uint32_t>(st.st_nlink)};
+  }
+  results.emplace_back(arena, path, size, flags, regular ? &inode : nullptr);
+  results.back().setModifiedTime(mtime_ns);
+}
+
+namespace {
+
+/** @brief Precomputed sort key of one entry */
+struct SortKey {
+  std::uint64_t key;   ///< Name prefix, size or time (see primaryKey())
+  std::uint32_t index; ///< Entry the key belongs to
+};
+
+/** @brief Category of an entry: parent (0), directory (1), file (2) */
+int tierOf(const FileInfo &info, bool include_parent) {
+  if (include_parent && info.isParentDir())
+    return 0;
+  return info.isDirectory() ? 1 : 2;
+}
+
+/**
+ * @brief First eight name bytes, big-endian and zero padded
+ *
+ * Compares like the names themselves wherever the prefixes differ (file
+ * names contain no NUL byte).
+ */
+std::uint64_t namePrefix(std::string_view name) {
+  std::uint64_t key = 0;
+  for (std::size_t i = 0; i < 8; ++i) {
+    key <<= 8;
+    if (i < name.size())
+      key |= static_cast<unsigned char>(name[i]);
+  }
+  return key;
+}
+
+/** @brief Key sorting ascending in the requested order (0 for Natural) */
+std::uint64_t primaryKey(const FileInfo &info, FileScanner::SortOrder order) {
+  switch (order) {
+  case FileScanner::SortOrder::Name:
+    return namePrefix(info.getName());
+  case FileScanner::SortOrder::Size:
+    return ~static_cast<std::uint64_t>(info.getFileSize());
+  case FileScanner::SortOrder::Modified:
+    // Sign bit flipped: signed order as unsigned, then newest first
+    return ~(static_cast<std::uint64_t>(info.getModifiedTime()) ^ (1ULL << 63));
+  case FileScanner::SortOrder::Natural:
+    break;
+  }
+  return 0;
+}
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+/**
+ * @brief Version order: digit runs compare by value, the rest byte-wise
+ *
+ * Names that differ only in leading zeros fall back to byte order, so the
+ * order stays strict.
+ */
+bool naturalLess(std::string_view a, std::string_view b) {
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < a.size() && j < b.size()) {
+    if (isDigit(a[i]) && isDigit(b[j])) {
+      while (i < a.size() && a[i] == '0')
+        ++i;
+      while (j < b.size() && b[j] == '0')
+        ++j;
+      std::size_t end_a = i;
+      std::size_t end_b = j;
+      while (end_a < a.size() && isDigit(a[end_a]))
+        ++end_a;
+      while (end_b < b.size() && isDigit(b[end_b]))
+        ++end_b;
+
+      // More significant digits: larger number
+      if (end_a - i != end_b - j)
+        return end_a - i < end_b - j;
+      const int cmp = a.substr(i, end_a - i).compare(b.substr(j, end_b - j));
+      if (cmp != 0)
+        return cmp < 0;
+      i = end_a;
+      j = end_b;
+      continue;
     }
+    if (a[i] != b[j])
+      return static_cast<unsigned char>(a[i]) < static_cast<unsigned char>(b[j]);
+    ++i;
+    ++j;
+  }
+  if (a.size() - i != b.size() - j)
+    return a.size() - i < b.size() - j;
+  return a < b;
+}
+
+/** @brief Order of two entries of the same tier with precomputed keys */
+bool keyLess(const SortKey &a, const SortKey &b, const std::vector<FileInfo> &entries,
+             FileScanner::SortOrder order) {
+  const std::string_view name_a = entries[a.index].getName();
+  const std::string_view name_b = entries[b.index].getName();
+  if (order == FileScanner::SortOrder::Natural)
+    return naturalLess(name_a, name_b);
+  if (a.key != b.key)
+    return a.key < b.key;
+  return name_a < name_b;
+}
+
+/**
+ * @brief Sorts [begin, end) on up to threads threads
+ *
+ * Sorts equal chunks concurrently, then merges neighbours pairwise (also
+ * concurrently) until one run is left.
+ */
+template <typename Less>
+void parallelSort(std::vector<SortKey>::iterator begin, std::vector<SortKey>::iterator end,
+                  unsigned threads, const Less &less) {
+  const std::size_t count = static_cast<std::size_t>(end - begin);
+  const std::size_t chunk = (count + threads - 1) / threads;
 
-  } catch (...) {
-    // Unexpected error
+  std::vector<std::thread> workers;
+  for (std::size_t start = 0; start < count; start += chunk) {
+    workers.emplace_back([=, &less]() {
+      std::sort(begin + start, begin + std::min(count, start + chunk), less);
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
   }
 
-  // Sorting order: ".." first, then folders, then files (alphabetical)
-  sortEntries(results, include_parent_dir);
+  for (std::size_t width = chunk; width < count; width *= 2) {
+    workers.clear();
+    for (std::size_t start = 0; start + width < count; start += 2 * width) {
+      workers.emplace_back([=, &less]() {
+        std::inplace_merge(begin + start, begin + start + width,
+                           begin + std::min(count, start + 2 * width), less);
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+}
 
-  return results;
+/**
+ * @brief LSD radix sort by key, one byte per pass
+ *
+ * Passes in which all keys share the byte are skipped, so e.g. sizes
+ * below 64 KiB cost two passes.
+ */
+void radixSort(std::vector<SortKey>::iterator begin, std::vector<SortKey>::iterator end) {
+  const std::size_t count = static_cast<std::size_t>(end - begin);
+  std::vector<SortKey> buffer(count);
+  SortKey *from = &*begin;
+  SortKey *to = buffer.data();
+
+  for (unsigned shift = 0; shift < 64; shift += 8) {
+    std::size_t offsets[256] = {};
+    for (std::size_t i = 0; i < count; ++i) {
+      ++offsets[(from[i].key >> shift) & 0xFF];
+    }
+    if (offsets[(from[0].key >> shift) & 0xFF] == count)
+      continue;
+
+    std::size_t sum = 0;
+    for (std::size_t &offset : offsets) {
+      const std::size_t bucket = offset;
+      offset = sum;
+      sum += bucket;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      to[offsets[(from[i].key >> shift) & 0xFF]++] = from[i];
+    }
+    std::swap(from, to);
+  }
+  if (from != &*begin) {
+    std::copy(from, from + count, begin);
+  }
+}
+
+/**
+ * @brief Sorts the keys of one tier
+ *
+ * Large ranges with a usable key: radix sort, then only runs of equal keys
+ * are ordered by name (spread over the threads when large). Otherwise a
+ * comparison sort, parallel when large.
+ */
+void sortTier(std::vector<SortKey>::iterator begin, std::vector<SortKey>::iterator end,
+              const std::vector<FileInfo> &entries, FileScanner::SortOrder order) {
+  const std::size_t count = static_cast<std::size_t>(end - begin);
+  const unsigned threads = count >= FileScanner::PARALLEL_SORT_THRESHOLD
+                               ? std::max(1u, std::thread::hardware_concurrency())
+                               : 1;
+  auto less = [&entries, order](const SortKey &a, const SortKey &b) {
+    return keyLess(a, b, entries, order);
+  };
+
+  if (order == FileScanner::SortOrder::Natural ||
+      count < FileScanner::RADIX_SORT_THRESHOLD) {
+    if (threads > 1) {
+      parallelSort(begin, end, threads, less);
+    } else {
+      std::sort(begin, end, less);
+    }
+    return;
+  }
+
+  radixSort(begin, end);
+
+  std::vector<std::pair<std::size_t, std::size_t>> runs;
+  for (std::size_t first = 0; first < count;) {
+    std::size_t last = first + 1;
+    while (last < count && begin[last].key == begin[first].key)
+      ++last;
+    if (last - first > 1)
+      runs.emplace_back(first, last);
+    first = last;
+  }
+
+  auto sortRuns = [&](std::atomic<std::size_t> &next) {
+    for (std::size_t run = next++; run < runs.size(); run = next++) {
+      std::sort(begin + runs[run].first, begin + runs[run].second, less);
+    }
+  };
+  std::atomic<std::size_t> next{0};
+  if (threads > 1 && runs.size() > 1) {
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back(sortRuns, std::ref(next));
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  } else if (threads > 1 && runs.size() == 1) {
+    parallelSort(begin + runs[0].first, begin + runs[0].second, threads, less);
+  } else {
+    sortRuns(next);
+  }
 }
 
+} // namespace
+
 /**
  * @brief Sorts directory entries in a specific hierarchical order
  *
  * Implements a three-tier sorting strategy for file system entries:
  * 1. Parent directory (..) appears first (if include_parent_dir is true)
  * 2. Directories appear before regular files
- * 3. Within each category, entries are sorted alphabetically by display name
+ * 3. Within each category, entries are sorted by order (alphabetically by
+ *    name by default)
  *
  * This sorting order provides an intuitive directory listing where navigation
  * entries appear first, followed by subdirectories, and finally files.
  *
+ * The entries are sorted through sortIndices() and moved into place once.
+ *
  * @param results Vector of FileInfo objects to sort in-place
  * @param include_parent_dir If true, ensures parent directory (..) is sorted
  *                           to the first position
+ * @param order Order within each category
  *
  * @see FileInfo::isParentDir()
  * @see FileInfo::isDirectory()
- * @see FileInfo::getDisplayName()
- *
- * @note The sort is performed in-place using std::sort with a custom
- * comparator
- * @note The comparator uses lexicographical comparison for alphabetical
- * ordering
- *
- * Sorting logic:
- * - Parent directory check: a.isParentDir() returns true → a comes first
- * - Directory vs file: a.isDirectory() != b.isDirectory() → directory comes
- * first
- * - Same type: a.getDisplayName() < b.getDisplayName() → alphabetical order
- */
-void FileScanner::sortEntries(std::vector<FileInfo> &results,
-                              bool include_parent_dir) {
-  std::sort(results.begin(), results.end(),
-            [include_parent_dir](const FileInfo &a, const FileInfo &b) {
-              // Parent (..) always first
-              if (include_parent_dir) {
-                if (a.isParentDir())
-                  return true;
-                if (b.isParentDir())
-                  return false;
-              }
-
-              // Directories before files
-              if (a.isDirectory() != b.isDirectory()) {
-                return a.isDirectory();
-              }
-
-              // Alphabetical by name
-              return a.getDisplayName() < b.getDisplayName();
-            });
+ * @see FileInfo::getName()
+ */
+void FileScanner::sortEntries(std::vector<FileInfo> &results, bool include_parent_dir,
+                              SortOrder order) {
+  std::vector<std::uint32_t> indices(results.size());
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    indices[i] = static_cast<std::uint32_t>(i);
+  }
+  sortIndices(results, indices, include_parent_dir, order);
+
+  std::vector<FileInfo> sorted;
+  sorted.reserve(results.size());
+  for (std::uint32_t index : indices) {
+    sorted.push_back(std::move(results[index]));
+  }
+  results.swap(sorted);
+}
+
+/**
+ * @brief Sorts indices by tier, then by precomputed key
+ *
+ * Implementation details:
+ * 1. Buckets the indices by tier (counting sort, stable)
+ * 2. Computes the sort key of every entry once: the first eight name bytes
+ *    for Name, the size for Size, the time for Modified
+ * 3. Sorts every tier with sortTier(); comparisons read names as views
+ *    into the path arena, so no string is allocated
+ */
+void FileScanner::sortIndices(const std::vector<FileInfo> &entries,
+                              std::vector<std::uint32_t> &indices, bool include_parent_dir,
+                              SortOrder order) {
+  TMF_STATS_TIMER(Sort);
+  std::size_t starts[4] = {};
+  for (std::uint32_t index : indices) {
+    ++starts[tierOf(entries[index], include_parent_dir) + 1];
+  }
+  starts[2] += starts[1];
+  starts[3] += starts[2];
+
+  std::vector<SortKey> keys(indices.size());
+  std::size_t fill[3] = {starts[0], starts[1], starts[2]};
+  for (std::uint32_t index : indices) {
+    const FileInfo &info = entries[index];
+    keys[fill[tierOf(info, include_parent_dir)]++] = {primaryKey(info, order), index};
+  }
+
+  for (int tier = 0; tier < 3; ++tier) {
+    if (starts[tier + 1] - starts[tier] > 1) {
+      sortTier(keys.begin() + starts[tier], keys.begin() + starts[tier + 1], entries, order);
+    }
+  }
+
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    indices[i] = keys[i].index;
+  }
+}
+
+bool FileScanner::entryLess(const FileInfo &a, const FileInfo &b,
+                            bool include_parent_dir, SortOrder order) {
+  // Parent (..) first, directories before files
+  const int tier_a = tierOf(a, include_parent_dir);
+  const int tier_b = tierOf(b, include_parent_dir);
+  if (tier_a != tier_b)
+    return tier_a < tier_b;
+
+  if (order == SortOrder::Natural)
+    return naturalLess(a.getName(), b.getName());
+  const std::uint64_t key_a = primaryKey(a, order);
+  const std::uint64_t key_b = primaryKey(b, order);
+  if (key_a != key_b)
+    return key_a < key_b;
+  return a.getName() < b.getName();
+}
+
+bool FileScanner::parseSortOrder(const std::string &name, SortOrder &order) {
+  if (name == "name") {
+    order = SortOrder::Name;
+  } else if (name == "size") {
+    order = SortOrder::Size;
+  } else if (name == "mtime") {
+    order = SortOrder::Modified;
+  } else if (name == "natural") {
+    order = SortOrder::Natural;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char *FileScanner::sortOrderName(SortOrder order) {
+  switch (order) {
+  case SortOrder::Size:
+    return "size";
+  case SortOrder::Modified:
+    return "mtime";
+  case SortOrder::Natural:
+    return "natural";
+  case SortOrder::Name:
+    break;
+  }
+  return "name";
+}
+
+/**
+ * @brief Stats a single path into results
+ *
+ * Uses the portable classification of processEntry(), so the entry looks
+ * exactly like one produced by a scan of its directory.
+ */
+bool FileScanner::scanEntry(const std::string &path, std::vector<FileInfo> &results,
+                            const std::shared_ptr<PathArena> &arena) const {
+  std::error_code ec;
+  std::filesystem::directory_entry entry(path, ec);
+  if (ec || !entry.exists(ec)) {
+    // exists() follows links; a dangling symlink is still an entry
+    if (!entry.is_symlink(ec))
+      return false;
+  }
+  processEntry(entry, results, arena);
+  return true;
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
  * @brief Directory scanning and file information collection
  *
  * This header defines the FileScanner class which provides functionality for
- * traversing directories, collecting file information, and calculating file hashes.
+ * traversing directories and collecting file metadata.
  */
 
 #ifndef FILESCANNER_HPP
@@ -12,37 +12,94 @@
 #include <filesystem>
 #include <vector>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <string>
+#include <thread>
 
+#include "direntreader.hpp"
 #include "fileinfo.hpp"
-#include "ihashcalculator.hpp"
+#include "stoptoken.hpp"
 
 /**
  * @class FileScanner
- * @brief Scans directories and collects file information with hash calculation
+ * @brief Scans directories and collects file metadata
  *
  * FileScanner traverses filesystem directories (recursively or non-recursively)
- * and builds a collection of FileInfo objects. It integrates hash calculation
- * for regular files using an injected IHashCalculator implementation.
+ * and builds a collection of FileInfo objects. The scan never reads file
+ * content; hashes are computed later, and only for duplicate candidates, by
+ * DuplicateFinder::findDuplicates(files, hasher).
  *
  * Key features:
  * - Recursive and non-recursive directory scanning
- * - Automatic file hash calculation for non-empty regular files
+ * - Metadata only (path, size, type), no file content I/O
+ * - Linux fast path: getdents64 + statx, no stat for directories
+ *   (setBackend(), DirentReader)
+ * - Parallel work-stealing traversal for recursive scans (setThreadCount())
  * - Progress reporting via callbacks or atomic counters
+ * - One compiled scan loop per option combination (scanpolicies.hpp):
+ *   recursion and progress reports cost nothing per entry when unused
+ * - Cooperative cancellation per entry (setStopToken())
+ * - Streaming delivery in batches (scanDirectoryStreaming())
  * - Sorted output with directories before files
  * - Parent directory (..) inclusion support
  *
  * @see FileInfo
- * @see IHashCalculator
+ * @see DuplicateFinder
  */
 class FileScanner {
 private:
-  /** @brief Hash calculator used for computing file hashes */
-  const IHashCalculator &hashCalculator;
-
   /** @brief Optional atomic counter for thread-safe progress tracking */
   std::atomic<int> *m_progress_counter = nullptr;
 
+  /** @brief Worker threads used for recursive scans (1 = sequential) */
+  unsigned m_thread_count = 1;
+
+  /** @brief Checked after every entry; a stopped scan returns early */
+  StopToken m_stop;
+
+public:
+  /**
+   * @brief Directory listing implementation
+   */
+  enum class Backend {
+    /** @brief getdents64/statx (DirentReader) where supported, else Portable */
+    Native,
+
+    /** @brief std::filesystem::directory_iterator plus one stat per entry */
+    Portable
+  };
+
+  /**
+   * @brief Order of the entries within the parent/directory/file tiers
+   */
+  enum class SortOrder {
+    /** @brief Byte-wise by name */
+    Name,
+
+    /** @brief Largest first, then by name */
+    Size,
+
+    /** @brief Newest first, then by name (unknown times sort last) */
+    Modified,
+
+    /** @brief By name with digit runs compared as numbers ("v2" < "v10") */
+    Natural
+  };
+
+  /** @brief Entries from which sortEntries() uses a radix sort on sort keys */
+  static constexpr std::size_t RADIX_SORT_THRESHOLD = 1024;
+
+  /** @brief Entries from which sortEntries() sorts on several threads */
+  static constexpr std::size_t PARALLEL_SORT_THRESHOLD = 65536;
+
+private:
+  /** @brief Configured listing backend */
+  Backend m_backend = Backend::Native;
+
 public:
   /**
    * @brief Sets an atomic progress counter for thread-safe progress tracking
@@ -54,41 +111,117 @@ public:
    *
    * @note This is separate from the ProgressCallback mechanism
    * @note The counter is not reset by this class; caller manages initialization
+   * @note Incremented with relaxed atomic adds, also from worker threads
    */
   void setProgressCounter(std::atomic<int> *counter) {
     m_progress_counter = counter;
   }
 
+  /**
+   * @brief Sets a token that stops running and later scans
+   *
+   * The scan checks the token after every entry (all workers of a
+   * parallel scan), so a stop takes effect within one stat call. A
+   * stopped scan delivers no further batch; scanDirectory() then returns
+   * an empty result.
+   *
+   * @param stop Token of the requester's StopSource
+   */
+  void setStopToken(StopToken stop) { m_stop = std::move(stop); }
+
+  /**
+   * @brief Sets the number of worker threads for recursive scans
+   *
+   * With more than one thread, recursive scans use a work-stealing pool:
+   * every worker lists one directory at a time and pushes the
+   * subdirectories it finds onto its own queue, idle workers steal from
+   * the others. Non-recursive scans always run on the calling thread.
+   *
+   * @param count Number of threads; 0 selects std::thread::hardware_concurrency()
+   */
+  void setThreadCount(unsigned count) {
+    if (count == 0)
+      count = std::thread::hardware_concurrency();
+    m_thread_count = count > 0 ? count : 1;
+  }
+
+  /**
+   * @brief Gets the configured number of worker threads
+   * @return Thread count used for recursive scans (at least 1)
+   */
+  unsigned getThreadCount() const { return m_thread_count; }
+
+  /**
+   * @brief Selects the directory listing backend
+   *
+   * Both backends produce the same entries. Native saves the stat(2) of
+   * every directory and resolves names relative to the directory
+   * descriptor; it silently falls back to Portable on platforms without
+   * DirentReader support.
+   *
+   * @param backend Backend to use (default: Native)
+   */
+  void setBackend(Backend backend) { m_backend = backend; }
+
+  /**
+   * @brief Gets the configured backend
+   * @return Backend passed to setBackend()
+   */
+  Backend getBackend() const { return m_backend; }
+
+  /**
+   * @brief Checks whether scans actually use DirentReader
+   * @return True if Native is configured and supported on this platform
+   */
+  bool usesNativeBackend() const {
+    return m_backend == Backend::Native && DirentReader::isSupported();
+  }
+
   /**
    * @brief Callback function type for progress notifications
    *
    * Function signature: void(int count)
    * - count: Number of items processed so far
    *
+   * In parallel scans the callback is invoked from worker threads, but
+   * never concurrently.
+   *
    * @see scanDirectory()
    */
   using ProgressCallback = std::function<void(int count)>;
 
   /**
-   * @brief Constructs a FileScanner with the specified hash calculator
+   * @brief Callback receiving a batch of scanned entries
    *
-   * Initializes the scanner with a hash calculator implementation that will
-   * be used to compute file hashes during directory traversal.
+   * Every batch has a PathArena of its own, so its entries may be read
+   * (e.g. by a UI thread) while the scan goes on. Batches are unsorted;
+   * see sortEntries().
    *
-   * @param calculator Reference to hash calculator implementation (e.g., FNV1A)
+   * In parallel scans the callback is invoked from worker threads, but
+   * never concurrently.
    *
-   * @note The calculator reference must remain valid for the lifetime of the
-   *       FileScanner object
-   * @see IHashCalculator
+   * @return false to stop the scan
+   *
+   * @see scanDirectoryStreaming()
    */
-  FileScanner(const IHashCalculator &calculator) : hashCalculator(calculator) {}
+  using BatchCallback = std::function<bool(std::vector<FileInfo> &&batch)>;
+
+  /** @brief Default maximum number of entries per streamed batch */
+  static constexpr std::size_t DEFAULT_BATCH_SIZE = 512;
+
+  /**
+   * @brief Maximum age of a non-empty batch before it is delivered
+   *
+   * Bounds the time to the first entries on slow (e.g. network) file
+   * systems, where filling a whole batch can take seconds.
+   */
+  static constexpr std::chrono::milliseconds BATCH_INTERVAL{16};
 
   /**
    * @brief Scans a directory and returns file information
    *
    * Traverses the specified directory path and collects FileInfo objects for
-   * all discovered files and subdirectories. Calculates hashes for non-empty
-   * regular files using the configured hash calculator.
+   * all discovered files and subdirectories. Only metadata is collected.
    *
    * @param dir_path The filesystem path to scan
    * @param recursive If true, recursively scan all subdirectories
@@ -110,55 +243,37 @@ public:
       bool include_parent,
       ProgressCallback progress = nullptr);  // callback
 
-private:
   /**
-   * @brief Processes a single directory entry and adds it to results
+   * @brief Scans a directory and delivers the entries in batches
    *
-   * Extracts file information from a directory entry, calculates file size,
-   * computes hash for non-empty regular files, and appends the FileInfo
-   * object to the results vector.
+   * Same traversal as scanDirectory(), but entries are handed to on_batch
+   * as soon as batch_size of them are collected or the oldest one waited
+   * BATCH_INTERVAL, so callers can show the first entries while the scan
+   * is still running. The parent directory (..), if requested, is part of
+   * the first batch. Entries are not sorted.
    *
-   * Processing steps:
-   * 1. Determine if entry is a directory
-   * 2. Get file size for regular files (with error handling)
-   * 3. Create FileInfo object with path, size, and directory flag
-   * 4. Calculate and set hash for non-empty regular files
-   * 5. Add to results vector
+   * @param dir_path The filesystem path to scan
+   * @param recursive If true, recursively scan all subdirectories
+   * @param include_parent If true (and non-recursive), include parent directory (..)
+   * @param on_batch Receives the batches; returning false stops the scan
+   * @param progress Optional callback for progress updates (default: nullptr)
+   * @param batch_size Maximum entries per batch; 0 delivers a single batch
+   *                   at the end
    *
-   * @param entry The filesystem directory entry to process
-   * @param results Vector to append the FileInfo object to
+   * @return Number of entries delivered (including the parent directory)
    *
-   * @note Inline implementation for performance
-   * @note File size errors are silently ignored (size defaults to 0)
-   * @note Hash calculation is skipped for directories and empty files
-   * @note Uses the injected hashCalculator for hash computation
+   * @see BatchCallback
+   * @see sortEntries()
    *
-   * @see FileInfo
-   * @see IHashCalculator::calculateHash()
+   * @note Implementation is in filescanner.cpp
    */
-  void processEntry(const std::filesystem::directory_entry &entry,
-                    std::vector<FileInfo> &results) const {
-    long long size = 0;
-    bool isDir = entry.is_directory();
-
-    if (!isDir) {
-      try {
-        size = entry.file_size();
-      } catch (...) {
-        // Ignore errors
-      }
-    }
-
-    FileInfo info(entry.path().string(), size, isDir);
-
-    // Hash only for non-empty regular files
-    if (!isDir && size > 0) {
-      std::string hash = hashCalculator.calculateHash(info.getPath());
-      info.setHash(hash);
-    }
-
-    results.push_back(info);
-  }
+  std::size_t scanDirectoryStreaming(
+      const std::filesystem::path &dir_path,
+      bool recursive,
+      bool include_parent,
+      const BatchCallback &on_batch,
+      ProgressCallback progress = nullptr,
+      std::size_t batch_size = DEFAULT_BATCH_SIZE);
 
   /**
    * @brief Sorts directory entries in hierarchical order
@@ -166,18 +281,193 @@ private:
    * Sorts FileInfo objects with the following priority:
    * 1. Parent directory (..) first (if include_parent is true)
    * 2. Directories before files
-   * 3. Alphabetical by display name within each category
+   * 3. By order within each category (alphabetical by name by default)
+   *
+   * scanDirectory() applies it to its result; callers of
+   * scanDirectoryStreaming() apply it once all batches are in.
+   *
+   * A sort key (name prefix, size or time) is computed once per entry and
+   * no string is built while sorting. From RADIX_SORT_THRESHOLD entries the
+   * keys are radix sorted and only entries with equal keys are compared;
+   * from PARALLEL_SORT_THRESHOLD entries the work is split across the
+   * hardware threads.
    *
    * @param results Vector of FileInfo objects to sort in-place
    * @param include_parent If true, ensures parent directory is sorted first
+   * @param order Order within each category
    *
    * @see FileInfo::isParentDir()
    * @see FileInfo::isDirectory()
-   * @see FileInfo::getDisplayName()
+   * @see entryLess()
    *
    * @note Implementation is in filescanner.cpp
    */
-  void sortEntries(std::vector<FileInfo> &results, bool include_parent);
+  static void sortEntries(std::vector<FileInfo> &results, bool include_parent,
+                          SortOrder order = SortOrder::Name);
+
+  /**
+   * @brief Sorts indices into entries instead of the entries themselves
+   *
+   * Same order and cost as sortEntries(); for containers that keep their
+   * entries in place (e.g. FileIndex).
+   *
+   * @param entries Entries the indices refer to
+   * @param indices Indices to sort (each must be < entries.size())
+   * @param include_parent If true, the parent directory (..) sorts first
+   * @param order Order within each category
+   */
+  static void sortIndices(const std::vector<FileInfo> &entries,
+                          std::vector<std::uint32_t> &indices, bool include_parent,
+                          SortOrder order = SortOrder::Name);
+
+  /**
+   * @brief Order used by sortEntries()
+   *
+   * For keeping a sorted listing sorted, e.g. with std::lower_bound().
+   *
+   * @param a Left entry
+   * @param b Right entry
+   * @param include_parent If true, the parent directory (..) sorts first
+   * @param order Order within each category
+   * @return true if a sorts before b
+   */
+  static bool entryLess(const FileInfo &a, const FileInfo &b, bool include_parent,
+                        SortOrder order = SortOrder::Name);
+
+  /**
+   * @brief Parses a sort order name as used on the command line
+   *
+   * Accepted names are "name", "size", "mtime" and "natural".
+   *
+   * @param name Name to parse
+   * @param order Receives the order on success
+   * @return true if the name is known, false otherwise
+   */
+  static bool parseSortOrder(const std::string &name, SortOrder &order);
+
+  /** @brief Command line name of a sort order (inverse of parseSortOrder()) */
+  static const char *sortOrderName(SortOrder order);
+
+  /**
+   * @brief Adds the entry for a single path, classified like a scan would
+   *
+   * @param path Entry to stat
+   * @param results Vector to append the FileInfo object to
+   * @param arena String storage for the new entry
+   *
+   * @return false (and nothing appended) if path does not exist
+   *
+   * @see ListingPatch
+   * @note Implementation is in filescanner.cpp
+   */
+  bool scanEntry(const std::string &path, std::vector<FileInfo> &results,
+                 const std::shared_ptr<PathArena> &arena) const;
+
+private:
+  /** @brief Entries of one thread, handed out in batches (filescanner.cpp) */
+  class Batch;
+
+  /**
+   * @brief Sequential scan with the policies chosen at runtime
+   *
+   * Picks the scanWith() instantiation for recursive and progress, so the
+   * per-entry loop has no branch on either.
+   *
+   * @param dir_path Directory to scan
+   * @param recursive If true, scan all subdirectories
+   * @param include_parent If true (and non-recursive), add the parent (..)
+   * @param sink Receives the entries (a Batch or a CollectSink)
+   * @param progress Optional progress callback
+   *
+   * @return Number of entries delivered
+   *
+   * @see scanpolicies.hpp
+   * @note Implementation is in filescanner.cpp
+   */
+  template <typename Sink>
+  std::size_t scanSequential(const std::filesystem::path &dir_path, bool recursive,
+                             bool include_parent, Sink &sink,
+                             const ProgressCallback &progress);
+
+  /**
+   * @brief Sequential scan core, one instantiation per policy combination
+   *
+   * @tparam Walk FlatWalk or RecursiveWalk
+   * @tparam Progress NoProgress or CallbackProgress
+   * @tparam Sink Batch or CollectSink
+   *
+   * @note Implementation is in filescanner.cpp
+   */
+  template <typename Walk, typename Progress, typename Sink>
+  std::size_t scanWith(const std::filesystem::path &dir_path, bool include_parent,
+                       Sink &sink, Progress progress);
+
+  /**
+   * @brief Lists one directory into a sink with the configured backend
+   *
+   * @param dir Directory to list
+   * @param sink Receives the entries
+   * @param reader Reader of the calling thread (Native backend), or nullptr
+   * @param subdirs If not nullptr, receives real subdirectories (symlinks
+   *                to directories are reported but not collected)
+   * @param on_entry Called after each added entry (inlined, no
+   *                 std::function); returning false stops
+   *
+   * @return false if on_entry stopped the listing; unreadable directories
+   *         list as empty
+   *
+   * @note Implementation is in filescanner.cpp
+   */
+  template <typename Sink, typename OnEntry>
+  bool listDirectory(const std::string &dir, Sink &sink, DirentReader *reader,
+                     std::vector<std::string> *subdirs, OnEntry &&on_entry) const;
+
+  /**
+   * @brief Recursive scan on m_thread_count work-stealing threads
+   *
+   * Each worker collects into its own batch and delivers it through
+   * on_batch (serialized) when full. Unreadable subdirectories are
+   * skipped instead of aborting the scan.
+   *
+   * @param dir_path Root directory (not included in the results)
+   * @param on_batch Receives the batches; returning false stops all workers
+   * @param batch_size Maximum entries per batch, 0 for one batch per worker
+   * @param progress Progress policy (reports every 100 items)
+   *
+   * @return Number of entries delivered
+   *
+   * @note Implementation is in filescanner.cpp
+   */
+  template <typename Progress>
+  std::size_t scanRecursiveParallel(const std::filesystem::path &dir_path,
+                                    const BatchCallback &on_batch,
+                                    std::size_t batch_size, Progress progress);
+
+  /**
+   * @brief Processes a single directory entry and adds it to results
+   *
+   * Extracts file information from a directory entry, determines the file
+   * size and appends the FileInfo object to the results vector.
+   *
+   * Processing steps:
+   * 1. Determine if entry is a directory (from the cached entry type)
+   * 2. For everything else, one stat(2) yields size and permission bits
+   * 3. Create FileInfo object in the scan's PathArena
+   * 4. Add to results vector
+   *
+   * @param entry The filesystem directory entry to process
+   * @param results Vector to append the FileInfo object to
+   * @param arena String storage shared by the entries of this scan
+   *
+   * @note File size errors are silently ignored (size defaults to 0)
+   * @note No file content is read here
+   * @note Implementation is in filescanner.cpp
+   *
+   * @see FileInfo
+   */
+  void processEntry(const std::filesystem::directory_entry &entry,
+                    std::vector<FileInfo> &results,
+                    const std::shared_ptr<PathArena> &arena) const;
 };
 
 #endif // FILESCANNER_HPP
\ No newline at end of file
@@ -0,0 +1,481 @@
+/**
+ * @file hashcache.cpp
+ * @brief Implementation of the persistent hash cache
+ */
+
+#include "hashcache.hpp"
+#include "fnv1a.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+constexpr char MAGIC[8] = {'T', 'F', 'M', 'H', 'A', 'S', 'H', '1'};
+
+/** @brief Pending records are written in one batch of this many */
+constexpr std::size_t WRITE_BATCH = 256;
+
+/**
+ * @brief Files modified this recently are not cached
+ *
+ * A second write within the same mtime tick would leave size and mtime
+ * unchanged, so a digest taken now could silently go stale.
+ */
+constexpr std::int64_t RACY_WINDOW_NS = 2'000'000'000;
+
+struct Header {
+  char magic[8];
+  std::uint32_t record_size;
+  std::uint32_t reserved;
+};
+
+} // namespace
+
+struct HashCache::Record {
+  std::uint64_t device;
+  std::uint64_t inode;
+  std::int64_t size;
+  std::int64_t mtime_ns;
+  std::uint64_t algorithm;
+  std::uint32_t sample_size;
+  std::uint8_t digest_length;
+  std::uint8_t reserved[3];
+  std::uint8_t digest[HashDigest::MAX_SIZE];
+  std::uint64_t checksum;
+};
+
+namespace {
+
+using Record = HashCache::Record;
+
+static_assert(sizeof(Header) == 16, "unexpected header padding");
+static_assert(sizeof(Record) == 72, "unexpected record padding");
+
+std::uint64_t recordChecksum(const Record &record) {
+  Fnv1aEngine fnv;
+  fnv.update(reinterpret_cast<const std::uint8_t *>(&record), offsetof(Record, checksum));
+  return fnv.hash;
+}
+
+/** @brief Holds a flock(2) on a descriptor while in scope */
+struct FileLock {
+  int fd;
+  bool locked;
+
+  FileLock(int fd, int operation) : fd(fd) {
+    int rc;
+    do {
+      rc = ::flock(fd, operation);
+    } while (rc != 0 && errno == EINTR);
+    locked = rc == 0;
+  }
+
+  ~FileLock() {
+    if (locked)
+      ::flock(fd, LOCK_UN);
+  }
+};
+
+bool writeFull(int fd, const void *data, std::size_t size, off_t offset) {
+  const auto *bytes = static_cast<const std::uint8_t *>(data);
+  std::size_t done = 0;
+  while (done < size) {
+    ssize_t n = ::pwrite(fd, bytes + done, size - done, offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    done += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+std::int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+// ============================================================================
+// FileStamp
+// ============================================================================
+
+bool FileStamp::fromPath(const std::string &path, FileStamp &stamp) {
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+    return false;
+
+  stamp.device = static_cast<std::uint64_t>(st.st_dev);
+  stamp.inode = static_cast<std::uint64_t>(st.st_ino);
+  stamp.size = static_cast<std::int64_t>(st.st_size);
+  stamp.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 +
+                   st.st_mtim.tv_nsec;
+  return true;
+}
+
+// ============================================================================
+// HashCache
+// ============================================================================
+
+std::size_t HashCache::KeyHasher::operator()(const Key &key) const {
+  std::uint64_t h = key.inode * 0x9E3779B97F4A7C15ull;
+  h ^= key.device + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+  h ^= key.algorithm + (h << 6) + (h >> 2);
+  h ^= key.sample_size + (h << 6) + (h >> 2);
+  return static_cast<std::size_t>(h);
+}
+
+HashCache::HashCache(const std::string &path) : m_path(path) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (openFile())
+    compact();
+}
+
+HashCache::~HashCache() {
+  flush();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  closeFile();
+}
+
+std::string HashCache::defaultPath() {
+  const char *xdg = std::getenv("XDG_CACHE_HOME");
+  if (xdg && xdg[0] == '/')
+    return std::string(xdg) + "/tfm/" + FILE_NAME;
+
+  const char *home = std::getenv("HOME");
+  if (home && home[0] != '\0')
+    return std::string(home) + "/.cache/tfm/" + FILE_NAME;
+
+  return "";
+}
+
+std::shared_ptr<HashCache> HashCache::openDefault() {
+  const std::string path = defaultPath();
+  if (path.empty())
+    return nullptr;
+
+  auto cache = std::make_shared<HashCache>(path);
+  if (!cache->isOpen())
+    return nullptr;
+  return cache;
+}
+
+std::uint64_t HashCache::packName(const char *algorithm) {
+  std::uint64_t packed = 0;
+  std::size_t length = std::strlen(algorithm);
+  std::memcpy(&packed, algorithm, length < sizeof(packed) ? length : sizeof(packed));
+  return packed;
+}
+
+/**
+ * @brief Opens the cache file and loads all records
+ *
+ * A missing or foreign file (wrong magic or record size) is reset to an
+ * empty cache; its content is only a cache after all.
+ *
+ * @return true if the file is usable
+ */
+bool HashCache::openFile() {
+  std::error_code ec;
+  std::filesystem::create_directories(std::filesystem::path(m_path).parent_path(), ec);
+
+  m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (m_fd < 0)
+    return false;
+
+  FileLock lock(m_fd, LOCK_EX);
+  struct stat st;
+  if (!lock.locked || ::fstat(m_fd, &st) != 0) {
+    closeFile();
+    return false;
+  }
+
+  Header header{};
+  bool valid = st.st_size >= static_cast<off_t>(sizeof(header)) &&
+               ::pread(m_fd, &header, sizeof(header), 0) == sizeof(header) &&
+               std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+               header.record_size == sizeof(Record);
+
+  if (!valid) {
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.record_size = sizeof(Record);
+    header.reserved = 0;
+    if (::ftruncate(m_fd, 0) != 0 || !writeFull(m_fd, &header, sizeof(header), 0)) {
+      closeFile();
+      return false;
+    }
+  }
+
+  m_inode = static_cast<std::uint64_t>(st.st_ino);
+  m_read_offset = sizeof(Header);
+  m_records = 0;
+  m_entries.clear();
+  readNewRecords();
+  return true;
+}
+
+void HashCache::closeFile() {
+  if (m_fd >= 0)
+    ::close(m_fd);
+  m_fd = -1;
+}
+
+/**
+ * @brief Loads records appended since the last call
+ *
+ * Only complete records are consumed; a record being written by another
+ * process is picked up on a later call. Caller holds m_mutex and a lock on
+ * the file.
+ */
+void HashCache::readNewRecords() {
+  struct stat st;
+  if (::fstat(m_fd, &st) != 0)
+    return;
+
+  const auto end = static_cast<std::uint64_t>(st.st_size);
+  if (end < m_read_offset + sizeof(Record))
+    return;
+
+  std::vector<Record> records(
+      static_cast<std::size_t>((end - m_read_offset) / sizeof(Record)));
+  const std::size_t bytes = records.size() * sizeof(Record);
+  std::size_t done = 0;
+  auto *buffer = reinterpret_cast<std::uint8_t *>(records.data());
+  while (done < bytes) {
+    ssize_t n = ::pread(m_fd, buffer + done, bytes - done,
+                        static_cast<off_t>(m_read_offset + done));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    done += static_cast<std::size_t>(n);
+  }
+  records.resize(done / sizeof(Record));
+
+  for (const Record &record : records) {
+    if (record.checksum != recordChecksum(record) ||
+        record.digest_length > HashDigest::MAX_SIZE)
+      continue;
+
+    Entry entry{record.size, record.mtime_ns, HashDigest{}};
+    std::memcpy(entry.digest.bytes.data(), record.digest, record.digest_length);
+    entry.digest.length = record.digest_length;
+
+    m_entries[Key{record.device, record.inode, record.algorithm, record.sample_size}] = entry;
+  }
+
+  m_records += records.size();
+  m_read_offset += records.size() * sizeof(Record);
+}
+
+/**
+ * @brief True if another process replaced the cache file (compaction)
+ */
+bool HashCache::isReplaced() const {
+  struct stat st;
+  return ::stat(m_path.c_str(), &st) != 0 || static_cast<std::uint64_t>(st.st_ino) != m_inode;
+}
+
+/**
+ * @brief Switches to the current cache file, keeping the known entries
+ *
+ * The replacement may lack records this process appended to the old file
+ * after it was compacted; those are simply hashed again later. Caller
+ * holds m_mutex but no file lock.
+ */
+void HashCache::reopen() {
+  auto known = std::move(m_entries);
+  closeFile();
+  if (openFile()) {
+    for (auto &entry : known)
+      m_entries.insert(std::move(entry));
+  }
+}
+
+/**
+ * @brief Rewrites the file with live entries only if most records are stale
+ *
+ * Caller holds m_mutex. The replacement is renamed over the original, so
+ * readers never see a partially written cache.
+ */
+void HashCache::compact() {
+  if (m_records < COMPACT_MIN_RECORDS || m_records <= 2 * m_entries.size())
+    return;
+
+  compactLocked();
+  if (isReplaced())
+    reopen();
+}
+
+/**
+ * @brief Writes the replacement file while holding the old file's lock
+ */
+void HashCache::compactLocked() {
+  FileLock lock(m_fd, LOCK_EX);
+  if (!lock.locked || isReplaced())
+    return;
+
+  const std::string tmp = m_path + ".tmp." + std::to_string(::getpid());
+  int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0)
+    return;
+
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.record_size = sizeof(Record);
+
+  std::vector<Record> records;
+  records.reserve(m_entries.size());
+  for (const auto &[key, entry] : m_entries) {
+    Record record{};
+    record.device = key.device;
+    record.inode = key.inode;
+    record.size = entry.size;
+    record.mtime_ns = entry.mtime_ns;
+    record.algorithm = key.algorithm;
+    record.sample_size = key.sample_size;
+    record.digest_length = entry.digest.length;
+    std::memcpy(record.digest, entry.digest.bytes.data(), entry.digest.length);
+    record.checksum = recordChecksum(record);
+    records.push_back(record);
+  }
+
+  bool ok = writeFull(fd, &header, sizeof(header), 0) &&
+            writeFull(fd, records.data(), records.size() * sizeof(Record), sizeof(header));
+  ::close(fd);
+
+  if (!ok || ::rename(tmp.c_str(), m_path.c_str()) != 0)
+    ::unlink(tmp.c_str());
+
+  // The old descriptor stays locked until waiting writers notice the rename
+}
+
+bool HashCache::lookup(const FileStamp &stamp, const char *algorithm,
+                       std::uint32_t sample_size, HashDigest &digest) {
+  const Key key{stamp.device, stamp.inode, packName(algorithm), sample_size};
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_fd < 0)
+    return false;
+
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end() && it->second.size == stamp.size &&
+        it->second.mtime_ns == stamp.mtime_ns) {
+      digest = it->second.digest;
+      return true;
+    }
+
+    if (attempt == 0) {
+      // Another process may have hashed the file meanwhile
+      struct stat st;
+      if (::fstat(m_fd, &st) != 0 ||
+          static_cast<std::uint64_t>(st.st_size) < m_read_offset + sizeof(Record))
+        return false;
+      FileLock file_lock(m_fd, LOCK_SH);
+      if (!file_lock.locked)
+        return false;
+      readNewRecords();
+    }
+  }
+  return false;
+}
+
+void HashCache::store(const FileStamp &stamp, const char *algorithm,
+                      std::uint32_t sample_size, const HashDigest &digest) {
+  if (digest.empty() || stamp.mtime_ns > nowNs() - RACY_WINDOW_NS)
+    return;
+
+  Record record{};
+  record.device = stamp.device;
+  record.inode = stamp.inode;
+  record.size = stamp.size;
+  record.mtime_ns = stamp.mtime_ns;
+  record.algorithm = packName(algorithm);
+  record.sample_size = sample_size;
+  record.digest_length = digest.length;
+  std::memcpy(record.digest, digest.bytes.data(), digest.length);
+  record.checksum = recordChecksum(record);
+
+  bool full;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_fd < 0)
+      return;
+
+    m_entries[Key{record.device, record.inode, record.algorithm, record.sample_size}] =
+        Entry{record.size, record.mtime_ns, digest};
+    m_pending.push_back(record);
+    full = m_pending.size() >= WRITE_BATCH;
+  }
+
+  if (full)
+    flush();
+}
+
+/**
+ * @brief Appends all pending records in one write
+ *
+ * Records of other processes that arrived in between are loaded first, so
+ * the read offset stays aligned with the end of the file. A torn record
+ * left by a crashed writer is cut off before appending.
+ */
+void HashCache::flush() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_fd < 0 || m_pending.empty())
+    return;
+
+  std::vector<Record> pending = std::move(m_pending);
+  m_pending.clear();
+
+  for (int attempt = 0; attempt < 2 && m_fd >= 0; ++attempt) {
+    if (appendLocked(pending))
+      return;
+    reopen(); // the file was compacted by another process
+  }
+}
+
+/**
+ * @brief Appends records under an exclusive lock
+ * @return false if the file was replaced and nothing was written
+ */
+bool HashCache::appendLocked(const std::vector<Record> &records) {
+  FileLock file_lock(m_fd, LOCK_EX);
+  if (!file_lock.locked)
+    return true; // give up silently
+  if (isReplaced())
+    return false;
+
+  readNewRecords();
+
+  struct stat st;
+  if (::fstat(m_fd, &st) != 0)
+    return true;
+  if (static_cast<std::uint64_t>(st.st_size) != m_read_offset &&
+      ::ftruncate(m_fd, static_cast<off_t>(m_read_offset)) != 0)
+    return true;
+
+  const std::size_t bytes = records.size() * sizeof(Record);
+  if (writeFull(m_fd, records.data(), bytes, static_cast<off_t>(m_read_offset))) {
+    m_read_offset += bytes;
+    m_records += records.size();
+  }
+  return true;
+}
+
+std::size_t HashCache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
@@ -0,0 +1,186 @@
+/**
+ * @file hashcache.hpp
+ * @brief Persistent content hash cache keyed by device, inode, size and mtime
+ *
+ * Lets repeated duplicate searches over an unchanged tree skip all content
+ * reads: a digest is reused as long as the file's identity (device, inode)
+ * and its size and modification time are unchanged.
+ */
+
+#ifndef HASHCACHE_HPP
+#define HASHCACHE_HPP
+
+#include "hashdigest.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Identity and change stamp of a file, as reported by stat(2)
+ */
+struct FileStamp {
+  std::uint64_t device = 0;
+  std::uint64_t inode = 0;
+  std::int64_t size = 0;
+  std::int64_t mtime_ns = 0;
+
+  /**
+   * @brief Reads the stamp of a path (symlinks are followed)
+   * @param path File to inspect
+   * @param stamp Receives the stamp
+   * @return false if the file cannot be stat'ed or is not a regular file
+   */
+  static bool fromPath(const std::string &path, FileStamp &stamp);
+
+  bool operator==(const FileStamp &other) const {
+    return device == other.device && inode == other.inode && size == other.size &&
+           mtime_ns == other.mtime_ns;
+  }
+  bool operator!=(const FileStamp &other) const { return !(*this == other); }
+};
+
+/**
+ * @class HashCache
+ * @brief Append-only on-disk digest cache shared between tfm processes
+ *
+ * File format (host byte order, not meant to be copied between machines):
+ * - 16 byte header: magic "TFMHASH1", record size, reserved
+ * - fixed-size records: FileStamp, algorithm name, sample size, digest,
+ *   checksum
+ *
+ * New digests are buffered and appended in batches under an exclusive
+ * flock(2); loading takes a shared lock. Records appended by other
+ * processes are picked up on the next lookup miss. Later records win, so
+ * a changed file simply gets a new record; torn or corrupt records are
+ * skipped. When more than half of the records are stale, open compacts
+ * the file into a replacement and renames it over the original; processes
+ * still holding the old file notice on their next store and reopen.
+ *
+ * All methods are thread-safe. I/O errors disable caching silently; the
+ * cache never fails a hash computation.
+ *
+ * @see CachedHashCalculator
+ */
+class HashCache {
+public:
+  /** @brief Cache file name inside the cache directory */
+  static constexpr const char *FILE_NAME = "hashes.v1";
+
+  /** @brief Only files with at least this many records are compacted */
+  static constexpr std::size_t COMPACT_MIN_RECORDS = 4096;
+
+  /** @brief On-disk record layout (defined in hashcache.cpp) */
+  struct Record;
+
+  /**
+   * @brief Opens (or creates) a cache file
+   * @param path Cache file path; parent directories are created
+   */
+  explicit HashCache(const std::string &path);
+
+  ~HashCache();
+
+  HashCache(const HashCache &) = delete;
+  HashCache &operator=(const HashCache &) = delete;
+
+  /**
+   * @brief Default cache location
+   * @return $XDG_CACHE_HOME/tfm/hashes.v1, falling back to
+   *         $HOME/.cache/tfm/hashes.v1; empty if neither is set
+   */
+  static std::string defaultPath();
+
+  /**
+   * @brief Opens the cache at defaultPath()
+   * @return Shared cache, or nullptr if it cannot be opened
+   */
+  static std::shared_ptr<HashCache> openDefault();
+
+  /** @brief True if the cache file is open and usable */
+  bool isOpen() const { return m_fd >= 0; }
+
+  /** @brief Path of the cache file */
+  const std::string &getPath() const { return m_path; }
+
+  /**
+   * @brief Looks up a digest
+   * @param stamp Current stamp of the file
+   * @param algorithm IHashCalculator::name() of the hash (max 8 characters)
+   * @param sample_size 0 for full hashes, otherwise the sample size
+   * @param digest Receives the cached digest on a hit
+   * @return true on a hit with an unchanged stamp
+   */
+  bool lookup(const FileStamp &stamp, const char *algorithm, std::uint32_t sample_size,
+              HashDigest &digest);
+
+  /**
+   * @brief Stores a digest (appends a record)
+   * @param stamp Stamp of the file at hashing time
+   * @param algorithm IHashCalculator::name() of the hash (max 8 characters)
+   * @param sample_size 0 for full hashes, otherwise the sample size
+   * @param digest Digest to cache; empty digests are ignored
+   */
+  void store(const FileStamp &stamp, const char *algorithm, std::uint32_t sample_size,
+             const HashDigest &digest);
+
+  /**
+   * @brief Writes records buffered by store() to disk
+   *
+   * store() batches records; they are flushed when the batch is full and
+   * by the destructor.
+   */
+  void flush();
+
+  /** @brief Number of distinct cached entries */
+  std::size_t size() const;
+
+private:
+  struct Key {
+    std::uint64_t device;
+    std::uint64_t inode;
+    std::uint64_t algorithm;
+    std::uint32_t sample_size;
+
+    bool operator==(const Key &other) const {
+      return device == other.device && inode == other.inode &&
+             algorithm == other.algorithm && sample_size == other.sample_size;
+    }
+  };
+
+  struct KeyHasher {
+    std::size_t operator()(const Key &key) const;
+  };
+
+  struct Entry {
+    std::int64_t size;
+    std::int64_t mtime_ns;
+    HashDigest digest;
+  };
+
+  std::string m_path;
+  int m_fd = -1;
+  std::uint64_t m_inode = 0;
+  std::uint64_t m_read_offset = 0;
+  std::size_t m_records = 0;
+  std::unordered_map<Key, Entry, KeyHasher> m_entries;
+  std::vector<Record> m_pending;
+  mutable std::mutex m_mutex;
+
+  bool openFile();
+  void closeFile();
+  void readNewRecords();
+  bool isReplaced() const;
+  void reopen();
+  void compact();
+  void compactLocked();
+  bool appendLocked(const std::vector<Record> &records);
+
+  static std::uint64_t packName(const char *algorithm);
+};
+
+#endif // HASHCACHE_HPP
@@ -0,0 +1,124 @@
+/**
+ * @file hashdigest.hpp
+ * @brief Fixed-width binary hash value returned by IHashCalculator
+ */
+
+#ifndef HASHDIGEST_HPP
+#define HASHDIGEST_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/**
+ * @struct HashDigest
+ * @brief Binary digest of up to 128 bits
+ *
+ * Digests are compared and used as map keys in their binary form; hex text
+ * is only produced for display via toHex(). 64-bit algorithms fill the
+ * first 8 bytes (big-endian, so the hex text matches the usual notation).
+ *
+ * A length of 0 means "no hash" (e.g. the file could not be read).
+ */
+struct HashDigest {
+  /** @brief Maximum digest width in bytes */
+  static constexpr std::size_t MAX_SIZE = 16;
+
+  /** @brief Digest bytes; bytes past length are always zero */
+  std::array<std::uint8_t, MAX_SIZE> bytes{};
+
+  /** @brief Number of significant bytes (0 = empty digest) */
+  std::uint8_t length = 0;
+
+  /** @brief True if no hash value is stored */
+  bool empty() const { return length == 0; }
+
+  /**
+   * @brief Builds a digest from a 64-bit hash value
+   * @param value Hash value, stored big-endian
+   */
+  static HashDigest fromUint64(std::uint64_t value) {
+    HashDigest d;
+    for (int i = 7; i >= 0; --i) {
+      d.bytes[static_cast<std::size_t>(i)] = static_cast<std::uint8_t>(value);
+      value >>= 8;
+    }
+    d.length = 8;
+    return d;
+  }
+
+  /**
+   * @brief Parses upper- or lowercase hex text
+   * @param hex Up to 32 hex digits; an odd digit count is zero-padded
+   * @return Parsed digest, or an empty digest on invalid input
+   */
+  static HashDigest fromHex(std::string_view hex) {
+    HashDigest d;
+    if (hex.empty() || hex.size() > 2 * MAX_SIZE)
+      return d;
+
+    for (std::size_t i = 0; i < hex.size(); ++i) {
+      int v = hexValue(hex[i]);
+      if (v < 0)
+        return HashDigest();
+      d.bytes[i / 2] |= static_cast<std::uint8_t>(i % 2 == 0 ? v << 4 : v);
+    }
+    d.length = static_cast<std::uint8_t>((hex.size() + 1) / 2);
+    return d;
+  }
+
+  /**
+   * @brief Formats the digest as uppercase hex
+   * @return 2 * length hex characters, "" for an empty digest
+   */
+  std::string toHex() const {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string out(2 * length, '0');
+    for (std::size_t i = 0; i < length; ++i) {
+      out[2 * i] = digits[bytes[i] >> 4];
+      out[2 * i + 1] = digits[bytes[i] & 0x0F];
+    }
+    return out;
+  }
+
+  bool operator==(const HashDigest &other) const {
+    return length == other.length && bytes == other.bytes;
+  }
+
+  bool operator!=(const HashDigest &other) const { return !(*this == other); }
+
+  bool operator<(const HashDigest &other) const {
+    if (length != other.length)
+      return length < other.length;
+    return bytes < other.bytes;
+  }
+
+private:
+  static int hexValue(char c) {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+};
+
+/**
+ * @brief Hash functor so HashDigest can key std::unordered_map
+ *
+ * Digests are already well mixed, so the first 8 bytes are used directly.
+ */
+struct HashDigestHasher {
+  std::size_t operator()(const HashDigest &d) const {
+    std::uint64_t v;
+    std::memcpy(&v, d.bytes.data(), sizeof(v));
+    return static_cast<std::size_t>(v ^ d.length);
+  }
+};
+
+#endif // HASHDIGEST_HPP
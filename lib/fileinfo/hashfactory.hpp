@@ -0,0 +1,96 @@
+/**
+ * @file hashfactory.hpp
+ * @brief Runtime selection of IHashCalculator implementations
+ */
+
+#ifndef HASHFACTORY_HPP
+#define HASHFACTORY_HPP
+
+#include "cachedhashcalculator.hpp"
+#include "fnv1a.hpp"
+#include "ihashcalculator.hpp"
+#include "xxhash64.hpp"
+#include <memory>
+#include <string>
+
+/**
+ * @enum HashAlgorithm
+ * @brief Content hash algorithms available for duplicate detection
+ */
+enum class HashAlgorithm {
+  /** @brief Classic byte-serial 64-bit FNV-1a (default, stable digests) */
+  FNV1A,
+
+  /** @brief Eight-lane FNV-1a variant, several times faster than FNV1A */
+  FNV1ALanes,
+
+  /** @brief XXH64, fastest option */
+  XXH64
+};
+
+/**
+ * @brief Creates the hash calculator for an algorithm
+ * @param algorithm Algorithm to instantiate
+ * @param mode How the calculator reads file content
+ * @return Owning pointer, never nullptr
+ */
+inline std::unique_ptr<IHashCalculator>
+createHashCalculator(HashAlgorithm algorithm,
+                     FileReader::ReadMode mode = FileReader::ReadMode::Buffered) {
+  auto make = [mode](auto calculator) -> std::unique_ptr<IHashCalculator> {
+    calculator->setReadMode(mode);
+    return calculator;
+  };
+  switch (algorithm) {
+  case HashAlgorithm::FNV1ALanes:
+    return make(std::make_unique<FNV1ALanes>());
+  case HashAlgorithm::XXH64:
+    return make(std::make_unique<XXHash64>());
+  case HashAlgorithm::FNV1A:
+  default:
+    return make(std::make_unique<FNV1A>());
+  }
+}
+
+/**
+ * @brief Creates the hash calculator for an algorithm, backed by a cache
+ * @param algorithm Algorithm to instantiate
+ * @param cache Persistent digest cache; nullptr returns the plain calculator
+ * @param mode How the calculator reads file content
+ * @return Owning pointer, never nullptr
+ *
+ * @see HashCache::openDefault()
+ */
+inline std::unique_ptr<IHashCalculator>
+createHashCalculator(HashAlgorithm algorithm, std::shared_ptr<HashCache> cache,
+                     FileReader::ReadMode mode = FileReader::ReadMode::Buffered) {
+  if (!cache)
+    return createHashCalculator(algorithm, mode);
+  return std::make_unique<CachedHashCalculator>(createHashCalculator(algorithm, mode),
+                                                std::move(cache));
+}
+
+/**
+ * @brief Parses an algorithm name as used on the command line
+ *
+ * Accepted names are the IHashCalculator::name() values: "fnv1a",
+ * "fnv1a-x8" and "xxh64".
+ *
+ * @param name Name to parse
+ * @param algorithm Receives the algorithm on success
+ * @return true if the name is known, false otherwise
+ */
+inline bool parseHashAlgorithm(const std::string &name, HashAlgorithm &algorithm) {
+  if (name == Fnv1aEngine::NAME) {
+    algorithm = HashAlgorithm::FNV1A;
+  } else if (name == Fnv1aLanesEngine::NAME) {
+    algorithm = HashAlgorithm::FNV1ALanes;
+  } else if (name == Xxh64Engine::NAME) {
+    algorithm = HashAlgorithm::XXH64;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+#endif // HASHFACTORY_HPP
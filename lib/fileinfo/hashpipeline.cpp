@@ -0,0 +1,174 @@
+/**
+ * @file hashpipeline.cpp
+ * @brief Implementation of the parallel hashing stage
+ */
+
+#include "hashpipeline.hpp"
+
+#include <algorithm>
+
+HashPipeline::HashPipeline(const IHashCalculator &hasher, unsigned threads,
+                           std::size_t queue_capacity)
+    : m_hasher(hasher), m_thread_count(threads), m_queue(queue_capacity) {
+  if (m_thread_count == 0)
+    m_thread_count = std::max(1u, std::thread::hardware_concurrency());
+}
+
+HashPipeline::~HashPipeline() {
+  cancel();
+  finish();
+}
+
+/**
+ * @brief Launches m_thread_count workers for one stage
+ *
+ * A pipeline runs one stage at a time; start() after finish() begins a new
+ * stage with fresh counters. Calls after cancel() start no workers.
+ */
+void HashPipeline::start(Mode mode, ResultCallback on_result) {
+  if (!m_workers.empty() || isCancelled())
+    return;
+
+  m_mode = mode;
+  m_on_result = std::move(on_result);
+  m_submitted.store(0, std::memory_order_relaxed);
+  m_files_done.store(0, std::memory_order_relaxed);
+  m_bytes_done.store(0, std::memory_order_relaxed);
+  m_last_report_ns.store(0, std::memory_order_relaxed);
+  m_started = std::chrono::steady_clock::now();
+  m_queue.reopen();
+
+  m_workers.reserve(m_thread_count);
+  for (unsigned i = 0; i < m_thread_count; ++i)
+    m_workers.emplace_back(&HashPipeline::workerLoop, this);
+}
+
+bool HashPipeline::submit(FileInfo *file) {
+  if (isCancelled() || m_workers.empty())
+    return false;
+  const std::size_t index = m_submitted.load(std::memory_order_relaxed);
+  if (!m_queue.push(Job{index, file}))
+    return false;
+  m_submitted.store(index + 1, std::memory_order_relaxed);
+  return true;
+}
+
+bool HashPipeline::finish() {
+  m_queue.close();
+  for (auto &worker : m_workers)
+    worker.join();
+  m_workers.clear();
+
+  if (isCancelled())
+    return false;
+
+  reportProgress(true);
+  return true;
+}
+
+/**
+ * @brief Hashes a complete candidate list with one start/submit/finish cycle
+ *
+ * Workers write into their candidate's slot, so the result order matches
+ * the input order regardless of which worker finished first.
+ */
+std::vector<HashDigest> HashPipeline::hashAll(const std::vector<FileInfo *> &files,
+                                              Mode mode) {
+  std::vector<HashDigest> digests(files.size());
+  if (files.empty() || isCancelled())
+    return digests;
+
+  start(mode, [&digests](std::size_t index, FileInfo *, const HashDigest &digest) {
+    digests[index] = digest;
+  });
+
+  for (FileInfo *file : files) {
+    if (!submit(file))
+      break;
+  }
+
+  finish();
+  return digests;
+}
+
+/**
+ * @brief Stops all workers as soon as possible
+ *
+ * Queued candidates are dropped; a file already being read is finished
+ * first, because IHashCalculator has no way to abort a single hash.
+ */
+void HashPipeline::cancel() {
+  m_cancelled.store(true, std::memory_order_release);
+  m_queue.close();
+  m_queue.clear();
+}
+
+void HashPipeline::workerLoop() {
+  Job job{};
+  while (!isCancelled() && m_queue.pop(job)) {
+    const std::string &path = job.file->getPath();
+    const long long size = job.file->getFileSize();
+
+    HashDigest digest;
+    long long bytes = size;
+    if (m_mode == Mode::Sample) {
+      digest = m_hasher.calculateSampleHash(path, m_sample_size);
+      bytes = std::min(size, static_cast<long long>(2 * m_sample_size));
+    } else {
+      digest = m_hasher.calculateHash(path);
+    }
+
+    if (isCancelled())
+      break;
+
+    if (m_on_result)
+      m_on_result(job.index, job.file, digest);
+
+    m_bytes_done.fetch_add(bytes, std::memory_order_relaxed);
+    m_files_done.fetch_add(1, std::memory_order_relaxed);
+    reportProgress(false);
+  }
+
+  // Stopped through the token: close the queue so submit() cannot block
+  if (m_stop.stopRequested())
+    cancel();
+}
+
+/**
+ * @brief Invokes the progress callback, throttled to PROGRESS_INTERVAL
+ *
+ * The interval check is lock-free so workers rarely touch the mutex; the
+ * mutex only serializes the callback itself.
+ *
+ * @param force Report even if the interval has not elapsed (stage end)
+ */
+void HashPipeline::reportProgress(bool force) {
+  if (!m_progress)
+    return;
+
+  const auto elapsed = std::chrono::steady_clock::now() - m_started;
+  const long long now_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+  if (!force) {
+    long long last = m_last_report_ns.load(std::memory_order_relaxed);
+    const long long interval =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(PROGRESS_INTERVAL).count();
+    if (now_ns - last < interval)
+      return;
+    if (!m_last_report_ns.compare_exchange_strong(last, now_ns, std::memory_order_relaxed))
+      return;
+  }
+
+  Progress progress;
+  progress.mode = m_mode;
+  progress.files_done = m_files_done.load(std::memory_order_relaxed);
+  progress.files_total = static_cast<int>(m_submitted.load(std::memory_order_relaxed));
+  progress.bytes_done = m_bytes_done.load(std::memory_order_relaxed);
+  const double seconds = static_cast<double>(now_ns) / 1e9;
+  progress.bytes_per_second =
+      seconds > 0.0 ? static_cast<double>(progress.bytes_done) / seconds : 0.0;
+
+  std::lock_guard<std::mutex> lock(m_progress_mutex);
+  m_progress(progress);
+}
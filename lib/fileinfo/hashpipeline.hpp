@@ -0,0 +1,187 @@
+/**
+ * @file hashpipeline.hpp
+ * @brief Parallel hashing stage for duplicate candidates
+ *
+ * Directory enumeration (FileScanner) only collects metadata. This stage
+ * hashes the candidates selected by DuplicateFinder on a pool of worker
+ * threads, so content reads keep several requests in flight.
+ */
+
+#ifndef HASHPIPELINE_HPP
+#define HASHPIPELINE_HPP
+
+#include "boundedqueue.hpp"
+#include "fileinfo.hpp"
+#include "ihashcalculator.hpp"
+#include "stoptoken.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class HashPipeline
+ * @brief Hashes FileInfo candidates on N workers fed by a bounded queue
+ *
+ * Usage pattern:
+ * 1. start() launches the workers
+ * 2. submit() enqueues candidates (blocks while the queue is full)
+ * 3. finish() closes the queue and waits for the workers
+ *
+ * hashAll() wraps these steps for a complete candidate list.
+ *
+ * Progress (bytes hashed per second) is reported through an optional
+ * callback at most every PROGRESS_INTERVAL. cancel() may be called from
+ * any thread; workers stop after the file they are currently reading. A
+ * StopToken (setStopToken()) has the same effect, so one StopSource can
+ * end a scan and the hashing that follows it.
+ *
+ * Example usage:
+ * @code
+ * XXHash64 hasher;
+ * HashPipeline pipeline(hasher, 8);
+ * pipeline.setProgressCallback([](const HashPipeline::Progress &p) {
+ *   std::cout << p.bytes_per_second / 1e6 << " MB/s\n";
+ * });
+ * auto groups = DuplicateFinder::findDuplicates(files, pipeline);
+ * @endcode
+ *
+ * @see DuplicateFinder
+ * @see IHashCalculator
+ */
+class HashPipeline {
+public:
+  /** @brief What each worker computes for a candidate */
+  enum class Mode {
+    Full,  ///< IHashCalculator::calculateHash()
+    Sample ///< IHashCalculator::calculateSampleHash()
+  };
+
+  /** @brief Snapshot passed to the progress callback */
+  struct Progress {
+    Mode mode = Mode::Full;         ///< Stage currently running
+    int files_done = 0;             ///< Candidates finished in this stage
+    int files_total = 0;            ///< Candidates submitted in this stage
+    long long bytes_done = 0;       ///< Content bytes read in this stage
+    double bytes_per_second = 0.0;  ///< Average throughput of this stage
+  };
+
+  /**
+   * @brief Callback function type for progress notifications
+   *
+   * Invoked from worker threads, but never concurrently.
+   */
+  using ProgressCallback = std::function<void(const Progress &progress)>;
+
+  /**
+   * @brief Receives each digest as soon as it is computed
+   *
+   * Invoked from worker threads, possibly concurrently.
+   * index: position of the candidate in submission order.
+   */
+  using ResultCallback =
+      std::function<void(std::size_t index, FileInfo *file, const HashDigest &digest)>;
+
+  /** @brief Minimum time between two progress callbacks */
+  static constexpr std::chrono::milliseconds PROGRESS_INTERVAL{100};
+
+  /**
+   * @brief Creates a pipeline
+   * @param hasher Hash implementation; must outlive the pipeline
+   * @param threads Worker count; 0 selects std::thread::hardware_concurrency()
+   * @param queue_capacity Maximum number of queued, unstarted candidates
+   */
+  explicit HashPipeline(const IHashCalculator &hasher, unsigned threads = 0,
+                        std::size_t queue_capacity = 1024);
+
+  /** @brief Cancels and joins any running workers */
+  ~HashPipeline();
+
+  HashPipeline(const HashPipeline &) = delete;
+  HashPipeline &operator=(const HashPipeline &) = delete;
+
+  /** @brief Sets the progress callback (call before start()) */
+  void setProgressCallback(ProgressCallback progress) { m_progress = std::move(progress); }
+
+  /**
+   * @brief Ends the pipeline like cancel() once the token is stopped
+   * @note Call before start(); workers check the token per file
+   */
+  void setStopToken(StopToken stop) { m_stop = std::move(stop); }
+
+  /** @brief Sets the per-end sample size used in Mode::Sample */
+  void setSampleSize(std::size_t sample_size) { m_sample_size = sample_size; }
+
+  /** @brief Gets the number of worker threads */
+  unsigned getThreadCount() const { return m_thread_count; }
+
+  /**
+   * @brief Launches the workers for one stage
+   * @param mode Full or sample hashing
+   * @param on_result Receives every computed digest
+   */
+  void start(Mode mode, ResultCallback on_result);
+
+  /**
+   * @brief Enqueues a candidate, waiting while the queue is full
+   * @param file Candidate; must stay valid until finish() returns
+   * @return false if the pipeline was cancelled
+   */
+  bool submit(FileInfo *file);
+
+  /**
+   * @brief Closes the queue and waits until all candidates are hashed
+   * @return false if the pipeline was cancelled
+   */
+  bool finish();
+
+  /**
+   * @brief Hashes a complete candidate list
+   * @param files Candidates
+   * @param mode Full or sample hashing
+   * @return One digest per candidate; empty digests for unreadable files
+   *         and for everything not hashed before a cancel()
+   */
+  std::vector<HashDigest> hashAll(const std::vector<FileInfo *> &files, Mode mode);
+
+  /** @brief Requests cancellation (thread-safe, idempotent) */
+  void cancel();
+
+  /** @brief True once cancel() was called or the stop token was stopped */
+  bool isCancelled() const {
+    return m_cancelled.load(std::memory_order_acquire) || m_stop.stopRequested();
+  }
+
+private:
+  struct Job {
+    std::size_t index;
+    FileInfo *file;
+  };
+
+  const IHashCalculator &m_hasher;
+  unsigned m_thread_count;
+  std::size_t m_sample_size = 4096;
+  BoundedQueue<Job> m_queue;
+  std::vector<std::thread> m_workers;
+  std::atomic<bool> m_cancelled{false};
+  StopToken m_stop;
+
+  Mode m_mode = Mode::Full;
+  ResultCallback m_on_result;
+  ProgressCallback m_progress;
+  std::atomic<std::size_t> m_submitted{0};
+
+  std::chrono::steady_clock::time_point m_started;
+  std::atomic<int> m_files_done{0};
+  std::atomic<long long> m_bytes_done{0};
+  std::atomic<long long> m_last_report_ns{0};
+  std::mutex m_progress_mutex;
+
+  void workerLoop();
+  void reportProgress(bool force);
+};
+
+#endif // HASHPIPELINE_HPP
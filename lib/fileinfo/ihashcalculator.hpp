@@ -1,11 +1,41 @@
 #ifndef IHASHCALCULATOR_HPP
 #define IHASHCALCULATOR_HPP
 
+#include "hashdigest.hpp"
+#include <cstddef>
 #include <string>
 
 class IHashCalculator {
 public:
-    virtual std::string calculateHash(const std::string& filePath) const = 0;
+    /**
+     * @brief Hashes the complete file content
+     * @param filePath Path of the file to hash
+     * @return Binary digest, or an empty digest if the file cannot be read
+     */
+    virtual HashDigest calculateHash(const std::string& filePath) const = 0;
+
+    /**
+     * @brief Hashes only the head and tail of a file
+     *
+     * Cheap pre-filter used by the staged duplicate engine: files whose
+     * samples differ cannot be identical, so only colliding samples need a
+     * full content hash. The default falls back to the full hash.
+     *
+     * @param filePath Path of the file to sample
+     * @param sampleSize Number of bytes to read from the head and from the tail
+     * @return Digest of the sampled bytes, or an empty digest on error
+     */
+    virtual HashDigest calculateSampleHash(const std::string& filePath,
+                                           std::size_t sampleSize) const {
+        (void)sampleSize;
+        return calculateHash(filePath);
+    }
+
+    /**
+     * @brief Short algorithm name for reports and benchmarks
+     */
+    virtual const char* name() const { return "custom"; }
+
     virtual ~IHashCalculator() = default;
 };
 
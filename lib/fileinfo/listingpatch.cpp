@@ -0,0 +1,152 @@
+/**
+ * @file listingpatch.cpp
+ * @brief Implementation of incremental listing updates
+ */
+
+#include "listingpatch.hpp"
+#include "filescanner.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+/**
+ * @brief Shared event loop: remove every path, re-add what still exists
+ *
+ * All paths of the batch are removed in one call, so the listing is
+ * compacted once however many entries a batch drops (e.g. the report of
+ * a large deletion). A path named by several events is handled once.
+ *
+ * @param remove Removes the entries of a list of paths
+ * @param insert Inserts a refreshed entry
+ */
+template <typename Remove, typename Insert>
+ListingPatch::Result patch(const std::vector<DirectoryWatcher::Event> &events, Remove remove,
+                           Insert insert) {
+  ListingPatch::Result result;
+  for (const auto &event : events) {
+    if (event.type == DirectoryWatcher::Event::Type::Overflow) {
+      result.rescan = true;
+      return result;
+    }
+  }
+
+  std::unordered_set<std::string_view> seen;
+  seen.reserve(events.size());
+  for (const auto &event : events) {
+    if (seen.insert(event.path).second)
+      result.paths.push_back(event.path);
+  }
+  remove(result.paths);
+
+  // One arena for all refreshed entries of this batch
+  auto arena = std::make_shared<PathArena>();
+  FileScanner scanner;
+
+  for (const auto &path : result.paths) {
+    // Deleted entries may have been re-created since; the stat decides
+    if (scanner.scanEntry(path, result.entries, arena)) {
+      insert(result.entries.back());
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+ListingPatch::Result ListingPatch::apply(std::vector<FileInfo> &listing,
+                                         const std::vector<DirectoryWatcher::Event> &events,
+                                         bool include_parent) {
+  return patch(
+      events,
+      [&](const std::vector<std::string> &paths) {
+        const std::unordered_set<std::string_view> removed(paths.begin(), paths.end());
+        listing.erase(std::remove_if(listing.begin(), listing.end(),
+                                     [&](const FileInfo &info) {
+                                       return !info.isParentDir() &&
+                                              removed.count(info.getPath()) != 0;
+                                     }),
+                      listing.end());
+      },
+      [&](const FileInfo &info) { insert(listing, info, include_parent); });
+}
+
+ListingPatch::Result ListingPatch::apply(FileIndex &index,
+                                         const std::vector<DirectoryWatcher::Event> &events,
+                                         bool include_parent) {
+  return patch(
+      events, [&](const std::vector<std::string> &paths) { index.remove(paths); },
+      [&](const FileInfo &info) { index.insert(info, include_parent); });
+}
+
+/**
+ * @brief Hashes the old paths; new and changed entries keep the order of after
+ */
+std::vector<DirectoryWatcher::Event> ListingPatch::diff(const std::vector<FileInfo> &before,
+                                                       const std::vector<FileInfo> &after) {
+  using Type = DirectoryWatcher::Event::Type;
+  std::unordered_map<std::string, const FileInfo *> old_entries;
+  old_entries.reserve(before.size());
+  for (const auto &info : before) {
+    if (!info.isParentDir())
+      old_entries.emplace(info.getPath(), &info);
+  }
+
+  std::vector<DirectoryWatcher::Event> events;
+  for (const auto &info : after) {
+    if (info.isParentDir())
+      continue;
+    std::string path = info.getPath();
+    const auto it = old_entries.find(path);
+    if (it == old_entries.end()) {
+      events.push_back({Type::Created, std::move(path)});
+      continue;
+    }
+    const FileInfo &old = *it->second;
+    if (old.isDirectory() != info.isDirectory() || old.getFileSize() != info.getFileSize() ||
+        old.getModifiedTime() != info.getModifiedTime()) {
+      events.push_back({Type::Modified, std::move(path)});
+    }
+    old_entries.erase(it);
+  }
+
+  // What is left was deleted; sorted for a deterministic order
+  std::vector<std::string> deleted;
+  deleted.reserve(old_entries.size());
+  for (auto &entry : old_entries) {
+    deleted.push_back(entry.first);
+  }
+  std::sort(deleted.begin(), deleted.end());
+  for (auto &path : deleted) {
+    events.push_back({Type::Deleted, std::move(path)});
+  }
+  return events;
+}
+
+/**
+ * @brief Linear search; names are compared first (no allocation)
+ */
+bool ListingPatch::remove(std::vector<FileInfo> &listing, const std::string &path) {
+  const std::size_t slash = path.rfind('/');
+  const std::string_view name =
+      slash == std::string::npos ? std::string_view(path) : std::string_view(path).substr(slash + 1);
+
+  auto it = std::find_if(listing.begin(), listing.end(), [&](const FileInfo &info) {
+    return !info.isParentDir() && info.getName() == name && info.getPath() == path;
+  });
+  if (it == listing.end())
+    return false;
+  listing.erase(it);
+  return true;
+}
+
+void ListingPatch::insert(std::vector<FileInfo> &listing, FileInfo info, bool include_parent) {
+  auto it = std::lower_bound(listing.begin(), listing.end(), info,
+                             [include_parent](const FileInfo &a, const FileInfo &b) {
+                               return FileScanner::entryLess(a, b, include_parent);
+                             });
+  listing.insert(it, std::move(info));
+}
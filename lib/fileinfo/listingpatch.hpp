@@ -0,0 +1,97 @@
+/**
+ * @file listingpatch.hpp
+ * @brief Applies directory change events to a loaded listing
+ */
+
+#ifndef LISTINGPATCH_HPP
+#define LISTINGPATCH_HPP
+
+#include "directorywatcher.hpp"
+#include "fileindex.hpp"
+#include "fileinfo.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * @class ListingPatch
+ * @brief Keeps a sorted directory listing in sync with watcher events
+ *
+ * Instead of rescanning a directory after a change, every event path is
+ * removed from the listing and, if it still exists, stat'ed again (one
+ * FileScanner::scanEntry() call) and inserted at its sorted position. The
+ * paths of a batch are removed together, so removal costs one pass over
+ * the listing per batch, and no directory is read: dropping one entry from
+ * 50k is instant, and so is dropping 100k from a million.
+ *
+ * The listing must be sorted with FileScanner::sortEntries() using the
+ * same include_parent value.
+ *
+ * @see DirectoryWatcher
+ */
+class ListingPatch {
+public:
+  /** @brief What apply() changed */
+  struct Result {
+    std::vector<std::string> paths; ///< Every path an event referred to
+    std::vector<FileInfo> entries;  ///< Current entries of those that exist
+    bool rescan = false;            ///< Overflow: listing must be rescanned
+  };
+
+  /**
+   * @brief Applies a batch of events to a sorted listing
+   * @param listing Sorted listing of the watched directory (modified)
+   * @param events Events from DirectoryWatcher
+   * @param include_parent Sort flag the listing was sorted with
+   * @return Changed paths and their new entries; on Overflow only
+   *         rescan is set and listing is left alone
+   */
+  static Result apply(std::vector<FileInfo> &listing,
+                      const std::vector<DirectoryWatcher::Event> &events,
+                      bool include_parent);
+
+  /**
+   * @brief Applies a batch of events to a FileIndex
+   *
+   * Same as above; duplicate groups of the index shrink with the removed
+   * entries (refreshed entries have no digest yet).
+   *
+   * @param index Index sorted with the same include_parent value (modified)
+   * @param events Events from DirectoryWatcher
+   * @param include_parent Sort flag the index was sorted with
+   */
+  static Result apply(FileIndex &index, const std::vector<DirectoryWatcher::Event> &events,
+                      bool include_parent);
+
+  /**
+   * @brief Events that turn one listing of a directory into another
+   *
+   * For a listing that did not come from a scan (e.g. a ScanSnapshot):
+   * diff it against a fresh scan and apply() the events. Entries are
+   * matched by path; a path present in both is Modified if type, size or
+   * modification time differ. The parent entry (..) is ignored.
+   *
+   * @param before Listing shown so far
+   * @param after Current listing of the same directory
+   * @return Created, Deleted and Modified events, in the order of after
+   *         (deletions last)
+   */
+  static std::vector<DirectoryWatcher::Event> diff(const std::vector<FileInfo> &before,
+                                                   const std::vector<FileInfo> &after);
+
+  /**
+   * @brief Removes the entry with the given path
+   * @return true if an entry was removed
+   */
+  static bool remove(std::vector<FileInfo> &listing, const std::string &path);
+
+  /**
+   * @brief Inserts an entry at its sorted position
+   * @param listing Sorted listing (modified)
+   * @param info Entry to insert
+   * @param include_parent Sort flag the listing was sorted with
+   */
+  static void insert(std::vector<FileInfo> &listing, FileInfo info, bool include_parent);
+};
+
+#endif // LISTINGPATCH_HPP
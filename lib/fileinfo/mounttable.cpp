@@ -0,0 +1,238 @@
+/**
+ * @file mounttable.cpp
+ * @brief Implementation of the cached mount table
+ */
+
+#include "mounttable.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+bool isOctal(char c) { return c >= '0' && c <= '7'; }
+
+/** @brief Decodes the octal escapes of mountinfo paths (e.g. "\040") */
+std::string unescape(const std::string &field) {
+  std::string out;
+  out.reserve(field.size());
+  for (std::size_t i = 0; i < field.size(); ++i) {
+    if (field[i] == '\\' && i + 3 < field.size() && isOctal(field[i + 1]) &&
+        isOctal(field[i + 2]) && isOctal(field[i + 3])) {
+      out += static_cast<char>((field[i + 1] - '0') * 64 + (field[i + 2] - '0') * 8 +
+                               (field[i + 3] - '0'));
+      i += 3;
+    } else {
+      out += field[i];
+    }
+  }
+  return out;
+}
+
+/** @brief Same heuristic as FileSafety::getMountPoints() */
+bool removablePath(const std::string &mountpoint) {
+  return mountpoint.find("/media") == 0 || mountpoint.find("/mnt") == 0 ||
+         mountpoint.find("/run/media") == 0;
+}
+
+/**
+ * @brief Reads the sysfs removable flag of a block device
+ *
+ * Partitions have no flag of their own; theirs is in the parent disk's
+ * directory.
+ */
+bool removableDevice(unsigned major, unsigned minor) {
+  const std::string base =
+      "/sys/dev/block/" + std::to_string(major) + ":" + std::to_string(minor);
+  for (const char *file : {"/removable", "/../removable"}) {
+    std::ifstream flag(base + file);
+    int removable = 0;
+    if (flag >> removable) {
+      return removable == 1;
+    }
+  }
+  return false;
+}
+
+/** @brief Strips trailing slashes (except of "/") */
+std::string_view trimmed(std::string_view path) {
+  while (path.size() > 1 && path.back() == '/') {
+    path.remove_suffix(1);
+  }
+  return path;
+}
+
+} // namespace
+
+// ============================================================================
+// Snapshot
+// ============================================================================
+
+/**
+ * @brief Parses mountinfo lines
+ *
+ * Line format (proc(5)):
+ * "36 35 98:0 /root /mnt/point rw,noatime master:1 - ext4 /dev/sda1 rw"
+ * with any number of optional fields before the "-" separator.
+ */
+std::shared_ptr<const MountTable::Snapshot> MountTable::Snapshot::parse(std::istream &mountinfo,
+                                                                        bool probe_sysfs) {
+  auto snapshot = std::make_shared<Snapshot>();
+  std::map<std::pair<unsigned, unsigned>, bool> removable_devices;
+
+  std::string line;
+  while (std::getline(mountinfo, line)) {
+    std::istringstream fields(line);
+    std::string id, parent, device_number, root, mountpoint, options, field;
+    if (!(fields >> id >> parent >> device_number >> root >> mountpoint >> options))
+      continue;
+    while (fields >> field && field != "-") {
+    }
+
+    Mount mount;
+    if (!(fields >> mount.fstype >> mount.device))
+      continue;
+    mount.mountpoint = unescape(mountpoint);
+    mount.device = unescape(mount.device);
+    std::sscanf(device_number.c_str(), "%u:%u", &mount.major, &mount.minor);
+    mount.fs_magic = magicOf(mount.fstype);
+
+    mount.removable = removablePath(mount.mountpoint);
+    if (!mount.removable && probe_sysfs && mount.major != 0) {
+      const auto key = std::make_pair(mount.major, mount.minor);
+      auto it = removable_devices.find(key);
+      if (it == removable_devices.end()) {
+        it = removable_devices.emplace(key, removableDevice(mount.major, mount.minor)).first;
+      }
+      mount.removable = it->second;
+    }
+    snapshot->m_mounts.push_back(std::move(mount));
+  }
+
+  // Sorted for lookup; of stacked mounts only the last (topmost) is kept
+  auto &mounts = snapshot->m_mounts;
+  std::stable_sort(mounts.begin(), mounts.end(), [](const Mount &a, const Mount &b) {
+    return a.mountpoint < b.mountpoint;
+  });
+  std::vector<Mount> unique;
+  unique.reserve(mounts.size());
+  for (auto &mount : mounts) {
+    if (!unique.empty() && unique.back().mountpoint == mount.mountpoint) {
+      unique.back() = std::move(mount);
+    } else {
+      unique.push_back(std::move(mount));
+    }
+  }
+  mounts = std::move(unique);
+  return snapshot;
+}
+
+const MountTable::Mount *MountTable::Snapshot::exact(std::string_view mountpoint) const {
+  auto it = std::lower_bound(m_mounts.begin(), m_mounts.end(), mountpoint,
+                             [](const Mount &mount, std::string_view key) {
+                               return std::string_view(mount.mountpoint) < key;
+                             });
+  return it != m_mounts.end() && it->mountpoint == mountpoint ? &*it : nullptr;
+}
+
+const MountTable::Mount *MountTable::Snapshot::find(std::string_view path) const {
+  path = trimmed(path);
+  if (path.empty() || path.front() != '/')
+    return nullptr;
+
+  for (;;) {
+    if (const Mount *mount = exact(path))
+      return mount;
+    if (path.size() == 1)
+      return nullptr; // "/" is not mounted (empty table)
+    const std::size_t slash = path.find_last_of('/');
+    path = slash == 0 ? path.substr(0, 1) : trimmed(path.substr(0, slash));
+  }
+}
+
+bool MountTable::Snapshot::isMountPoint(std::string_view path) const {
+  return exact(trimmed(path)) != nullptr;
+}
+
+// ============================================================================
+// MountTable
+// ============================================================================
+
+MountTable &MountTable::global() {
+  static MountTable table;
+  return table;
+}
+
+MountTable::MountTable() {
+  m_fd = ::open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+  reload();
+}
+
+MountTable::~MountTable() {
+  if (m_fd >= 0)
+    ::close(m_fd);
+}
+
+std::shared_ptr<const MountTable::Snapshot> MountTable::snapshot() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (changed()) {
+    reload();
+  }
+  return m_snapshot;
+}
+
+/**
+ * @brief Asks the kernel whether the mount table changed since the last read
+ *
+ * /proc/self/mountinfo reports POLLPRI | POLLERR once per change; the
+ * event is consumed by this poll, so reload() must follow.
+ */
+bool MountTable::changed() const {
+  if (m_fd < 0)
+    return false;
+  pollfd request{m_fd, POLLPRI, 0};
+  return ::poll(&request, 1, 0) > 0 && (request.revents & (POLLPRI | POLLERR)) != 0;
+}
+
+void MountTable::reload() {
+  std::string text;
+  if (m_fd >= 0 && ::lseek(m_fd, 0, SEEK_SET) == 0) {
+    char buffer[16384];
+    for (;;) {
+      const ssize_t n = ::read(m_fd, buffer, sizeof(buffer));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        break;
+      text.append(buffer, static_cast<std::size_t>(n));
+    }
+  }
+  std::istringstream in(text);
+  m_snapshot = Snapshot::parse(in);
+}
+
+/**
+ * @brief Magic numbers of the pseudo file systems FileSafety protects
+ * @see /usr/include/linux/magic.h
+ */
+long MountTable::magicOf(std::string_view fstype) {
+  static const std::pair<std::string_view, long> MAGICS[] = {
+      {"proc", 0x9fa0},          {"sysfs", 0x62656572},     {"tmpfs", 0x01021994},
+      {"ramfs", 0x858458f6},     {"devpts", 0x3434},        {"securityfs", 0x73636673},
+      {"cgroup", 0x27e0eb},      {"cgroup2", 0x63677270},
+  };
+  for (const auto &[name, magic] : MAGICS) {
+    if (fstype == name)
+      return magic;
+  }
+  return 0;
+}
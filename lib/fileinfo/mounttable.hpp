@@ -0,0 +1,116 @@
+/**
+ * @file mounttable.hpp
+ * @brief Cached mount table with containing-mount lookup
+ */
+
+#ifndef MOUNTTABLE_HPP
+#define MOUNTTABLE_HPP
+
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class MountTable
+ * @brief Mounts of this process, re-read only when the kernel reports a change
+ *
+ * /proc/self/mountinfo is parsed once and kept as an immutable Snapshot.
+ * The descriptor stays open: the kernel flags it (POLLPRI) whenever a
+ * file system is mounted or unmounted, so snapshot() costs one poll()
+ * while nothing changed.
+ *
+ * Per mount the snapshot keeps what the safety checks need, resolved at
+ * parse time: the file system magic (from the type name, no statfs()) and
+ * whether the device is removable (one sysfs read per device, not per
+ * path).
+ *
+ * @code
+ * auto mounts = MountTable::global().snapshot();
+ * if (const auto *mount = mounts->find("/media/usb/photo.jpg")) {
+ *   std::cout << mount->mountpoint << (mount->removable ? " (removable)" : "");
+ * }
+ * @endcode
+ *
+ * @note Thread-safe; snapshots may be used after newer ones were taken
+ * @see FileSafety
+ */
+class MountTable {
+public:
+  /** @brief One mounted file system */
+  struct Mount {
+    std::string mountpoint;   ///< Absolute path, escapes decoded
+    std::string device;       ///< Mount source (e.g. /dev/sda1)
+    std::string fstype;       ///< File system type (e.g. ext4)
+    unsigned major = 0;       ///< Device number of the file system
+    unsigned minor = 0;
+    long fs_magic = 0;        ///< statfs() magic of pseudo file systems, else 0
+    bool removable = false;   ///< USB/SD device or mounted below /media, /mnt
+  };
+
+  /** @brief Immutable, sorted view of the mounts at one point in time */
+  class Snapshot {
+  public:
+    Snapshot() = default;
+
+    /**
+     * @brief Builds a snapshot from mountinfo text
+     * @param mountinfo Lines in the format of /proc/self/mountinfo
+     * @param probe_sysfs Read /sys to detect removable block devices
+     */
+    static std::shared_ptr<const Snapshot> parse(std::istream &mountinfo,
+                                                 bool probe_sysfs = true);
+
+    /**
+     * @brief Mount containing a path: the one at its longest mounted prefix
+     *
+     * Looks up the path and each parent with a binary search (O(depth *
+     * log n)); of stacked mounts on one directory the topmost counts.
+     *
+     * @param path Absolute path (need not exist)
+     * @return The mount, or nullptr for relative paths or an empty table
+     */
+    const Mount *find(std::string_view path) const;
+
+    /** @brief True if path itself is a mount point */
+    bool isMountPoint(std::string_view path) const;
+
+    /** @brief Mounts ordered by mount point */
+    const std::vector<Mount> &mounts() const { return m_mounts; }
+
+  private:
+    const Mount *exact(std::string_view mountpoint) const;
+
+    std::vector<Mount> m_mounts;
+  };
+
+  /** @brief Table of the running process */
+  static MountTable &global();
+
+  /**
+   * @brief Current mounts; re-reads /proc/self/mountinfo if it changed
+   * @return Never null (empty when /proc is not available)
+   */
+  std::shared_ptr<const Snapshot> snapshot();
+
+  /** @brief statfs() magic of a pseudo file system type name, 0 otherwise */
+  static long magicOf(std::string_view fstype);
+
+  MountTable(const MountTable &) = delete;
+  MountTable &operator=(const MountTable &) = delete;
+  ~MountTable();
+
+private:
+  MountTable();
+
+  bool changed() const;
+  void reload();
+
+  std::mutex m_mutex;
+  int m_fd = -1; ///< Open /proc/self/mountinfo, polled for changes
+  std::shared_ptr<const Snapshot> m_snapshot;
+};
+
+#endif // MOUNTTABLE_HPP
@@ -0,0 +1,229 @@
+/**
+ * @file multirootscanner.cpp
+ * @brief Implementation of multi-root scanning
+ */
+
+#include "multirootscanner.hpp"
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+
+/** @brief Device and inode of a directory (stat follows links) */
+bool identify(const std::string &path, std::uint64_t &device, std::uint64_t &inode) {
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+    return false;
+  device = st.st_dev;
+  inode = st.st_ino;
+  return true;
+}
+
+/** @brief True if path is root or lies below it */
+bool below(const std::string &path, const std::string &root) {
+  if (root == "/")
+    return !path.empty() && path[0] == '/';
+  return path.size() >= root.size() && path.compare(0, root.size(), root) == 0 &&
+         (path.size() == root.size() || path[root.size()] == '/');
+}
+
+} // namespace
+
+/**
+ * @brief Reads the parent disk of a partition from sysfs
+ *
+ * /sys/dev/block/<major>:<minor> links to the partition directory, which
+ * has a "partition" file and lies inside the disk's directory, whose
+ * "dev" file holds the disk's numbers.
+ */
+std::uint64_t MultiRootScanner::diskOf(std::uint64_t device) {
+  const unsigned major_number = major(static_cast<dev_t>(device));
+  const unsigned minor_number = minor(static_cast<dev_t>(device));
+  if (major_number == 0)
+    return device; // no block device (tmpfs, NFS, btrfs subvolumes, ...)
+
+  const std::string base = "/sys/dev/block/" + std::to_string(major_number) + ":" +
+                           std::to_string(minor_number);
+  std::error_code ec;
+  if (!std::filesystem::exists(base + "/partition", ec))
+    return device;
+
+  std::ifstream parent(base + "/../dev");
+  unsigned disk_major = 0;
+  unsigned disk_minor = 0;
+  char colon = 0;
+  if (parent >> disk_major >> colon >> disk_minor && colon == ':')
+    return makedev(disk_major, disk_minor);
+  return device;
+}
+
+/**
+ * @brief Normalizes the path and checks it against the existing roots
+ *
+ * Containment is decided by (device, inode) along the canonical path, so
+ * a root given through a symlink or with "..", or the same directory
+ * under two names, is still recognized.
+ */
+MultiRootScanner::AddResult MultiRootScanner::addRoot(const std::string &path) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  std::string absolute = fs::absolute(path, ec).lexically_normal().string();
+  while (absolute.size() > 1 && absolute.back() == '/') {
+    absolute.pop_back();
+  }
+
+  Root root;
+  root.path = absolute;
+  if (ec || !identify(absolute, root.device, root.inode))
+    return AddResult::Invalid;
+  root.disk = diskOf(root.device);
+
+  // Directories on the way from "/" to the root
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> ancestors;
+  const fs::path canonical = fs::canonical(absolute, ec);
+  if (!ec) {
+    for (fs::path dir = canonical.parent_path(); !dir.empty(); dir = dir.parent_path()) {
+      std::uint64_t device = 0;
+      std::uint64_t inode = 0;
+      if (identify(dir.native(), device, inode))
+        ancestors.emplace_back(device, inode);
+      if (dir == dir.root_path())
+        break;
+    }
+  }
+  auto contains = [](const std::vector<std::pair<std::uint64_t, std::uint64_t>> &chain,
+                     const Root &dir) {
+    return std::find(chain.begin(), chain.end(), std::make_pair(dir.device, dir.inode)) !=
+           chain.end();
+  };
+
+  for (const Root &existing : m_roots) {
+    if ((existing.device == root.device && existing.inode == root.inode) ||
+        contains(ancestors, existing))
+      return AddResult::Covered;
+  }
+
+  // Roots below the new one are scanned as part of it
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < m_roots.size(); ++i) {
+    if (contains(m_ancestors[i], root))
+      continue;
+    if (kept != i) {
+      m_roots[kept] = std::move(m_roots[i]);
+      m_ancestors[kept] = std::move(m_ancestors[i]);
+    }
+    ++kept;
+  }
+  m_roots.resize(kept);
+  m_ancestors.resize(kept);
+
+  m_roots.push_back(std::move(root));
+  m_ancestors.push_back(std::move(ancestors));
+  return AddResult::Added;
+}
+
+/**
+ * @brief One thread per disk, each walking its roots in turn
+ *
+ * Implementation details:
+ * 1. Roots are grouped by Root::disk
+ * 2. Every group runs a FileScanner (m_thread_count workers) over its
+ *    roots on a thread of its own
+ * 3. All scanners share one progress counter; batches and progress
+ *    reports are serialized by a mutex. A declined batch stops every
+ *    group at its next batch
+ */
+std::size_t MultiRootScanner::scan(const FileScanner::BatchCallback &on_batch,
+                                   const FileScanner::ProgressCallback &progress) {
+  // 1. Disks
+  std::map<std::uint64_t, std::vector<std::size_t>> disks;
+  for (std::size_t i = 0; i < m_roots.size(); ++i) {
+    disks[m_roots[i].disk].push_back(i);
+  }
+
+  std::mutex mutex;
+  std::atomic<bool> stopped{false};
+  std::atomic<int> listed{0};
+  std::atomic<std::size_t> delivered{0};
+
+  const FileScanner::BatchCallback emit = [&](std::vector<FileInfo> &&batch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopped.load(std::memory_order_relaxed))
+      return false;
+    const std::size_t size = batch.size();
+    if (!on_batch(std::move(batch))) {
+      stopped.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    delivered.fetch_add(size, std::memory_order_relaxed);
+    return true;
+  };
+  FileScanner::ProgressCallback report;
+  if (progress) {
+    report = [&](int) {
+      std::lock_guard<std::mutex> lock(mutex);
+      progress(listed.load(std::memory_order_relaxed));
+    };
+  }
+
+  // 2. One scheduler per disk
+  auto walk = [&](const std::vector<std::size_t> &roots) {
+    FileScanner scanner;
+    scanner.setThreadCount(m_thread_count);
+    scanner.setStopToken(m_stop);
+    scanner.setProgressCounter(&listed);
+    for (std::size_t i : roots) {
+      if (stopped.load(std::memory_order_relaxed) || m_stop.stopRequested())
+        break;
+      scanner.scanDirectoryStreaming(m_roots[i].path, true, false, emit, report);
+    }
+  };
+
+  if (disks.size() == 1) {
+    walk(disks.begin()->second);
+  } else {
+    std::vector<std::thread> threads;
+    threads.reserve(disks.size());
+    for (const auto &disk : disks) {
+      threads.emplace_back(walk, std::cref(disk.second));
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+  return delivered.load();
+}
+
+std::size_t MultiRootScanner::rootOf(const std::string &path) const {
+  for (std::size_t i = 0; i < m_roots.size(); ++i) {
+    if (below(path, m_roots[i].path))
+      return i;
+  }
+  return m_roots.size();
+}
+
+std::vector<DuplicateFinder::DuplicateGroup>
+MultiRootScanner::crossRoot(const std::vector<DuplicateFinder::DuplicateGroup> &groups,
+                            const MultiRootScanner &scanner) {
+  std::vector<DuplicateFinder::DuplicateGroup> result;
+  for (const auto &group : groups) {
+    std::unordered_set<std::size_t> roots;
+    for (const FileInfo *file : group.files) {
+      roots.insert(scanner.rootOf(file->getPath()));
+    }
+    if (roots.size() >= 2) {
+      result.push_back(group);
+    }
+  }
+  return result;
+}
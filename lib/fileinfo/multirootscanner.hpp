@@ -0,0 +1,138 @@
+/**
+ * @file multirootscanner.hpp
+ * @brief Concurrent scans of several roots, one scheduler per disk
+ */
+
+#ifndef MULTIROOTSCANNER_HPP
+#define MULTIROOTSCANNER_HPP
+
+#include "duplicatefinder.hpp"
+#include "filescanner.hpp"
+#include "stoptoken.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class MultiRootScanner
+ * @brief Scans several directory trees into one stream of batches
+ *
+ * Finding duplicates between /data/a and /backup/b should not mean
+ * scanning a common parent. Roots are added one by one and scanned
+ * recursively by scan(), which feeds all of them into one callback, so a
+ * single DuplicateFinder run sees every file:
+ * - Overlapping roots are scanned once: a root whose directory (device,
+ *   inode) is already a root, or lies below one, is not added, and a
+ *   root added above existing ones replaces them.
+ * - Roots are grouped by the physical disk behind their file system
+ *   (the whole disk of a partition, from sysfs). Every disk gets one
+ *   FileScanner of its own, running on its own thread with
+ *   setThreadCount() workers, so disks are walked concurrently while the
+ *   roots of one disk are walked one after the other instead of seeking
+ *   against each other.
+ *
+ * @code
+ * MultiRootScanner scanner;
+ * scanner.addRoot("/data/a");
+ * scanner.addRoot("/backup/b");
+ * std::vector<FileInfo> files;
+ * scanner.scan([&](std::vector<FileInfo> &&batch) { ...; return true; });
+ * auto groups = MultiRootScanner::crossRoot(
+ *     DuplicateFinder::findDuplicates(files, hasher), scanner);
+ * @endcode
+ */
+class MultiRootScanner {
+public:
+  /** @brief One root to scan */
+  struct Root {
+    std::string path;        ///< Absolute, normalized path as given
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    std::uint64_t disk = 0;  ///< Physical disk (see diskOf())
+  };
+
+  /** @brief Result of addRoot() */
+  enum class AddResult {
+    Added,   ///< New root (roots below it were dropped)
+    Covered, ///< Same directory as a root, or below one; nothing changed
+    Invalid  ///< Not a readable directory
+  };
+
+  /**
+   * @brief Adds a directory to scan
+   * @param path Directory; relative paths are made absolute
+   * @return Whether the root was added
+   */
+  AddResult addRoot(const std::string &path);
+
+  /** @brief Roots to scan, in the order they were added */
+  const std::vector<Root> &roots() const { return m_roots; }
+
+  /**
+   * @brief Sets the worker threads per disk
+   * @param count Threads per FileScanner; 0 selects
+   *        std::thread::hardware_concurrency()
+   * @see FileScanner::setThreadCount()
+   */
+  void setThreadCount(unsigned count) { m_thread_count = count; }
+
+  /** @brief Stops running and later scans (see FileScanner::setStopToken()) */
+  void setStopToken(StopToken stop) { m_stop = std::move(stop); }
+
+  /**
+   * @brief Scans every root recursively
+   *
+   * Batches of all disks are delivered through on_batch one at a time
+   * (never concurrently). Roots are not part of the results, as with
+   * FileScanner::scanDirectory().
+   *
+   * @param on_batch Receives unsorted batches; returning false stops all
+   *        disks
+   * @param progress Optional callback with the number of entries listed
+   *        on all disks (serialized like on_batch)
+   * @return Number of entries delivered
+   */
+  std::size_t scan(const FileScanner::BatchCallback &on_batch,
+                   const FileScanner::ProgressCallback &progress = nullptr);
+
+  /**
+   * @brief Index of the root a path belongs to
+   * @param path Entry path produced by scan()
+   * @return Position in roots(), or roots().size() if none
+   */
+  std::size_t rootOf(const std::string &path) const;
+
+  /**
+   * @brief Keeps the duplicate groups that span at least two roots
+   * @param groups Result of a duplicate search over scan() entries
+   * @param scanner Scanner the entries came from
+   * @return Groups with members below two or more roots
+   */
+  static std::vector<DuplicateFinder::DuplicateGroup>
+  crossRoot(const std::vector<DuplicateFinder::DuplicateGroup> &groups,
+            const MultiRootScanner &scanner);
+
+  /**
+   * @brief Physical disk of a device number
+   *
+   * The whole disk for a partition (sysfs /sys/dev/block/<major>:<minor>),
+   * otherwise the device itself (e.g. for NFS, tmpfs or when /sys is not
+   * available).
+   *
+   * @param device st_dev of a file
+   * @return Device number of the disk
+   */
+  static std::uint64_t diskOf(std::uint64_t device);
+
+private:
+  std::vector<Root> m_roots;
+  /** @brief (device, inode) of the directories above each root */
+  std::vector<std::vector<std::pair<std::uint64_t, std::uint64_t>>> m_ancestors;
+  unsigned m_thread_count = 0;
+  StopToken m_stop;
+};
+
+#endif // MULTIROOTSCANNER_HPP
@@ -0,0 +1,210 @@
+/**
+ * @file namesearch.cpp
+ * @brief Implementation of the incremental name search
+ */
+
+#include "namesearch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+/** @brief Separator after every name; file names never contain it */
+constexpr char SEPARATOR = '/';
+
+char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c; }
+
+} // namespace
+
+void NameSearch::clear() {
+  m_text.clear();
+  m_starts.assign(1, 0);
+  m_steps.clear();
+}
+
+void NameSearch::reserve(std::size_t names, std::size_t bytes) {
+  m_text.reserve(bytes + names);
+  m_starts.reserve(names + 1);
+}
+
+void NameSearch::add(std::string_view name) {
+  for (char c : name) {
+    m_text.push_back(lower(c));
+  }
+  m_text.push_back(SEPARATOR);
+  m_starts.push_back(static_cast<std::uint32_t>(m_text.size()));
+  m_steps.clear();
+}
+
+/**
+ * @brief Refines the stored result of the longest prefix of the query
+ *
+ * Implementation details:
+ * 1. Results of queries that are no prefix of this one are dropped; an
+ *    equal query returns its result unchanged
+ * 2. Appending to a query only narrows it (the last word grows, or a
+ *    word is added), so the previous result is the candidate set
+ * 3. Without one, the longest plain word is searched in the whole buffer
+ *    by scan(); the remaining words are checked on its hits
+ */
+const std::vector<std::uint32_t> &NameSearch::match(std::string_view query) {
+  // 1. Stored results
+  while (!m_steps.empty() && query.compare(0, m_steps.back().query.size(),
+                                           m_steps.back().query) != 0) {
+    m_steps.pop_back();
+  }
+  if (!m_steps.empty() && m_steps.back().query.size() == query.size()) {
+    return m_steps.back().matches;
+  }
+
+  Step step;
+  step.query = std::string(query);
+  const std::vector<Word> words = parse(query);
+  const bool impossible = std::any_of(words.begin(), words.end(), [](const Word &word) {
+    return word.text.find(SEPARATOR) != std::string::npos;
+  });
+
+  if (impossible) {
+    // No name contains the separator
+  } else if (!m_steps.empty()) {
+    // 2. Refine
+    for (std::uint32_t position : m_steps.back().matches) {
+      if (matches(position, words))
+        step.matches.push_back(position);
+    }
+  } else {
+    // 3. Full search
+    const Word *longest = nullptr;
+    for (const Word &word : words) {
+      if (!word.prefix && (!longest || word.text.size() > longest->text.size()))
+        longest = &word;
+    }
+    if (longest) {
+      std::vector<std::uint32_t> hits;
+      scan(longest->text, hits);
+      for (std::uint32_t position : hits) {
+        if (words.size() == 1 || matches(position, words))
+          step.matches.push_back(position);
+      }
+    } else if (words.empty()) {
+      step.matches.resize(size());
+      std::iota(step.matches.begin(), step.matches.end(), 0u);
+    } else {
+      for (std::uint32_t position = 0; position < size(); ++position) {
+        if (matches(position, words))
+          step.matches.push_back(position);
+      }
+    }
+  }
+
+  m_steps.push_back(std::move(step));
+  return m_steps.back().matches;
+}
+
+std::vector<NameSearch::Word> NameSearch::parse(std::string_view query) {
+  std::vector<Word> words;
+  std::size_t pos = 0;
+  while (pos < query.size()) {
+    if (query[pos] == ' ') {
+      ++pos;
+      continue;
+    }
+    std::size_t end = query.find(' ', pos);
+    if (end == std::string_view::npos)
+      end = query.size();
+
+    Word word;
+    word.prefix = query[pos] == '^';
+    for (std::size_t i = pos + (word.prefix ? 1 : 0); i < end; ++i) {
+      word.text.push_back(lower(query[i]));
+    }
+    if (!word.text.empty() || word.prefix)
+      words.push_back(std::move(word));
+    pos = end;
+  }
+  return words;
+}
+
+std::string_view NameSearch::name(std::uint32_t position) const {
+  const std::uint32_t begin = m_starts[position];
+  return std::string_view(m_text).substr(begin, m_starts[position + 1] - begin - 1);
+}
+
+bool NameSearch::matches(std::uint32_t position, const std::vector<Word> &words) const {
+  const std::string_view text = name(position);
+  for (const Word &word : words) {
+    const bool found = word.prefix ? text.compare(0, word.text.size(), word.text) == 0
+                                   : text.find(word.text) != std::string_view::npos;
+    if (!found)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Positions of all names containing a word
+ *
+ * Classic first/last byte filter: for 16 candidate starts at a time, the
+ * byte at the start is compared with the first byte of the word and the
+ * byte k-1 further with its last byte; only starts where both match are
+ * compared in full. A hit ends the search in that name, the scan goes on
+ * at the start of the next one. The tail of the buffer (fewer than 16
+ * candidate starts with a full load) and builds without SSE2 use
+ * std::string_view::find().
+ */
+void NameSearch::scan(const std::string &word, std::vector<std::uint32_t> &out) const {
+  const std::size_t k = word.size();
+  const std::size_t n = m_text.size();
+  if (k == 0 || k > n)
+    return;
+  const char *text = m_text.data();
+  const std::size_t last_start = n - k;
+
+  std::uint32_t entry = 0;
+  auto hit = [&](std::size_t pos) {
+    while (m_starts[entry + 1] <= pos) {
+      ++entry;
+    }
+    out.push_back(entry);
+    return static_cast<std::size_t>(m_starts[entry + 1]); // next name
+  };
+
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i first = _mm_set1_epi8(word.front());
+  const __m128i last = _mm_set1_epi8(word.back());
+  while (i + k - 1 + 16 <= n) {
+    const __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+    const __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i + k - 1));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+
+    std::size_t next = i + 16;
+    while (mask != 0) {
+      const std::size_t pos = i + static_cast<std::size_t>(__builtin_ctz(mask));
+      if (k <= 2 || std::memcmp(text + pos + 1, word.data() + 1, k - 2) == 0) {
+        next = hit(pos);
+        break;
+      }
+      mask &= mask - 1;
+    }
+    i = next;
+  }
+#endif
+
+  const std::string_view view(m_text);
+  while (i <= last_start) {
+    const std::size_t pos = view.find(word, i);
+    if (pos == std::string_view::npos)
+      break;
+    i = hit(pos);
+  }
+}
@@ -0,0 +1,97 @@
+/**
+ * @file namesearch.hpp
+ * @brief Incremental file name search over a packed name buffer
+ */
+
+#ifndef NAMESEARCH_HPP
+#define NAMESEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class NameSearch
+ * @brief Finds names containing the words of a query, refining per keystroke
+ *
+ * Names are added once and kept lowercased (ASCII) in one buffer, each
+ * followed by a '/' (which no file name contains). A query is split at
+ * spaces into words; a name matches if it contains every word, in any
+ * order. A word starting with '^' must be a prefix of the name
+ * ("^read me" finds "README.md" and "readme-old.txt").
+ *
+ * Matching is incremental: the results of every query are kept on a
+ * stack. A query extending the previous one (typing) only filters the
+ * previous matches; a shorter one (backspace) returns the stored result.
+ * Only the first word of a search scans all names: an SSE2 loop compares
+ * 16 positions of the buffer at once against the first and last byte of
+ * the word and checks the rest of the word only where both matched, then
+ * jumps to the next name after a hit.
+ *
+ * @code
+ * NameSearch search;
+ * for (const auto &info : files)
+ *   search.add(info.getName());
+ * const auto &first = search.match("rep");     // scans all names
+ * const auto &refined = search.match("repo");  // filters `first`
+ * @endcode
+ *
+ * @note Not thread-safe
+ * @see FileIndex::setNameFilter()
+ */
+class NameSearch {
+public:
+  /** @brief Removes all names and stored results */
+  void clear();
+
+  /**
+   * @brief Reserves space for a number of names
+   * @param names Expected name count
+   * @param bytes Expected total length of the names
+   */
+  void reserve(std::size_t names, std::size_t bytes);
+
+  /**
+   * @brief Adds a name; its position is the number of names added before
+   *
+   * Drops the stored results (they do not cover the new name).
+   */
+  void add(std::string_view name);
+
+  /** @brief Number of names */
+  std::size_t size() const { return m_starts.size() - 1; }
+
+  /**
+   * @brief Positions of the names matching a query, ascending
+   * @param query Words separated by spaces; case-insensitive for ASCII.
+   *        An empty query matches every name
+   * @return Reference valid until the next call
+   */
+  const std::vector<std::uint32_t> &match(std::string_view query);
+
+private:
+  /** @brief One word of a query (lowercased) */
+  struct Word {
+    std::string text;
+    bool prefix = false;
+  };
+
+  /** @brief Result of one query, refined by the next */
+  struct Step {
+    std::string query;
+    std::vector<std::uint32_t> matches;
+  };
+
+  std::string m_text;                  ///< Lowercased names, each followed by '/'
+  std::vector<std::uint32_t> m_starts{0}; ///< Start of every name, plus the end
+  std::vector<Step> m_steps;           ///< Results of the query and its prefixes
+
+  static std::vector<Word> parse(std::string_view query);
+  std::string_view name(std::uint32_t position) const;
+  bool matches(std::uint32_t position, const std::vector<Word> &words) const;
+  void scan(const std::string &word, std::vector<std::uint32_t> &out) const;
+};
+
+#endif // NAMESEARCH_HPP
@@ -0,0 +1,178 @@
+/**
+ * @file patharena.hpp
+ * @brief Shared string storage for the paths of scanned entries
+ */
+
+#ifndef PATHARENA_HPP
+#define PATHARENA_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class PathArena
+ * @brief Interned directory paths plus packed file names
+ *
+ * A scan stores every directory path once and every file name as a slice
+ * of a large chunk, so a FileInfo only needs a directory id and a name
+ * reference instead of its own heap-allocated path string.
+ *
+ * Names never move once added (chunks are not reallocated), so views
+ * returned by name() stay valid for the arena's lifetime. A NameRef holds
+ * the chunk index and the position inside the chunk separately, so an
+ * arena may grow past 4 GiB (one arena collects a whole sequential scan).
+ *
+ * A regular file's Inode record can be stored right behind its name
+ * (addName(name, inode)), so entries carry their identity without
+ * growing FileInfo.
+ *
+ * @note Not synchronized: one writer at a time, and readers only after
+ *       the writer is done (the parallel scanner uses one arena per worker)
+ */
+class PathArena {
+public:
+  using DirId = std::uint32_t;
+
+  /** @brief Maximum chunk size; positions in a chunk fit NameRef::position */
+  static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+  /** @brief Size of the first chunk; chunks double up to CHUNK_SIZE */
+  static constexpr std::size_t FIRST_CHUNK_SIZE = 256;
+
+  /** @brief Identity and allocation of a file, captured at scan time */
+  struct Inode {
+    std::uint64_t device = 0; ///< st_dev
+    std::uint64_t inode = 0;  ///< st_ino
+    std::uint64_t blocks = 0; ///< st_blocks (512-byte units)
+    std::uint32_t links = 0;  ///< st_nlink
+  };
+
+  /** @brief Reference to a name inside the arena */
+  struct NameRef {
+    std::uint32_t chunk = 0;    ///< Index of the chunk
+    std::uint16_t position = 0; ///< Start inside the chunk
+    std::uint16_t length = 0;
+  };
+
+  /**
+   * @param chunk_size Maximum chunk size (at most CHUNK_SIZE); smaller
+   *        values only serve tests that need many chunks
+   */
+  explicit PathArena(std::size_t chunk_size = CHUNK_SIZE)
+      : m_chunk_size(chunk_size < CHUNK_SIZE ? chunk_size : CHUNK_SIZE) {}
+
+  /** @brief Number of chunks allocated so far */
+  std::size_t chunkCount() const { return m_chunks.size(); }
+
+  /**
+   * @brief Interns a directory path
+   *
+   * Consecutive calls with the same directory (the common case while
+   * listing one directory) skip the hash lookup.
+   *
+   * @param path Directory path
+   * @return Id for directory()
+   */
+  DirId internDirectory(std::string_view path) {
+    if (!m_dirs.empty() && m_dirs[m_last_dir] == path)
+      return m_last_dir;
+
+    auto it = m_dir_ids.find(std::string(path));
+    if (it == m_dir_ids.end()) {
+      it = m_dir_ids.emplace(std::string(path), static_cast<DirId>(m_dirs.size())).first;
+      m_dirs.emplace_back(path);
+    }
+    m_last_dir = it->second;
+    return m_last_dir;
+  }
+
+  /** @brief Path of an interned directory */
+  const std::string &directory(DirId id) const { return m_dirs[id]; }
+
+  /**
+   * @brief Copies a name into the arena
+   * @param name Name (truncated to 65535 bytes; NAME_MAX is far smaller)
+   * @return Reference for name()
+   */
+  NameRef addName(std::string_view name) { return append(name, nullptr); }
+
+  /**
+   * @brief Copies a name and the file's Inode record into the arena
+   * @param name Name (truncated to 65535 bytes)
+   * @param inode Record for inode()
+   * @return Reference for name() and inode()
+   */
+  NameRef addName(std::string_view name, const Inode &inode) { return append(name, &inode); }
+
+  /**
+   * @brief Inode record stored behind a name
+   * @param ref Reference returned by addName(name, inode)
+   */
+  Inode inode(NameRef ref) const {
+    Inode record;
+    std::memcpy(&record, m_chunks[ref.chunk].get() + ref.position + ref.length,
+                sizeof(record));
+    return record;
+  }
+
+  /** @brief View of a stored name */
+  std::string_view name(NameRef ref) const {
+    return std::string_view(m_chunks[ref.chunk].get() + ref.position, ref.length);
+  }
+
+  /** @brief Approximate heap usage in bytes (for diagnostics) */
+  std::size_t memoryUsage() const {
+    std::size_t bytes = m_chunk_bytes;
+    for (const auto &dir : m_dirs)
+      bytes += dir.capacity() * 2 + sizeof(std::string) * 2;
+    return bytes;
+  }
+
+private:
+  NameRef append(std::string_view name, const Inode *inode) {
+    const std::size_t length = name.size() < 0xFFFF ? name.size() : 0xFFFF;
+    const std::size_t bytes = length + (inode ? sizeof(Inode) : 0);
+    if (m_chunks.empty() || m_used + bytes > m_capacity) {
+      // Small first chunks keep single-entry arenas cheap
+      if (m_chunks.size() >= UINT32_MAX) // 0xFFFFFFFF stays free as a sentinel
+        throw std::length_error("PathArena: chunk index exceeds 32 bits");
+      std::size_t capacity = m_chunks.empty() ? FIRST_CHUNK_SIZE : 2 * m_capacity;
+      capacity = capacity < m_chunk_size ? capacity : m_chunk_size;
+      capacity = capacity > bytes ? capacity : bytes; // alone in its chunk
+      m_chunks.emplace_back(new char[capacity]);
+      m_chunk_bytes += capacity;
+      m_capacity = capacity;
+      m_used = 0;
+    }
+
+    // m_used < CHUNK_SIZE here: a chunk is at most CHUNK_SIZE bytes, or
+    // holds a single oversized record starting at 0
+    NameRef ref;
+    ref.chunk = static_cast<std::uint32_t>(m_chunks.size() - 1);
+    ref.position = static_cast<std::uint16_t>(m_used);
+    ref.length = static_cast<std::uint16_t>(length);
+    std::memcpy(m_chunks.back().get() + m_used, name.data(), length);
+    if (inode) {
+      std::memcpy(m_chunks.back().get() + m_used + length, inode, sizeof(Inode));
+    }
+    m_used += bytes;
+    return ref;
+  }
+
+  std::size_t m_chunk_size;
+  std::vector<std::unique_ptr<char[]>> m_chunks;
+  std::size_t m_used = 0;
+  std::size_t m_capacity = 0;
+  std::size_t m_chunk_bytes = 0;
+  std::vector<std::string> m_dirs;
+  std::unordered_map<std::string, DirId> m_dir_ids;
+  DirId m_last_dir = 0;
+};
+
+#endif // PATHARENA_HPP
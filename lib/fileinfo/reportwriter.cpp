@@ -0,0 +1,176 @@
+/**
+ * @file reportwriter.cpp
+ * @brief Implementation of the buffered NDJSON/CSV report writer
+ */
+
+#include "reportwriter.hpp"
+
+ReportWriter::ReportWriter(std::FILE *out, Format format) : m_out(out), m_format(format) {
+  m_buffer.reserve(BUFFER_SIZE + 4096);
+  if (m_format == Format::Csv) {
+    append("type,group,hash,size,wasted_bytes,path\n");
+  }
+}
+
+ReportWriter::~ReportWriter() { flush(); }
+
+bool ReportWriter::parseFormat(const std::string &name, Format &format) {
+  if (name == "ndjson") {
+    format = Format::Ndjson;
+  } else if (name == "csv") {
+    format = Format::Csv;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void ReportWriter::zeroByteFile(const FileInfo &file) {
+  ++m_zero_files;
+  const std::string path = file.getPath();
+  if (m_format == Format::Ndjson) {
+    append("{\"type\":\"zero\",\"path\":");
+    appendJsonString(path);
+    append("}");
+  } else {
+    append("zero,,,0,,");
+    appendCsvField(path);
+  }
+  endRow();
+}
+
+void ReportWriter::duplicateGroup(const DuplicateFinder::DuplicateGroup &group) {
+  const long long id = static_cast<long long>(++m_groups);
+  const long long size = group.files.empty() ? 0 : group.files.front()->getFileSize();
+  m_duplicate_files += group.files.size();
+  m_wasted_bytes += group.wastedSpace;
+
+  if (m_format == Format::Ndjson) {
+    append("{\"type\":\"group\",\"group\":");
+    appendNumber(id);
+    append(",\"hash\":\"");
+    append(group.hash); // hex digits only
+    append("\",\"size\":");
+    appendNumber(size);
+    append(",\"files\":");
+    appendNumber(static_cast<std::uint64_t>(group.files.size()));
+    append(",\"wasted_bytes\":");
+    appendNumber(group.wastedSpace);
+    append(",\"paths\":[");
+    for (std::size_t i = 0; i < group.files.size(); ++i) {
+      if (i > 0)
+        append(",");
+      appendJsonString(group.files[i]->getPath());
+    }
+    append("]}");
+    endRow();
+    return;
+  }
+
+  for (const FileInfo *file : group.files) {
+    append("duplicate,");
+    appendNumber(id);
+    append(",");
+    append(group.hash);
+    append(",");
+    appendNumber(size);
+    append(",");
+    appendNumber(group.wastedSpace);
+    append(",");
+    appendCsvField(file->getPath());
+    endRow();
+  }
+}
+
+bool ReportWriter::summary(std::uint64_t files_scanned) {
+  if (m_format == Format::Ndjson) {
+    append("{\"type\":\"summary\",\"files\":");
+    appendNumber(files_scanned);
+    append(",\"zero_files\":");
+    appendNumber(m_zero_files);
+    append(",\"groups\":");
+    appendNumber(m_groups);
+    append(",\"duplicate_files\":");
+    appendNumber(m_duplicate_files);
+    append(",\"wasted_bytes\":");
+    appendNumber(m_wasted_bytes);
+    append("}");
+  } else {
+    append("summary,");
+    appendNumber(m_groups);
+    append(",,");
+    appendNumber(files_scanned);
+    append(",");
+    appendNumber(m_wasted_bytes);
+    append(",");
+  }
+  endRow();
+  return flush();
+}
+
+bool ReportWriter::flush() {
+  writeBuffer();
+  if (std::fflush(m_out) != 0)
+    m_good = false;
+  return m_good;
+}
+
+/**
+ * @brief Quotes and escapes a JSON string (RFC 8259)
+ *
+ * Control characters become \\uXXXX; other bytes are copied unchanged.
+ */
+void ReportWriter::appendJsonString(std::string_view text) {
+  static const char HEX[] = "0123456789abcdef";
+  m_buffer += '"';
+  for (char c : text) {
+    const auto byte = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') {
+      m_buffer += '\\';
+      m_buffer += c;
+    } else if (c == '\n') {
+      append("\\n");
+    } else if (c == '\t') {
+      append("\\t");
+    } else if (byte < 0x20) {
+      append("\\u00");
+      m_buffer += HEX[byte >> 4];
+      m_buffer += HEX[byte & 0xF];
+    } else {
+      m_buffer += c;
+    }
+  }
+  m_buffer += '"';
+}
+
+/**
+ * @brief Appends a CSV field, quoted if it contains a separator, quote or
+ *        line break (RFC 4180)
+ */
+void ReportWriter::appendCsvField(std::string_view text) {
+  if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+    append(text);
+    return;
+  }
+  m_buffer += '"';
+  for (char c : text) {
+    if (c == '"')
+      m_buffer += '"';
+    m_buffer += c;
+  }
+  m_buffer += '"';
+}
+
+void ReportWriter::endRow() {
+  m_buffer += '\n';
+  if (m_buffer.size() >= BUFFER_SIZE)
+    writeBuffer();
+}
+
+void ReportWriter::writeBuffer() {
+  if (m_buffer.empty())
+    return;
+  if (std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_out) != m_buffer.size())
+    m_good = false;
+  m_buffer.clear();
+}
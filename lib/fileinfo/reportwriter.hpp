@@ -0,0 +1,120 @@
+/**
+ * @file reportwriter.hpp
+ * @brief Buffered NDJSON/CSV output of duplicate and zero-byte reports
+ */
+
+#ifndef REPORTWRITER_HPP
+#define REPORTWRITER_HPP
+
+#include "duplicatefinder.hpp"
+#include "fileinfo.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+/**
+ * @class ReportWriter
+ * @brief Writes report rows for scripts and cron jobs
+ *
+ * Rows are collected in a BUFFER_SIZE buffer and written with one fwrite()
+ * whenever it is full, so millions of rows cost a few thousand writes and
+ * no flush per line.
+ *
+ * NDJSON: one object per line, distinguished by "type":
+ * @code
+ * {"type":"zero","path":"/a/empty"}
+ * {"type":"group","group":1,"hash":"...","size":4096,"files":2,"wasted_bytes":4096,"paths":["/a/x","/b/x"]}
+ * {"type":"summary","files":1000,"zero_files":1,"groups":1,"duplicate_files":2,"wasted_bytes":4096}
+ * @endcode
+ *
+ * CSV (RFC 4180 quoting) with the header type,group,hash,size,wasted_bytes,path:
+ * one "zero" row per empty file, one "duplicate" row per file of a group
+ * (wasted_bytes is the group's), and a final "summary" row whose group
+ * column holds the group count, size the number of scanned files and
+ * wasted_bytes the total.
+ *
+ * Paths are written as they are stored; names that are not valid UTF-8
+ * are not re-encoded.
+ *
+ * @note Not thread-safe; DuplicateFinder::GroupCallback never runs
+ *       concurrently
+ * @see DuplicateFinder::findDuplicates()
+ */
+class ReportWriter {
+public:
+  /** @brief Output format */
+  enum class Format { Ndjson, Csv };
+
+  /** @brief Bytes collected before they are written */
+  static constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+  /**
+   * @brief Creates a writer; the CSV header is written first
+   * @param out Destination (not closed by the writer)
+   * @param format Output format
+   */
+  ReportWriter(std::FILE *out, Format format);
+
+  /** @brief Writes the remaining buffer (see flush()) */
+  ~ReportWriter();
+
+  ReportWriter(const ReportWriter &) = delete;
+  ReportWriter &operator=(const ReportWriter &) = delete;
+
+  /**
+   * @brief Parses a format name as used on the command line
+   *
+   * Accepted names are "ndjson" and "csv".
+   *
+   * @param name Name to parse
+   * @param format Receives the format on success
+   * @return true if the name is known, false otherwise
+   */
+  static bool parseFormat(const std::string &name, Format &format);
+
+  /** @brief Adds a zero-byte file */
+  void zeroByteFile(const FileInfo &file);
+
+  /** @brief Adds a duplicate group; groups are numbered from 1 */
+  void duplicateGroup(const DuplicateFinder::DuplicateGroup &group);
+
+  /**
+   * @brief Adds the totals of all rows written so far and flushes
+   * @param files_scanned Number of scanned files, reported as is
+   * @return false if a write failed
+   */
+  bool summary(std::uint64_t files_scanned);
+
+  /**
+   * @brief Writes the buffer and flushes the stream
+   * @return false if a write failed (now or before)
+   */
+  bool flush();
+
+  /** @brief False once a write failed */
+  bool good() const { return m_good; }
+
+private:
+  std::FILE *m_out;
+  Format m_format;
+  std::string m_buffer;
+  bool m_good = true;
+
+  std::uint64_t m_zero_files = 0;
+  std::uint64_t m_groups = 0;
+  std::uint64_t m_duplicate_files = 0;
+  long long m_wasted_bytes = 0;
+
+  void append(std::string_view text) { m_buffer.append(text.data(), text.size()); }
+  void appendNumber(long long value) { m_buffer += std::to_string(value); }
+  void appendNumber(std::uint64_t value) { m_buffer += std::to_string(value); }
+  void appendJsonString(std::string_view text);
+  void appendCsvField(std::string_view text);
+  void endRow();
+  void writeBuffer();
+};
+
+#endif // REPORTWRITER_HPP
@@ -0,0 +1,96 @@
+/**
+ * @file scanpolicies.hpp
+ * @brief Compile-time policies of the FileScanner core
+ *
+ * FileScanner::scanDirectory() and scanDirectoryStreaming() pick one
+ * instantiation of their core per call from the runtime arguments; inside
+ * it, recursion, progress reporting and result delivery are fixed, so
+ * unused stages are not even compiled into the per-entry loop.
+ */
+
+#ifndef SCANPOLICIES_HPP
+#define SCANPOLICIES_HPP
+
+#include "fileinfo.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Walk policy: list the start directory only
+ *
+ * A walk policy provides:
+ * - static constexpr bool RECURSIVE: descend into subdirectories
+ * - static constexpr int PROGRESS_STEP: entries between progress reports
+ */
+struct FlatWalk {
+  static constexpr bool RECURSIVE = false;
+  static constexpr int PROGRESS_STEP = 10;
+};
+
+/** @brief Walk policy: descend into every real subdirectory */
+struct RecursiveWalk {
+  static constexpr bool RECURSIVE = true;
+  static constexpr int PROGRESS_STEP = 100;
+};
+
+/**
+ * @brief Progress policy: no reports (the entry count is not even kept)
+ *
+ * A progress policy provides:
+ * - static constexpr bool ENABLED
+ * - void report(int count): called every PROGRESS_STEP entries and once
+ *   at the end
+ */
+struct NoProgress {
+  static constexpr bool ENABLED = false;
+  void report(int) const {}
+};
+
+/** @brief Progress policy: reports to a ProgressCallback */
+struct CallbackProgress {
+  static constexpr bool ENABLED = true;
+  const std::function<void(int)> &callback;
+  void report(int count) const { callback(count); }
+};
+
+/**
+ * @brief Result sink that keeps the whole scan in one vector
+ *
+ * A sink provides:
+ * - std::vector<FileInfo> &entries() and the PathArena of new entries
+ * - bool added(): called after every entry; false stops the scan
+ * - bool flush(): called once at the end of a scan that was not stopped
+ * - std::size_t delivered(): entries handed out so far
+ *
+ * The streaming sink (FileScanner::Batch) delivers batches to a
+ * BatchCallback; this one has nothing to check per entry. As with a
+ * single batch, a stopped scan delivers nothing.
+ */
+class CollectSink {
+public:
+  /** @param results Receives the entries of a completed scan (replaced) */
+  explicit CollectSink(std::vector<FileInfo> &results)
+      : m_results(results), m_arena(std::make_shared<PathArena>()) {}
+
+  std::vector<FileInfo> &entries() { return m_entries; }
+  const std::shared_ptr<PathArena> &arena() const { return m_arena; }
+  bool added() { return true; }
+
+  bool flush() {
+    m_results = std::move(m_entries);
+    m_entries.clear();
+    return true;
+  }
+
+  std::size_t delivered() const { return m_results.size(); }
+
+private:
+  std::vector<FileInfo> m_entries;
+  std::vector<FileInfo> &m_results;
+  std::shared_ptr<PathArena> m_arena;
+};
+
+#endif // SCANPOLICIES_HPP
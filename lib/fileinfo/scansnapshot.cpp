@@ -0,0 +1,463 @@
+/**
+ * @file scansnapshot.cpp
+ * @brief Implementation of the binary scan snapshot
+ */
+
+#include "scansnapshot.hpp"
+#include "filescanner.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <system_error>
+#include <unordered_map>
+
+struct ScanSnapshot::Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint32_t header_size;
+  std::uint32_t directory_record_size;
+  std::uint32_t entry_record_size;
+  std::uint32_t flags;
+  std::uint64_t directory_count;
+  std::uint64_t entry_count;
+  std::uint64_t directories_offset;
+  std::uint64_t entries_offset;
+  std::uint64_t strings_offset;
+  std::uint64_t strings_size;
+  std::int64_t created_ns;
+  std::uint64_t root;          ///< Offset in the string table
+  std::uint32_t root_length;
+  std::uint32_t reserved;
+};
+
+struct ScanSnapshot::DirectoryRecord {
+  std::uint64_t path;          ///< Offset in the string table
+  std::uint32_t path_length;
+  std::uint32_t reserved;
+  std::uint64_t first_entry;   ///< Index into the entry table
+  std::uint64_t entry_count;
+};
+
+struct ScanSnapshot::EntryRecord {
+  std::int64_t size;
+  std::int64_t mtime_ns;
+  std::uint64_t device;
+  std::uint64_t inode;
+  std::uint64_t blocks;
+  std::uint64_t name;          ///< Offset in the string table
+  std::uint32_t links;
+  std::uint32_t group;         ///< Duplicate group id, 0 for none
+  std::uint16_t name_length;
+  std::uint8_t flags;          ///< FileInfo::Flags (see STORED_FLAGS)
+  std::uint8_t digest_length;
+  std::uint8_t digest[HashDigest::MAX_SIZE];
+  std::uint8_t reserved[4];
+};
+
+namespace {
+
+constexpr char MAGIC[8] = {'T', 'F', 'M', 'S', 'N', 'A', 'P', '1'};
+constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool LITTLE_ENDIAN_HOST = false;
+#else
+constexpr bool LITTLE_ENDIAN_HOST = true;
+#endif
+
+/** @brief Entry flags worth keeping; Parent and WholePath never occur */
+constexpr std::uint8_t STORED_FLAGS = FileInfo::Directory | FileInfo::Executable |
+                                      FileInfo::Duplicate | FileInfo::Verified |
+                                      FileInfo::HasInode;
+
+std::string errorMessage(int error) {
+  return std::error_code(error, std::generic_category()).message();
+}
+
+/** @brief Directory path as scanners produce it (no trailing slash) */
+std::string normalized(std::string path) {
+  while (path.size() > 1 && path.back() == '/') {
+    path.pop_back();
+  }
+  return path;
+}
+
+std::uint64_t aligned(std::uint64_t offset) { return (offset + 7) & ~std::uint64_t{7}; }
+
+/** @brief Fixed-size sections fit behind offset in a file of size bytes */
+bool fits(std::uint64_t offset, std::uint64_t count, std::uint64_t record,
+          std::uint64_t size) {
+  return offset <= size && offset % 8 == 0 && count <= (size - offset) / record;
+}
+
+} // namespace
+
+static_assert(sizeof(ScanSnapshot::Header) == 104, "snapshot header layout");
+static_assert(sizeof(ScanSnapshot::DirectoryRecord) == 32, "snapshot directory layout");
+static_assert(sizeof(ScanSnapshot::EntryRecord) == 80, "snapshot entry layout");
+
+/**
+ * @brief Lays out and writes the snapshot
+ *
+ * Implementation details:
+ * 1. Entries below root are ordered by directory, then by
+ *    FileScanner::entryLess(); every directory (also empty ones and the
+ *    root) gets a record, in path order
+ * 2. Group ids are the 1-based positions in groups
+ * 3. The sections are written to path.tmp-<pid> and renamed over path
+ */
+bool ScanSnapshot::write(const std::string &path, const std::string &root_path,
+                         const std::vector<FileInfo> &entries,
+                         const std::vector<DuplicateFinder::DuplicateGroup> *groups,
+                         std::string *error) {
+  auto fail = [error](std::string message) {
+    if (error)
+      *error = std::move(message);
+    return false;
+  };
+  if (!LITTLE_ENDIAN_HOST)
+    return fail("snapshots need a little-endian host");
+
+  const std::string root = normalized(root_path);
+  auto below_root = [&root](const std::string &dir) {
+    return dir == root || (dir.size() > root.size() && dir.compare(0, root.size(), root) == 0 &&
+                           (root == "/" || dir[root.size()] == '/'));
+  };
+
+  // 1. Entry order and directory records
+  std::vector<std::uint32_t> order;
+  order.reserve(entries.size());
+  for (std::uint32_t i = 0; i < entries.size(); ++i) {
+    if (!entries[i].isParentDir() && below_root(entries[i].getDirectory()))
+      order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&entries](std::uint32_t a, std::uint32_t b) {
+    const int dir = entries[a].getDirectory().compare(entries[b].getDirectory());
+    if (dir != 0)
+      return dir < 0;
+    return FileScanner::entryLess(entries[a], entries[b], false);
+  });
+
+  struct Range {
+    std::uint64_t first = 0;
+    std::uint64_t count = 0;
+  };
+  std::map<std::string, Range> directories;
+  directories[root];
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    const FileInfo &entry = entries[order[i]];
+    Range &range = directories[entry.getDirectory()];
+    if (range.count++ == 0)
+      range.first = i;
+    if (entry.isDirectory())
+      directories.emplace(entry.getPath(), Range());
+  }
+
+  // 2. Group ids
+  std::unordered_map<const FileInfo *, std::uint32_t> group_of;
+  if (groups) {
+    for (std::size_t g = 0; g < groups->size(); ++g) {
+      for (const FileInfo *file : (*groups)[g].files) {
+        group_of[file] = static_cast<std::uint32_t>(g + 1);
+      }
+    }
+  }
+
+  // String table: root, directory paths, names
+  std::string strings = root;
+  std::vector<DirectoryRecord> directory_records;
+  directory_records.reserve(directories.size());
+  for (const auto &[dir, range] : directories) {
+    DirectoryRecord record{};
+    record.path = strings.size();
+    record.path_length = static_cast<std::uint32_t>(dir.size());
+    record.first_entry = range.first;
+    record.entry_count = range.count;
+    strings += dir;
+    directory_records.push_back(record);
+  }
+
+  std::vector<EntryRecord> entry_records;
+  entry_records.reserve(order.size());
+  for (std::uint32_t i : order) {
+    const FileInfo &entry = entries[i];
+    const std::string_view name = entry.getName();
+    if (name.size() > UINT16_MAX)
+      return fail("file name too long: " + entry.getPath());
+
+    EntryRecord record{};
+    record.size = entry.getFileSize();
+    record.mtime_ns = entry.getModifiedTime();
+    if (entry.hasInode()) {
+      const PathArena::Inode inode = entry.getInode();
+      record.device = inode.device;
+      record.inode = inode.inode;
+      record.blocks = inode.blocks;
+      record.links = inode.links;
+    }
+    record.name = strings.size();
+    record.name_length = static_cast<std::uint16_t>(name.size());
+    record.flags = entry.getFlags() & STORED_FLAGS;
+    const HashDigest &digest = entry.getDigest();
+    record.digest_length = digest.length;
+    std::memcpy(record.digest, digest.bytes.data(), HashDigest::MAX_SIZE);
+    const auto group = group_of.find(&entry);
+    record.group = group == group_of.end() ? 0 : group->second;
+    strings += name;
+    entry_records.push_back(record);
+  }
+
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.byte_order = BYTE_ORDER_MARK;
+  header.header_size = sizeof(Header);
+  header.directory_record_size = sizeof(DirectoryRecord);
+  header.entry_record_size = sizeof(EntryRecord);
+  header.flags = groups ? static_cast<std::uint32_t>(DuplicatesSearched) : 0u;
+  header.directory_count = directory_records.size();
+  header.entry_count = entry_records.size();
+  header.directories_offset = aligned(sizeof(Header));
+  header.entries_offset =
+      aligned(header.directories_offset + directory_records.size() * sizeof(DirectoryRecord));
+  header.strings_offset =
+      aligned(header.entries_offset + entry_records.size() * sizeof(EntryRecord));
+  header.strings_size = strings.size();
+  header.created_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+  header.root = 0;
+  header.root_length = static_cast<std::uint32_t>(root.size());
+
+  // 3. Write under a temporary name, then rename into place
+  const std::string temp = path + ".tmp-" + std::to_string(::getpid());
+  std::FILE *out = std::fopen(temp.c_str(), "wb");
+  if (!out)
+    return fail(temp + ": " + errorMessage(errno));
+
+  std::uint64_t written = 0;
+  auto put = [&](const void *data, std::size_t size) {
+    if (size > 0 && std::fwrite(data, 1, size, out) != size)
+      return false;
+    written += size;
+    return true;
+  };
+  auto pad_to = [&](std::uint64_t offset) {
+    static const char zeros[8] = {};
+    return put(zeros, static_cast<std::size_t>(offset - written));
+  };
+  bool ok = put(&header, sizeof(header)) && pad_to(header.directories_offset) &&
+            put(directory_records.data(), directory_records.size() * sizeof(DirectoryRecord)) &&
+            pad_to(header.entries_offset) &&
+            put(entry_records.data(), entry_records.size() * sizeof(EntryRecord)) &&
+            pad_to(header.strings_offset) && put(strings.data(), strings.size());
+  ok = std::fflush(out) == 0 && ok;
+  ok = ::fsync(::fileno(out)) == 0 && ok;
+  const int write_error = errno;
+  ok = std::fclose(out) == 0 && ok;
+
+  if (!ok || ::rename(temp.c_str(), path.c_str()) != 0) {
+    const int rename_error = ok ? errno : write_error;
+    ::unlink(temp.c_str());
+    return fail(path + ": " + errorMessage(rename_error));
+  }
+  return true;
+}
+
+/**
+ * @brief Maps the file read-only and checks the header
+ *
+ * Only the header and the section bounds are checked; the records are
+ * read (and checked) when a directory is listed.
+ */
+ScanSnapshot::ScanSnapshot(const std::string &path) {
+  if (!LITTLE_ENDIAN_HOST) {
+    m_error = "snapshots need a little-endian host";
+    return;
+  }
+
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    m_error = path + ": " + errorMessage(errno);
+    return;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+    m_error = path + ": not a tfm snapshot";
+    ::close(fd);
+    return;
+  }
+
+  const auto size = static_cast<std::size_t>(st.st_size);
+  void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int map_error = errno;
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    m_error = path + ": " + errorMessage(map_error);
+    return;
+  }
+  m_data = static_cast<const unsigned char *>(data);
+  m_size = size;
+
+  const Header &h = header();
+  std::string_view root;
+  if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.byte_order != BYTE_ORDER_MARK) {
+    m_error = path + ": not a tfm snapshot";
+  } else if (h.version != VERSION) {
+    m_error = path + ": unsupported snapshot version " + std::to_string(h.version);
+  } else if (h.header_size != sizeof(Header) ||
+             h.directory_record_size != sizeof(DirectoryRecord) ||
+             h.entry_record_size != sizeof(EntryRecord) || h.directory_count == 0 ||
+             !fits(h.directories_offset, h.directory_count, sizeof(DirectoryRecord), m_size) ||
+             !fits(h.entries_offset, h.entry_count, sizeof(EntryRecord), m_size) ||
+             !fits(h.strings_offset, h.strings_size, 1, m_size) ||
+             !string(h.root, h.root_length, root)) {
+    m_error = path + ": corrupt snapshot";
+  }
+
+  if (!m_error.empty()) {
+    ::munmap(const_cast<unsigned char *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+    return;
+  }
+  ::madvise(const_cast<unsigned char *>(m_data), m_size, MADV_RANDOM);
+}
+
+ScanSnapshot::~ScanSnapshot() {
+  if (m_data) {
+    ::munmap(const_cast<unsigned char *>(m_data), m_size);
+  }
+}
+
+const ScanSnapshot::Header &ScanSnapshot::header() const {
+  // mmap() returns page-aligned memory; every section is 8-byte aligned
+  return *reinterpret_cast<const Header *>(m_data);
+}
+
+bool ScanSnapshot::string(std::uint64_t offset, std::uint32_t length,
+                          std::string_view &out) const {
+  const Header &h = header();
+  if (offset > h.strings_size || length > h.strings_size - offset)
+    return false;
+  out = std::string_view(reinterpret_cast<const char *>(m_data + h.strings_offset + offset),
+                         length);
+  return true;
+}
+
+std::string ScanSnapshot::root() const {
+  std::string_view root;
+  if (!isOpen() || !string(header().root, header().root_length, root))
+    return {};
+  return std::string(root);
+}
+
+std::uint32_t ScanSnapshot::flags() const { return isOpen() ? header().flags : 0; }
+
+std::uint64_t ScanSnapshot::entryCount() const { return isOpen() ? header().entry_count : 0; }
+
+std::uint64_t ScanSnapshot::directoryCount() const {
+  return isOpen() ? header().directory_count : 0;
+}
+
+std::int64_t ScanSnapshot::createdTime() const { return isOpen() ? header().created_ns : 0; }
+
+/** @brief Binary search over the directory table (byte-wise path order) */
+bool ScanSnapshot::findDirectory(std::string_view path, const DirectoryRecord *&record) const {
+  const Header &h = header();
+  const auto *records =
+      reinterpret_cast<const DirectoryRecord *>(m_data + h.directories_offset);
+  std::uint64_t low = 0;
+  std::uint64_t high = h.directory_count;
+  while (low < high) {
+    const std::uint64_t mid = low + (high - low) / 2;
+    std::string_view candidate;
+    if (!string(records[mid].path, records[mid].path_length, candidate))
+      return false;
+    const int cmp = candidate.compare(path);
+    if (cmp == 0) {
+      record = &records[mid];
+      return true;
+    }
+    if (cmp < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return false;
+}
+
+bool ScanSnapshot::list(const std::string &dir, bool include_parent, std::vector<FileInfo> &out,
+                        std::vector<std::uint32_t> *groups) const {
+  out.clear();
+  if (groups)
+    groups->clear();
+  if (!isOpen())
+    return false;
+
+  const std::string path = normalized(dir);
+  const DirectoryRecord *directory = nullptr;
+  if (!findDirectory(path, directory))
+    return false;
+  const Header &h = header();
+  if (directory->first_entry > h.entry_count ||
+      directory->entry_count > h.entry_count - directory->first_entry)
+    return false;
+
+  auto arena = std::make_shared<PathArena>();
+  out.reserve(directory->entry_count + (include_parent ? 1 : 0));
+  if (include_parent) {
+    // As FileScanner adds it
+    out.emplace_back(arena, std::filesystem::path(path).parent_path().native(), 0,
+                     FileInfo::Directory | FileInfo::Parent);
+    if (groups)
+      groups->push_back(0);
+  }
+
+  const auto *records = reinterpret_cast<const EntryRecord *>(m_data + h.entries_offset) +
+                        directory->first_entry;
+  std::string entry_path = path == "/" ? path : path + '/';
+  const std::size_t prefix = entry_path.size();
+  for (std::uint64_t i = 0; i < directory->entry_count; ++i) {
+    const EntryRecord &record = records[i];
+    std::string_view name;
+    if (!string(record.name, record.name_length, name) || name.empty() ||
+        record.digest_length > HashDigest::MAX_SIZE) {
+      out.clear();
+      if (groups)
+        groups->clear();
+      return false;
+    }
+
+    entry_path.resize(prefix);
+    entry_path += name;
+    PathArena::Inode inode;
+    const bool has_inode = (record.flags & FileInfo::HasInode) != 0;
+    if (has_inode) {
+      inode = {record.device, record.inode, record.blocks, record.links};
+    }
+    const auto flags = static_cast<std::uint8_t>(record.flags & STORED_FLAGS & ~FileInfo::HasInode);
+    out.emplace_back(arena, entry_path, record.size, flags, has_inode ? &inode : nullptr);
+    out.back().setModifiedTime(record.mtime_ns);
+
+    HashDigest digest;
+    digest.length = record.digest_length;
+    std::memcpy(digest.bytes.data(), record.digest, record.digest_length);
+    out.back().setDigest(digest);
+    if (groups)
+      groups->push_back(record.group);
+  }
+  return true;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file scansnapshot.hpp
+ * @brief Binary snapshot of a scan result, reloaded with mmap()
+ */
+
+#ifndef SCANSNAPSHOT_HPP
+#define SCANSNAPSHOT_HPP
+
+#include "duplicatefinder.hpp"
+#include "fileinfo.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class ScanSnapshot
+ * @brief Stores a recursive scan once and lists its directories on demand
+ *
+ * A cold scan of a large tree dominates the start of tfm. A snapshot
+ * written after a scan (tmf-cli --snapshot) holds every entry with its
+ * metadata, digest and duplicate group, laid out so that opening it costs
+ * one mmap() and a header check, independent of the entry count:
+ * - Header: magic "TFMSNAP1", format version, byte order mark, record
+ *   sizes, section offsets and counts, flags
+ * - Directory table: one record per directory (path, first entry, entry
+ *   count), sorted by path for a binary search
+ * - Entry table: fixed-size records (size, mtime, device/inode/blocks/
+ *   links, name, flags, digest, duplicate group id), grouped by directory
+ *   and sorted within each one as FileScanner::sortEntries() does
+ * - String table: paths of the directories and names of the entries
+ *
+ * All numbers are little-endian and sections are 8-byte aligned, so a
+ * snapshot written on a storage server can be browsed on a workstation;
+ * big-endian hosts reject the file. Nothing is parsed when opening: list()
+ * turns only the entries of the requested directory into FileInfo, and
+ * every offset it follows is checked against the mapped size, so a
+ * truncated or corrupt file yields errors, not crashes.
+ *
+ * @code
+ * // after the scan and duplicate search of tmf-cli
+ * ScanSnapshot::write("tree.tfmsnap", root, files, &groups);
+ *
+ * ScanSnapshot snapshot("tree.tfmsnap");
+ * std::vector<FileInfo> listing;
+ * if (snapshot.isOpen() && snapshot.list(snapshot.root(), true, listing)) { ... }
+ * @endcode
+ *
+ * @note A snapshot is immutable; list() may be called from any thread
+ */
+class ScanSnapshot {
+public:
+  /** @brief Format version written by write() and accepted by open */
+  static constexpr std::uint32_t VERSION = 1;
+
+  /** @brief Header flags */
+  enum Flags : std::uint32_t {
+    DuplicatesSearched = 1 << 0 ///< Digests and groups of a full duplicate search
+  };
+
+  /**
+   * @brief Writes a scan result
+   *
+   * The file is written under a temporary name next to path and renamed
+   * into place, so readers never see a partial snapshot.
+   *
+   * @param path Destination file
+   * @param root Scanned directory
+   * @param entries Entries of the scan below root, in any order
+   * @param groups Duplicate groups of entries (pointers into entries), or
+   *        nullptr if no duplicate search ran
+   * @param error Receives a message on failure (optional)
+   * @return false if the file could not be written
+   */
+  static bool write(const std::string &path, const std::string &root,
+                    const std::vector<FileInfo> &entries,
+                    const std::vector<DuplicateFinder::DuplicateGroup> *groups,
+                    std::string *error = nullptr);
+
+  /**
+   * @brief Maps a snapshot file
+   * @param path File written by write(); see isOpen() and error()
+   */
+  explicit ScanSnapshot(const std::string &path);
+  ~ScanSnapshot();
+
+  ScanSnapshot(const ScanSnapshot &) = delete;
+  ScanSnapshot &operator=(const ScanSnapshot &) = delete;
+
+  /** @brief True if the file is mapped and its header is valid */
+  bool isOpen() const { return m_data != nullptr; }
+
+  /** @brief Why opening failed (empty if isOpen()) */
+  const std::string &error() const { return m_error; }
+
+  /** @brief Scanned directory */
+  std::string root() const;
+
+  /** @brief Header flags (see Flags) */
+  std::uint32_t flags() const;
+
+  /** @brief True if the snapshot carries a full duplicate search */
+  bool duplicatesSearched() const { return (flags() & DuplicatesSearched) != 0; }
+
+  /** @brief Entries stored */
+  std::uint64_t entryCount() const;
+
+  /** @brief Directories stored, including the root */
+  std::uint64_t directoryCount() const;
+
+  /** @brief Time of write() in nanoseconds since the epoch */
+  std::int64_t createdTime() const;
+
+  /**
+   * @brief Materializes the listing of one directory
+   *
+   * Entries come in FileScanner::sortEntries() order and carry size,
+   * mtime, inode record, digest and their Directory, Executable,
+   * Duplicate and Verified flags; they share one new PathArena.
+   *
+   * @param dir Directory path (a trailing slash is ignored)
+   * @param include_parent If true, the parent directory (..) comes first
+   * @param out Receives the entries (replaced)
+   * @param groups Receives the duplicate group id per entry, 0 for none
+   *        (optional)
+   * @return false if the directory is not in the snapshot or its records
+   *         are corrupt
+   */
+  bool list(const std::string &dir, bool include_parent, std::vector<FileInfo> &out,
+            std::vector<std::uint32_t> *groups = nullptr) const;
+
+  /** @brief On-disk layouts (defined in scansnapshot.cpp) */
+  struct Header;
+  struct DirectoryRecord;
+  struct EntryRecord;
+
+private:
+  const Header &header() const;
+  bool string(std::uint64_t offset, std::uint32_t length, std::string_view &out) const;
+  bool findDirectory(std::string_view path, const DirectoryRecord *&record) const;
+
+  const unsigned char *m_data = nullptr;
+  std::size_t m_size = 0;
+  std::string m_error;
+};
+
+#endif // SCANSNAPSHOT_HPP
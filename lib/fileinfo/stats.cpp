@@ -0,0 +1,134 @@
+/**
+ * @file stats.cpp
+ * @brief Implementation of the process-wide counters and timers
+ */
+
+#include "stats.hpp"
+
+#include <cstdio>
+
+Stats &Stats::global() {
+  static Stats stats;
+  return stats;
+}
+
+void Stats::addTime(Timer t, std::uint64_t ns) {
+  TimerCell &cell = m_timers[static_cast<std::size_t>(t)];
+  cell.count.fetch_add(1, std::memory_order_relaxed);
+  cell.total_ns.fetch_add(ns, std::memory_order_relaxed);
+  std::uint64_t max = cell.max_ns.load(std::memory_order_relaxed);
+  while (ns > max && !cell.max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+Stats::Snapshot Stats::snapshot() const {
+  Snapshot snap;
+  for (std::size_t i = 0; i < COUNTER_COUNT; ++i) {
+    snap.counters[i] = m_counters[i].value.load(std::memory_order_relaxed);
+  }
+  for (std::size_t i = 0; i < TIMER_COUNT; ++i) {
+    snap.timers[i].count = m_timers[i].count.load(std::memory_order_relaxed);
+    snap.timers[i].total_ns = m_timers[i].total_ns.load(std::memory_order_relaxed);
+    snap.timers[i].max_ns = m_timers[i].max_ns.load(std::memory_order_relaxed);
+  }
+  return snap;
+}
+
+void Stats::reset() {
+  for (auto &cell : m_counters) {
+    cell.value.store(0, std::memory_order_relaxed);
+  }
+  for (auto &cell : m_timers) {
+    cell.count.store(0, std::memory_order_relaxed);
+    cell.total_ns.store(0, std::memory_order_relaxed);
+    cell.max_ns.store(0, std::memory_order_relaxed);
+  }
+}
+
+const char *Stats::name(Counter c) {
+  switch (c) {
+  case Counter::DirectoriesListed:
+    return "directories listed";
+  case Counter::EntriesListed:
+    return "entries listed";
+  case Counter::GetdentsCalls:
+    return "getdents calls";
+  case Counter::StatCalls:
+    return "stat calls";
+  case Counter::FilesHashed:
+    return "files hashed";
+  case Counter::BytesHashed:
+    return "bytes hashed";
+  case Counter::SampledFiles:
+    return "sample candidates";
+  case Counter::FullHashedFiles:
+    return "full hash candidates";
+  case Counter::BytesCompared:
+    return "bytes compared";
+  case Counter::LinksCollapsed:
+    return "hardlinks collapsed";
+  case Counter::RunsSpilled:
+    return "runs spilled";
+  }
+  return "?";
+}
+
+const char *Stats::name(Timer t) {
+  switch (t) {
+  case Timer::Scan:
+    return "scan";
+  case Timer::Sort:
+    return "sort";
+  case Timer::DuplicateSearch:
+    return "duplicate search";
+  case Timer::SampleHash:
+    return "sample hash";
+  case Timer::FullHash:
+    return "full hash";
+  case Timer::Verify:
+    return "verify";
+  case Timer::Frame:
+    return "frame";
+  }
+  return "?";
+}
+
+/**
+ * @brief Timers first (runs, total, average and longest run in ms), then
+ *        counters, then the rates; timers that never ran are left out
+ */
+std::vector<std::string> Stats::Snapshot::lines() const {
+  std::vector<std::string> out;
+  char line[128];
+
+  for (std::size_t i = 0; i < TIMER_COUNT; ++i) {
+    const TimerTotals &t = timers[i];
+    if (t.count == 0)
+      continue;
+    std::snprintf(line, sizeof(line), "%-20s %8llux  total %10.1f ms  avg %8.2f ms  max %8.2f ms",
+                  name(static_cast<Timer>(i)), static_cast<unsigned long long>(t.count),
+                  t.total_ns / 1e6, t.total_ns / 1e6 / static_cast<double>(t.count),
+                  t.max_ns / 1e6);
+    out.emplace_back(line);
+  }
+
+  for (std::size_t i = 0; i < COUNTER_COUNT; ++i) {
+    std::snprintf(line, sizeof(line), "%-20s %14llu", name(static_cast<Counter>(i)),
+                  static_cast<unsigned long long>(counters[i]));
+    out.emplace_back(line);
+  }
+
+  const std::uint64_t scan_ns = timer(Timer::Scan).total_ns;
+  if (scan_ns > 0) {
+    std::snprintf(line, sizeof(line), "%-20s %14.0f", "entries/s",
+                  counter(Counter::EntriesListed) * 1e9 / static_cast<double>(scan_ns));
+    out.emplace_back(line);
+  }
+  const std::uint64_t hash_ns = timer(Timer::SampleHash).total_ns + timer(Timer::FullHash).total_ns;
+  if (hash_ns > 0) {
+    std::snprintf(line, sizeof(line), "%-20s %14.1f", "hash MB/s",
+                  counter(Counter::BytesHashed) * 1e3 / static_cast<double>(hash_ns));
+    out.emplace_back(line);
+  }
+  return out;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file stats.hpp
+ * @brief Process-wide counters and phase timers for the hot paths
+ */
+
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class Stats
+ * @brief Relaxed atomic counters and timers, one cache line each
+ *
+ * Instrumented code does not touch the counters per entry or per block:
+ * it tallies locally (Tally) and adds once per directory or file, and
+ * times whole phases (ScopedTimer), so the cost stays far below the
+ * syscalls being counted.
+ *
+ * Everything is gated by TMF_STATS (CMake option ENABLE_STATS). Without
+ * it, TMF_STATS_ADD() and TMF_STATS_TIMER() expand to nothing and Tally
+ * and ScopedTimer are empty, so instrumented code compiles as if the
+ * instrumentation were not there; the global instance then stays zero.
+ *
+ * @code
+ * {
+ *   TMF_STATS_TIMER(Sort);
+ *   sortEntries(entries, true);
+ * }
+ * for (const auto &line : Stats::global().snapshot().lines())
+ *   std::cerr << line << '\n';
+ * @endcode
+ *
+ * @note Thread-safe; snapshot() is not atomic across counters
+ */
+class Stats {
+public:
+  /** @brief Event counters */
+  enum class Counter {
+    DirectoriesListed, ///< Directories opened by the scanner
+    EntriesListed,     ///< Entries delivered by the scanner
+    GetdentsCalls,     ///< getdents64() calls (native backend)
+    StatCalls,         ///< statx()/fstatat() calls (native backend)
+    FilesHashed,       ///< Sample or full hashes computed from content
+    BytesHashed,       ///< Content bytes passed to the hash engines
+    SampledFiles,      ///< Duplicate candidates sent to the sample stage
+    FullHashedFiles,   ///< Duplicate candidates sent to the full hash stage
+    BytesCompared,     ///< Content bytes compared by ContentVerifier
+    LinksCollapsed,    ///< Hardlinks not hashed: their inode was queued already
+    RunsSpilled        ///< Sorted runs written by ExternalSizeIndex
+  };
+
+  /** @brief Phase timers */
+  enum class Timer {
+    Scan,            ///< FileScanner::scanDirectoryStreaming()
+    Sort,            ///< FileScanner::sortIndices()
+    DuplicateSearch, ///< DuplicateFinder::findDuplicates()
+    SampleHash,      ///< Sample stage of the duplicate search
+    FullHash,        ///< Full hash stage of the duplicate search
+    Verify,          ///< DuplicateFinder::verifyGroups()
+    Frame            ///< Building one TUI frame
+  };
+
+  static constexpr std::size_t COUNTER_COUNT = 11;
+  static constexpr std::size_t TIMER_COUNT = 7;
+
+#ifdef TMF_STATS
+  static constexpr bool ENABLED = true;
+#else
+  static constexpr bool ENABLED = false;
+#endif
+
+  /** @brief Accumulated runs of one timer */
+  struct TimerTotals {
+    std::uint64_t count = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t max_ns = 0;
+  };
+
+  /** @brief Copy of all values */
+  struct Snapshot {
+    std::uint64_t counters[COUNTER_COUNT] = {};
+    TimerTotals timers[TIMER_COUNT] = {};
+
+    std::uint64_t counter(Counter c) const { return counters[static_cast<std::size_t>(c)]; }
+    const TimerTotals &timer(Timer t) const { return timers[static_cast<std::size_t>(t)]; }
+
+    /**
+     * @brief Formats the values for display, one line per timer, counter
+     *        and derived rate (entries/s over scan time, hash MB/s over
+     *        hash stage time)
+     */
+    std::vector<std::string> lines() const;
+  };
+
+  class Tally;
+  class ScopedTimer;
+
+  /** @brief Instance used by the TMF_STATS_* macros */
+  static Stats &global();
+
+  /** @brief Adds n to a counter */
+  void add(Counter c, std::uint64_t n) {
+    m_counters[static_cast<std::size_t>(c)].value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /** @brief Records one run of a timer */
+  void addTime(Timer t, std::uint64_t ns);
+
+  /** @brief Current values */
+  Snapshot snapshot() const;
+
+  /** @brief Sets everything to zero */
+  void reset();
+
+  /** @brief Display name of a counter */
+  static const char *name(Counter c);
+
+  /** @brief Display name of a timer */
+  static const char *name(Timer t);
+
+private:
+  struct alignas(64) CounterCell {
+    std::atomic<std::uint64_t> value{0};
+  };
+  struct alignas(64) TimerCell {
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> total_ns{0};
+    std::atomic<std::uint64_t> max_ns{0};
+  };
+
+  CounterCell m_counters[COUNTER_COUNT];
+  TimerCell m_timers[TIMER_COUNT];
+};
+
+#ifdef TMF_STATS
+
+/**
+ * @class Stats::Tally
+ * @brief Local counter added to the global one when it goes out of scope
+ */
+class Stats::Tally {
+public:
+  explicit Tally(Counter counter) : m_counter(counter) {}
+  ~Tally() {
+    if (m_value)
+      Stats::global().add(m_counter, m_value);
+  }
+  Tally(const Tally &) = delete;
+  Tally &operator=(const Tally &) = delete;
+
+  void add(std::uint64_t n = 1) { m_value += n; }
+
+private:
+  Counter m_counter;
+  std::uint64_t m_value = 0;
+};
+
+/**
+ * @class Stats::ScopedTimer
+ * @brief Records the time from construction to destruction
+ */
+class Stats::ScopedTimer {
+public:
+  explicit ScopedTimer(Timer timer)
+      : m_timer(timer), m_start(std::chrono::steady_clock::now()) {}
+  ~ScopedTimer() {
+    const auto elapsed = std::chrono::steady_clock::now() - m_start;
+    Stats::global().addTime(
+        m_timer, static_cast<std::uint64_t>(
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+  }
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+  Timer m_timer;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+#define TMF_STATS_CONCAT_(a, b) a##b
+#define TMF_STATS_CONCAT(a, b) TMF_STATS_CONCAT_(a, b)
+
+/** @brief Adds n to Stats::Counter::counter */
+#define TMF_STATS_ADD(counter, n) Stats::global().add(Stats::Counter::counter, (n))
+
+/** @brief Times the rest of the enclosing scope as Stats::Timer::timer */
+#define TMF_STATS_TIMER(timer)                                                               \
+  Stats::ScopedTimer TMF_STATS_CONCAT(tmf_stats_timer_, __LINE__)(Stats::Timer::timer)
+
+#else // !TMF_STATS
+
+class Stats::Tally {
+public:
+  explicit Tally(Counter) {}
+  void add(std::uint64_t = 1) {}
+};
+
+class Stats::ScopedTimer {
+public:
+  explicit ScopedTimer(Timer) {}
+};
+
+#define TMF_STATS_ADD(counter, n) ((void)0)
+#define TMF_STATS_TIMER(timer) ((void)0)
+
+#endif // TMF_STATS
+
+#endif // STATS_HPP
@@ -0,0 +1,71 @@
+/**
+ * @file stoptoken.hpp
+ * @brief Cooperative cancellation shared between a requester and workers
+ */
+
+#ifndef STOPTOKEN_HPP
+#define STOPTOKEN_HPP
+
+#include <atomic>
+#include <memory>
+
+/**
+ * @class StopToken
+ * @brief Read side of a StopSource, checked by long-running work
+ *
+ * Checking is one relaxed atomic load, cheap enough for every directory
+ * entry. A default-constructed token is never stopped.
+ *
+ * @see StopSource
+ */
+class StopToken {
+public:
+  StopToken() = default;
+
+  /** @brief True once the source requested a stop */
+  bool stopRequested() const {
+    return m_state && m_state->load(std::memory_order_relaxed);
+  }
+
+  /** @brief False for a default-constructed token */
+  bool stopPossible() const { return m_state != nullptr; }
+
+private:
+  friend class StopSource;
+  explicit StopToken(std::shared_ptr<const std::atomic<bool>> state)
+      : m_state(std::move(state)) {}
+
+  std::shared_ptr<const std::atomic<bool>> m_state;
+};
+
+/**
+ * @class StopSource
+ * @brief Requests a stop of the work holding its tokens
+ *
+ * The C++17 counterpart of std::stop_source without callbacks: workers
+ * poll their StopToken. Copies share the same state.
+ *
+ * @code
+ * StopSource stop;
+ * scanner.setStopToken(stop.token());
+ * // another thread: stop.requestStop();
+ * @endcode
+ */
+class StopSource {
+public:
+  StopSource() : m_state(std::make_shared<std::atomic<bool>>(false)) {}
+
+  /** @brief Token observing this source */
+  StopToken token() const { return StopToken(m_state); }
+
+  /** @brief Asks all token holders to stop (thread-safe, idempotent) */
+  void requestStop() { m_state->store(true, std::memory_order_relaxed); }
+
+  /** @brief True once requestStop() was called */
+  bool stopRequested() const { return m_state->load(std::memory_order_relaxed); }
+
+private:
+  std::shared_ptr<std::atomic<bool>> m_state;
+};
+
+#endif // STOPTOKEN_HPP
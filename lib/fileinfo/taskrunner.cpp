@@ -0,0 +1,81 @@
+/**
+ * @file taskrunner.cpp
+ * @brief Implementation of the supersede-on-run background worker
+ */
+
+#include "taskrunner.hpp"
+
+TaskRunner::~TaskRunner() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shutdown = true;
+    m_pending = nullptr;
+    m_stop.requestStop();
+  }
+  m_wake.notify_one();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void TaskRunner::run(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop.requestStop();
+    m_pending = std::move(task);
+    if (!m_thread.joinable()) {
+      m_thread = std::thread(&TaskRunner::loop, this);
+    }
+  }
+  m_wake.notify_one();
+}
+
+void TaskRunner::cancel() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stop.requestStop();
+  m_pending = nullptr;
+  if (!m_running) {
+    m_idle.notify_all();
+  }
+}
+
+void TaskRunner::wait() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_idle.wait(lock, [this] { return !m_running && !m_pending; });
+}
+
+bool TaskRunner::busy() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_running || m_pending;
+}
+
+/**
+ * @brief Worker loop: takes the queued task with a fresh stop source
+ */
+void TaskRunner::loop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;) {
+    m_wake.wait(lock, [this] { return m_shutdown || m_pending; });
+    if (m_shutdown) {
+      break;
+    }
+
+    Task task = std::move(m_pending);
+    m_pending = nullptr;
+    m_stop = StopSource();
+    const StopToken token = m_stop.token();
+    m_running = true;
+
+    lock.unlock();
+    task(token);
+    task = nullptr; // release captures before reporting idle
+    lock.lock();
+
+    m_running = false;
+    if (!m_pending) {
+      m_idle.notify_all();
+    }
+  }
+  m_running = false;
+  m_idle.notify_all();
+}
@@ -0,0 +1,81 @@
+/**
+ * @file taskrunner.hpp
+ * @brief Persistent worker thread that runs only the newest task
+ */
+
+#ifndef TASKRUNNER_HPP
+#define TASKRUNNER_HPP
+
+#include "stoptoken.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class TaskRunner
+ * @brief Runs background tasks one at a time; a new task supersedes the old
+ *
+ * run() never waits: it requests a stop of the running task through its
+ * StopToken and queues the new one, replacing a queued task that has not
+ * started yet. The task runs as soon as the stopped one returns, on the
+ * same thread, which lives as long as the runner (started on first use).
+ *
+ * This is the shape of directory loads while navigating: only the last
+ * directory matters, and abandoned scans must neither block the caller
+ * nor keep running.
+ *
+ * @code
+ * TaskRunner loader;
+ * loader.run([path](const StopToken &stop) {
+ *   FileScanner scanner;
+ *   scanner.setStopToken(stop);
+ *   scanner.scanDirectory(path, false, true, nullptr);
+ * });
+ * @endcode
+ *
+ * @note Tasks must poll their token to end early; a task ignoring it
+ *       delays its successor, not the caller
+ */
+class TaskRunner {
+public:
+  using Task = std::function<void(const StopToken &)>;
+
+  TaskRunner() = default;
+
+  /** @brief Stops the running task, drops a queued one and joins */
+  ~TaskRunner();
+
+  TaskRunner(const TaskRunner &) = delete;
+  TaskRunner &operator=(const TaskRunner &) = delete;
+
+  /**
+   * @brief Queues a task and asks the running one to stop
+   * @param task Task to run; receives the token of its own stop source
+   */
+  void run(Task task);
+
+  /** @brief Asks the running task to stop and drops a queued one */
+  void cancel();
+
+  /** @brief Blocks until no task is running or queued */
+  void wait();
+
+  /** @brief True while a task is running or queued */
+  bool busy() const;
+
+private:
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_idle;
+  Task m_pending;
+  StopSource m_stop; ///< Source of the running task
+  bool m_running = false;
+  bool m_shutdown = false;
+  std::thread m_thread;
+
+  void loop();
+};
+
+#endif // TASKRUNNER_HPP
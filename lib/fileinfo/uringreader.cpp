@@ -0,0 +1,455 @@
+/**
+ * @file uringreader.cpp
+ * @brief io_uring file reading (raw syscalls, Linux only)
+ */
+
+#include "uringreader.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define TFM_HAVE_IO_URING 1
+#endif
+
+#ifdef TFM_HAVE_IO_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// <linux/fs.h> (via io_uring.h) defines BLOCK_SIZE, clashing with FileReader
+#undef BLOCK_SIZE
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+#ifdef TFM_HAVE_IO_URING
+
+namespace {
+
+/** @brief Bytes per buffer slot: one block plus room for O_DIRECT alignment */
+constexpr std::size_t SLOT_SIZE = FileReader::BLOCK_SIZE + UringReader::ALIGNMENT;
+
+/** @brief Set once io_uring turned out to be unusable on this system */
+std::atomic<bool> g_unusable{false};
+
+std::size_t alignDown(std::uint64_t value) {
+  return static_cast<std::size_t>(value & ~std::uint64_t(UringReader::ALIGNMENT - 1));
+}
+
+std::size_t alignUp(std::size_t value) {
+  return (value + UringReader::ALIGNMENT - 1) & ~(UringReader::ALIGNMENT - 1);
+}
+
+/** @brief Number of BLOCK_SIZE chunks of a file */
+std::size_t blockCount(std::uint64_t size) {
+  return static_cast<std::size_t>((size + FileReader::BLOCK_SIZE - 1) / FileReader::BLOCK_SIZE);
+}
+
+/** @brief Length of chunk i of a file */
+std::size_t blockLength(std::uint64_t size, std::size_t i) {
+  const std::uint64_t rest = size - std::uint64_t(i) * FileReader::BLOCK_SIZE;
+  return static_cast<std::size_t>(rest < FileReader::BLOCK_SIZE ? rest : FileReader::BLOCK_SIZE);
+}
+
+/** @brief Closes a file descriptor when leaving scope */
+struct FdGuard {
+  int fd;
+  ~FdGuard() {
+    if (fd >= 0)
+      ::close(fd);
+  }
+};
+
+} // namespace
+
+/**
+ * @brief Mapped submission and completion rings plus the buffer pool
+ */
+struct UringReader::Ring {
+  int fd = -1;
+
+  void *sq_ptr = MAP_FAILED;
+  std::size_t sq_size = 0;
+  void *cq_ptr = MAP_FAILED;
+  std::size_t cq_size = 0;
+  io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+  std::size_t sqes_size = 0;
+
+  unsigned *sq_tail = nullptr;
+  unsigned *sq_mask = nullptr;
+  unsigned *sq_array = nullptr;
+  unsigned *cq_head = nullptr;
+  unsigned *cq_tail = nullptr;
+  unsigned *cq_mask = nullptr;
+  io_uring_cqe *cqes = nullptr;
+
+  unsigned to_submit = 0;
+  std::uint8_t *buffers = nullptr;
+
+  ~Ring() {
+    if (sqes != MAP_FAILED)
+      ::munmap(sqes, sqes_size);
+    if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr)
+      ::munmap(cq_ptr, cq_size);
+    if (sq_ptr != MAP_FAILED)
+      ::munmap(sq_ptr, sq_size);
+    if (fd >= 0)
+      ::close(fd);
+    std::free(buffers);
+  }
+
+  bool setup() {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    fd = static_cast<int>(::syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params));
+    if (fd < 0)
+      return false;
+
+    sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap)
+      sq_size = cq_size = sq_size > cq_size ? sq_size : cq_size;
+
+    sq_ptr = ::mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED)
+      return false;
+    cq_ptr = single_mmap ? sq_ptr
+                         : ::mmap(nullptr, cq_size, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ptr == MAP_FAILED)
+      return false;
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe *>(::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_POPULATE, fd,
+                                              IORING_OFF_SQES));
+    if (sqes == MAP_FAILED)
+      return false;
+
+    auto *sq = static_cast<std::uint8_t *>(sq_ptr);
+    auto *cq = static_cast<std::uint8_t *>(cq_ptr);
+    sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    void *pool = nullptr;
+    if (::posix_memalign(&pool, ALIGNMENT, QUEUE_DEPTH * SLOT_SIZE) != 0)
+      return false;
+    buffers = static_cast<std::uint8_t *>(pool);
+    return true;
+  }
+
+  std::uint8_t *buffer(unsigned slot) const { return buffers + slot * SLOT_SIZE; }
+
+  /** @brief Queues a read; submitted by the next enter() */
+  void prepareRead(int file, unsigned slot, std::uint8_t *dest, std::size_t length,
+                   std::uint64_t offset) {
+    const unsigned tail = *sq_tail; // only this thread writes the tail
+    const unsigned index = tail & *sq_mask;
+    io_uring_sqe &sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = file;
+    sqe.addr = reinterpret_cast<std::uint64_t>(dest);
+    sqe.len = static_cast<std::uint32_t>(length);
+    sqe.off = offset;
+    sqe.user_data = slot;
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++to_submit;
+  }
+
+  /** @brief Submits queued reads and waits for at least wait_for completions */
+  bool enter(unsigned wait_for) {
+    for (;;) {
+      long ret = ::syscall(__NR_io_uring_enter, fd, to_submit, wait_for,
+                           wait_for ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+      if (ret >= 0) {
+        to_submit -= static_cast<unsigned>(ret) < to_submit ? static_cast<unsigned>(ret)
+                                                            : to_submit;
+        return true;
+      }
+      if (errno != EINTR)
+        return false;
+    }
+  }
+
+  /** @brief Takes one completion, if any */
+  bool popCompletion(std::uint64_t &user_data, int &res) {
+    const unsigned head = *cq_head;
+    if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+      return false;
+    const io_uring_cqe &cqe = cqes[head & *cq_mask];
+    user_data = cqe.user_data;
+    res = cqe.res;
+    __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+};
+
+UringReader::UringReader(std::unique_ptr<Ring> ring) : m_ring(std::move(ring)) {}
+
+UringReader::~UringReader() = default;
+
+/**
+ * @brief Ring of the calling thread
+ *
+ * Created on first use and kept until the thread exits. A failed setup
+ * (ENOSYS, EPERM from seccomp, ...) disables io_uring for the process.
+ */
+UringReader *UringReader::forThread() {
+  if (g_unusable.load(std::memory_order_relaxed))
+    return nullptr;
+
+  thread_local std::unique_ptr<UringReader> reader;
+  if (!reader) {
+    auto ring = std::make_unique<Ring>();
+    if (!ring->setup()) {
+      g_unusable.store(true, std::memory_order_relaxed);
+      return nullptr;
+    }
+    reader.reset(new UringReader(std::move(ring)));
+  }
+  return reader.get();
+}
+
+/**
+ * @brief Opens a regular file for reading, with O_DIRECT if requested and possible
+ * @param fd Receives the descriptor on Ok
+ * @param size Receives the file size on Ok
+ * @return Unsupported for anything but regular files (pipes, devices)
+ */
+UringReader::Result UringReader::openFile(const std::string &path, bool direct, int &fd,
+                                          std::uint64_t &size) const {
+  fd = -1;
+  if (direct) {
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+  }
+  if (fd < 0) {
+    // Not requested, or the file system has no O_DIRECT (e.g. tmpfs)
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  }
+  if (fd < 0)
+    return Result::Error;
+
+  struct stat st;
+  const bool ok = ::fstat(fd, &st) == 0;
+  if (!ok || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    fd = -1;
+    return ok ? Result::Unsupported : Result::Error;
+  }
+  size = static_cast<std::uint64_t>(st.st_size);
+  return Result::Ok;
+}
+
+/**
+ * @brief Reads byte ranges with up to QUEUE_DEPTH reads in flight
+ *
+ * Range i is read into slot i % QUEUE_DEPTH, so at most QUEUE_DEPTH
+ * consecutive ranges are outstanding; completed ranges are consumed
+ * strictly in order. Direct reads are widened to ALIGNMENT boundaries and
+ * the consumer gets the requested part. Short reads are resubmitted for
+ * the remainder; a read hitting the end of file early means the file
+ * shrank and fails the whole read.
+ *
+ * All submitted reads are completed before returning, so buffers and the
+ * descriptor are never released while the kernel still uses them.
+ *
+ * @param fd Open file
+ * @param direct fd was opened with O_DIRECT
+ * @param count Number of ranges
+ * @param range_at Returns range i (each at most BLOCK_SIZE bytes)
+ * @param consume Receives the ranges in order
+ */
+template <typename RangeAt>
+UringReader::Result UringReader::readRanges(int fd, bool direct, std::size_t count,
+                                            RangeAt range_at,
+                                            const FileReader::BlockConsumer &consume) {
+  struct Slot {
+    std::uint64_t start = 0; ///< File offset of the (aligned) request
+    std::size_t skip = 0;    ///< Bytes before the requested range
+    std::size_t need = 0;    ///< skip + range length
+    std::size_t request = 0; ///< Bytes requested from the kernel
+    std::size_t done = 0;
+    bool complete = false;
+  };
+  Slot slots[QUEUE_DEPTH];
+  Ring &ring = *m_ring;
+
+  auto submit = [&](unsigned slot) {
+    Slot &s = slots[slot];
+    ring.prepareRead(fd, slot, ring.buffer(slot) + s.done, s.request - s.done,
+                     s.start + s.done);
+  };
+
+  auto start = [&](std::size_t index) {
+    const unsigned slot = static_cast<unsigned>(index % QUEUE_DEPTH);
+    const Range range = range_at(index);
+    Slot &s = slots[slot];
+    s.start = direct ? alignDown(range.offset) : range.offset;
+    s.skip = static_cast<std::size_t>(range.offset - s.start);
+    s.need = s.skip + range.length;
+    s.request = direct ? alignUp(s.need) : s.need;
+    s.done = 0;
+    s.complete = false;
+    submit(slot);
+  };
+
+  std::size_t next_submit = 0;
+  std::size_t next_consume = 0;
+  unsigned in_flight = 0;
+  Result result = Result::Ok;
+
+  for (; next_submit < count && next_submit < QUEUE_DEPTH; ++next_submit, ++in_flight) {
+    start(next_submit);
+  }
+
+  while (next_consume < count && result == Result::Ok) {
+    const unsigned slot = static_cast<unsigned>(next_consume % QUEUE_DEPTH);
+    if (slots[slot].complete) {
+      consume(ring.buffer(slot) + slots[slot].skip, slots[slot].need - slots[slot].skip);
+      ++next_consume;
+      if (next_submit < count) {
+        start(next_submit++);
+        ++in_flight;
+      }
+      continue;
+    }
+
+    if (!ring.enter(1)) {
+      result = Result::Unsupported;
+      break;
+    }
+
+    std::uint64_t user_data;
+    int res;
+    while (ring.popCompletion(user_data, res)) {
+      const unsigned done_slot = static_cast<unsigned>(user_data);
+      Slot &s = slots[done_slot];
+      --in_flight;
+
+      if (res == -EINTR || res == -EAGAIN) {
+        submit(done_slot);
+        ++in_flight;
+      } else if (res == -EINVAL || res == -EOPNOTSUPP) {
+        // Opcode unknown to the kernel, or O_DIRECT refused by the file system
+        if (!direct)
+          g_unusable.store(true, std::memory_order_relaxed);
+        result = Result::Unsupported;
+      } else if (res <= 0) {
+        result = Result::Error; // I/O error, or the file shrank
+      } else {
+        s.done += static_cast<std::size_t>(res);
+        if (s.done >= s.need) {
+          s.complete = true;
+        } else {
+          submit(done_slot);
+          ++in_flight;
+        }
+      }
+    }
+  }
+
+  // Never leave reads into our buffers behind
+  while (in_flight > 0 && ring.enter(1)) {
+    std::uint64_t user_data;
+    int res;
+    while (ring.popCompletion(user_data, res)) {
+      --in_flight;
+    }
+  }
+  if (in_flight > 0) {
+    // The ring is broken; do not reuse buffers the kernel might still write
+    m_ring.release();
+    g_unusable.store(true, std::memory_order_relaxed);
+  }
+
+  // A fallback would pass the consumed ranges a second time
+  if (result == Result::Unsupported && next_consume > 0)
+    result = Result::Error;
+  return result;
+}
+
+UringReader::Result UringReader::readAll(const std::string &path, bool direct,
+                                         const FileReader::BlockConsumer &consume) {
+  std::uint64_t size = 0;
+  FdGuard guard{-1};
+  const Result opened = openFile(path, direct, guard.fd, size);
+  if (opened != Result::Ok)
+    return opened;
+
+  const bool is_direct = direct && (::fcntl(guard.fd, F_GETFL) & O_DIRECT);
+  return readRanges(guard.fd, is_direct, blockCount(size),
+                    [size](std::size_t i) {
+                      return Range{std::uint64_t(i) * FileReader::BLOCK_SIZE,
+                                   blockLength(size, i)};
+                    },
+                    consume);
+}
+
+UringReader::Result UringReader::readHeadTail(const std::string &path,
+                                              std::size_t sampleSize, bool direct,
+                                              const FileReader::BlockConsumer &consume) {
+  if (sampleSize == 0 || sampleSize > FileReader::BLOCK_SIZE)
+    return Result::Error;
+
+  std::uint64_t size = 0;
+  FdGuard guard{-1};
+  const Result opened = openFile(path, direct, guard.fd, size);
+  if (opened != Result::Ok)
+    return opened;
+
+  const bool is_direct = direct && (::fcntl(guard.fd, F_GETFL) & O_DIRECT);
+
+  // Whole file fits into the sample window: pass it exactly once
+  if (size <= 2 * sampleSize) {
+    return readRanges(guard.fd, is_direct, blockCount(size),
+                      [size](std::size_t i) {
+                        return Range{std::uint64_t(i) * FileReader::BLOCK_SIZE,
+                                     blockLength(size, i)};
+                      },
+                      consume);
+  }
+
+  const Range ranges[2] = {{0, sampleSize}, {size - sampleSize, sampleSize}};
+  return readRanges(guard.fd, is_direct, 2,
+                    [&ranges](std::size_t i) { return ranges[i]; }, consume);
+}
+
+#else // !TFM_HAVE_IO_URING
+
+struct UringReader::Ring {};
+
+UringReader::UringReader(std::unique_ptr<Ring> ring) : m_ring(std::move(ring)) {}
+
+UringReader::~UringReader() = default;
+
+UringReader *UringReader::forThread() { return nullptr; }
+
+UringReader::Result UringReader::openFile(const std::string &, bool, int &fd,
+                                          std::uint64_t &) const {
+  fd = -1;
+  return Result::Unsupported;
+}
+
+UringReader::Result UringReader::readAll(const std::string &, bool,
+                                         const FileReader::BlockConsumer &) {
+  return Result::Unsupported;
+}
+
+UringReader::Result UringReader::readHeadTail(const std::string &, std::size_t, bool,
+                                              const FileReader::BlockConsumer &) {
+  return Result::Unsupported;
+}
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file uringreader.hpp
+ * @brief io_uring based file reading with many outstanding reads
+ */
+
+#ifndef URINGREADER_HPP
+#define URINGREADER_HPP
+
+#include "filereader.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @class UringReader
+ * @brief Reads files through a per-thread io_uring
+ *
+ * Keeps up to QUEUE_DEPTH block reads of one file in flight, so a single
+ * hashing thread has a deep I/O queue on NVMe arrays and overlaps the
+ * round trips of network file systems. Blocks are handed to the consumer
+ * in file order. Reads go into a pool of ALIGNMENT-aligned buffers that
+ * lives as long as the thread's ring, which also makes O_DIRECT possible:
+ * direct reads bypass (and therefore do not evict) the page cache.
+ *
+ * The ring is set up with raw syscalls (no liburing dependency). If the
+ * kernel, a seccomp policy or the file system refuses io_uring, read
+ * functions report Unsupported and FileReader falls back to blocking
+ * reads.
+ *
+ * @note One instance per thread (see forThread()); not thread-safe
+ * @see FileReader::ReadMode
+ */
+class UringReader {
+public:
+  /** @brief Reads kept in flight per file */
+  static constexpr unsigned QUEUE_DEPTH = 8;
+
+  /** @brief Buffer and O_DIRECT alignment */
+  static constexpr std::size_t ALIGNMENT = 4096;
+
+  /** @brief Outcome of a read call */
+  enum class Result {
+    Ok,         ///< Content passed to the consumer completely
+    Error,      ///< I/O error or file changed while reading
+    Unsupported ///< io_uring cannot be used; nothing was consumed, fall back
+  };
+
+  ~UringReader();
+
+  UringReader(const UringReader &) = delete;
+  UringReader &operator=(const UringReader &) = delete;
+
+  /**
+   * @brief Ring of the calling thread, created on first use
+   * @return nullptr if io_uring is not available on this system
+   */
+  static UringReader *forThread();
+
+  /**
+   * @brief Reads a whole file in FileReader::BLOCK_SIZE chunks
+   * @param path File to read
+   * @param direct Open with O_DIRECT (silently buffered where unsupported)
+   * @param consume Receives the chunks in order
+   */
+  Result readAll(const std::string &path, bool direct,
+                 const FileReader::BlockConsumer &consume);
+
+  /**
+   * @brief Reads the first and last sampleSize bytes (both in flight at once)
+   *
+   * Same contract as FileReader::readHeadTail().
+   */
+  Result readHeadTail(const std::string &path, std::size_t sampleSize, bool direct,
+                      const FileReader::BlockConsumer &consume);
+
+private:
+  struct Ring;
+  struct Range {
+    std::uint64_t offset;
+    std::size_t length;
+  };
+
+  std::unique_ptr<Ring> m_ring;
+
+  explicit UringReader(std::unique_ptr<Ring> ring);
+
+  Result openFile(const std::string &path, bool direct, int &fd, std::uint64_t &size) const;
+
+  template <typename RangeAt>
+  Result readRanges(int fd, bool direct, std::size_t count, RangeAt range_at,
+                    const FileReader::BlockConsumer &consume);
+};
+
+#endif // URINGREADER_HPP
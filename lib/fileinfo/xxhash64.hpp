@@ -0,0 +1,158 @@
+/**
+ * @file xxhash64.hpp
+ * @brief Streaming XXH64 implementation (no external dependency)
+ */
+
+#ifndef XXHASH64_HPP
+#define XXHASH64_HPP
+
+#include "blockhashcalculator.hpp"
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Streaming state of the 64-bit xxHash algorithm (XXH64, seed 0)
+ *
+ * Processes 32-byte stripes in four independent accumulators and reaches
+ * several GB/s per core, far beyond byte-serial FNV-1a.
+ *
+ * @see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+ */
+struct Xxh64Engine {
+  static constexpr const char *NAME = "xxh64";
+
+  static constexpr uint64_t P1 = 0x9E3779B185EBCA87ULL;
+  static constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+  static constexpr uint64_t P3 = 0x165667B19E3779F9ULL;
+  static constexpr uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+  static constexpr uint64_t P5 = 0x27D4EB2F165667C5ULL;
+
+  uint64_t v[4] = {P1 + P2, P2, 0, 0 - P1};
+  std::uint8_t pending[32];
+  std::size_t pending_size = 0;
+  uint64_t total = 0;
+
+  void update(const std::uint8_t *data, std::size_t size) {
+    total += size;
+
+    if (pending_size > 0) {
+      std::size_t take = 32 - pending_size < size ? 32 - pending_size : size;
+      std::memcpy(pending + pending_size, data, take);
+      pending_size += take;
+      data += take;
+      size -= take;
+      if (pending_size < 32)
+        return;
+      consumeStripe(pending);
+      pending_size = 0;
+    }
+
+    // Keep the accumulators in registers for the bulk loop
+    if (size >= 32) {
+      uint64_t a0 = v[0], a1 = v[1], a2 = v[2], a3 = v[3];
+      do {
+        a0 = round(a0, read64(data));
+        a1 = round(a1, read64(data + 8));
+        a2 = round(a2, read64(data + 16));
+        a3 = round(a3, read64(data + 24));
+        data += 32;
+        size -= 32;
+      } while (size >= 32);
+      v[0] = a0;
+      v[1] = a1;
+      v[2] = a2;
+      v[3] = a3;
+    }
+
+    std::memcpy(pending, data, size);
+    pending_size = size;
+  }
+
+  HashDigest digest() const {
+    uint64_t h;
+    if (total >= 32) {
+      h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+      for (uint64_t acc : v)
+        h = mergeRound(h, acc);
+    } else {
+      h = P5;
+    }
+    h += total;
+
+    const std::uint8_t *p = pending;
+    std::size_t left = pending_size;
+    while (left >= 8) {
+      h ^= round(0, read64(p));
+      h = rotl(h, 27) * P1 + P4;
+      p += 8;
+      left -= 8;
+    }
+    if (left >= 4) {
+      h ^= static_cast<uint64_t>(read32(p)) * P1;
+      h = rotl(h, 23) * P2 + P3;
+      p += 4;
+      left -= 4;
+    }
+    while (left > 0) {
+      h ^= *p * P5;
+      h = rotl(h, 11) * P1;
+      ++p;
+      --left;
+    }
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+
+    return HashDigest::fromUint64(h);
+  }
+
+private:
+  static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+  static uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * P2;
+    return rotl(acc, 31) * P1;
+  }
+
+  static uint64_t mergeRound(uint64_t acc, uint64_t val) {
+    acc ^= round(0, val);
+    return acc * P1 + P4;
+  }
+
+  // xxHash is defined on little-endian input
+  static uint64_t read64(const std::uint8_t *p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+#else
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i)
+      value = (value << 8) | p[i];
+    return value;
+#endif
+  }
+
+  static uint32_t read32(const std::uint8_t *p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+  }
+
+  void consumeStripe(const std::uint8_t *p) {
+    v[0] = round(v[0], read64(p));
+    v[1] = round(v[1], read64(p + 8));
+    v[2] = round(v[2], read64(p + 16));
+    v[3] = round(v[3], read64(p + 24));
+  }
+};
+
+/**
+ * @brief XXH64 hash calculator
+ * @see Xxh64Engine
+ */
+class XXHash64 : public BlockHashCalculator<Xxh64Engine> {};
+
+#endif // XXHASH64_HPP
@@ -0,0 +1,139 @@
+/**
+ * @file test_consolidator.cpp
+ * @brief Unit tests for hardlink/reflink consolidation
+ *
+ * @see Consolidator
+ */
+
+#include <gtest/gtest.h>
+#include "consolidator.hpp"
+#include "filescanner.hpp"
+#include "fnv1a.hpp"
+#include "mounttable.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+
+/**
+ * @class ConsolidatorTest
+ * @brief Finds and verifies duplicates in a temporary directory
+ */
+class ConsolidatorTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::vector<FileInfo> files;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "consolidator_test";
+        std::filesystem::remove_all(test_dir);
+        std::filesystem::create_directories(test_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    void createFile(const std::string& name, const std::string& content) {
+        std::ofstream file(test_dir / name, std::ios::binary);
+        file << content;
+    }
+
+    std::vector<DuplicateFinder::DuplicateGroup> verifiedGroups() {
+        FileScanner scanner;
+        files = scanner.scanDirectory(test_dir, false, false);
+        FNV1A hasher;
+        auto groups = DuplicateFinder::findDuplicates(files, hasher);
+        return DuplicateFinder::verifyGroups(groups, 1);
+    }
+
+    ino_t inode(const std::string& name) {
+        struct stat st;
+        return ::stat((test_dir / name).c_str(), &st) == 0 ? st.st_ino : 0;
+    }
+};
+
+/**
+ * @test HardlinksCopiesAndKeepsPaths
+ * @brief Every copy shares the kept inode afterwards, all paths remain
+ */
+TEST_F(ConsolidatorTest, HardlinksCopiesAndKeepsPaths) {
+    createFile("a.txt", "duplicate content");
+    createFile("b.txt", "duplicate content");
+    createFile("c.txt", "duplicate content");
+    createFile("unique.txt", "something else");
+
+    auto groups = verifiedGroups();
+    Consolidator consolidator(Consolidator::Method::Hardlink, 2);
+    auto report = consolidator.run(groups);
+
+    EXPECT_EQ(report.hardlinked, 2u);
+    EXPECT_TRUE(report.failed.empty());
+    EXPECT_GT(report.reclaimed, 0);
+    EXPECT_EQ(inode("a.txt"), inode("b.txt"));
+    EXPECT_EQ(inode("a.txt"), inode("c.txt"));
+    EXPECT_NE(inode("a.txt"), inode("unique.txt"));
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(test_dir),
+                            std::filesystem::directory_iterator()), 4);
+}
+
+/**
+ * @test SkipsSharedUnverifiedAndChanged
+ * @brief Existing links, unverified groups and changed files stay untouched
+ */
+TEST_F(ConsolidatorTest, SkipsSharedUnverifiedAndChanged) {
+    createFile("a.txt", "same");
+    std::filesystem::create_hard_link(test_dir / "a.txt", test_dir / "link.txt");
+    createFile("b.txt", "same");
+
+    auto groups = verifiedGroups();
+    ASSERT_EQ(groups.size(), 1u);
+    createFile("b.txt", "SAME"); // same size, new mtime
+
+    auto unverified = groups;
+    unverified[0].verified = false;
+
+    Consolidator consolidator(Consolidator::Method::Hardlink, 1);
+    auto report = consolidator.run(unverified);
+    EXPECT_EQ(report.unverified, 3u);
+    EXPECT_TRUE(report.replaced.empty());
+
+    report = consolidator.run(groups);
+    EXPECT_EQ(report.already_shared, 1u);
+    EXPECT_EQ(report.hardlinked, 0u);
+}
+
+/**
+ * @test FailedReflinkLeavesCopy
+ * @brief Without FICLONE support the copy stays and no temporary remains
+ */
+TEST_F(ConsolidatorTest, FailedReflinkLeavesCopy) {
+    if (Consolidator::supportsReflink(
+            MountTable::global().snapshot()->find(test_dir.string())->fstype)) {
+        GTEST_SKIP() << "temporary directory supports reflinks";
+    }
+    createFile("a.txt", "content");
+    createFile("b.txt", "content");
+
+    auto groups = verifiedGroups();
+    Consolidator consolidator(Consolidator::Method::Reflink, 1);
+    auto report = consolidator.run(groups);
+
+    EXPECT_EQ(report.reflinked, 0u);
+    EXPECT_EQ(report.failed.size(), 1u);
+    EXPECT_NE(inode("a.txt"), inode("b.txt"));
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(test_dir),
+                            std::filesystem::directory_iterator()), 2);
+}
+
+/**
+ * @test ParsesMethods
+ * @brief Method names as used by tmf-cli --consolidate
+ */
+TEST(ConsolidatorMethodTest, ParsesMethods) {
+    Consolidator::Method method;
+    EXPECT_TRUE(Consolidator::parseMethod("reflink", method));
+    EXPECT_EQ(method, Consolidator::Method::Reflink);
+    EXPECT_TRUE(Consolidator::parseMethod("hardlink", method));
+    EXPECT_EQ(method, Consolidator::Method::Hardlink);
+    EXPECT_FALSE(Consolidator::parseMethod("copy", method));
+}
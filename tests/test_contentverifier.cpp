@@ -0,0 +1,121 @@
+/**
+ * @file test_contentverifier.cpp
+ * @brief Unit tests for the byte-for-byte ContentVerifier
+ *
+ * @see ContentVerifier
+ */
+
+#include <gtest/gtest.h>
+#include "contentverifier.hpp"
+#include <filesystem>
+#include <fstream>
+
+/**
+ * @class ContentVerifierTest
+ * @brief Creates files in a temporary directory and compares them
+ */
+class ContentVerifierTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "contentverifier_test";
+        std::filesystem::create_directories(test_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    std::string createFile(const std::string& name, const std::string& content) {
+        std::ofstream file(test_dir / name, std::ios::binary);
+        file << content;
+        return (test_dir / name).string();
+    }
+};
+
+/**
+ * @test EqualFilesFormOneSet
+ * @brief Identical content spanning several chunks is one set
+ */
+TEST_F(ContentVerifierTest, EqualFilesFormOneSet) {
+    std::string content(ContentVerifier::CHUNK_SIZE * 2 + 17, 'x');
+    std::vector<std::string> paths{createFile("a.bin", content), createFile("b.bin", content),
+                                   createFile("c.bin", content)};
+
+    auto sets = ContentVerifier::partition(paths);
+
+    ASSERT_EQ(sets.size(), 1u);
+    EXPECT_EQ(sets[0], (std::vector<std::size_t>{0, 1, 2}));
+    EXPECT_TRUE(ContentVerifier::equal(paths[0], paths[2]));
+}
+
+/**
+ * @test DifferentTailsSplitIntoSets
+ * @brief Files differing in the last chunk are told apart, equal ones kept
+ */
+TEST_F(ContentVerifierTest, DifferentTailsSplitIntoSets) {
+    std::string head(ContentVerifier::CHUNK_SIZE + 5, 'h');
+    std::vector<std::string> paths{createFile("a.bin", head + "1"), createFile("b.bin", head + "2"),
+                                   createFile("c.bin", head + "1"), createFile("d.bin", head + "2"),
+                                   createFile("e.bin", head + "3")};
+
+    auto sets = ContentVerifier::partition(paths);
+
+    ASSERT_EQ(sets.size(), 2u);
+    EXPECT_EQ(sets[0], (std::vector<std::size_t>{0, 2}));
+    EXPECT_EQ(sets[1], (std::vector<std::size_t>{1, 3}));
+    EXPECT_FALSE(ContentVerifier::equal(paths[0], paths[1]));
+}
+
+/**
+ * @test SizesAndUnreadableFilesAreSeparated
+ * @brief Different sizes never match; missing files are left out
+ */
+TEST_F(ContentVerifierTest, SizesAndUnreadableFilesAreSeparated) {
+    std::vector<std::string> paths{createFile("a.txt", "abc"), createFile("b.txt", "abcd"),
+                                   (test_dir / "missing").string(), createFile("c.txt", "abc")};
+
+    std::vector<std::size_t> unreadable;
+    auto sets = ContentVerifier::partition(paths, StopToken(), &unreadable);
+
+    ASSERT_EQ(sets.size(), 1u);
+    EXPECT_EQ(sets[0], (std::vector<std::size_t>{0, 3}));
+    EXPECT_EQ(unreadable, (std::vector<std::size_t>{2}));
+    EXPECT_FALSE(ContentVerifier::equal(paths[0], paths[2]));
+}
+
+/**
+ * @test MoreFilesThanOpenLimit
+ * @brief Files beyond MAX_OPEN_FILES are reopened per chunk and still sorted
+ */
+TEST_F(ContentVerifierTest, MoreFilesThanOpenLimit) {
+    const std::string head(ContentVerifier::CHUNK_SIZE, 'h');
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < ContentVerifier::MAX_OPEN_FILES + 6; ++i) {
+        const char tail = i % 2 == 0 ? 'a' : 'b';
+        paths.push_back(createFile("f" + std::to_string(i), head + std::string(3, tail)));
+    }
+
+    std::vector<std::size_t> unreadable;
+    auto sets = ContentVerifier::partition(paths, StopToken(), &unreadable);
+
+    ASSERT_EQ(sets.size(), 2u);
+    EXPECT_EQ(sets[0].size(), paths.size() / 2);
+    EXPECT_EQ(sets[1].size(), paths.size() / 2);
+    EXPECT_EQ(sets[0].front(), 0u);
+    EXPECT_EQ(sets[1].front(), 1u);
+    EXPECT_TRUE(unreadable.empty());
+}
+
+/**
+ * @test StoppedComparisonIsEmpty
+ * @brief A stopped token ends the comparison without a result
+ */
+TEST_F(ContentVerifierTest, StoppedComparisonIsEmpty) {
+    std::vector<std::string> paths{createFile("a.txt", "same"), createFile("b.txt", "same")};
+    StopSource stop;
+    stop.requestStop();
+
+    EXPECT_TRUE(ContentVerifier::partition(paths, stop.token()).empty());
+}
@@ -0,0 +1,195 @@
+/**
+ * @file test_deletionengine.cpp
+ * @brief Unit tests for the batched DeletionEngine
+ *
+ * run() is tested with hand-built plans, so the tests do not depend on
+ * FileSafety accepting the temporary directory's file system.
+ *
+ * @see DeletionEngine
+ */
+
+#include <gtest/gtest.h>
+#include "deletionengine.hpp"
+#include <filesystem>
+#include <fstream>
+
+/**
+ * @class DeletionEngineTest
+ * @brief Creates a tree in a temporary directory for deletion
+ */
+class DeletionEngineTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "deletionengine_test";
+        std::filesystem::remove_all(test_dir);
+        std::filesystem::create_directories(test_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    FileInfo createFile(const std::filesystem::path& path, const std::string& content = "x") {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+        return FileInfo(path.string(), static_cast<long long>(content.size()), false);
+    }
+};
+
+/**
+ * @test DeletesFilesOfSeveralDirectories
+ * @brief Files in different parents are removed on several workers
+ */
+TEST_F(DeletionEngineTest, DeletesFilesOfSeveralDirectories) {
+    DeletionEngine::Plan plan;
+    for (int d = 0; d < 4; ++d) {
+        for (int f = 0; f < 10; ++f) {
+            plan.targets.push_back(createFile(test_dir / std::to_string(d) / std::to_string(f)));
+        }
+    }
+    const auto keep = createFile(test_dir / "0" / "keep");
+
+    DeletionEngine engine(3);
+    auto report = engine.run(plan);
+
+    EXPECT_EQ(report.deleted.size(), 40u);
+    EXPECT_TRUE(report.failed.empty());
+    EXPECT_FALSE(report.stopped);
+    EXPECT_EQ(report.items_removed, 40u);
+    EXPECT_TRUE(std::filesystem::exists(keep.getPath()));
+    EXPECT_FALSE(std::filesystem::exists(test_dir / "3" / "9"));
+}
+
+/**
+ * @test RemovesTreesWithoutFollowingSymlinks
+ * @brief A directory target goes with its contents; a symlink's target stays
+ */
+TEST_F(DeletionEngineTest, RemovesTreesWithoutFollowingSymlinks) {
+    createFile(test_dir / "tree" / "a" / "b" / "file");
+    createFile(test_dir / "tree" / "top");
+    const auto outside = createFile(test_dir / "outside" / "precious");
+    std::filesystem::create_directory_symlink(test_dir / "outside", test_dir / "tree" / "link");
+
+    DeletionEngine::Plan plan;
+    plan.targets.emplace_back((test_dir / "tree").string(), 0, true);
+
+    DeletionEngine engine(1);
+    auto report = engine.run(plan);
+
+    ASSERT_EQ(report.deleted.size(), 1u);
+    EXPECT_EQ(report.items_removed, 6u); // file, b, a, top, link, tree
+    EXPECT_FALSE(std::filesystem::exists(test_dir / "tree"));
+    EXPECT_TRUE(std::filesystem::exists(outside.getPath()));
+}
+
+/**
+ * @test RemovesDirectorySymlinkNotTarget
+ * @brief A scanned symlink to a directory is unlinked, its target stays
+ */
+TEST_F(DeletionEngineTest, RemovesDirectorySymlinkNotTarget) {
+    const auto precious = createFile(test_dir / "target" / "precious");
+    std::filesystem::create_directory_symlink(test_dir / "target", test_dir / "link");
+
+    DeletionEngine::Plan plan;
+    plan.targets.emplace_back((test_dir / "link").string(), 0, true); // as scanned
+
+    DeletionEngine engine(1);
+    auto report = engine.run(plan);
+
+    ASSERT_EQ(report.deleted.size(), 1u);
+    EXPECT_TRUE(report.failed.empty());
+    EXPECT_EQ(report.items_removed, 1u);
+    EXPECT_FALSE(std::filesystem::exists(std::filesystem::symlink_status(test_dir / "link")));
+    EXPECT_TRUE(std::filesystem::exists(precious.getPath()));
+}
+
+/**
+ * @test ReportsMissingTargets
+ * @brief An entry that vanished is a failure, the others are still deleted
+ */
+TEST_F(DeletionEngineTest, ReportsMissingTargets) {
+    DeletionEngine::Plan plan;
+    plan.targets.push_back(createFile(test_dir / "a"));
+    plan.targets.emplace_back((test_dir / "missing").string(), 1, false);
+    plan.targets.emplace_back((test_dir / "nodir" / "b").string(), 1, false);
+
+    std::size_t last_done = 0;
+    DeletionEngine engine(2);
+    engine.setProgressCallback(
+        [&last_done](const DeletionEngine::Progress& progress) { last_done = progress.targets_done; });
+    auto report = engine.run(plan);
+
+    EXPECT_EQ(report.deleted.size(), 1u);
+    EXPECT_EQ(report.failed.size(), 2u);
+    EXPECT_EQ(last_done, 3u);
+}
+
+/**
+ * @test StoppedRunDeletesNothing
+ * @brief A stopped token ends the run before the first target
+ */
+TEST_F(DeletionEngineTest, StoppedRunDeletesNothing) {
+    DeletionEngine::Plan plan;
+    plan.targets.push_back(createFile(test_dir / "a"));
+    StopSource stop;
+    stop.requestStop();
+
+    DeletionEngine engine(1);
+    engine.setStopToken(stop.token());
+    auto report = engine.run(plan);
+
+    EXPECT_TRUE(report.stopped);
+    EXPECT_TRUE(report.deleted.empty());
+    EXPECT_TRUE(std::filesystem::exists(test_dir / "a"));
+}
+
+/**
+ * @test PlanBlocksSystemPaths
+ * @brief The safety pass refuses system paths and drops parent entries
+ */
+TEST_F(DeletionEngineTest, PlanBlocksSystemPaths) {
+    std::vector<FileInfo> files{FileInfo("/usr", 0, true), FileInfo("/etc", 0, true),
+                                FileInfo("/etc", 0, true), FileInfo("..", 0, true, true)};
+
+    auto plan = DeletionEngine::plan(files);
+
+    EXPECT_TRUE(plan.targets.empty());
+    ASSERT_EQ(plan.blocked.size(), 2u);
+    EXPECT_EQ(plan.blocked[0].path, "/usr");
+}
+
+/**
+ * @test PlanDropsEntriesBelowDirectoryTargets
+ * @brief Entries inside a directory target are deleted with it, not again
+ */
+TEST_F(DeletionEngineTest, PlanDropsEntriesBelowDirectoryTargets) {
+    const auto tree = test_dir / "tree";
+    std::vector<FileInfo> files{createFile(tree / "a" / "file"),
+                                FileInfo((tree / "a").string(), 0, true),
+                                createFile(tree / "top"),
+                                FileInfo(tree.string(), 0, true),
+                                createFile(test_dir / "tree-b" / "file")};
+
+    auto plan = DeletionEngine::plan(files);
+    if (!plan.blocked.empty())
+        GTEST_SKIP() << "FileSafety blocks the temporary directory here";
+
+    std::vector<std::string> targets;
+    for (const auto& target : plan.targets) {
+        targets.push_back(target.getPath());
+    }
+    EXPECT_EQ(targets, (std::vector<std::string>{tree.string(),
+                                                 (test_dir / "tree-b" / "file").string()}));
+    EXPECT_EQ(plan.bytes, 1);
+
+    DeletionEngine engine(2);
+    auto report = engine.run(plan);
+
+    EXPECT_EQ(report.deleted.size(), 2u);
+    EXPECT_TRUE(report.failed.empty());
+    EXPECT_EQ(report.items_removed, 5u); // file, a, top, tree, tree-b/file
+    EXPECT_FALSE(std::filesystem::exists(tree));
+}
@@ -0,0 +1,173 @@
+/**
+ * @file test_directorytree.cpp
+ * @brief Unit tests for the per-directory size aggregation
+ *
+ * @see DirectoryTree
+ */
+
+#include <gtest/gtest.h>
+#include "directorytree.hpp"
+#include "filescanner.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+/** @brief Node of a path that must be in the tree */
+const DirectoryTree::Node &nodeOf(const DirectoryTree &tree, const std::string &path) {
+    DirectoryTree::NodeId id = 0;
+    EXPECT_TRUE(tree.find(path, id)) << path;
+    return tree.node(id);
+}
+
+} // namespace
+
+/**
+ * @test SumsSubtreesBottomUp
+ * @brief Own totals per directory, subtree totals after rollUp()
+ */
+TEST(DirectoryTreeTest, SumsSubtreesBottomUp) {
+    auto arena = std::make_shared<PathArena>();
+    DirectoryTree tree("/r/");
+
+    // A deep file before the entries of its directories
+    tree.add(FileInfo(arena, "/r/d/e/big", 300, 0));
+    tree.add(std::vector<FileInfo>{
+        FileInfo(arena, "/r/..", 0, FileInfo::Directory | FileInfo::Parent),
+        FileInfo(arena, "/r/a", 100, 0),
+        FileInfo(arena, "/r/d", 0, FileInfo::Directory),
+        FileInfo(arena, "/r/d/empty", 0, 0),
+        FileInfo(arena, "/r/d/e", 0, FileInfo::Directory),
+        FileInfo(arena, "/r/f", 0, FileInfo::Directory),
+        FileInfo(arena, "/r/f/small", 50, 0),
+        FileInfo(arena, "/elsewhere/x", 1000, 0),
+    });
+    tree.rollUp();
+
+    EXPECT_EQ(tree.size(), 4u);
+    const auto &root = tree.node(tree.root());
+    EXPECT_EQ(root.path, "/r");
+    EXPECT_EQ(root.own.files, 1u);
+    EXPECT_EQ(root.own.directories, 2u);
+    EXPECT_EQ(root.total.bytes, 450);
+    EXPECT_EQ(root.total.files, 4u);
+    EXPECT_EQ(root.total.zero_files, 1u);
+    EXPECT_EQ(root.total.directories, 3u);
+
+    const auto &d = nodeOf(tree, "/r/d");
+    EXPECT_EQ(d.own.bytes, 0);
+    EXPECT_EQ(d.own.zero_files, 1u);
+    EXPECT_EQ(d.total.bytes, 300);
+    EXPECT_EQ(d.total.files, 2u);
+    EXPECT_EQ(nodeOf(tree, "/r/d/e").total.bytes, 300);
+
+    DirectoryTree::NodeId id;
+    EXPECT_FALSE(tree.find("/elsewhere", id));
+
+    const auto children = tree.childrenBySize(tree.root());
+    ASSERT_EQ(children.size(), 2u);
+    EXPECT_EQ(tree.node(children[0]).path, "/r/d");
+    EXPECT_EQ(tree.node(children[1]).path, "/r/f");
+}
+
+/**
+ * @test CountsLinksOnceAndDuplicates
+ * @brief Hardlinks take space once; duplicate bytes follow the flag
+ */
+TEST(DirectoryTreeTest, CountsLinksOnceAndDuplicates) {
+    auto arena = std::make_shared<PathArena>();
+    const PathArena::Inode linked{1, 10, 8, 2};
+    const PathArena::Inode copy{1, 11, 8, 1};
+
+    std::vector<FileInfo> files;
+    files.emplace_back(arena, "/r/a/one", 4000, 0, &linked);
+    files.emplace_back(arena, "/r/b/two", 4000, 0, &linked);
+    files.emplace_back(arena, "/r/b/copy", 4000, 0, &copy);
+    files.back().setDuplicate(true);
+
+    DirectoryTree tree("/r");
+    tree.add(files);
+    tree.rollUp();
+    EXPECT_EQ(tree.node(tree.root()).total.bytes, 2 * 8 * 512);
+    EXPECT_EQ(tree.node(tree.root()).total.size, 3 * 4000);
+    EXPECT_EQ(tree.node(tree.root()).total.files, 3u);
+    EXPECT_EQ(nodeOf(tree, "/r/a").total.bytes, 8 * 512);
+    EXPECT_EQ(nodeOf(tree, "/r/b").total.bytes, 8 * 512);
+    EXPECT_EQ(nodeOf(tree, "/r/b").total.duplicate_bytes, 8 * 512);
+
+    // A later search: both links are duplicates of the copy
+    for (auto &file : files) {
+        file.setDuplicate(true);
+    }
+    tree.setDuplicates(files);
+    tree.rollUp();
+    EXPECT_EQ(nodeOf(tree, "/r/a").total.duplicate_bytes, 8 * 512);
+    EXPECT_EQ(nodeOf(tree, "/r/b").total.duplicate_bytes, 8 * 512);
+    EXPECT_EQ(tree.node(tree.root()).total.duplicate_bytes, 2 * 8 * 512);
+}
+
+/**
+ * @test ParallelRollUpMatchesSequential
+ * @brief The split into subtrees does not change any total
+ */
+TEST(DirectoryTreeTest, ParallelRollUpMatchesSequential) {
+    auto arena = std::make_shared<PathArena>();
+    std::vector<FileInfo> files;
+    // An unbalanced tree: one deep chain and many flat directories
+    std::string deep = "/r/deep";
+    for (int level = 0; level < 50; ++level) {
+        deep += "/" + std::to_string(level);
+        files.emplace_back(arena, deep + "/f", level, 0);
+    }
+    for (std::size_t i = 0; i < DirectoryTree::PARALLEL_THRESHOLD; ++i) {
+        const std::string dir = "/r/flat/" + std::to_string(i % 64) + "/" + std::to_string(i);
+        files.emplace_back(arena, dir + "/f", static_cast<long long>(i), 0);
+    }
+
+    DirectoryTree sequential("/r");
+    sequential.add(files);
+    sequential.rollUp(1);
+    DirectoryTree parallel("/r");
+    parallel.add(files);
+    parallel.rollUp(8);
+
+    ASSERT_EQ(parallel.size(), sequential.size());
+    ASSERT_GE(parallel.size(), DirectoryTree::PARALLEL_THRESHOLD);
+    for (DirectoryTree::NodeId id = 0; id < parallel.size(); ++id) {
+        EXPECT_EQ(parallel.node(id).total.bytes, sequential.node(id).total.bytes);
+        EXPECT_EQ(parallel.node(id).total.files, sequential.node(id).total.files);
+        EXPECT_EQ(parallel.node(id).total.directories, sequential.node(id).total.directories);
+    }
+    EXPECT_EQ(parallel.node(parallel.root()).total.files, files.size());
+}
+
+/**
+ * @test BuiltFromStreamingScan
+ * @brief The batches of one recursive scan give du's numbers
+ */
+TEST(DirectoryTreeTest, BuiltFromStreamingScan) {
+    const auto dir = std::filesystem::temp_directory_path() / "directorytree_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "sub" / "deeper");
+    std::ofstream(dir / "top.txt") << "top";
+    std::ofstream(dir / "sub" / "empty.txt");
+    std::ofstream(dir / "sub" / "deeper" / "data.bin") << std::string(10000, 'x');
+
+    FileScanner scanner;
+    scanner.setThreadCount(4);
+    DirectoryTree tree(dir.string());
+    scanner.scanDirectoryStreaming(dir, true, false, [&](std::vector<FileInfo> &&batch) {
+        tree.add(batch);
+        return true;
+    });
+    tree.rollUp();
+
+    const auto &root = tree.node(tree.root());
+    EXPECT_EQ(tree.size(), 3u);
+    EXPECT_EQ(root.total.files, 3u);
+    EXPECT_EQ(root.total.zero_files, 1u);
+    EXPECT_EQ(root.total.size, 10003);
+    EXPECT_GE(root.total.bytes, nodeOf(tree, (dir / "sub").string()).total.bytes);
+    EXPECT_EQ(nodeOf(tree, (dir / "sub" / "deeper").string()).total.size, 10000);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,180 @@
+/**
+ * @file test_directorywatcher.cpp
+ * @brief Unit tests for DirectoryWatcher and ListingPatch
+ *
+ * @see DirectoryWatcher
+ * @see ListingPatch
+ */
+
+#include <gtest/gtest.h>
+#include "directorywatcher.hpp"
+#include "filescanner.hpp"
+#include "listingpatch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class DirectoryWatcherTest
+ * @brief Fixture providing a temporary directory with a few files
+ */
+class DirectoryWatcherTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "directorywatcher_test";
+        std::filesystem::remove_all(test_dir);
+        std::filesystem::create_directories(test_dir / "sub");
+        createFile("a.txt", "a");
+        createFile("c.txt", "ccc");
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    void createFile(const std::string &name, const std::string &content) {
+        std::ofstream file(test_dir / name, std::ios::binary);
+        file << content;
+    }
+
+    std::string path(const std::string &name) const {
+        return (test_dir / name).string();
+    }
+
+    std::vector<FileInfo> scan() const {
+        FileScanner scanner;
+        return scanner.scanDirectory(test_dir, false, true);
+    }
+
+    static std::vector<std::string> paths(const std::vector<FileInfo> &listing) {
+        std::vector<std::string> result;
+        for (const auto &info : listing) {
+            result.push_back(info.getPath());
+        }
+        return result;
+    }
+};
+
+TEST_F(DirectoryWatcherTest, PatchMatchesRescan) {
+    using Type = DirectoryWatcher::Event::Type;
+    auto listing = scan();
+
+    std::filesystem::remove(test_dir / "a.txt");
+    createFile("b.txt", "bb");
+    createFile("c.txt", "changed");
+    std::filesystem::create_directory(test_dir / "dir");
+
+    auto result = ListingPatch::apply(listing,
+                                      {{Type::Deleted, path("a.txt")},
+                                       {Type::Created, path("b.txt")},
+                                       {Type::Modified, path("c.txt")},
+                                       {Type::Created, path("dir")},
+                                       {Type::Deleted, path("missing.txt")}},
+                                      true);
+
+    EXPECT_FALSE(result.rescan);
+    EXPECT_EQ(result.paths.size(), 5u);
+    EXPECT_EQ(result.entries.size(), 3u);
+    EXPECT_EQ(paths(listing), paths(scan()));
+
+    for (const auto &info : listing) {
+        if (info.getPath() == path("c.txt")) {
+            EXPECT_EQ(info.getFileSize(), 7);
+        }
+    }
+}
+
+TEST_F(DirectoryWatcherTest, DiffBringsStaleListingUpToDate) {
+    using Type = DirectoryWatcher::Event::Type;
+    auto listing = scan();
+
+    std::filesystem::remove(test_dir / "a.txt");
+    createFile("b.txt", "bb");
+    createFile("c.txt", "changed");
+    const auto current = scan();
+
+    const auto events = ListingPatch::diff(listing, current);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].type, Type::Created);
+    EXPECT_EQ(events[0].path, path("b.txt"));
+    EXPECT_EQ(events[1].type, Type::Modified);
+    EXPECT_EQ(events[1].path, path("c.txt"));
+    EXPECT_EQ(events[2].type, Type::Deleted);
+    EXPECT_EQ(events[2].path, path("a.txt"));
+
+    ListingPatch::apply(listing, events, true);
+    EXPECT_EQ(paths(listing), paths(current));
+    EXPECT_TRUE(ListingPatch::diff(listing, current).empty());
+}
+
+TEST_F(DirectoryWatcherTest, OverflowRequestsRescan) {
+    auto listing = scan();
+    const auto before = paths(listing);
+
+    auto result = ListingPatch::apply(
+        listing,
+        {{DirectoryWatcher::Event::Type::Deleted, path("a.txt")},
+         {DirectoryWatcher::Event::Type::Overflow, test_dir.string()}},
+        true);
+
+    EXPECT_TRUE(result.rescan);
+    EXPECT_EQ(paths(listing), before);
+}
+
+TEST_F(DirectoryWatcherTest, ReportsCoalescedChanges) {
+    if (!DirectoryWatcher::isSupported()) {
+        GTEST_SKIP() << "No directory watching on this platform";
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<DirectoryWatcher::Event> received;
+
+    DirectoryWatcher watcher([&](std::vector<DirectoryWatcher::Event> &&events) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.insert(received.end(), events.begin(), events.end());
+        cv.notify_all();
+    });
+    ASSERT_TRUE(watcher.watch(test_dir.string()));
+    EXPECT_EQ(watcher.getDirectory(), test_dir.string());
+
+    // Created and written in one burst: a single Created event
+    createFile("new.txt", "content");
+    std::filesystem::remove(test_dir / "a.txt");
+    createFile("sub/nested.txt", "not watched");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(5), [&] { return received.size() >= 2; }));
+    lock.unlock();
+    std::this_thread::sleep_for(3 * DirectoryWatcher::DEBOUNCE);
+    lock.lock();
+
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[0].type, DirectoryWatcher::Event::Type::Created);
+    EXPECT_EQ(received[0].path, path("new.txt"));
+    EXPECT_EQ(received[1].type, DirectoryWatcher::Event::Type::Deleted);
+    EXPECT_EQ(received[1].path, path("a.txt"));
+}
+
+TEST_F(DirectoryWatcherTest, UnwatchDropsEvents) {
+    if (!DirectoryWatcher::isSupported()) {
+        GTEST_SKIP() << "No directory watching on this platform";
+    }
+
+    std::atomic<int> batches{0};
+    DirectoryWatcher watcher([&](std::vector<DirectoryWatcher::Event> &&) { ++batches; });
+    ASSERT_TRUE(watcher.watch(test_dir.string()));
+    watcher.unwatch();
+
+    createFile("ignored.txt", "x");
+    std::this_thread::sleep_for(3 * DirectoryWatcher::DEBOUNCE);
+    EXPECT_EQ(batches.load(), 0);
+    EXPECT_FALSE(watcher.watch((test_dir / "missing").string()));
+}
@@ -13,7 +13,14 @@
 #include <gtest/gtest.h>
 #include "duplicatefinder.hpp"
 #include "fileinfo.hpp"
+#include "filescanner.hpp"
+#include "fnv1a.hpp"
+#include "hashpipeline.hpp"
 #include "utils.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
 
 /**
  * @class DuplicateFinderTest
@@ -208,3 +215,311 @@ TEST_F(DuplicateFinderTest, FormatsBytesCorrectly) {
     EXPECT_EQ(formatBytes(1048576), "1.0 MB");
     EXPECT_EQ(formatBytes(1073741824), "1.0 GB");
 }
+
+/**
+ * @class CountingHasher
+ * @brief FNV1A wrapper that counts how often each hashing stage runs
+ *
+ * Lets the staged tests verify that file content is only read where sizes
+ * (and samples) collide.
+ */
+class CountingHasher : public IHashCalculator {
+public:
+    mutable int fullCalls = 0;
+    mutable int sampleCalls = 0;
+
+    HashDigest calculateHash(const std::string& filePath) const override {
+        ++fullCalls;
+        return m_fnv.calculateHash(filePath);
+    }
+
+    HashDigest calculateSampleHash(const std::string& filePath,
+                                    std::size_t sampleSize) const override {
+        ++sampleCalls;
+        return m_fnv.calculateSampleHash(filePath, sampleSize);
+    }
+
+private:
+    FNV1A m_fnv;
+};
+
+/**
+ * @class StagedDuplicateFinderTest
+ * @brief Test fixture for the staged (size -> sample -> full) engine
+ *
+ * Creates real files in a temporary directory and scans them with a
+ * metadata-only FileScanner before running the staged engine.
+ */
+class StagedDuplicateFinderTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    CountingHasher hasher;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "duplicatefinder_test";
+        std::filesystem::create_directories(test_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    void createFile(const std::string& name, const std::string& content) {
+        std::ofstream file(test_dir / name, std::ios::binary);
+        file << content;
+    }
+
+    std::vector<FileInfo> scan() {
+        FileScanner scanner;
+        return scanner.scanDirectory(test_dir, false, false);
+    }
+
+    /** @brief Disk space of a file as wastedSpace counts it (st_blocks) */
+    long long allocated(const std::string& name) {
+        struct stat st;
+        return ::stat((test_dir / name).c_str(), &st) == 0
+                   ? static_cast<long long>(st.st_blocks) * 512 : -1;
+    }
+};
+
+/**
+ * @test UniqueSizesAreNeverRead
+ * @brief Files with a unique size are dropped before any hashing
+ */
+TEST_F(StagedDuplicateFinderTest, UniqueSizesAreNeverRead) {
+    createFile("a.txt", "a");
+    createFile("b.txt", "bb");
+    createFile("c.txt", "ccc");
+
+    auto files = scan();
+    auto groups = DuplicateFinder::findDuplicates(files, hasher);
+
+    EXPECT_TRUE(groups.empty());
+    EXPECT_EQ(hasher.fullCalls, 0);
+    EXPECT_EQ(hasher.sampleCalls, 0);
+}
+
+/**
+ * @test IdenticalFilesAreGrouped
+ * @brief Identical content ends up in one group with the full hash set
+ */
+TEST_F(StagedDuplicateFinderTest, IdenticalFilesAreGrouped) {
+    createFile("file1.txt", "identical content");
+    createFile("file2.txt", "identical content");
+    createFile("other.txt", "different content");  // same size, other content
+
+    auto files = scan();
+    auto groups = DuplicateFinder::findDuplicates(files, hasher);
+
+    ASSERT_EQ(groups.size(), 1);
+    EXPECT_EQ(groups[0].files.size(), 2);
+    EXPECT_EQ(groups[0].hash, FNV1A().calculateHash((test_dir / "file1.txt").string()).toHex());
+    EXPECT_EQ(groups[0].wastedSpace, allocated("file2.txt"));
+
+    for (const auto& info : files) {
+        bool is_copy = info.getPath().find("file") != std::string::npos;
+        EXPECT_EQ(info.isDuplicate(), is_copy);
+    }
+}
+
+/**
+ * @test DifferentSamplesSkipFullHash
+ * @brief Large files of equal size but different heads stop at the sample stage
+ */
+TEST_F(StagedDuplicateFinderTest, DifferentSamplesSkipFullHash) {
+    std::string body(3 * DuplicateFinder::SAMPLE_SIZE, 'x');
+    createFile("a.bin", "A" + body);
+    createFile("b.bin", "B" + body);
+
+    auto files = scan();
+    auto groups = DuplicateFinder::findDuplicates(files, hasher);
+
+    EXPECT_TRUE(groups.empty());
+    EXPECT_EQ(hasher.sampleCalls, 2);
+    EXPECT_EQ(hasher.fullCalls, 0);
+}
+
+/**
+ * @test SameSampleDifferentMiddle
+ * @brief Equal head and tail still go through the full hash and are told apart
+ */
+TEST_F(StagedDuplicateFinderTest, SameSampleDifferentMiddle) {
+    std::string edge(DuplicateFinder::SAMPLE_SIZE, 'e');
+    std::string middle(DuplicateFinder::SAMPLE_SIZE, 'm');
+    createFile("a.bin", edge + middle + "1" + edge);
+    createFile("b.bin", edge + middle + "2" + edge);
+    createFile("c.bin", edge + middle + "1" + edge);
+
+    auto files = scan();
+    auto groups = DuplicateFinder::findDuplicates(files, hasher);
+
+    ASSERT_EQ(groups.size(), 1);
+    EXPECT_EQ(groups[0].files.size(), 2);
+    EXPECT_EQ(hasher.sampleCalls, 3);
+    EXPECT_EQ(hasher.fullCalls, 3);
+}
+
+/**
+ * @test IgnoresEmptyFilesAndDirectories
+ * @brief Zero-byte files and directories never become candidates
+ */
+TEST_F(StagedDuplicateFinderTest, IgnoresEmptyFilesAndDirectories) {
+    createFile("empty1.txt", "");
+    createFile("empty2.txt", "");
+    std::filesystem::create_directories(test_dir / "dir1");
+    std::filesystem::create_directories(test_dir / "dir2");
+
+    auto files = scan();
+    auto groups = DuplicateFinder::findDuplicates(files, hasher);
+
+    EXPECT_TRUE(groups.empty());
+    EXPECT_EQ(hasher.fullCalls, 0);
+}
+
+/**
+ * @test GroupCallbackReceivesEveryGroup
+ * @brief Streamed groups match the returned ones
+ */
+TEST_F(StagedDuplicateFinderTest, GroupCallbackReceivesEveryGroup) {
+    createFile("a1.txt", "first");
+    createFile("a2.txt", "first");
+    createFile("b1.txt", "second content");
+    createFile("b2.txt", "second content");
+    createFile("b3.txt", "second content");
+    createFile("c.txt", "unique!");
+
+    auto files = scan();
+    FNV1A fnv; // CountingHasher is not thread-safe
+    HashPipeline pipeline(fnv, 2);
+    std::vector<std::string> streamed;
+    auto groups = DuplicateFinder::findDuplicates(
+        files, pipeline, [&streamed](const DuplicateFinder::DuplicateGroup& group) {
+            streamed.push_back(group.hash + ":" + std::to_string(group.files.size()));
+        });
+
+    std::vector<std::string> returned;
+    for (const auto& group : groups) {
+        returned.push_back(group.hash + ":" + std::to_string(group.files.size()));
+    }
+    std::sort(streamed.begin(), streamed.end());
+    std::sort(returned.begin(), returned.end());
+    EXPECT_EQ(returned.size(), 2u);
+    EXPECT_EQ(streamed, returned);
+}
+
+/**
+ * @test VerifyGroupsSplitsHashCollisions
+ * @brief A group whose hashes collided is split by content comparison
+ */
+TEST_F(StagedDuplicateFinderTest, VerifyGroupsSplitsHashCollisions) {
+    createFile("a1.txt", "same content");
+    createFile("a2.txt", "same content");
+    createFile("b.txt", "other conten");
+
+    auto files = scan();
+    DuplicateFinder::DuplicateGroup collided;
+    collided.hash = "00";
+    for (auto& info : files) {
+        info.setDuplicate(true);
+        collided.files.push_back(&info);
+    }
+
+    auto groups = DuplicateFinder::verifyGroups({collided}, 2);
+
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_TRUE(groups[0].verified);
+    EXPECT_EQ(groups[0].files.size(), 2u);
+    EXPECT_EQ(groups[0].wastedSpace, allocated("a2.txt"));
+    for (const auto& info : files) {
+        const bool copy = info.getName() != "b.txt";
+        EXPECT_EQ(info.isVerified(), copy) << info.getName();
+        EXPECT_EQ(info.isDuplicate(), copy) << info.getName();
+    }
+}
+
+/**
+ * @test VerifyGroupsKeepsUnreadableMarks
+ * @brief A file that cannot be read is not taken for a different one
+ */
+TEST_F(StagedDuplicateFinderTest, VerifyGroupsKeepsUnreadableMarks) {
+    createFile("a.txt", "same content");
+    createFile("b.txt", "same content");
+
+    auto files = scan();
+    DuplicateFinder::DuplicateGroup group;
+    group.hash = "00";
+    for (auto& info : files) {
+        info.setDuplicate(true);
+        group.files.push_back(&info);
+    }
+    std::filesystem::remove(test_dir / "b.txt");
+
+    auto groups = DuplicateFinder::verifyGroups({group}, 1);
+
+    EXPECT_TRUE(groups.empty());
+    for (const auto& info : files) {
+        EXPECT_FALSE(info.isVerified()) << info.getName();
+        EXPECT_TRUE(info.isDuplicate()) << info.getName();
+    }
+}
+
+/**
+ * @test HardlinksAreHashedOnce
+ * @brief Paths of one inode share one hash and count no wasted space
+ */
+TEST_F(StagedDuplicateFinderTest, HardlinksAreHashedOnce) {
+    createFile("a.txt", "linked content");
+    std::filesystem::create_hard_link(test_dir / "a.txt", test_dir / "a_link.txt");
+    std::filesystem::create_hard_link(test_dir / "a.txt", test_dir / "a_link2.txt");
+    createFile("b.txt", "linked content");
+
+    auto files = scan();
+    auto groups = DuplicateFinder::findDuplicates(files, hasher);
+
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_EQ(groups[0].files.size(), 4u);
+    EXPECT_EQ(hasher.fullCalls, 2); // one per inode
+    EXPECT_EQ(groups[0].wastedSpace, allocated("b.txt"));
+    for (const auto& info : files) {
+        EXPECT_TRUE(info.isDuplicate()) << info.getName();
+    }
+}
+
+/**
+ * @test LinksOfOneInodeAreNoDuplicates
+ * @brief A size whose paths all share one inode is never read
+ */
+TEST_F(StagedDuplicateFinderTest, LinksOfOneInodeAreNoDuplicates) {
+    createFile("a.txt", "only one file");
+    std::filesystem::create_hard_link(test_dir / "a.txt", test_dir / "a_link.txt");
+
+    auto files = scan();
+    for (const auto& info : files) {
+        EXPECT_TRUE(info.hasInode());
+        EXPECT_EQ(info.getInode().links, 2u);
+    }
+    auto groups = DuplicateFinder::findDuplicates(files, hasher);
+
+    EXPECT_TRUE(groups.empty());
+    EXPECT_EQ(hasher.fullCalls, 0);
+}
+
+/**
+ * @test VerifyGroupsReadsLinksOnce
+ * @brief Links keep their inode's verification result
+ */
+TEST_F(StagedDuplicateFinderTest, VerifyGroupsReadsLinksOnce) {
+    createFile("a.txt", "verified content");
+    std::filesystem::create_hard_link(test_dir / "a.txt", test_dir / "a_link.txt");
+    createFile("b.txt", "verified content");
+
+    auto files = scan();
+    auto groups = DuplicateFinder::verifyGroups(DuplicateFinder::findDuplicates(files, hasher), 1);
+
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_EQ(groups[0].files.size(), 3u);
+    EXPECT_EQ(groups[0].wastedSpace, allocated("b.txt"));
+    for (const auto& info : files) {
+        EXPECT_TRUE(info.isVerified()) << info.getName();
+    }
+}
@@ -0,0 +1,167 @@
+/**
+ * @file test_externalsizeindex.cpp
+ * @brief Unit tests for the spilling size-collision search
+ *
+ * @see ExternalSizeIndex
+ */
+
+#include <gtest/gtest.h>
+#include "duplicatefinder.hpp"
+#include "externalsizeindex.hpp"
+#include "filescanner.hpp"
+#include "fnv1a.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+/** @brief Collects every delivered file as "size:path" */
+std::vector<std::string> collisions(ExternalSizeIndex &index, std::size_t *batches = nullptr) {
+    std::vector<std::string> found;
+    EXPECT_TRUE(index.forEachCollision([&](std::vector<FileInfo> &&files) {
+        if (batches) {
+            ++*batches;
+        }
+        for (const auto &info : files) {
+            found.push_back(std::to_string(info.getFileSize()) + ":" + info.getPath());
+        }
+        return true;
+    }));
+    return found;
+}
+
+} // namespace
+
+/**
+ * @test FindsCollisionsAcrossSpilledRuns
+ * @brief Members of one size added far apart meet in the merge
+ */
+TEST(ExternalSizeIndexTest, FindsCollisionsAcrossSpilledRuns) {
+    auto arena = std::make_shared<PathArena>();
+    ExternalSizeIndex index(ExternalSizeIndex::MIN_MEMORY);
+
+    // Far more records than one run of the minimum ceiling holds
+    const long long unique = 3 * ExternalSizeIndex::MIN_MEMORY / sizeof(ExternalSizeIndex::Record);
+    index.add(FileInfo(arena, "/a/first", unique + 7, 0));
+    for (long long size = 1; size <= unique; ++size) {
+        ASSERT_TRUE(index.add(FileInfo(arena, "/u/" + std::to_string(size), size, 0)));
+    }
+    index.add(FileInfo(arena, "/z/last", unique + 7, 0));
+    index.add(FileInfo(arena, "/z/dir", 0, FileInfo::Directory));
+
+    EXPECT_GE(index.spilledRuns(), 2u);
+    EXPECT_EQ(index.size(), static_cast<std::uint64_t>(unique) + 2);
+
+    const auto found = collisions(index);
+    ASSERT_EQ(found.size(), 2u);
+    const std::string size = std::to_string(unique + 7);
+    EXPECT_EQ(found[0], size + ":/a/first");
+    EXPECT_EQ(found[1], size + ":/z/last");
+}
+
+/**
+ * @test MergesMoreRunsThanFanIn
+ * @brief Runs beyond the fan-in are merged in passes before the last merge
+ */
+TEST(ExternalSizeIndexTest, MergesMoreRunsThanFanIn) {
+    auto arena = std::make_shared<PathArena>();
+    ExternalSizeIndex index(ExternalSizeIndex::MIN_MEMORY);
+
+    // Sizes descend so every run covers a different range; pairs are split
+    // between the first and the last runs
+    const long long per_run = ExternalSizeIndex::MIN_MEMORY / 2 / sizeof(ExternalSizeIndex::Record);
+    const long long unique = (ExternalSizeIndex::MERGE_FAN_IN + 2) * per_run;
+    for (long long pair = 1; pair <= 3; ++pair) {
+        index.add(FileInfo(arena, "/a/" + std::to_string(pair), unique + pair, 0));
+    }
+    for (long long size = unique; size >= 1; --size) {
+        ASSERT_TRUE(index.add(FileInfo(arena, "/u/" + std::to_string(size), size, 0)));
+    }
+    for (long long pair = 1; pair <= 3; ++pair) {
+        index.add(FileInfo(arena, "/z/" + std::to_string(pair), unique + pair, 0));
+    }
+    EXPECT_GT(index.spilledRuns(), ExternalSizeIndex::MERGE_FAN_IN);
+
+    auto found = collisions(index);
+    std::sort(found.begin(), found.end()); // members of a size come in any order
+    EXPECT_GE(index.mergePasses(), 1u);
+    ASSERT_EQ(found.size(), 6u);
+    for (long long pair = 1; pair <= 3; ++pair) {
+        const std::string size = std::to_string(unique + pair);
+        EXPECT_EQ(found[2 * (pair - 1)], size + ":/a/" + std::to_string(pair));
+        EXPECT_EQ(found[2 * (pair - 1) + 1], size + ":/z/" + std::to_string(pair));
+    }
+}
+
+/**
+ * @test SkipsSizesOfOneInode
+ * @brief Hardlinks alone are no collision; with a copy they are delivered
+ */
+TEST(ExternalSizeIndexTest, SkipsSizesOfOneInode) {
+    auto arena = std::make_shared<PathArena>();
+    ExternalSizeIndex index(ExternalSizeIndex::MIN_MEMORY);
+
+    const PathArena::Inode linked{1, 10, 8, 2};
+    const PathArena::Inode copy{1, 11, 8, 1};
+    index.add(FileInfo(arena, "/l/one", 100, 0, &linked));
+    index.add(FileInfo(arena, "/l/two", 100, 0, &linked));
+    index.add(FileInfo(arena, "/m/one", 200, 0, &linked));
+    index.add(FileInfo(arena, "/m/two", 200, 0, &linked));
+    index.add(FileInfo(arena, "/m/copy", 200, 0, &copy));
+
+    std::size_t batches = 0;
+    const auto found = collisions(index, &batches);
+    EXPECT_EQ(index.spilledRuns(), 0u);
+    EXPECT_EQ(batches, 1u);
+    ASSERT_EQ(found.size(), 3u);
+    for (const auto &entry : found) {
+        EXPECT_EQ(entry.rfind("200:/m/", 0), 0u) << entry;
+    }
+}
+
+/**
+ * @test BatchesFeedDuplicateFinder
+ * @brief Delivered batches carry what the staged search needs
+ */
+TEST(ExternalSizeIndexTest, BatchesFeedDuplicateFinder) {
+    const auto dir = std::filesystem::temp_directory_path() / "externalsizeindex_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    for (const char *name : {"a.txt", "b.txt"}) {
+        std::ofstream(dir / name) << "same content";
+    }
+    std::ofstream(dir / "c.txt") << "other conten";
+    std::ofstream(dir / "d.txt") << "unique";
+
+    ExternalSizeIndex index(ExternalSizeIndex::MIN_MEMORY, dir.string());
+    FileScanner scanner;
+    for (const auto &info : scanner.scanDirectory(dir, false, false)) {
+        index.add(info);
+    }
+
+    FNV1A hasher;
+    std::size_t groups = 0;
+    ASSERT_TRUE(index.forEachCollision([&](std::vector<FileInfo> &&files) {
+        EXPECT_EQ(files.size(), 3u);
+        for (const auto &info : files) {
+            EXPECT_TRUE(info.hasInode());
+            EXPECT_NE(info.getModifiedTime(), 0);
+        }
+        for (const auto &group : DuplicateFinder::findDuplicates(files, hasher)) {
+            ++groups;
+            EXPECT_EQ(group.files.size(), 2u);
+        }
+        return true;
+    }));
+    EXPECT_EQ(groups, 1u);
+
+    // Temporary files are unnamed
+    std::size_t entries = 0;
+    for (auto it = std::filesystem::directory_iterator(dir);
+         it != std::filesystem::directory_iterator(); ++it) {
+        ++entries;
+    }
+    EXPECT_EQ(entries, 4u);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,199 @@
+/**
+ * @file test_fileindex.cpp
+ * @brief Unit tests for FileIndex views and incremental duplicate groups
+ *
+ * @see FileIndex
+ */
+
+#include <gtest/gtest.h>
+#include "fileindex.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * @class FileIndexTest
+ * @brief Fixture with a small in-memory listing (no file system access)
+ *
+ * Contains a parent entry, a directory, two files with the same digest,
+ * one unique file and one empty file.
+ */
+class FileIndexTest : public ::testing::Test {
+protected:
+    FileIndex index;
+    HashDigest digest = HashDigest::fromUint64(42);
+
+    void SetUp() override {
+        std::vector<FileInfo> entries;
+        entries.emplace_back("/d/..", 0, true, true);
+        entries.emplace_back("/d/sub", 0, true);
+        entries.push_back(file("/d/b.txt", 10, digest));
+        entries.push_back(file("/d/a.txt", 10, digest));
+        entries.push_back(file("/d/c.txt", 20, HashDigest()));
+        entries.push_back(file("/d/empty", 0, HashDigest()));
+        index.append(std::move(entries));
+        index.sort(true);
+    }
+
+    static FileInfo file(const std::string& path, long long size, const HashDigest& digest) {
+        FileInfo info(path, size, false);
+        info.setDigest(digest);
+        return info;
+    }
+
+    std::vector<std::string> paths(FileIndex::View view) const {
+        std::vector<std::string> result;
+        for (FileIndex::Id id : index.view(view)) {
+            result.push_back(index.at(id).getPath());
+        }
+        return result;
+    }
+};
+
+TEST_F(FileIndexTest, ViewsFollowListingOrder) {
+    EXPECT_EQ(index.size(), 6u);
+    EXPECT_EQ(paths(FileIndex::View::All),
+              (std::vector<std::string>{"/d/..", "/d/sub", "/d/a.txt", "/d/b.txt",
+                                        "/d/c.txt", "/d/empty"}));
+    EXPECT_EQ(paths(FileIndex::View::Duplicates),
+              (std::vector<std::string>{"/d/a.txt", "/d/b.txt"}));
+    EXPECT_EQ(paths(FileIndex::View::ZeroBytes), (std::vector<std::string>{"/d/empty"}));
+    EXPECT_EQ(index.wastedSpace(), 10);
+}
+
+TEST_F(FileIndexTest, SortBySizeKeepsParentFirst) {
+    // The directory counts with a cumulative size, ties keep name order
+    index.sortBySize([](const FileInfo& info) {
+        return info.isDirectory() ? 15 : info.getFileSize();
+    });
+    EXPECT_EQ(paths(FileIndex::View::All),
+              (std::vector<std::string>{"/d/..", "/d/c.txt", "/d/sub", "/d/a.txt",
+                                        "/d/b.txt", "/d/empty"}));
+    EXPECT_EQ(paths(FileIndex::View::Duplicates),
+              (std::vector<std::string>{"/d/a.txt", "/d/b.txt"}));
+
+    // Inserts are appended to the size order until the next sort
+    index.insert(file("/d/big.txt", 100, HashDigest()), true);
+    EXPECT_EQ(paths(FileIndex::View::All).back(), "/d/big.txt");
+
+    index.sort(true);
+    EXPECT_EQ(index.at(index.view(FileIndex::View::All)[1]).getPath(), "/d/sub");
+}
+
+TEST_F(FileIndexTest, GroupsUpdateIncrementally) {
+    // A third copy joins the group at its sorted position
+    index.insert(file("/d/a2.txt", 10, digest), true);
+    EXPECT_EQ(paths(FileIndex::View::Duplicates),
+              (std::vector<std::string>{"/d/a.txt", "/d/a2.txt", "/d/b.txt"}));
+    EXPECT_EQ(index.wastedSpace(), 20);
+
+    // Below two members the group is no longer a duplicate
+    EXPECT_TRUE(index.remove("/d/a.txt"));
+    EXPECT_TRUE(index.remove("/d/a2.txt"));
+    EXPECT_FALSE(index.remove("/d/a.txt"));
+    EXPECT_TRUE(paths(FileIndex::View::Duplicates).empty());
+    FileIndex::Id id;
+    ASSERT_TRUE(index.find("/d/b.txt", id));
+    EXPECT_FALSE(index.at(id).isDuplicate());
+    EXPECT_EQ(index.wastedSpace(), 0);
+
+    // A digest set later regroups the entry
+    ASSERT_TRUE(index.find("/d/c.txt", id));
+    index.setDigest(id, digest);
+    EXPECT_EQ(paths(FileIndex::View::Duplicates),
+              (std::vector<std::string>{"/d/b.txt", "/d/c.txt"}));
+}
+
+TEST_F(FileIndexTest, FindAndStaleIds) {
+    FileIndex::Id id;
+    ASSERT_TRUE(index.find("/d/c.txt", id));
+    EXPECT_TRUE(index.contains(id));
+    EXPECT_EQ(index.at(id).getFileSize(), 20);
+    EXPECT_FALSE(index.find("/d/missing", id));
+
+    ASSERT_TRUE(index.find("/d/c.txt", id));
+    index.clear();
+    EXPECT_TRUE(index.empty());
+    EXPECT_FALSE(index.contains(id));
+
+    // Ids of the new listing differ from the old ones
+    std::vector<FileInfo> entries;
+    entries.push_back(file("/e/c.txt", 20, HashDigest()));
+    index.append(std::move(entries));
+    EXPECT_FALSE(index.contains(id));
+    ASSERT_TRUE(index.find("/e/c.txt", id));
+    EXPECT_TRUE(index.contains(id));
+    EXPECT_FALSE(index.duplicatesKnown());
+}
+
+TEST_F(FileIndexTest, SnapshotCarriesIds) {
+    std::vector<FileIndex::Id> ids;
+    std::vector<FileInfo> copy = index.snapshot(&ids);
+    ASSERT_EQ(copy.size(), ids.size());
+    for (std::size_t i = 0; i < copy.size(); ++i) {
+        EXPECT_EQ(copy[i].getPath(), index.at(ids[i]).getPath());
+    }
+}
+
+TEST_F(FileIndexTest, LabelsAreBuiltOnce) {
+    for (FileIndex::Id id : index.view(FileIndex::View::All)) {
+        EXPECT_EQ(index.label(id, false), index.at(id).getDisplayName());
+        EXPECT_EQ(index.label(id, true), index.at(id).getPath());
+    }
+
+    FileIndex::Id id;
+    ASSERT_TRUE(index.find("/d/sub", id));
+    const std::string_view label = index.label(id, false);
+    EXPECT_EQ(label, "sub/");
+    EXPECT_EQ(index.label(id, false).data(), label.data()); // no new copy
+
+    // A new listing reuses slot numbers but not labels
+    index.clear();
+    std::vector<FileInfo> entries;
+    entries.push_back(file("/e/other", 1, HashDigest()));
+    index.append(std::move(entries));
+    ASSERT_TRUE(index.find("/e/other", id));
+    EXPECT_EQ(index.label(id, false), "other");
+}
+
+TEST_F(FileIndexTest, NameFilterFollowsListing) {
+    index.setNameFilter("TXT");
+    EXPECT_EQ(paths(FileIndex::View::Matches),
+              (std::vector<std::string>{"/d/a.txt", "/d/b.txt", "/d/c.txt"}));
+    index.setNameFilter("txt ^b");
+    EXPECT_EQ(paths(FileIndex::View::Matches), (std::vector<std::string>{"/d/b.txt"}));
+    index.setNameFilter(".");
+    EXPECT_EQ(paths(FileIndex::View::Matches),
+              (std::vector<std::string>{"/d/a.txt", "/d/b.txt", "/d/c.txt"})); // not ".."
+
+    // Changes of the listing reach the filter
+    index.setNameFilter("txt");
+    EXPECT_EQ(paths(FileIndex::View::Matches).size(), 3u);
+    index.insert(file("/d/0.txt", 1, HashDigest()), true);
+    EXPECT_TRUE(index.remove("/d/b.txt"));
+    EXPECT_EQ(paths(FileIndex::View::Matches),
+              (std::vector<std::string>{"/d/0.txt", "/d/a.txt", "/d/c.txt"}));
+
+    index.setNameFilter("");
+    EXPECT_EQ(paths(FileIndex::View::Matches).size(), index.size() - 1);
+}
+
+TEST_F(FileIndexTest, BatchRemoveCompactsOnce) {
+    std::vector<FileInfo> entries;
+    entries.push_back(file("/d/a2.txt", 10, digest));
+    index.append(std::move(entries));
+    index.sort(true);
+    ASSERT_EQ(paths(FileIndex::View::Duplicates).size(), 3u);
+
+    EXPECT_EQ(index.remove(std::vector<std::string>{"/d/a.txt", "/d/missing", "/d/c.txt",
+                                                    "/d/a.txt", "/d/b.txt"}),
+              3u);
+    EXPECT_EQ(paths(FileIndex::View::All),
+              (std::vector<std::string>{"/d/..", "/d/sub", "/d/a2.txt", "/d/empty"}));
+    EXPECT_TRUE(paths(FileIndex::View::Duplicates).empty()); // last member left alone
+    FileIndex::Id id;
+    ASSERT_TRUE(index.find("/d/a2.txt", id));
+    EXPECT_FALSE(index.at(id).isDuplicate());
+    EXPECT_FALSE(index.find("/d/b.txt", id));
+    EXPECT_EQ(index.remove(std::vector<std::string>{}), 0u);
+}
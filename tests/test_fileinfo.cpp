@@ -12,6 +12,8 @@
 #include <gtest/gtest.h>
 #include "fileinfo.hpp"
 #include "utils.hpp"
+#include <cstdio>
+#include <vector>
 
 /**
  * @test BasicConstruction
@@ -199,4 +201,143 @@ TEST(FileInfoTest, ZeroFilesDetection) {
 
     FileInfo dir("/tmp/folder", 0, true);
     EXPECT_FALSE(dir.zeroFiles());  // Directories don't count
-}
\ No newline at end of file
+}
+/**
+ * @test PathRoundTrip
+ * @brief Verifies that paths split into directory and name are rebuilt unchanged
+ *
+ * FileInfo stores the parent directory and the name separately; getPath()
+ * must return exactly the string passed in, including edge cases like the
+ * root directory, relative paths and names without a directory.
+ *
+ * @see FileInfo::getPath()
+ * @see FileInfo::getName()
+ */
+TEST(FileInfoTest, PathRoundTrip) {
+    for (const std::string path : {"/tmp/test.txt", "/test.txt", "/", "relative/dir/a",
+                                   "plain", "/tmp/with space/x.y", "/tmp/trailing/"}) {
+        FileInfo info(path, 1, false);
+        EXPECT_EQ(info.getPath(), path);
+    }
+
+    FileInfo file("/home/user/document.pdf", 1024, false);
+    EXPECT_EQ(file.getName(), "document.pdf");
+
+    FileInfo root("/", 0, true);
+    EXPECT_EQ(root.getDisplayName(), "/");
+}
+
+/**
+ * @test SharedArena
+ * @brief Verifies that entries of one scan share directory storage
+ *
+ * @see PathArena
+ */
+TEST(FileInfoTest, SharedArena) {
+    auto arena = std::make_shared<PathArena>();
+    FileInfo a(arena, "/data/photos/a.jpg", 10, 0);
+    FileInfo b(arena, "/data/photos/b.jpg", 20, 0);
+    FileInfo dir(arena, "/data/photos/raw", 0, FileInfo::Directory);
+
+    EXPECT_EQ(a.getPath(), "/data/photos/a.jpg");
+    EXPECT_EQ(b.getPath(), "/data/photos/b.jpg");
+    EXPECT_EQ(dir.getDisplayName(), "raw/");
+    EXPECT_TRUE(dir.isDirectory());
+
+    // Copies keep the arena alive
+    FileInfo copy = a;
+    arena.reset();
+    EXPECT_EQ(copy.getPath(), "/data/photos/a.jpg");
+}
+
+/**
+ * @test InodeRecordInArena
+ * @brief Scan-time identity is kept behind the name, not in the entry
+ *
+ * @see PathArena::Inode
+ */
+TEST(FileInfoTest, InodeRecordInArena) {
+    auto arena = std::make_shared<PathArena>();
+    const PathArena::Inode record{42, 1234, 8, 2};
+    FileInfo a(arena, "/data/a.bin", 100, 0, &record);
+    FileInfo link(arena, "/backup/a.bin", 100, 0, &record);
+    FileInfo plain(arena, "/data/b.bin", 100, 0);
+
+    EXPECT_TRUE(a.hasInode());
+    EXPECT_EQ(a.getName(), "a.bin");
+    EXPECT_EQ(a.getInode().inode, 1234u);
+    EXPECT_EQ(a.getInode().links, 2u);
+    EXPECT_EQ(a.getAllocatedSize(), 8 * 512);
+    EXPECT_TRUE(a.sameInode(link));
+
+    EXPECT_FALSE(plain.hasInode());
+    EXPECT_EQ(plain.getAllocatedSize(), 100);
+    EXPECT_FALSE(plain.sameInode(a));
+}
+
+/**
+ * @test ArenaPastFourGiB
+ * @brief Names in chunk 65536 and beyond, where a 32-bit offset with a
+ *        CHUNK_SIZE stride wraps, still resolve to their own bytes
+ *
+ * Small chunks (one name and inode record each) reach that chunk index
+ * with a few MB instead of 4 GiB.
+ *
+ * @see PathArena::NameRef
+ */
+TEST(FileInfoTest, ArenaPastFourGiB) {
+    EXPECT_LE(sizeof(PathArena::NameRef), 8u);
+
+    PathArena arena(64);
+    const std::size_t count = (std::size_t(1) << 32) / PathArena::CHUNK_SIZE + 100;
+    std::vector<PathArena::NameRef> refs;
+    refs.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        PathArena::Inode record;
+        record.inode = i;
+        char name[48];
+        std::snprintf(name, sizeof(name), "name-%039zu", i);
+        refs.push_back(arena.addName(name, record));
+    }
+    ASSERT_GT(arena.chunkCount(), (std::size_t(1) << 32) / PathArena::CHUNK_SIZE);
+
+    for (std::size_t i : {std::size_t(0), std::size_t(1), count - 101, count - 100, count - 1}) {
+        char name[48];
+        std::snprintf(name, sizeof(name), "name-%039zu", i);
+        EXPECT_EQ(arena.name(refs[i]), name) << i;
+        EXPECT_EQ(arena.inode(refs[i]).inode, i);
+    }
+}
+
+/**
+ * @test CompactLayout
+ * @brief Verifies that an entry stays small and stores its hash in binary
+ *
+ * @see FileInfo::getDigest()
+ */
+TEST(FileInfoTest, CompactLayout) {
+    EXPECT_LE(sizeof(FileInfo), 64u);
+
+    FileInfo info("/tmp/file.txt", 100, false);
+    info.setDigest(HashDigest::fromUint64(0xCBF29CE484222325ull));
+    EXPECT_EQ(info.getHash(), "CBF29CE484222325");
+    EXPECT_EQ(info.getDigest(), HashDigest::fromUint64(0xCBF29CE484222325ull));
+}
+
+/**
+ * @test ExecutableFlagFromScan
+ * @brief Verifies that the executable color comes from scan-time flags
+ *
+ * getColorCode() must not query the file system; the Executable flag is
+ * set by the scanner.
+ *
+ * @see FileInfo::getColorCode()
+ */
+TEST(FileInfoTest, ExecutableFlagFromScan) {
+    auto arena = std::make_shared<PathArena>();
+    FileInfo exec(arena, "/does/not/exist/run.sh", 10, FileInfo::Executable);
+    FileInfo plain(arena, "/does/not/exist/readme", 10, 0);
+
+    EXPECT_EQ(exec.getColorCode(), 2);
+    EXPECT_EQ(plain.getColorCode(), 7);
+}
@@ -169,6 +169,32 @@ TEST_F(FileSafetyTest, DetectsVirtualFilesystems) {
               FileSafety::DeletionStatus::BlockedVirtualFS);
 }
 
+/**
+ * @test BlocksPathsThroughSymlinkedDirectories
+ * @brief A path below a link into tmpfs counts for tmpfs, not the link's mount
+ *
+ * The link itself lies on the normal file system and may be deleted.
+ *
+ * @see FileSafety::checkDeletions()
+ */
+TEST_F(FileSafetyTest, BlocksPathsThroughSymlinkedDirectories) {
+    if (!std::filesystem::is_directory("/dev/shm") ||
+        !FileSafety::isProtectedFilesystem("/dev/shm")) {
+        GTEST_SKIP() << "/dev/shm is not a tmpfs here";
+    }
+    std::filesystem::create_directory_symlink("/dev/shm", test_dir / "ramdisk");
+    const std::string inside = (test_dir / "ramdisk" / "x").string();
+
+    EXPECT_EQ(FileSafety::checkDeletion(inside),
+              FileSafety::DeletionStatus::BlockedVirtualFS);
+    const auto statuses = FileSafety::checkDeletions(
+        {inside, (test_dir / "ramdisk" / "y").string(), (test_dir / "ramdisk").string()});
+    ASSERT_EQ(statuses.size(), 3u);
+    EXPECT_EQ(statuses[0], FileSafety::DeletionStatus::BlockedVirtualFS);
+    EXPECT_EQ(statuses[1], FileSafety::DeletionStatus::BlockedVirtualFS);
+    EXPECT_EQ(statuses[2], FileSafety::checkDeletion(test_dir.string() + "/file"));
+}
+
 /**
  * @test GetsMountPoints
  * @brief Verifies retrieval of system mount point information
@@ -27,59 +27,70 @@
  * - SortingOrderComplete: Full hierarchical sort validation
  *   (Order: parent -> dirs alphabetically -> files alphabetically)
  *
- * ### Hash Calculation (5 tests)
- * - CalculatesHashes: Hash generation for non-empty files
+ * ### Metadata-only Scanning (3 tests)
+ * - DoesNotHashDuringScan: Non-empty files are not read during the scan
  * - DoesNotHashEmptyFiles: Empty files skip hashing
  * - DoesNotHashDirectories: Directories don't get hashed
- * - IdenticalFilesHaveSameHash: Consistent hashing for same content
- * - DifferentFilesHaveDifferentHashes: Unique hashes for different content
+ *
+ * Content hashing is covered by the staged duplicate tests in
+ * test_duplicatefinder.cpp.
  *
  * ### Recursive Scanning (2 tests)
  * - RecursiveScan: Deep directory traversal (3 levels)
  * - RecursiveScanDoesNotIncludeParent: Parent handling in recursive mode
  *
+ * ### Parallel Scanning (2 tests)
+ * - ParallelRecursiveScanMatchesSequential: Same sorted result on 4 threads
+ * - ParallelScanReportsProgress: Callback and atomic counter are updated
+ *
+ * ### Scan Policies (1 test)
+ * - ProgressPolicyDoesNotChangeResult: Every walk/progress instantiation
+ *   lists the same entries; reports come every 10/100 entries
+ *
+ * ### Streaming Scans (3 tests)
+ * - StreamingDeliversBatches: Bounded batches, parent in the first batch
+ * - StreamingStopsWhenCallbackDeclines: Returning false ends the scan
+ * - ParallelStreamingDeliversAllEntries: Batches of all workers add up
+ *
+ * ### Backends (1 test)
+ * - NativeBackendMatchesPortable: getdents64/statx and std::filesystem
+ *   agree on paths, types, sizes and permissions (incl. symlinks)
+ *
  * ### Edge Cases (1 test)
  * - HandlesNonExistentDirectory: Graceful handling of invalid paths
  *
- * @note All tests use FNV1A hash calculator for consistency
  * @note Tests run in isolated temporary directories with automatic cleanup
  *
  * @see FileScanner
  * @see FileInfo
- * @see FNV1A
  */
 
 #include <gtest/gtest.h>
 #include "filescanner.hpp"
-#include "fnv1a.hpp"
 #include <filesystem>
+#include <algorithm>
 #include <fstream>
+#include <map>
 
 /**
  * @class FileScannerTest
  * @brief Test fixture for FileScanner unit tests
  *
  * Provides a test environment with a temporary test directory and helper
- * methods for creating test files and directories. Uses FNV1A hash calculator
- * for all tests to ensure consistent hashing behavior.
+ * methods for creating test files and directories.
  *
  * The fixture provides:
  * - Isolated temporary test directory for each test
  * - Automatic cleanup after each test
  * - Helper methods for creating test files and directories
- * - Pre-configured FNV1A hasher instance
  *
  * @see FileScanner
- * @see FNV1A
  */
 class FileScannerTest : public ::testing::Test {
 protected:
     /** @brief Path to temporary test directory */
     std::filesystem::path test_dir;
 
-    /** @brief FNV1A hash calculator instance used for all tests */
-    FNV1A hasher;
-
     /**
      * @brief Sets up the test environment before each test
      *
@@ -143,7 +154,7 @@ protected:
  * @see FileScanner::scanDirectory()
  */
 TEST_F(FileScannerTest, ScansEmptyDirectory) {
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
 
     EXPECT_TRUE(results.empty());
@@ -164,7 +175,7 @@ TEST_F(FileScannerTest, ScansFilesInDirectory) {
     createFile("file1.txt", "content1");
     createFile("file2.txt", "content2");
 
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
 
     EXPECT_EQ(results.size(), 2);
@@ -191,7 +202,7 @@ TEST_F(FileScannerTest, ScansDirectories) {
     createDir("subdir2");
     createFile("file.txt", "test");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
     
     EXPECT_EQ(results.size(), 3);
@@ -216,7 +227,7 @@ TEST_F(FileScannerTest, ScansDirectories) {
 TEST_F(FileScannerTest, IncludesParentDirectory) {
     createFile("file.txt", "test");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, true);
     
     // Should have: ".." + "file.txt" = 2
@@ -230,7 +241,7 @@ TEST_F(FileScannerTest, IncludesParentDirectory) {
 TEST_F(FileScannerTest, ExcludesParentDirectory) {
     createFile("file.txt", "test");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
     
     // Should have only: "file.txt" = 1
@@ -243,7 +254,7 @@ TEST_F(FileScannerTest, SortsParentDirectoryFirst) {
     createFile("bbb.txt", "test");
     createDir("dir");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, true);
     
     // First should be parent (..)
@@ -255,7 +266,7 @@ TEST_F(FileScannerTest, SortsDirectoriesBeforeFiles) {
     createFile("file.txt", "test");
     createDir("directory");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
     
     EXPECT_EQ(results.size(), 2);
@@ -270,7 +281,7 @@ TEST_F(FileScannerTest, SortsAlphabetically) {
     createFile("apple.txt", "test");
     createFile("banana.txt", "test");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
     
     EXPECT_EQ(results.size(), 3);
@@ -285,23 +296,23 @@ TEST_F(FileScannerTest, SortsAlphabetically) {
     EXPECT_EQ(name2, "zebra.txt");
 }
 
-TEST_F(FileScannerTest, CalculatesHashes) {
+TEST_F(FileScannerTest, DoesNotHashDuringScan) {
     createFile("file1.txt", "hello world");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
     
     EXPECT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].getFileSize(), 11);
     
-    // Hash should be calculated for non-empty file
-    EXPECT_FALSE(results[0].getHash().empty());
-    EXPECT_GT(results[0].getHash().length(), 0);
+    // Scan is metadata-only; hashing is done by DuplicateFinder
+    EXPECT_TRUE(results[0].getHash().empty());
 }
 
 TEST_F(FileScannerTest, DoesNotHashEmptyFiles) {
     createFile("empty.txt", "");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
     
     EXPECT_EQ(results.size(), 1);
@@ -314,7 +325,7 @@ TEST_F(FileScannerTest, DoesNotHashEmptyFiles) {
 TEST_F(FileScannerTest, DoesNotHashDirectories) {
     createDir("testdir");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
     
     EXPECT_EQ(results.size(), 1);
@@ -324,6 +335,32 @@ TEST_F(FileScannerTest, DoesNotHashDirectories) {
     EXPECT_TRUE(results[0].getHash().empty());
 }
 
+TEST_F(FileScannerTest, CapturesTypeAndPermissionsAtScan) {
+    createFile("run.sh", "#!/bin/sh\n");
+    createFile("plain.txt", "text");
+    createDir("dir");
+    std::filesystem::permissions(test_dir / "run.sh", std::filesystem::perms::owner_exec,
+                                 std::filesystem::perm_options::add);
+    std::filesystem::create_symlink(test_dir / "dir", test_dir / "link");
+
+    FileScanner scanner;
+    auto results = scanner.scanDirectory(test_dir.string(), false, false);
+    ASSERT_EQ(results.size(), 4u);
+
+    // Flags survive removal of the files: nothing is queried at render time
+    std::filesystem::remove_all(test_dir);
+
+    std::map<std::string, const FileInfo*> byName;
+    for (const auto& info : results) {
+        byName[std::string(info.getName())] = &info;
+    }
+    EXPECT_EQ(byName["run.sh"]->getColorCode(), 2);
+    EXPECT_EQ(byName["plain.txt"]->getColorCode(), 7);
+    EXPECT_TRUE(byName["dir"]->isDirectory());
+    EXPECT_TRUE(byName["link"]->isDirectory());  // symlinks are followed
+    EXPECT_EQ(byName["plain.txt"]->getPath(), (test_dir / "plain.txt").string());
+}
+
 TEST_F(FileScannerTest, RecursiveScan) {
     createFile("root_file.txt", "root");
     createDir("subdir");
@@ -331,7 +368,7 @@ TEST_F(FileScannerTest, RecursiveScan) {
     createDir("subdir/deepdir");
     createFile("subdir/deepdir/deep_file.txt", "deep");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), true, false);
     
     // Should find all files recursively
@@ -349,12 +386,44 @@ TEST_F(FileScannerTest, RecursiveScan) {
     EXPECT_TRUE(found_deep);
 }
 
+/**
+ * @test StopTokenEndsScan
+ * @brief A stop ends the scan after the current entry; no batch follows
+ */
+TEST_F(FileScannerTest, StopTokenEndsScan) {
+    for (int i = 0; i < 20; ++i) {
+        createFile("file" + std::to_string(i), "x");
+    }
+    createDir("subdir");
+    createFile("subdir/deep", "y");
+
+    StopSource stop;
+    FileScanner scanner;
+    scanner.setStopToken(stop.token());
+    std::size_t batches = 0;
+    const std::size_t delivered = scanner.scanDirectoryStreaming(
+        test_dir, true, false,
+        [&](std::vector<FileInfo>&&) {
+            ++batches;
+            stop.requestStop();
+            return true;
+        },
+        nullptr, 1);
+    EXPECT_EQ(batches, 1u);
+    EXPECT_EQ(delivered, 1u);
+
+    // Already stopped: nothing is listed, also by the parallel walker
+    EXPECT_TRUE(scanner.scanDirectory(test_dir, false, true).empty());
+    scanner.setThreadCount(4);
+    EXPECT_TRUE(scanner.scanDirectory(test_dir, true, false).empty());
+}
+
 TEST_F(FileScannerTest, RecursiveScanDoesNotIncludeParent) {
     createFile("file.txt", "test");
     createDir("subdir");
     createFile("subdir/sub.txt", "sub");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), true, true);
     
     // Parent (..) should NOT be included in recursive scan
@@ -368,7 +437,7 @@ TEST_F(FileScannerTest, HandlesSpecialCharacters) {
     createFile("file-with-dashes.txt", "test");
     createFile("file_with_underscores.txt", "test");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
     
     EXPECT_EQ(results.size(), 3);
@@ -382,7 +451,7 @@ TEST_F(FileScannerTest, DetectsFileSize) {
     createFile("small.txt", "x");          // 1 byte
     createFile("medium.txt", std::string(1024, 'x'));  // 1 KB
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, false);
     
     EXPECT_EQ(results.size(), 2);
@@ -398,35 +467,8 @@ TEST_F(FileScannerTest, DetectsFileSize) {
     }
 }
 
-TEST_F(FileScannerTest, IdenticalFilesHaveSameHash) {
-    createFile("file1.txt", "identical content");
-    createFile("file2.txt", "identical content");
-    
-    FileScanner scanner(hasher);
-    auto results = scanner.scanDirectory(test_dir.string(), false, false);
-    
-    EXPECT_EQ(results.size(), 2);
-    
-    // Both files should have the same hash
-    EXPECT_EQ(results[0].getHash(), results[1].getHash());
-    EXPECT_FALSE(results[0].getHash().empty());
-}
-
-TEST_F(FileScannerTest, DifferentFilesHaveDifferentHashes) {
-    createFile("file1.txt", "content A");
-    createFile("file2.txt", "content B");
-    
-    FileScanner scanner(hasher);
-    auto results = scanner.scanDirectory(test_dir.string(), false, false);
-    
-    EXPECT_EQ(results.size(), 2);
-    
-    // Files should have different hashes
-    EXPECT_NE(results[0].getHash(), results[1].getHash());
-}
-
 TEST_F(FileScannerTest, HandlesNonExistentDirectory) {
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     
     // Should not throw, but return empty or handle gracefully
     EXPECT_NO_THROW({
@@ -442,7 +484,7 @@ TEST_F(FileScannerTest, SortingOrderComplete) {
     createFile("banana.txt", "test");
     createDir("cherry_dir");
     
-    FileScanner scanner(hasher);
+    FileScanner scanner;
     auto results = scanner.scanDirectory(test_dir.string(), false, true);
     
     // Expected order:
@@ -469,4 +511,271 @@ TEST_F(FileScannerTest, SortingOrderComplete) {
     EXPECT_EQ(name2, "cherry_dir");
     EXPECT_EQ(name3, "banana.txt");
     EXPECT_EQ(name4, "zebra.txt");
-}
\ No newline at end of file
+}
+
+TEST_F(FileScannerTest, ParallelRecursiveScanMatchesSequential) {
+    for (int d = 0; d < 5; ++d) {
+        std::string dir = "dir" + std::to_string(d);
+        createDir(dir + "/nested/deeper");
+        for (int f = 0; f < 20; ++f) {
+            createFile(dir + "/file" + std::to_string(f) + ".txt", "x");
+            createFile(dir + "/nested/deeper/f" + std::to_string(f), "yy");
+        }
+    }
+    createFile("root.txt", "root");
+
+    FileScanner sequential;
+    auto expected = sequential.scanDirectory(test_dir.string(), true, false);
+
+    FileScanner parallel;
+    parallel.setThreadCount(4);
+    auto results = parallel.scanDirectory(test_dir.string(), true, false);
+
+    ASSERT_EQ(results.size(), expected.size());
+    std::vector<std::string> expected_paths;
+    std::vector<std::string> result_paths;
+    for (size_t i = 0; i < results.size(); ++i) {
+        expected_paths.push_back(expected[i].getPath());
+        result_paths.push_back(results[i].getPath());
+        EXPECT_EQ(results[i].isDirectory(), expected[i].isDirectory());
+    }
+    std::sort(expected_paths.begin(), expected_paths.end());
+    std::sort(result_paths.begin(), result_paths.end());
+    EXPECT_EQ(result_paths, expected_paths);
+
+    // Directories still sorted before files
+    EXPECT_TRUE(results.front().isDirectory());
+    EXPECT_FALSE(results.back().isDirectory());
+}
+
+TEST_F(FileScannerTest, ParallelScanReportsProgress) {
+    for (int i = 0; i < 250; ++i) {
+        createFile("file" + std::to_string(i), "x");
+    }
+    createDir("sub");
+    createFile("sub/inner.txt", "x");
+
+    std::atomic<int> counter{0};
+    int last_progress = 0;
+
+    FileScanner scanner;
+    scanner.setThreadCount(3);
+    scanner.setProgressCounter(&counter);
+    auto results = scanner.scanDirectory(test_dir.string(), true, false,
+                                         [&](int count) { last_progress = count; });
+
+    EXPECT_EQ(results.size(), 252);
+    EXPECT_EQ(counter.load(), 252);
+    EXPECT_EQ(last_progress, 252);
+}
+
+TEST_F(FileScannerTest, ProgressPolicyDoesNotChangeResult) {
+    for (int i = 0; i < 25; ++i) {
+        createFile("file" + std::to_string(i), "x");
+    }
+    createDir("sub");
+    for (int i = 0; i < 200; ++i) {
+        createFile("sub/inner" + std::to_string(i), "x");
+    }
+
+    FileScanner scanner;
+    for (bool recursive : {false, true}) {
+        std::vector<int> reports;
+        const auto silent = scanner.scanDirectory(test_dir.string(), recursive, !recursive);
+        const auto reported = scanner.scanDirectory(test_dir.string(), recursive, !recursive,
+                                                    [&](int count) { reports.push_back(count); });
+
+        ASSERT_EQ(silent.size(), reported.size());
+        for (std::size_t i = 0; i < silent.size(); ++i) {
+            EXPECT_EQ(silent[i].getPath(), reported[i].getPath());
+        }
+
+        // Periodic reports, then the final count (parent not counted)
+        const int entries = recursive ? 226 : 26;
+        const int step = recursive ? 100 : 10;
+        ASSERT_EQ(reports.size(), static_cast<std::size_t>(entries / step + 1));
+        for (std::size_t i = 0; i + 1 < reports.size(); ++i) {
+            EXPECT_EQ(reports[i], static_cast<int>(i + 1) * step);
+        }
+        EXPECT_EQ(reports.back(), entries);
+    }
+}
+
+TEST_F(FileScannerTest, StreamingDeliversBatches) {
+    for (int i = 0; i < 25; ++i) {
+        createFile("file" + std::to_string(i), "x");
+    }
+
+    FileScanner scanner;
+    std::vector<std::size_t> batch_sizes;
+    std::vector<FileInfo> all;
+    auto delivered = scanner.scanDirectoryStreaming(
+        test_dir.string(), false, true,
+        [&](std::vector<FileInfo>&& batch) {
+            batch_sizes.push_back(batch.size());
+            std::move(batch.begin(), batch.end(), std::back_inserter(all));
+            return true;
+        },
+        nullptr, 10);
+
+    EXPECT_EQ(delivered, 26u);
+    ASSERT_EQ(all.size(), 26u);
+    EXPECT_TRUE(all.front().isParentDir());
+    for (auto size : batch_sizes) {
+        EXPECT_LE(size, 10u);
+    }
+
+    // Batches are unsorted; sortEntries() gives the scanDirectory() order
+    FileScanner::sortEntries(all, true);
+    auto expected = scanner.scanDirectory(test_dir.string(), false, true);
+    ASSERT_EQ(all.size(), expected.size());
+    for (size_t i = 0; i < all.size(); ++i) {
+        EXPECT_EQ(all[i].getPath(), expected[i].getPath());
+    }
+}
+
+TEST_F(FileScannerTest, StreamingStopsWhenCallbackDeclines) {
+    for (int i = 0; i < 50; ++i) {
+        createFile("file" + std::to_string(i), "x");
+    }
+
+    FileScanner scanner;
+    int batches = 0;
+    auto delivered = scanner.scanDirectoryStreaming(
+        test_dir.string(), false, false,
+        [&](std::vector<FileInfo>&&) { return ++batches < 2; },
+        nullptr, 10);
+
+    EXPECT_EQ(batches, 2);
+    EXPECT_EQ(delivered, 20u);
+}
+
+TEST_F(FileScannerTest, ParallelStreamingDeliversAllEntries) {
+    for (int d = 0; d < 4; ++d) {
+        std::string dir = "dir" + std::to_string(d);
+        createDir(dir);
+        for (int f = 0; f < 30; ++f) {
+            createFile(dir + "/file" + std::to_string(f), "x");
+        }
+    }
+
+    FileScanner scanner;
+    scanner.setThreadCount(3);
+    std::vector<std::string> paths;
+    auto delivered = scanner.scanDirectoryStreaming(
+        test_dir.string(), true, false,
+        [&](std::vector<FileInfo>&& batch) {
+            for (const auto& info : batch) {
+                paths.push_back(info.getPath());
+            }
+            return true;
+        },
+        nullptr, 16);
+
+    EXPECT_EQ(delivered, 124u);
+    EXPECT_EQ(paths.size(), 124u);
+    std::sort(paths.begin(), paths.end());
+    EXPECT_EQ(std::unique(paths.begin(), paths.end()), paths.end());
+}
+
+TEST_F(FileScannerTest, NativeBackendMatchesPortable) {
+    createDir("dir/sub");
+    createFile("dir/sub/deep.txt", "deep");
+    createFile("plain.txt", "hello");
+    createFile("empty.txt", "");
+    createFile("tool.sh", "#!/bin/sh\n");
+    std::filesystem::permissions(test_dir / "tool.sh",
+                                 std::filesystem::perms::owner_exec,
+                                 std::filesystem::perm_options::add);
+    std::filesystem::create_directory_symlink(test_dir / "dir", test_dir / "dirlink");
+    std::filesystem::create_symlink(test_dir / "plain.txt", test_dir / "filelink");
+    std::filesystem::create_symlink(test_dir / "missing", test_dir / "broken");
+
+    for (bool recursive : {false, true}) {
+        FileScanner portable;
+        portable.setBackend(FileScanner::Backend::Portable);
+        auto expected = portable.scanDirectory(test_dir.string(), recursive, !recursive);
+
+        FileScanner native;
+        EXPECT_EQ(native.getBackend(), FileScanner::Backend::Native);
+        auto results = native.scanDirectory(test_dir.string(), recursive, !recursive);
+
+        ASSERT_EQ(results.size(), expected.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            EXPECT_EQ(results[i].getPath(), expected[i].getPath());
+            EXPECT_EQ(results[i].isDirectory(), expected[i].isDirectory());
+            EXPECT_EQ(results[i].getFileSize(), expected[i].getFileSize());
+            EXPECT_EQ(results[i].getColorCode(), expected[i].getColorCode());
+            EXPECT_EQ(results[i].getModifiedTime(), expected[i].getModifiedTime());
+        }
+    }
+}
+
+TEST_F(FileScannerTest, SortOrders) {
+    auto entry = [](const std::string& name, long long size, std::int64_t mtime) {
+        FileInfo info("/d/" + name, size, false);
+        info.setModifiedTime(mtime);
+        return info;
+    };
+    std::vector<FileInfo> entries;
+    entries.push_back(entry("v10", 1, 300));
+    entries.push_back(entry("v9", 30, 100));
+    entries.emplace_back("/d/sub", 0, true);
+    entries.push_back(entry("v2", 20, 200));
+    entries.push_back(entry("v02", 20, 0));
+
+    auto names = [&entries](FileScanner::SortOrder order) {
+        FileScanner::sortEntries(entries, false, order);
+        std::vector<std::string> result;
+        for (const auto& info : entries) {
+            result.emplace_back(info.getName());
+        }
+        return result;
+    };
+    using V = std::vector<std::string>;
+    EXPECT_EQ(names(FileScanner::SortOrder::Name), (V{"sub", "v02", "v10", "v2", "v9"}));
+    EXPECT_EQ(names(FileScanner::SortOrder::Size), (V{"sub", "v9", "v02", "v2", "v10"}));
+    EXPECT_EQ(names(FileScanner::SortOrder::Modified), (V{"sub", "v10", "v2", "v9", "v02"}));
+    EXPECT_EQ(names(FileScanner::SortOrder::Natural), (V{"sub", "v02", "v2", "v9", "v10"}));
+
+    FileScanner::SortOrder order;
+    EXPECT_TRUE(FileScanner::parseSortOrder("mtime", order));
+    EXPECT_EQ(order, FileScanner::SortOrder::Modified);
+    EXPECT_STREQ(FileScanner::sortOrderName(order), "mtime");
+    EXPECT_FALSE(FileScanner::parseSortOrder("random", order));
+}
+
+TEST_F(FileScannerTest, LargeSortMatchesComparator) {
+    // Above both thresholds; shared name prefixes give long runs of equal keys
+    const std::size_t count = FileScanner::PARALLEL_SORT_THRESHOLD + 1000;
+    std::vector<FileInfo> entries;
+    entries.reserve(count);
+    std::uint64_t seed = 12345;
+    for (std::size_t i = 0; i < count; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const std::string prefix = (seed >> 60) < 8 ? "IMG_2024_" : "";
+        FileInfo info("/d/" + prefix + std::to_string(seed % 1000003) + "_" +
+                          std::to_string(i),
+                      static_cast<long long>((seed >> 20) % 5000), (seed >> 40) % 13 == 0);
+        info.setModifiedTime(static_cast<std::int64_t>(seed >> 30) - (1LL << 32));
+        entries.push_back(std::move(info));
+    }
+
+    for (auto order : {FileScanner::SortOrder::Name, FileScanner::SortOrder::Size,
+                       FileScanner::SortOrder::Modified, FileScanner::SortOrder::Natural}) {
+        std::vector<FileInfo> sorted = entries;
+        FileScanner::sortEntries(sorted, false, order);
+
+        std::vector<FileInfo> expected = entries;
+        std::sort(expected.begin(), expected.end(),
+                  [order](const FileInfo& a, const FileInfo& b) {
+                      return FileScanner::entryLess(a, b, false, order);
+                  });
+
+        ASSERT_EQ(sorted.size(), expected.size());
+        for (std::size_t i = 0; i < sorted.size(); ++i) {
+            ASSERT_EQ(sorted[i].getName(), expected[i].getName())
+                << FileScanner::sortOrderName(order) << " at " << i;
+        }
+    }
+}
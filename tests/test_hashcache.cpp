@@ -0,0 +1,238 @@
+/**
+ * @file test_hashcache.cpp
+ * @brief Unit tests for the persistent hash cache
+ *
+ * Verifies persistence across instances, invalidation on file changes,
+ * sharing between concurrently open caches and that the cached calculator
+ * skips content reads for unchanged files.
+ *
+ * @see HashCache
+ * @see CachedHashCalculator
+ */
+
+#include <gtest/gtest.h>
+#include "cachedhashcalculator.hpp"
+#include "fnv1a.hpp"
+#include "hashcache.hpp"
+#include <filesystem>
+#include <fstream>
+
+/**
+ * @class CountingFullHasher
+ * @brief FNV1A wrapper counting calls, to detect content reads
+ */
+class CountingFullHasher : public IHashCalculator {
+public:
+    mutable int calls = 0;
+
+    HashDigest calculateHash(const std::string& filePath) const override {
+        ++calls;
+        return m_fnv.calculateHash(filePath);
+    }
+
+    const char* name() const override { return m_fnv.name(); }
+
+private:
+    FNV1A m_fnv;
+};
+
+/**
+ * @class HashCacheTest
+ * @brief Test fixture with a temporary directory for files and the cache
+ *
+ * Files get an mtime in the past; digests of files modified within the
+ * last seconds are deliberately not cached.
+ */
+class HashCacheTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::string cache_path;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "hashcache_test";
+        std::filesystem::remove_all(test_dir);
+        std::filesystem::create_directories(test_dir);
+        cache_path = (test_dir / "cache" / HashCache::FILE_NAME).string();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    std::string createFile(const std::string& name, const std::string& content) {
+        auto path = test_dir / name;
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << content;
+        }
+        std::filesystem::last_write_time(
+            path, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+        return path.string();
+    }
+
+    static FileStamp stampOf(const std::string& path) {
+        FileStamp stamp;
+        EXPECT_TRUE(FileStamp::fromPath(path, stamp));
+        return stamp;
+    }
+};
+
+/**
+ * @test PersistsAcrossInstances
+ * @brief A stored digest is found again after reopening the cache file
+ */
+TEST_F(HashCacheTest, PersistsAcrossInstances) {
+    std::string path = createFile("a.txt", "content");
+    FileStamp stamp = stampOf(path);
+    HashDigest digest = HashDigest::fromUint64(0x1234);
+
+    {
+        HashCache cache(cache_path);
+        ASSERT_TRUE(cache.isOpen());
+        cache.store(stamp, "fnv1a", 0, digest);
+    }
+
+    HashCache cache(cache_path);
+    HashDigest cached;
+    ASSERT_TRUE(cache.lookup(stamp, "fnv1a", 0, cached));
+    EXPECT_EQ(cached, digest);
+
+    // Algorithm and sample size are part of the key
+    EXPECT_FALSE(cache.lookup(stamp, "xxh64", 0, cached));
+    EXPECT_FALSE(cache.lookup(stamp, "fnv1a", 4096, cached));
+}
+
+/**
+ * @test ChangedFileIsAMiss
+ * @brief A different size or mtime invalidates the entry
+ */
+TEST_F(HashCacheTest, ChangedFileIsAMiss) {
+    std::string path = createFile("a.txt", "content");
+    FileStamp stamp = stampOf(path);
+
+    HashCache cache(cache_path);
+    cache.store(stamp, "fnv1a", 0, HashDigest::fromUint64(1));
+
+    FileStamp resized = stamp;
+    resized.size += 1;
+    FileStamp touched = stamp;
+    touched.mtime_ns += 1;
+
+    HashDigest cached;
+    EXPECT_TRUE(cache.lookup(stamp, "fnv1a", 0, cached));
+    EXPECT_FALSE(cache.lookup(resized, "fnv1a", 0, cached));
+    EXPECT_FALSE(cache.lookup(touched, "fnv1a", 0, cached));
+}
+
+/**
+ * @test SharedBetweenOpenInstances
+ * @brief Records flushed by one instance are visible to another open one
+ */
+TEST_F(HashCacheTest, SharedBetweenOpenInstances) {
+    std::string path = createFile("a.txt", "content");
+    FileStamp stamp = stampOf(path);
+
+    HashCache first(cache_path);
+    HashCache second(cache_path);
+
+    first.store(stamp, "fnv1a", 0, HashDigest::fromUint64(7));
+    first.flush();
+
+    HashDigest cached;
+    ASSERT_TRUE(second.lookup(stamp, "fnv1a", 0, cached));
+    EXPECT_EQ(cached, HashDigest::fromUint64(7));
+}
+
+/**
+ * @test IgnoresCorruptTail
+ * @brief A torn record at the end is skipped and cut off on the next write
+ */
+TEST_F(HashCacheTest, IgnoresCorruptTail) {
+    std::string a = createFile("a.txt", "aaa");
+    std::string b = createFile("b.txt", "bbb");
+
+    {
+        HashCache cache(cache_path);
+        cache.store(stampOf(a), "fnv1a", 0, HashDigest::fromUint64(1));
+    }
+    {
+        std::ofstream garbage(cache_path, std::ios::binary | std::ios::app);
+        garbage << "torn";
+    }
+    {
+        HashCache cache(cache_path);
+        cache.store(stampOf(b), "fnv1a", 0, HashDigest::fromUint64(2));
+    }
+
+    HashCache cache(cache_path);
+    HashDigest cached;
+    EXPECT_TRUE(cache.lookup(stampOf(a), "fnv1a", 0, cached));
+    EXPECT_TRUE(cache.lookup(stampOf(b), "fnv1a", 0, cached));
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+/**
+ * @test CachedCalculatorSkipsUnchangedFiles
+ * @brief The second hash of an unchanged file does not read its content
+ */
+TEST_F(HashCacheTest, CachedCalculatorSkipsUnchangedFiles) {
+    std::string path = createFile("a.txt", "content");
+
+    auto counting = std::make_unique<CountingFullHasher>();
+    auto* inner = counting.get();
+    CachedHashCalculator hasher(std::move(counting),
+                                std::make_shared<HashCache>(cache_path));
+
+    FNV1A reference;
+    EXPECT_EQ(hasher.calculateHash(path), reference.calculateHash(path));
+    EXPECT_EQ(hasher.calculateHash(path), reference.calculateHash(path));
+    EXPECT_EQ(inner->calls, 1);
+
+    // Modifying the file invalidates the cached digest
+    createFile("a.txt", "changed content");
+    EXPECT_EQ(hasher.calculateHash(path), reference.calculateHash(path));
+    EXPECT_EQ(inner->calls, 2);
+}
+
+/**
+ * @test RecentlyModifiedFilesAreNotCached
+ * @brief Files written within the racy window are always hashed again
+ */
+TEST_F(HashCacheTest, RecentlyModifiedFilesAreNotCached) {
+    auto path = (test_dir / "fresh.txt").string();
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "fresh";
+    }
+
+    HashCache cache(cache_path);
+    FileStamp stamp = stampOf(path);
+    cache.store(stamp, "fnv1a", 0, HashDigest::fromUint64(3));
+
+    HashDigest cached;
+    EXPECT_FALSE(cache.lookup(stamp, "fnv1a", 0, cached));
+}
+
+/**
+ * @test CompactsStaleRecords
+ * @brief Reopening a cache dominated by stale records rewrites it
+ */
+TEST_F(HashCacheTest, CompactsStaleRecords) {
+    std::string path = createFile("a.txt", "content");
+    FileStamp stamp = stampOf(path);
+
+    {
+        HashCache cache(cache_path);
+        for (std::size_t i = 0; i < HashCache::COMPACT_MIN_RECORDS + 1; ++i) {
+            cache.store(stamp, "fnv1a", 0, HashDigest::fromUint64(i));
+        }
+    }
+    auto grown = std::filesystem::file_size(cache_path);
+
+    HashCache cache(cache_path);
+    EXPECT_LT(std::filesystem::file_size(cache_path), grown);
+
+    HashDigest cached;
+    ASSERT_TRUE(cache.lookup(stamp, "fnv1a", 0, cached));
+    EXPECT_EQ(cached, HashDigest::fromUint64(HashCache::COMPACT_MIN_RECORDS));
+}
@@ -0,0 +1,191 @@
+/**
+ * @file test_hashcalculator.cpp
+ * @brief Unit tests for the IHashCalculator implementations
+ *
+ * Verifies known test vectors, independence from block boundaries, the
+ * mmap and read(2) paths of FileReader, sample hashing and the runtime
+ * algorithm selection.
+ *
+ * @see FNV1A
+ * @see FNV1ALanes
+ * @see XXHash64
+ * @see HashDigest
+ */
+
+#include <gtest/gtest.h>
+#include "hashfactory.hpp"
+#include <filesystem>
+#include <fstream>
+
+/**
+ * @brief Hashes an in-memory buffer with a single update() call
+ */
+template <typename Engine>
+HashDigest hashBuffer(const std::string &data) {
+    Engine engine;
+    engine.update(reinterpret_cast<const std::uint8_t *>(data.data()), data.size());
+    return engine.digest();
+}
+
+/**
+ * @brief Hashes an in-memory buffer in chunks of the given size
+ */
+template <typename Engine>
+HashDigest hashChunked(const std::string &data, std::size_t chunk) {
+    Engine engine;
+    for (std::size_t offset = 0; offset < data.size(); offset += chunk) {
+        std::size_t n = std::min(chunk, data.size() - offset);
+        engine.update(reinterpret_cast<const std::uint8_t *>(data.data() + offset), n);
+    }
+    return engine.digest();
+}
+
+/**
+ * @class HashCalculatorTest
+ * @brief Fixture providing a temporary directory for file based tests
+ */
+class HashCalculatorTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "hashcalculator_test";
+        std::filesystem::create_directories(test_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    std::string createFile(const std::string &name, const std::string &content) {
+        auto path = test_dir / name;
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+        return path.string();
+    }
+
+    /** @brief Deterministic pseudo-random content */
+    static std::string makeContent(std::size_t size) {
+        std::string data(size, '\0');
+        uint32_t state = 12345;
+        for (auto &c : data) {
+            state = state * 1103515245u + 12345u;
+            c = static_cast<char>(state >> 24);
+        }
+        return data;
+    }
+};
+
+TEST_F(HashCalculatorTest, DigestHexRoundTrip) {
+    HashDigest d = HashDigest::fromUint64(0x0123456789ABCDEFULL);
+    EXPECT_EQ(d.toHex(), "0123456789ABCDEF");
+    EXPECT_EQ(HashDigest::fromHex("0123456789abcdef"), d);
+    EXPECT_TRUE(HashDigest::fromHex("xyz").empty());
+    EXPECT_TRUE(HashDigest().empty());
+    EXPECT_EQ(HashDigest().toHex(), "");
+}
+
+TEST_F(HashCalculatorTest, Fnv1aKnownVectors) {
+    EXPECT_EQ(hashBuffer<Fnv1aEngine>("").toHex(), "CBF29CE484222325");
+    EXPECT_EQ(hashBuffer<Fnv1aEngine>("a").toHex(), "AF63DC4C8601EC8C");
+}
+
+TEST_F(HashCalculatorTest, Xxh64KnownVectors) {
+    EXPECT_EQ(hashBuffer<Xxh64Engine>("").toHex(), "EF46DB3751D8E999");
+    EXPECT_EQ(hashBuffer<Xxh64Engine>("a").toHex(), "D24EC4F1A98C6E5B");
+    EXPECT_EQ(hashBuffer<Xxh64Engine>("abc").toHex(), "44BC2CF5AD770999");
+    EXPECT_EQ(hashBuffer<Xxh64Engine>("The quick brown fox jumps over the lazy dog").toHex(),
+              "0B242D361FDA71BC");
+}
+
+TEST_F(HashCalculatorTest, IndependentOfChunkBoundaries) {
+    std::string data = makeContent(10007);
+    for (std::size_t chunk : {1u, 3u, 31u, 64u, 65u, 4096u}) {
+        EXPECT_EQ(hashChunked<Fnv1aEngine>(data, chunk), hashBuffer<Fnv1aEngine>(data));
+        EXPECT_EQ(hashChunked<Fnv1aLanesEngine>(data, chunk), hashBuffer<Fnv1aLanesEngine>(data));
+        EXPECT_EQ(hashChunked<Xxh64Engine>(data, chunk), hashBuffer<Xxh64Engine>(data));
+    }
+}
+
+TEST_F(HashCalculatorTest, LanesDetectSingleByteChange) {
+    std::string a = makeContent(4096);
+    std::string b = a;
+    b[1000] ^= 0x01;
+    EXPECT_NE(hashBuffer<Fnv1aLanesEngine>(a), hashBuffer<Fnv1aLanesEngine>(b));
+
+    // Same bytes, different length (trailing zero)
+    EXPECT_NE(hashBuffer<Fnv1aLanesEngine>(a), hashBuffer<Fnv1aLanesEngine>(a + '\0'));
+}
+
+TEST_F(HashCalculatorTest, FileHashMatchesBuffer) {
+    // Below and above FileReader::MMAP_THRESHOLD
+    for (std::size_t size : {std::size_t(100), FileReader::MMAP_THRESHOLD + 12345}) {
+        std::string data = makeContent(size);
+        std::string path = createFile("file.bin", data);
+
+        EXPECT_EQ(FNV1A().calculateHash(path), hashBuffer<Fnv1aEngine>(data));
+        EXPECT_EQ(FNV1ALanes().calculateHash(path), hashBuffer<Fnv1aLanesEngine>(data));
+        EXPECT_EQ(XXHash64().calculateHash(path), hashBuffer<Xxh64Engine>(data));
+    }
+}
+
+TEST_F(HashCalculatorTest, SampleHashCoversHeadAndTail) {
+    const std::size_t sample = 16;
+
+    std::string small = createFile("small.bin", "0123456789");
+    XXHash64 hasher;
+    EXPECT_EQ(hasher.calculateSampleHash(small, sample), hasher.calculateHash(small));
+
+    std::string data = makeContent(100);
+    std::string path = createFile("large.bin", data);
+    std::string expected = data.substr(0, sample) + data.substr(data.size() - sample);
+    EXPECT_EQ(hasher.calculateSampleHash(path, sample), hashBuffer<Xxh64Engine>(expected));
+}
+
+TEST_F(HashCalculatorTest, MissingFileGivesEmptyDigest) {
+    EXPECT_TRUE(FNV1A().calculateHash("/nonexistent/file").empty());
+    EXPECT_TRUE(XXHash64().calculateSampleHash("/nonexistent/file", 16).empty());
+}
+
+TEST_F(HashCalculatorTest, SelectsAlgorithmByName) {
+    HashAlgorithm algorithm = HashAlgorithm::FNV1A;
+
+    for (const char *name : {"fnv1a", "fnv1a-x8", "xxh64"}) {
+        ASSERT_TRUE(parseHashAlgorithm(name, algorithm));
+        EXPECT_STREQ(createHashCalculator(algorithm)->name(), name);
+    }
+
+    EXPECT_FALSE(parseHashAlgorithm("md5", algorithm));
+}
+
+TEST_F(HashCalculatorTest, ReadModesGiveSameDigest) {
+    using Mode = FileReader::ReadMode;
+
+    // Empty, one partial block, and more blocks than UringReader keeps in flight
+    for (std::size_t size : {std::size_t(0), std::size_t(100), 9 * FileReader::BLOCK_SIZE + 777}) {
+        std::string data = makeContent(size);
+        std::string path = createFile("file.bin", data);
+        // Unaligned sample exercises the O_DIRECT range widening
+        const std::size_t sample = 4096 + 3;
+        std::string expected_sample =
+            size <= 2 * sample ? data
+                               : data.substr(0, sample) + data.substr(data.size() - sample);
+
+        for (Mode mode : {Mode::Buffered, Mode::Uring, Mode::UringDirect}) {
+            auto hasher = createHashCalculator(HashAlgorithm::XXH64, mode);
+            EXPECT_EQ(hasher->calculateHash(path), hashBuffer<Xxh64Engine>(data))
+                << FileReader::readModeName(mode) << " size " << size;
+            EXPECT_EQ(hasher->calculateSampleHash(path, sample),
+                      hashBuffer<Xxh64Engine>(expected_sample))
+                << FileReader::readModeName(mode) << " size " << size;
+            EXPECT_TRUE(hasher->calculateHash("/nonexistent/file").empty());
+        }
+    }
+
+    Mode mode = Mode::Buffered;
+    for (const char *name : {"blocking", "uring", "direct"}) {
+        ASSERT_TRUE(FileReader::parseReadMode(name, mode));
+        EXPECT_STREQ(FileReader::readModeName(mode), name);
+    }
+    EXPECT_FALSE(FileReader::parseReadMode("aio", mode));
+}
@@ -0,0 +1,213 @@
+/**
+ * @file test_hashpipeline.cpp
+ * @brief Unit tests for the parallel hashing stage
+ *
+ * Verifies that HashPipeline produces the same digests as sequential
+ * hashing, reports progress and stops on cancellation.
+ *
+ * @see HashPipeline
+ * @see DuplicateFinder
+ */
+
+#include <gtest/gtest.h>
+#include "duplicatefinder.hpp"
+#include "filescanner.hpp"
+#include "fnv1a.hpp"
+#include "hashpipeline.hpp"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+/**
+ * @class HashPipelineTest
+ * @brief Test fixture that creates a set of real files
+ *
+ * Ten pairs of identical files (half of them larger than the sample
+ * window) plus unique files of colliding sizes.
+ */
+class HashPipelineTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    FNV1A hasher;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "hashpipeline_test";
+        std::filesystem::create_directories(test_dir);
+
+        for (int i = 0; i < 10; ++i) {
+            std::string content(i < 5 ? 100 + i : 20000 + i, static_cast<char>('a' + i));
+            createFile("dup" + std::to_string(i) + "_a.bin", content);
+            createFile("dup" + std::to_string(i) + "_b.bin", content);
+            content.back() = 'z';
+            createFile("uniq" + std::to_string(i) + ".bin", content);
+        }
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    void createFile(const std::string& name, const std::string& content) {
+        std::ofstream file(test_dir / name, std::ios::binary);
+        file << content;
+    }
+
+    std::vector<FileInfo> scan() {
+        FileScanner scanner;
+        return scanner.scanDirectory(test_dir, false, false);
+    }
+
+    static std::vector<FileInfo*> pointers(std::vector<FileInfo>& files) {
+        std::vector<FileInfo*> result;
+        for (auto& info : files) {
+            result.push_back(&info);
+        }
+        return result;
+    }
+};
+
+/**
+ * @class SlowHasher
+ * @brief Hasher that blocks until released, to test cancellation
+ */
+class SlowHasher : public IHashCalculator {
+public:
+    mutable std::atomic<int> calls{0};
+    std::atomic<bool> release{false};
+
+    HashDigest calculateHash(const std::string&) const override {
+        ++calls;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+        return HashDigest::fromUint64(1);
+    }
+};
+
+/**
+ * @test HashAllMatchesSequential
+ * @brief Digests are in input order and equal to direct hashing
+ */
+TEST_F(HashPipelineTest, HashAllMatchesSequential) {
+    auto files = scan();
+    auto candidates = pointers(files);
+
+    HashPipeline pipeline(hasher, 4, 3);  // small queue forces back-pressure
+    auto digests = pipeline.hashAll(candidates, HashPipeline::Mode::Full);
+
+    ASSERT_EQ(digests.size(), candidates.size());
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        EXPECT_EQ(digests[i], hasher.calculateHash(candidates[i]->getPath()));
+    }
+}
+
+/**
+ * @test ParallelDuplicateGroupsMatchSequential
+ * @brief Four workers find exactly the groups of the single-threaded engine
+ */
+TEST_F(HashPipelineTest, ParallelDuplicateGroupsMatchSequential) {
+    auto sequentialFiles = scan();
+    auto sequential = DuplicateFinder::findDuplicates(sequentialFiles, hasher);
+
+    auto parallelFiles = scan();
+    HashPipeline pipeline(hasher, 4);
+    auto parallel = DuplicateFinder::findDuplicates(parallelFiles, pipeline);
+
+    ASSERT_EQ(sequential.size(), 10u);
+    ASSERT_EQ(parallel.size(), sequential.size());
+
+    auto hashes = [](const std::vector<DuplicateFinder::DuplicateGroup>& groups) {
+        std::vector<std::string> result;
+        for (const auto& group : groups) {
+            EXPECT_EQ(group.files.size(), 2u);
+            result.push_back(group.hash);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    EXPECT_EQ(hashes(parallel), hashes(sequential));
+}
+
+/**
+ * @test ReportsBytesHashed
+ * @brief The final progress report covers every submitted byte
+ */
+TEST_F(HashPipelineTest, ReportsBytesHashed) {
+    auto files = scan();
+    auto candidates = pointers(files);
+
+    long long expectedBytes = 0;
+    for (auto* file : candidates) {
+        expectedBytes += file->getFileSize();
+    }
+
+    HashPipeline::Progress last;
+    int reports = 0;
+    HashPipeline pipeline(hasher, 2);
+    pipeline.setProgressCallback([&](const HashPipeline::Progress& progress) {
+        last = progress;
+        ++reports;
+    });
+    pipeline.hashAll(candidates, HashPipeline::Mode::Full);
+
+    EXPECT_GE(reports, 1);
+    EXPECT_EQ(last.files_done, static_cast<int>(candidates.size()));
+    EXPECT_EQ(last.files_total, static_cast<int>(candidates.size()));
+    EXPECT_EQ(last.bytes_done, expectedBytes);
+    EXPECT_GT(last.bytes_per_second, 0.0);
+}
+
+/**
+ * @test CancelStopsWorkers
+ * @brief cancel() drops queued candidates and makes the engine return nothing
+ */
+TEST_F(HashPipelineTest, CancelStopsWorkers) {
+    auto files = scan();
+
+    SlowHasher slow;
+    HashPipeline pipeline(slow, 2);
+
+    std::vector<DuplicateFinder::DuplicateGroup> groups;
+    std::thread runner([&] { groups = DuplicateFinder::findDuplicates(files, pipeline); });
+
+    while (slow.calls.load() == 0) {
+        std::this_thread::yield();
+    }
+    pipeline.cancel();
+    slow.release = true;
+    runner.join();
+
+    EXPECT_TRUE(pipeline.isCancelled());
+    EXPECT_TRUE(groups.empty());
+    EXPECT_LE(slow.calls.load(), 2);  // only the files already in progress
+}
+
+/**
+ * @test StopTokenStopsWorkers
+ * @brief A stopped token ends the pipeline like cancel(), also while the
+ *        submitting thread waits on a full queue
+ */
+TEST_F(HashPipelineTest, StopTokenStopsWorkers) {
+    auto files = scan();
+
+    SlowHasher slow;
+    HashPipeline pipeline(slow, 2, 1);
+    StopSource stop;
+    pipeline.setStopToken(stop.token());
+
+    std::vector<DuplicateFinder::DuplicateGroup> groups;
+    std::thread runner([&] { groups = DuplicateFinder::findDuplicates(files, pipeline); });
+
+    while (slow.calls.load() == 0) {
+        std::this_thread::yield();
+    }
+    stop.requestStop();
+    slow.release = true;
+    runner.join();
+
+    EXPECT_TRUE(pipeline.isCancelled());
+    EXPECT_TRUE(groups.empty());
+    EXPECT_LE(slow.calls.load(), 2);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file test_mounttable.cpp
+ * @brief Unit tests for the cached MountTable
+ *
+ * Snapshots are parsed from fixed mountinfo text, so the tests do not
+ * depend on the mounts of the machine running them.
+ *
+ * @see MountTable
+ */
+
+#include <gtest/gtest.h>
+#include "mounttable.hpp"
+#include <sstream>
+
+namespace {
+
+std::shared_ptr<const MountTable::Snapshot> parse(const std::string& text) {
+    std::istringstream in(text);
+    return MountTable::Snapshot::parse(in, false);
+}
+
+const char* const MOUNTINFO =
+    "1 0 8:1 / / rw,relatime shared:1 - ext4 /dev/sda1 rw\n"
+    "2 1 0:22 / /proc rw,nosuid - proc proc rw\n"
+    "3 1 8:17 / /media/usb\\040stick rw master:2 - vfat /dev/sdb1 rw\n"
+    "4 1 8:2 / /home rw - ext4 /dev/sda2 rw\n"
+    "5 4 8:3 / /home/data rw - xfs /dev/sda3 rw\n"
+    "6 4 0:40 / /home/data rw - tmpfs tmpfs rw\n";
+
+} // namespace
+
+/**
+ * @test ParsesFieldsAndEscapes
+ * @brief Optional fields are skipped and octal escapes decoded
+ */
+TEST(MountTableTest, ParsesFieldsAndEscapes) {
+    auto snapshot = parse(MOUNTINFO);
+
+    const auto* usb = snapshot->find("/media/usb stick/photo.jpg");
+    ASSERT_NE(usb, nullptr);
+    EXPECT_EQ(usb->mountpoint, "/media/usb stick");
+    EXPECT_EQ(usb->fstype, "vfat");
+    EXPECT_EQ(usb->device, "/dev/sdb1");
+    EXPECT_EQ(usb->major, 8u);
+    EXPECT_EQ(usb->minor, 17u);
+    EXPECT_TRUE(usb->removable);
+}
+
+/**
+ * @test FindsLongestPrefix
+ * @brief A path belongs to its innermost mount, not to string prefixes
+ */
+TEST(MountTableTest, FindsLongestPrefix) {
+    auto snapshot = parse(MOUNTINFO);
+
+    EXPECT_EQ(snapshot->find("/home/user/file")->mountpoint, "/home");
+    EXPECT_EQ(snapshot->find("/homework")->mountpoint, "/");
+    EXPECT_EQ(snapshot->find("/proc/self/")->fstype, "proc");
+    EXPECT_EQ(snapshot->find("/")->mountpoint, "/");
+    EXPECT_EQ(snapshot->find("relative/path"), nullptr);
+    EXPECT_FALSE(snapshot->find("/home")->removable);
+}
+
+/**
+ * @test TopmostOfStackedMountsWins
+ * @brief Of two mounts on one directory the later one hides the first
+ */
+TEST(MountTableTest, TopmostOfStackedMountsWins) {
+    auto snapshot = parse(MOUNTINFO);
+
+    const auto* data = snapshot->find("/home/data/x");
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(data->fstype, "tmpfs");
+    EXPECT_EQ(data->fs_magic, MountTable::magicOf("tmpfs"));
+    EXPECT_NE(data->fs_magic, 0);
+    EXPECT_EQ(snapshot->mounts().size(), 5u);
+}
+
+/**
+ * @test MountPoints
+ * @brief Only mounted directories themselves are mount points
+ */
+TEST(MountTableTest, MountPoints) {
+    auto snapshot = parse(MOUNTINFO);
+
+    EXPECT_TRUE(snapshot->isMountPoint("/home"));
+    EXPECT_TRUE(snapshot->isMountPoint("/home/"));
+    EXPECT_FALSE(snapshot->isMountPoint("/home/user"));
+    EXPECT_EQ(MountTable::magicOf("ext4"), 0);
+}
+
+/**
+ * @test GlobalTableHasRoot
+ * @brief The process table contains the root mount and stays cached
+ */
+TEST(MountTableTest, GlobalTableHasRoot) {
+    auto first = MountTable::global().snapshot();
+    ASSERT_NE(first->find("/"), nullptr);
+    EXPECT_EQ(MountTable::global().snapshot(), first);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file test_multirootscanner.cpp
+ * @brief Unit tests for scans over several roots
+ *
+ * @see MultiRootScanner
+ */
+
+#include <gtest/gtest.h>
+#include "fnv1a.hpp"
+#include "multirootscanner.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+class MultiRootScannerTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "multirootscanner_test";
+        std::filesystem::remove_all(test_dir);
+        std::filesystem::create_directories(test_dir / "a" / "nested");
+        std::filesystem::create_directories(test_dir / "b");
+
+        std::ofstream(test_dir / "a" / "one.txt") << "shared";
+        std::ofstream(test_dir / "a" / "nested" / "two.txt") << "inside a";
+        std::ofstream(test_dir / "a" / "nested" / "three.txt") << "inside a";
+        std::ofstream(test_dir / "b" / "copy.txt") << "shared";
+        std::ofstream(test_dir / "b" / "alone.txt") << "unique";
+    }
+
+    void TearDown() override { std::filesystem::remove_all(test_dir); }
+
+    std::string dir(const std::string &name) const { return (test_dir / name).string(); }
+
+    static std::vector<FileInfo> scanAll(MultiRootScanner &scanner) {
+        std::vector<FileInfo> files;
+        scanner.scan([&](std::vector<FileInfo> &&batch) {
+            for (auto &info : batch) {
+                files.push_back(std::move(info));
+            }
+            return true;
+        });
+        return files;
+    }
+};
+
+/**
+ * @test OverlappingRootsAreScannedOnce
+ * @brief Equal and nested roots are covered, a parent replaces its children
+ */
+TEST_F(MultiRootScannerTest, OverlappingRootsAreScannedOnce) {
+    MultiRootScanner scanner;
+    EXPECT_EQ(scanner.addRoot(dir("a/nested")), MultiRootScanner::AddResult::Added);
+    EXPECT_EQ(scanner.addRoot(dir("b")), MultiRootScanner::AddResult::Added);
+    EXPECT_EQ(scanner.addRoot(dir("b") + "/"), MultiRootScanner::AddResult::Covered);
+    EXPECT_EQ(scanner.addRoot(dir("a/nested/../nested")), MultiRootScanner::AddResult::Covered);
+    EXPECT_EQ(scanner.addRoot(dir("missing")), MultiRootScanner::AddResult::Invalid);
+    EXPECT_EQ(scanner.addRoot(dir("a/one.txt")), MultiRootScanner::AddResult::Invalid);
+
+    EXPECT_EQ(scanner.addRoot(dir("a")), MultiRootScanner::AddResult::Added);
+    ASSERT_EQ(scanner.roots().size(), 2u);
+    EXPECT_EQ(scanner.roots()[0].path, dir("b"));
+    EXPECT_EQ(scanner.roots()[1].path, dir("a"));
+    EXPECT_EQ(scanner.addRoot(dir("a/nested")), MultiRootScanner::AddResult::Covered);
+
+    std::filesystem::create_directory_symlink(test_dir / "a", test_dir / "link");
+    EXPECT_EQ(scanner.addRoot(dir("link")), MultiRootScanner::AddResult::Covered);
+    EXPECT_EQ(scanner.addRoot(dir("link/nested")), MultiRootScanner::AddResult::Covered);
+}
+
+/**
+ * @test ScanDeliversEveryRoot
+ * @brief One scan returns the entries of all roots, each once
+ */
+TEST_F(MultiRootScannerTest, ScanDeliversEveryRoot) {
+    MultiRootScanner scanner;
+    scanner.setThreadCount(2);
+    scanner.addRoot(dir("a"));
+    scanner.addRoot(dir("b"));
+    scanner.addRoot(dir("a/nested"));
+
+    std::vector<std::string> paths;
+    for (const auto &info : scanAll(scanner)) {
+        paths.push_back(info.getPath());
+    }
+    std::sort(paths.begin(), paths.end());
+    const std::vector<std::string> expected = {
+        dir("a/nested"),           dir("a/nested/three.txt"), dir("a/nested/two.txt"),
+        dir("a/one.txt"),          dir("b/alone.txt"),        dir("b/copy.txt")};
+    EXPECT_EQ(paths, expected);
+
+    EXPECT_EQ(scanner.rootOf(dir("a/nested/two.txt")), 0u);
+    EXPECT_EQ(scanner.rootOf(dir("b/copy.txt")), 1u);
+    EXPECT_EQ(scanner.rootOf(dir("bb/copy.txt")), 2u);
+}
+
+/**
+ * @test CrossRootKeepsSpanningGroups
+ * @brief Groups inside one root are dropped, groups across roots are kept
+ */
+TEST_F(MultiRootScannerTest, CrossRootKeepsSpanningGroups) {
+    MultiRootScanner scanner;
+    scanner.addRoot(dir("a"));
+    scanner.addRoot(dir("b"));
+    std::vector<FileInfo> files = scanAll(scanner);
+
+    FNV1A hasher;
+    const auto groups = DuplicateFinder::findDuplicates(files, hasher);
+    ASSERT_EQ(groups.size(), 2u);
+
+    const auto across = MultiRootScanner::crossRoot(groups, scanner);
+    ASSERT_EQ(across.size(), 1u);
+    std::vector<std::string> names;
+    for (const FileInfo *file : across[0].files) {
+        names.emplace_back(file->getName());
+    }
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(names, (std::vector<std::string>{"copy.txt", "one.txt"}));
+}
+
+/**
+ * @test StopTokenEndsScan
+ * @brief A stopped scan delivers nothing
+ */
+TEST_F(MultiRootScannerTest, StopTokenEndsScan) {
+    MultiRootScanner scanner;
+    scanner.addRoot(dir("a"));
+    scanner.addRoot(dir("b"));
+    StopSource source;
+    source.requestStop();
+    scanner.setStopToken(source.token());
+    EXPECT_TRUE(scanAll(scanner).empty());
+}
@@ -0,0 +1,98 @@
+/**
+ * @file test_namesearch.cpp
+ * @brief Unit tests for the incremental name search
+ *
+ * @see NameSearch
+ */
+
+#include <gtest/gtest.h>
+#include "namesearch.hpp"
+
+#include <string>
+#include <vector>
+
+using Positions = std::vector<std::uint32_t>;
+
+class NameSearchTest : public ::testing::Test {
+protected:
+    const std::vector<std::string> names = {"README.md", "readme-old.txt", "Makefile",
+                                            "main.cpp",  "main_test.cpp",  "notes.txt"};
+    NameSearch search;
+
+    void SetUp() override {
+        for (const auto &name : names) {
+            search.add(name);
+        }
+    }
+
+    /** @brief Result of a new NameSearch over the same names (full scan) */
+    Positions fresh(const std::string &query) const {
+        NameSearch other;
+        for (const auto &name : names) {
+            other.add(name);
+        }
+        return other.match(query);
+    }
+};
+
+/**
+ * @test WordsPrefixesAndCase
+ * @brief All words must occur, '^' anchors at the start, ASCII ignores case
+ */
+TEST_F(NameSearchTest, WordsPrefixesAndCase) {
+    EXPECT_EQ(search.match("readme"), (Positions{0, 1}));
+    EXPECT_EQ(search.match("MAIN cpp"), (Positions{3, 4}));
+    EXPECT_EQ(search.match("cpp main"), (Positions{3, 4}));
+    EXPECT_EQ(search.match("^m"), (Positions{2, 3, 4}));
+    EXPECT_EQ(search.match("^read txt"), (Positions{1}));
+    EXPECT_EQ(search.match("s.t"), (Positions{5}));
+    EXPECT_EQ(search.match("missing"), Positions{});
+    EXPECT_EQ(search.match("a/b"), Positions{}); // never across names
+    EXPECT_EQ(search.match("   ").size(), search.size());
+    EXPECT_EQ(search.match("").size(), 6u);
+}
+
+/**
+ * @test RefinementMatchesFreshSearch
+ * @brief Typing and deleting give the same result as searching anew
+ */
+TEST_F(NameSearchTest, RefinementMatchesFreshSearch) {
+    const std::string typed = "main test.c";
+    for (std::size_t length = 0; length <= typed.size(); ++length) {
+        const std::string query = typed.substr(0, length);
+        EXPECT_EQ(search.match(query), fresh(query)) << query;
+    }
+    for (std::size_t length = typed.size() + 1; length-- > 0;) {
+        const std::string query = typed.substr(0, length);
+        EXPECT_EQ(search.match(query), fresh(query)) << query;
+    }
+    EXPECT_EQ(search.match("main test.c"), (Positions{4}));
+    EXPECT_EQ(search.match("note"), (Positions{5})); // no prefix of the last query
+}
+
+/**
+ * @test LongBufferScan
+ * @brief Hits at block boundaries, in the tail and in the last name
+ */
+TEST(NameSearchScanTest, LongBufferScan) {
+    NameSearch search;
+    Positions expected;
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        std::string name = "f" + std::to_string(i) + std::string(i % 23, 'x');
+        if (i % 7 == 0) {
+            name += "Needle";
+            expected.push_back(i);
+        }
+        search.add(name);
+    }
+    search.add("needle");
+    expected.push_back(1000);
+    EXPECT_EQ(search.match("needle"), expected);
+    EXPECT_EQ(search.match("needlex"), Positions{});
+    EXPECT_EQ(search.match("f999").size(), 1u);
+    EXPECT_EQ(search.match("x").size(), 1000u - 1000u / 23 - 1);
+
+    search.clear();
+    EXPECT_EQ(search.size(), 0u);
+    EXPECT_TRUE(search.match("needle").empty());
+}
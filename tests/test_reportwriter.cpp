@@ -0,0 +1,100 @@
+/**
+ * @file test_reportwriter.cpp
+ * @brief Unit tests for the NDJSON/CSV ReportWriter
+ *
+ * @see ReportWriter
+ */
+
+#include <gtest/gtest.h>
+#include "reportwriter.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @class ReportWriterTest
+ * @brief Fixture writing into a temporary file and reading it back
+ */
+class ReportWriterTest : public ::testing::Test {
+protected:
+    std::FILE* out = nullptr;
+    std::vector<FileInfo> files;
+    DuplicateFinder::DuplicateGroup group;
+
+    void SetUp() override {
+        out = std::tmpfile();
+        files.emplace_back("/d/empty", 0, false);
+        files.emplace_back("/d/a,\"b\"", 10, false);
+        files.emplace_back("/d/line\nbreak", 10, false);
+        group.hash = "00000000000000FF";
+        group.files = {&files[1], &files[2]};
+        group.wastedSpace = 10;
+    }
+
+    void TearDown() override {
+        std::fclose(out);
+    }
+
+    std::string contents() {
+        std::string text;
+        std::rewind(out);
+        char buffer[4096];
+        std::size_t bytes;
+        while ((bytes = std::fread(buffer, 1, sizeof(buffer), out)) > 0) {
+            text.append(buffer, bytes);
+        }
+        return text;
+    }
+};
+
+TEST_F(ReportWriterTest, WritesNdjson) {
+    {
+        ReportWriter writer(out, ReportWriter::Format::Ndjson);
+        writer.zeroByteFile(files[0]);
+        writer.duplicateGroup(group);
+        EXPECT_TRUE(writer.summary(3));
+    }
+    EXPECT_EQ(contents(),
+              "{\"type\":\"zero\",\"path\":\"/d/empty\"}\n"
+              "{\"type\":\"group\",\"group\":1,\"hash\":\"00000000000000FF\",\"size\":10,"
+              "\"files\":2,\"wasted_bytes\":10,"
+              "\"paths\":[\"/d/a,\\\"b\\\"\",\"/d/line\\nbreak\"]}\n"
+              "{\"type\":\"summary\",\"files\":3,\"zero_files\":1,\"groups\":1,"
+              "\"duplicate_files\":2,\"wasted_bytes\":10}\n");
+}
+
+TEST_F(ReportWriterTest, WritesCsv) {
+    {
+        ReportWriter writer(out, ReportWriter::Format::Csv);
+        writer.zeroByteFile(files[0]);
+        writer.duplicateGroup(group);
+        EXPECT_TRUE(writer.summary(3));
+    }
+    EXPECT_EQ(contents(),
+              "type,group,hash,size,wasted_bytes,path\n"
+              "zero,,,0,,/d/empty\n"
+              "duplicate,1,00000000000000FF,10,10,\"/d/a,\"\"b\"\"\"\n"
+              "duplicate,1,00000000000000FF,10,10,\"/d/line\nbreak\"\n"
+              "summary,1,,3,10,\n");
+}
+
+TEST_F(ReportWriterTest, BuffersUntilFull) {
+    ReportWriter writer(out, ReportWriter::Format::Ndjson);
+    writer.zeroByteFile(files[0]);
+    std::fseek(out, 0, SEEK_END);
+    EXPECT_EQ(std::ftell(out), 0);
+
+    // Written in one piece once the buffer is full
+    const std::size_t rows = ReportWriter::BUFFER_SIZE / 30 + 1;
+    for (std::size_t i = 0; i < rows; ++i) {
+        writer.zeroByteFile(files[0]);
+    }
+    std::fseek(out, 0, SEEK_END);
+    EXPECT_GE(static_cast<std::size_t>(std::ftell(out)), ReportWriter::BUFFER_SIZE);
+
+    ReportWriter::Format format;
+    EXPECT_TRUE(ReportWriter::parseFormat("csv", format));
+    EXPECT_EQ(format, ReportWriter::Format::Csv);
+    EXPECT_FALSE(ReportWriter::parseFormat("xml", format));
+}
@@ -0,0 +1,167 @@
+/**
+ * @file test_scansnapshot.cpp
+ * @brief Unit tests for the binary scan snapshot
+ *
+ * @see ScanSnapshot
+ */
+
+#include <gtest/gtest.h>
+#include "duplicatefinder.hpp"
+#include "filescanner.hpp"
+#include "fnv1a.hpp"
+#include "scansnapshot.hpp"
+#include <filesystem>
+#include <fstream>
+
+class ScanSnapshotTest : public ::testing::Test {
+protected:
+    std::filesystem::path test_dir;
+    std::filesystem::path file;
+
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "scansnapshot_test";
+        std::filesystem::remove_all(test_dir);
+        std::filesystem::create_directories(test_dir / "tree" / "sub" / "empty");
+        file = test_dir / "tree.tfmsnap";
+
+        std::ofstream(test_dir / "tree" / "a.txt") << "same content";
+        std::ofstream(test_dir / "tree" / "b.txt") << "unique";
+        std::ofstream(test_dir / "tree" / "sub" / "copy.txt") << "same content";
+        std::ofstream(test_dir / "tree" / "sub" / "other.txt") << "other conten";
+    }
+
+    void TearDown() override { std::filesystem::remove_all(test_dir); }
+
+    std::string root() const { return (test_dir / "tree").string(); }
+
+    /** @brief Recursive scan with a duplicate search, written to file */
+    void writeSnapshot() {
+        FileScanner scanner;
+        files = scanner.scanDirectory(root(), true, false);
+        FNV1A hasher;
+        groups = DuplicateFinder::findDuplicates(files, hasher);
+        std::string error;
+        ASSERT_TRUE(ScanSnapshot::write(file.string(), root(), files, &groups, &error)) << error;
+    }
+
+    static std::vector<std::string> paths(const std::vector<FileInfo> &listing) {
+        std::vector<std::string> result;
+        for (const auto &info : listing) {
+            result.push_back(info.getPath());
+        }
+        return result;
+    }
+
+    std::vector<FileInfo> files;
+    std::vector<DuplicateFinder::DuplicateGroup> groups;
+};
+
+/**
+ * @test ListsLikeAScan
+ * @brief Every stored directory lists as a fresh non-recursive scan does
+ */
+TEST_F(ScanSnapshotTest, ListsLikeAScan) {
+    writeSnapshot();
+    ScanSnapshot snapshot(file.string());
+    ASSERT_TRUE(snapshot.isOpen()) << snapshot.error();
+    EXPECT_EQ(snapshot.root(), root());
+    EXPECT_TRUE(snapshot.duplicatesSearched());
+    EXPECT_EQ(snapshot.entryCount(), files.size());
+    EXPECT_EQ(snapshot.directoryCount(), 3u);
+
+    FileScanner scanner;
+    for (const std::string &dir : {root(), root() + "/sub", root() + "/sub/empty"}) {
+        std::vector<FileInfo> listing;
+        ASSERT_TRUE(snapshot.list(dir, true, listing)) << dir;
+        const auto scanned = scanner.scanDirectory(dir, false, true);
+        EXPECT_EQ(paths(listing), paths(scanned)) << dir;
+        for (std::size_t i = 1; i < listing.size() && i < scanned.size(); ++i) {
+            EXPECT_EQ(listing[i].getFileSize(), scanned[i].getFileSize());
+            EXPECT_EQ(listing[i].getModifiedTime(), scanned[i].getModifiedTime());
+            EXPECT_EQ(listing[i].isDirectory(), scanned[i].isDirectory());
+            EXPECT_EQ(listing[i].getInode().inode, scanned[i].getInode().inode);
+        }
+    }
+
+    std::vector<FileInfo> listing;
+    EXPECT_TRUE(snapshot.list(root() + "/", false, listing));
+    EXPECT_FALSE(snapshot.list(root() + "/missing", false, listing));
+    EXPECT_TRUE(listing.empty());
+}
+
+/**
+ * @test KeepsDigestsAndGroups
+ * @brief Duplicates come back flagged, with their digest and group id
+ */
+TEST_F(ScanSnapshotTest, KeepsDigestsAndGroups) {
+    writeSnapshot();
+    ASSERT_EQ(groups.size(), 1u);
+    ScanSnapshot snapshot(file.string());
+    ASSERT_TRUE(snapshot.isOpen()) << snapshot.error();
+
+    std::vector<FileInfo> top;
+    std::vector<FileInfo> sub;
+    std::vector<std::uint32_t> top_groups;
+    std::vector<std::uint32_t> sub_groups;
+    ASSERT_TRUE(snapshot.list(root(), false, top, &top_groups));
+    ASSERT_TRUE(snapshot.list(root() + "/sub", false, sub, &sub_groups));
+    ASSERT_EQ(top_groups.size(), top.size());
+
+    const FileInfo *a = nullptr;
+    const FileInfo *copy = nullptr;
+    std::uint32_t a_group = 0;
+    std::uint32_t copy_group = 0;
+    for (std::size_t i = 0; i < top.size(); ++i) {
+        if (top[i].getName() == "a.txt") {
+            a = &top[i];
+            a_group = top_groups[i];
+        } else {
+            EXPECT_EQ(top_groups[i], 0u) << top[i].getPath();
+        }
+    }
+    for (std::size_t i = 0; i < sub.size(); ++i) {
+        if (sub[i].getName() == "copy.txt") {
+            copy = &sub[i];
+            copy_group = sub_groups[i];
+        }
+    }
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(copy, nullptr);
+    EXPECT_TRUE(a->isDuplicate());
+    EXPECT_TRUE(copy->isDuplicate());
+    EXPECT_EQ(a_group, 1u);
+    EXPECT_EQ(copy_group, 1u);
+    EXPECT_FALSE(a->getDigest().empty());
+    EXPECT_EQ(a->getDigest(), copy->getDigest());
+}
+
+/**
+ * @test RejectsDamagedFiles
+ * @brief Truncated or foreign files fail to open instead of crashing
+ */
+TEST_F(ScanSnapshotTest, RejectsDamagedFiles) {
+    writeSnapshot();
+    const auto size = std::filesystem::file_size(file);
+
+    std::filesystem::resize_file(file, size - 8);
+    ScanSnapshot truncated(file.string());
+    EXPECT_FALSE(truncated.isOpen());
+    EXPECT_FALSE(truncated.error().empty());
+
+    std::ofstream(file, std::ios::trunc) << std::string(200, 'x');
+    ScanSnapshot foreign(file.string());
+    EXPECT_FALSE(foreign.isOpen());
+
+    ScanSnapshot missing((test_dir / "none.tfmsnap").string());
+    EXPECT_FALSE(missing.isOpen());
+    std::vector<FileInfo> listing;
+    EXPECT_FALSE(missing.list(root(), false, listing));
+
+    // No temporary files are left behind
+    std::size_t entries = 0;
+    for (auto it = std::filesystem::directory_iterator(test_dir);
+         it != std::filesystem::directory_iterator(); ++it) {
+        ++entries;
+    }
+    EXPECT_EQ(entries, 2u);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file test_stats.cpp
+ * @brief Unit tests for the Stats counters and timers
+ *
+ * @see Stats
+ */
+
+#include <gtest/gtest.h>
+#include "filescanner.hpp"
+#include "fnv1a.hpp"
+#include "stats.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+TEST(StatsTest, CountsAndTimes) {
+    Stats stats;
+    stats.add(Stats::Counter::BytesHashed, 100);
+    stats.add(Stats::Counter::BytesHashed, 23);
+    stats.addTime(Stats::Timer::Sort, 3000);
+    stats.addTime(Stats::Timer::Sort, 1000);
+
+    Stats::Snapshot snap = stats.snapshot();
+    EXPECT_EQ(snap.counter(Stats::Counter::BytesHashed), 123u);
+    EXPECT_EQ(snap.counter(Stats::Counter::StatCalls), 0u);
+    EXPECT_EQ(snap.timer(Stats::Timer::Sort).count, 2u);
+    EXPECT_EQ(snap.timer(Stats::Timer::Sort).total_ns, 4000u);
+    EXPECT_EQ(snap.timer(Stats::Timer::Sort).max_ns, 3000u);
+
+    stats.reset();
+    snap = stats.snapshot();
+    EXPECT_EQ(snap.counter(Stats::Counter::BytesHashed), 0u);
+    EXPECT_EQ(snap.timer(Stats::Timer::Sort).count, 0u);
+}
+
+/**
+ * @test LinesListRunTimersAndAllCounters
+ * @brief Timers that never ran are left out; rates need their timer
+ */
+TEST(StatsTest, LinesListRunTimersAndAllCounters) {
+    Stats stats;
+    stats.add(Stats::Counter::EntriesListed, 500);
+    stats.addTime(Stats::Timer::Scan, 1000000000);
+
+    const auto lines = stats.snapshot().lines();
+    EXPECT_EQ(lines.size(), 1 + Stats::COUNTER_COUNT + 1);
+    EXPECT_EQ(lines.front().rfind("scan", 0), 0u);
+    EXPECT_NE(lines.back().find("entries/s"), std::string::npos);
+    EXPECT_NE(lines.back().find("500"), std::string::npos);
+}
+
+#ifdef TMF_STATS
+
+/**
+ * @test InstrumentsScanAndHash
+ * @brief The scanner and the hashers report into Stats::global()
+ */
+TEST(StatsTest, InstrumentsScanAndHash) {
+    const auto dir = std::filesystem::temp_directory_path() / "stats_test";
+    std::filesystem::create_directories(dir / "sub");
+    {
+        std::ofstream(dir / "a.txt") << "hello";
+        std::ofstream(dir / "sub" / "b.txt") << "world!";
+    }
+
+    Stats::global().reset();
+    FileScanner scanner;
+    const auto files = scanner.scanDirectory(dir, true, false, nullptr);
+    FNV1A hasher;
+    hasher.calculateHash((dir / "sub" / "b.txt").string());
+
+    const Stats::Snapshot snap = Stats::global().snapshot();
+    EXPECT_EQ(snap.counter(Stats::Counter::EntriesListed), files.size());
+    EXPECT_EQ(snap.counter(Stats::Counter::DirectoriesListed), 2u);
+    EXPECT_EQ(snap.timer(Stats::Timer::Scan).count, 1u);
+    EXPECT_EQ(snap.timer(Stats::Timer::Sort).count, 1u);
+    EXPECT_EQ(snap.counter(Stats::Counter::FilesHashed), 1u);
+    EXPECT_EQ(snap.counter(Stats::Counter::BytesHashed), 6u);
+    if (scanner.usesNativeBackend()) {
+        EXPECT_GE(snap.counter(Stats::Counter::GetdentsCalls), 4u); // two per directory
+        EXPECT_EQ(snap.counter(Stats::Counter::StatCalls), 2u);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+#endif // TMF_STATS
@@ -0,0 +1,116 @@
+/**
+ * @file test_taskrunner.cpp
+ * @brief Unit tests for the supersede-on-run TaskRunner
+ *
+ * @see TaskRunner
+ * @see StopSource
+ */
+
+#include <gtest/gtest.h>
+#include "taskrunner.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+/** @brief Waits (bounded) until a flag is set */
+void waitFor(const std::atomic<bool>& flag) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!flag.load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+TEST(StopTokenTest, SourceStopsItsTokens) {
+    StopToken unbound;
+    EXPECT_FALSE(unbound.stopPossible());
+    EXPECT_FALSE(unbound.stopRequested());
+
+    StopSource source;
+    StopToken token = source.token();
+    StopSource copy = source;
+    EXPECT_TRUE(token.stopPossible());
+    EXPECT_FALSE(token.stopRequested());
+    copy.requestStop();
+    EXPECT_TRUE(token.stopRequested());
+    EXPECT_TRUE(source.stopRequested());
+}
+
+/**
+ * @test NewTaskStopsRunningOne
+ * @brief run() does not wait: the running task sees its stop, the new
+ *        task follows on the same thread with a fresh token
+ */
+TEST(TaskRunnerTest, NewTaskStopsRunningOne) {
+    TaskRunner runner;
+    std::atomic<bool> started{false};
+    std::atomic<bool> saw_stop{false};
+    std::thread::id first_thread;
+    std::thread::id second_thread;
+    int second_runs = 0;
+
+    runner.run([&](const StopToken& stop) {
+        first_thread = std::this_thread::get_id();
+        started = true;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!stop.stopRequested() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        saw_stop = stop.stopRequested();
+    });
+    waitFor(started);
+
+    runner.run([&](const StopToken& stop) {
+        EXPECT_FALSE(stop.stopRequested());
+        second_thread = std::this_thread::get_id();
+        ++second_runs;
+    });
+    runner.wait();
+
+    EXPECT_TRUE(saw_stop.load());
+    EXPECT_EQ(second_runs, 1);
+    EXPECT_EQ(first_thread, second_thread);
+    EXPECT_FALSE(runner.busy());
+}
+
+/**
+ * @test QueuedTaskIsReplaced
+ * @brief Of several tasks queued behind a running one only the last runs;
+ *        cancel() drops the queued task
+ */
+TEST(TaskRunnerTest, QueuedTaskIsReplaced) {
+    TaskRunner runner;
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    std::atomic<int> runs_b{0};
+    std::atomic<int> runs_c{0};
+
+    auto blocker = [&](const StopToken&) {
+        started = true;
+        waitFor(release); // ignores its token on purpose
+    };
+
+    runner.run(blocker);
+    waitFor(started);
+    runner.run([&](const StopToken&) { ++runs_b; });
+    runner.run([&](const StopToken&) { ++runs_c; });
+    EXPECT_TRUE(runner.busy());
+    release = true;
+    runner.wait();
+    EXPECT_EQ(runs_b.load(), 0);
+    EXPECT_EQ(runs_c.load(), 1);
+
+    started = false;
+    release = false;
+    runner.run(blocker);
+    waitFor(started);
+    runner.run([&](const StopToken&) { ++runs_b; });
+    runner.cancel();
+    release = true;
+    runner.wait();
+    EXPECT_EQ(runs_b.load(), 0);
+}
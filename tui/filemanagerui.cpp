@@ -14,6 +14,7 @@
  * - UI setup and layout configuration
  * - File/directory navigation and selection
  * - Delete operations with safety checks
+ * - Live updates from the directory watcher
  * - Animation thread management
  *
  * @see FileManagerUI
@@ -24,21 +25,65 @@
 #include "duplicatefinder.hpp"
 #include "fileprocessoradapter.hpp"
 #include "filesafety.hpp"
+#include "listingpatch.hpp"
+#include "stats.hpp"
 #include "utils.hpp"
 
+#include <sys/stat.h>
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+/** @brief Spinner steps per second while loading */
+constexpr unsigned SPINNER_FPS = 10;
+
+/**
+ * @brief Current spinner phase, derived from the clock
+ * @return Monotonic step counter (SPINNER_FPS steps per second, 8 bits)
+ */
+std::uint64_t spinnerFrame() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+  return static_cast<std::uint64_t>(ms / (1000 / SPINNER_FPS)) & 0xFF;
+}
+
+} // namespace
+
 FileManagerUI::~FileManagerUI() {
   stopAnimation();
-
-  // Wait for background task to complete
-  if (m_load_future.valid()) {
-    m_load_future.wait();
-  }
+  m_watcher.unwatch();
+
+  // Stop background tasks and wait for them; they use the members below
+  ++m_load_generation;
+  cancelDuplicateSearch();
+  m_loader.cancel();
+  m_duplicate_runner.cancel();
+  m_refresh_runner.cancel();
+  m_delete_runner.cancel();
+  m_usage_runner.cancel();
+  m_cross_root_runner.cancel();
+  m_loader.wait();
+  m_duplicate_runner.wait();
+  m_refresh_runner.wait();
+  m_delete_runner.wait();
+  m_usage_runner.wait();
+  m_cross_root_runner.wait();
 
   // FTXUI bug workaround: Terminal cleanup requires output to properly restore
   // state This ensures the terminal is left in a clean state even if the
   // program terminates unexpectedly (e.g., via exception or early exit)
   std::cout << "FileManager terminated. Final status: " << m_current_status
             << std::endl;
+  if (Stats::ENABLED) {
+    for (const auto &line : Stats::global().snapshot().lines()) {
+      std::cout << "  " << line << '\n';
+    }
+    std::cout.flush();
+  }
 }
 
 // ============================================================================
@@ -49,63 +94,311 @@ FileManagerUI::~FileManagerUI() {
  * @brief Filters file list to show only duplicate files
  *
  * Implementation details:
- * 1. Toggle behavior: If duplicate filter is already active, clears it
+ * 1. Toggle behavior: If duplicate filter is already active, clears it;
+ *    if a search is still running, cancels it
  * 2. State preservation: Clears any other active filter first
- * 3. Backs up current file list to m_all_files
- * 4. Uses DuplicateFinder to identify duplicates
- * 5. Extracts only files marked as duplicates
- * 6. Updates UI to show full paths and resets selection
- * 7. Calculates and displays wasted space from duplicates
+ * 3. Listing already searched: switches to the duplicate view of m_index,
+ *    whose groups were kept up to date since (no I/O)
+ * 4. Otherwise copies the listing for the background search and runs the
+ *    staged DuplicateFinder on a HashPipeline on m_duplicate_runner
+ *    (size, sample hash, full hash on all cores)
+ * 5. Progress (files and throughput) is posted to the status line
+ * 6. The result is posted back and applied by applyDuplicateResult()
  *
- * If no duplicates are found, updates status message and returns without
- * applying filter.
+ * The UI thread never reads file content, so navigation stays responsive
+ * while large files are hashed.
  *
  * @see DuplicateFinder::findDuplicates()
- * @see DuplicateFinder::calculateWastedSpace()
+ * @see applyDuplicateResult()
  * @see clearFilter()
  */
 void FileManagerUI::showDuplicates() {
-  // 1. Switching logic: Deactivate if already active.
+  // 1. Switching logic: Cancel a running search, deactivate if already active.
+  if (m_duplicate_pipeline) {
+    cancelDuplicateSearch();
+    m_current_status = "Duplicate search cancelled.";
+    return;
+  }
+
   if (m_current_filter_state == FilterState::DuplicatesOnly) {
     clearFilter();
     return;
   }
 
-  // 2. State preservation: If ANOTHER filter is active, delete it first,
-  //    so that m_file_infos is reset to its original state.
+  if (m_loading) {
+    m_current_status = "Directory is still loading.";
+    return;
+  }
+
+  // 2. State preservation: If ANOTHER filter is active, delete it first.
   if (m_current_filter_state != FilterState::None) {
     clearFilter();
   }
 
-  // 3. Filter preparation (backup of the original state, since clearFilter()
-  // deleted m_all_files)
-  m_all_files = m_file_infos;
-  auto groups = DuplicateFinder::findDuplicates(m_file_infos);
+  // 3. Groups of an earlier search
+  if (m_index.duplicatesKnown()) {
+    const std::size_t count = m_index.view(FileIndex::View::Duplicates).size();
+    if (count == 0) {
+      m_current_status = "No duplicates found.";
+      return;
+    }
+
+    m_show_full_paths = true;
+    m_current_filter_state = FilterState::DuplicatesOnly;
+    m_selected = 0;
+    updateVirtualizedView();
+
+    m_current_status = "Showing " + std::to_string(count) + " duplicates (" +
+                       formatBytes(m_index.wastedSpace()) +
+                       " wasted). Press 'c' to clear filter.";
+    m_redraw.requestRedraw();
+    return;
+  }
+
+  if (!m_duplicate_hasher) {
+    m_hash_cache = HashCache::openDefault();
+    m_duplicate_hasher = createHashCalculator(HashAlgorithm::FNV1A, m_hash_cache);
+  }
+
+  // 4. The search works on a copy; m_index stays usable meanwhile
+  auto pipeline = std::make_shared<HashPipeline>(*m_duplicate_hasher);
+  pipeline->setProgressCallback(
+      [this, id = pipeline.get()](const HashPipeline::Progress &progress) {
+        std::string text =
+            std::string(progress.mode == HashPipeline::Mode::Sample
+                            ? "Sampling "
+                            : "Hashing ") +
+            std::to_string(progress.files_done) + "/" +
+            std::to_string(progress.files_total) + " files, " +
+            formatBytes(static_cast<long long>(progress.bytes_per_second)) +
+            "/s. Press 'd' to cancel.";
+
+        m_screen.Post([this, id, text]() {
+          if (m_duplicate_pipeline.get() == id) {
+            m_current_status = text;
+          }
+        });
+        m_redraw.requestRedraw();
+      });
+
+  m_duplicate_pipeline = pipeline;
+  m_current_status = "Searching duplicates...";
+
+  std::vector<FileIndex::Id> ids;
+  std::vector<FileInfo> files = m_index.snapshot(&ids);
+
+  // 5. Background search; a cancelled one may still be finishing its
+  //    current file, this one starts right after it
+  m_duplicate_runner.run(
+      [this, pipeline, files = std::move(files), ids = std::move(ids)](
+          const StopToken &stop) mutable {
+        pipeline->setStopToken(stop);
+        DuplicateFinder::findDuplicates(files, *pipeline);
+        if (m_hash_cache) {
+          m_hash_cache->flush(); // share new digests with other tfm instances
+        }
+
+        // 6. Apply on the UI thread
+        m_screen.Post([this, pipeline, files = std::move(files), ids = std::move(ids)]() {
+          applyDuplicateResult(pipeline, files, ids);
+        });
+        m_redraw.requestRedraw();
+      });
+}
+
+/**
+ * @brief Applies a finished duplicate search (UI thread only)
+ *
+ * Implementation details:
+ * 1. Discards results of cancelled or superseded searches
+ * 2. Stores the digests of the duplicates in m_index; entries removed or
+ *    replaced since the snapshot are skipped (their id is no longer valid)
+ * 3. Shows the duplicate view via showDuplicates(), which now finds the
+ *    listing searched
+ *
+ * @see showDuplicates()
+ * @see FileIndex::setDigest()
+ */
+void FileManagerUI::applyDuplicateResult(const std::shared_ptr<HashPipeline> &pipeline,
+                                         const std::vector<FileInfo> &files,
+                                         const std::vector<FileIndex::Id> &ids) {
+  // 1. Stale result (cancelled, or the directory changed meanwhile)
+  if (pipeline != m_duplicate_pipeline) {
+    return;
+  }
+  m_duplicate_pipeline.reset();
 
-  if (groups.empty()) {
-    m_current_status = "No duplicates found.";
+  if (pipeline->isCancelled()) {
+    m_current_status = "Duplicate search cancelled.";
     return;
   }
 
-  m_store_files.clear();
-  for (const auto &info : m_file_infos) {
-    if (info.isDuplicate()) {
-      m_store_files.push_back(info);
+  // 2. Digests into the index
+  for (std::size_t i = 0; i < files.size() && i < ids.size(); ++i) {
+    if (files[i].isDuplicate() && m_index.contains(ids[i])) {
+      m_index.setDigest(ids[i], files[i].getDigest());
     }
   }
+  m_index.setDuplicatesKnown(true);
 
-  m_file_infos = m_store_files;
-  m_show_full_paths = true;
-  m_current_filter_state = FilterState::DuplicatesOnly;
+  // 3. Also replaces a filter applied while the search was running
+  showDuplicates();
+}
 
-  updateMenuStrings(m_file_infos, m_panel_files);
-  updateVirtualizedView();
-  m_selected = 0;
+/**
+ * @brief Cancels a running duplicate search without waiting for it
+ *
+ * The worker threads stop after their current file; the posted result is
+ * discarded by applyDuplicateResult() because m_duplicate_pipeline is reset.
+ * A running size-group refresh is cancelled the same way.
+ *
+ * @see HashPipeline::cancel()
+ */
+void FileManagerUI::cancelDuplicateSearch() {
+  if (m_duplicate_pipeline) {
+    m_duplicate_pipeline->cancel();
+    m_duplicate_pipeline.reset();
+  }
+  if (m_refresh_pipeline) {
+    m_refresh_pipeline->cancel();
+    m_refresh_pipeline.reset();
+  }
+  m_refresh_sizes.clear();
+  if (m_verifying) {
+    m_duplicate_runner.cancel();
+    m_verifying = false;
+    ++m_verify_generation;
+  }
+}
+
+/**
+ * @brief Confirms the duplicate groups of m_index byte for byte
+ *
+ * Implementation details:
+ * 1. Toggle behavior: a running verification is cancelled
+ * 2. Needs the groups of a finished duplicate search
+ * 3. Copies the duplicates and regroups the copies by digest on
+ *    m_duplicate_runner
+ * 4. DuplicateFinder::verifyGroups() compares every group (memory-mapped,
+ *    chunk by chunk, several groups at a time)
+ * 5. The result is posted back and applied by applyVerifyResult()
+ *
+ * @see DuplicateFinder::verifyGroups()
+ * @see applyVerifyResult()
+ */
+void FileManagerUI::verifyDuplicates() {
+  // 1. Switching logic
+  if (m_verifying) {
+    cancelDuplicateSearch();
+    m_current_status = "Verification cancelled.";
+    return;
+  }
 
-  long long wasted = DuplicateFinder::calculateWastedSpace(groups);
-  m_current_status = "Showing " + std::to_string(m_store_files.size()) +
-                     " duplicates (" + formatBytes(wasted) +
-                     " wasted). Press 'c' to clear filter.";
+  // 2. Groups to verify
+  if (m_duplicate_pipeline) {
+    m_current_status = "Duplicate search is still running.";
+    return;
+  }
+  if (!m_index.duplicatesKnown()) {
+    m_current_status = "Search duplicates first ('d').";
+    return;
+  }
+
+  std::vector<FileIndex::Id> ids = m_index.view(FileIndex::View::Duplicates);
+  if (ids.empty()) {
+    m_current_status = "No duplicates to verify.";
+    return;
+  }
+
+  // 3. Copies, so m_index stays usable meanwhile
+  std::vector<FileInfo> files;
+  files.reserve(ids.size());
+  for (FileIndex::Id id : ids) {
+    files.push_back(m_index.at(id));
+  }
+
+  m_verifying = true;
+  const unsigned generation = ++m_verify_generation;
+  m_current_status = "Verifying " + std::to_string(files.size()) +
+                     " duplicates byte for byte... Press 'v' to cancel.";
+
+  m_duplicate_runner.run([this, generation, files = std::move(files),
+                          ids = std::move(ids)](const StopToken &stop) mutable {
+    std::map<HashDigest, DuplicateFinder::DuplicateGroup> by_digest;
+    for (auto &file : files) {
+      auto &group = by_digest[file.getDigest()];
+      group.files.push_back(&file);
+    }
+    std::vector<DuplicateFinder::DuplicateGroup> groups;
+    groups.reserve(by_digest.size());
+    for (auto &[digest, group] : by_digest) {
+      group.hash = digest.toHex();
+      groups.push_back(std::move(group));
+    }
+
+    // 4. Compare
+    DuplicateFinder::verifyGroups(groups, 0, stop);
+    if (stop.stopRequested()) {
+      return;
+    }
+
+    // 5. Apply on the UI thread
+    m_screen.Post([this, generation, files = std::move(files), ids = std::move(ids)]() {
+      applyVerifyResult(generation, files, ids);
+    });
+    m_redraw.requestRedraw();
+  });
+}
+
+/**
+ * @brief Applies a finished verification (UI thread only)
+ *
+ * Confirmed files are flagged in m_index. Files that matched no other
+ * member of their group (a hash collision) lose their digest and leave
+ * the duplicate view, unless they changed since. Files that could not
+ * be compared (still marked as duplicates) are left as they were and
+ * only counted.
+ *
+ * @see FileIndex::setVerified()
+ */
+void FileManagerUI::applyVerifyResult(unsigned generation, const std::vector<FileInfo> &files,
+                                      const std::vector<FileIndex::Id> &ids) {
+  if (generation != m_verify_generation || !m_verifying) {
+    return;
+  }
+  m_verifying = false;
+
+  std::size_t confirmed = 0;
+  std::size_t rejected = 0;
+  std::size_t unreadable = 0;
+  for (std::size_t i = 0; i < files.size() && i < ids.size(); ++i) {
+    if (!m_index.contains(ids[i]) || m_index.at(ids[i]).getDigest() != files[i].getDigest()) {
+      continue;
+    }
+    if (files[i].isVerified()) {
+      m_index.setVerified(ids[i], true);
+      ++confirmed;
+    } else if (files[i].isDuplicate()) {
+      ++unreadable;
+    } else {
+      m_index.setDigest(ids[i], HashDigest());
+      ++rejected;
+    }
+  }
+
+  if (m_current_filter_state == FilterState::DuplicatesOnly) {
+    m_selected = 0;
+    updateVirtualizedView();
+  }
+  m_current_status = "Verified " + std::to_string(confirmed) + " duplicates byte for byte";
+  if (rejected > 0) {
+    m_current_status += ", " + std::to_string(rejected) + " differ and were unmarked";
+  }
+  if (unreadable > 0) {
+    m_current_status += ", " + std::to_string(unreadable) + " could not be read";
+  }
+  m_current_status += ".";
+  m_redraw.requestRedraw();
 }
 
 /**
@@ -114,10 +407,10 @@ void FileManagerUI::showDuplicates() {
  * Implementation details:
  * 1. Toggle behavior: If zero-byte filter is already active, clears it
  * 2. State preservation: Clears any other active filter first
- * 3. Backs up current file list to m_all_files
- * 4. Filters for files with size == 0 (excludes directories and parent dir)
- * 5. Updates UI to show full paths and resets selection
- * 6. If no zero-byte files found, clears backup and returns
+ * 3. Switches to the zero-byte view of m_index (files with size == 0,
+ *    without directories and parent dir); nothing is copied
+ * 4. Updates UI to show full paths and resets selection
+ * 5. If no zero-byte files found, keeps the listing shown
  *
  * @see clearFilter()
  */
@@ -128,71 +421,166 @@ void FileManagerUI::showZeroByteFiles() {
     return;
   }
 
-  // 2. State preservation: If ANOTHER filter is active, delete it first,
-  //    so that m_file_infos is reset to its original state.
-  if (m_current_filter_state != FilterState::None) {
-    clearFilter();
+  if (m_loading) {
+    m_current_status = "Directory is still loading.";
+    return;
   }
 
-  m_all_files = m_file_infos; // Saving the current file list (backup)
-
-  for (const auto &info : m_file_infos) {
-    if (info.getFileSize() == 0 && !info.isDirectory() && !info.isParentDir()) {
-      m_store_files.push_back(info);
-    }
+  // 2. State preservation: If ANOTHER filter is active, delete it first.
+  if (m_current_filter_state != FilterState::None) {
+    clearFilter();
   }
 
-  if (m_store_files.empty()) {
+  const std::size_t count = m_index.view(FileIndex::View::ZeroBytes).size();
+  if (count == 0) {
     m_current_status = "No 0-byte files found.";
-    m_all_files.clear(); // Delete the backup because no filter was applied.
-    clearFilter();       // ensures that the status is consistent.
     return;
   }
 
-  m_file_infos = m_store_files;
   m_show_full_paths = true;
   m_current_filter_state = FilterState::ZeroBytesOnly;
 
-  updateMenuStrings(m_file_infos, m_panel_files);
-  updateVirtualizedView();
   m_selected = 0;
-  m_current_status =
-      "Filter: " + std::to_string(m_file_infos.size()) + " Zero file(s) found.";
-  m_screen.RequestAnimationFrame();
+  updateVirtualizedView();
+  m_current_status = "Filter: " + std::to_string(count) + " Zero file(s) found.";
+  m_redraw.requestRedraw();
 }
 
 /**
- * @brief Clears active filter and restores original file list
+ * @brief Starts typing a name search
  *
- * Restores m_file_infos from the backup stored in m_all_files, clears the
- * backup, resets filter state to None, disables full path display, updates
- * the UI strings and virtualized view, and resets selection to first item.
+ * The query starts empty, so all entries show until the first key. The
+ * name index of m_index is built when the view is first requested (one
+ * pass over the names), and again only after the listing changed.
+ */
+void FileManagerUI::startNameSearch() {
+  if (m_current_filter_state != FilterState::NameMatches) {
+    m_index.setNameFilter("");
+    m_current_filter_state = FilterState::NameMatches;
+    m_show_full_paths = m_cross_root_view;
+    m_selected = 0;
+    updateVirtualizedView();
+  }
+  m_search_typing = true;
+  m_current_status = "Search: type to filter, Enter to keep, Esc to cancel.";
+  m_redraw.requestRedraw();
+}
+
+bool FileManagerUI::handleSearchKey(const Event &event) {
+  std::string query = m_index.nameFilter();
+
+  if (event == Event::Escape) {
+    m_search_typing = false;
+    m_index.setNameFilter("");
+    if (m_cross_root_view) {
+      m_current_filter_state = FilterState::DuplicatesOnly;
+      m_selected = 0;
+      updateVirtualizedView();
+      m_current_status = "Search cancelled.";
+    } else {
+      clearFilter();
+    }
+    m_redraw.requestRedraw();
+    return true;
+  }
+  if (event == Event::Return) {
+    m_search_typing = false;
+    m_current_status = std::to_string(rows().size()) + " entries match \"" + query +
+                       "\". Press 'c' to clear filter.";
+    return true;
+  }
+  if (event == Event::Backspace) {
+    // Whole UTF-8 characters
+    while (!query.empty() && (static_cast<unsigned char>(query.back()) & 0xC0) == 0x80) {
+      query.pop_back();
+    }
+    if (!query.empty()) {
+      query.pop_back();
+    }
+  } else if (event.is_character()) {
+    query += event.character();
+  } else {
+    return false;
+  }
+
+  m_index.setNameFilter(query);
+  m_selected = 0;
+  updateVirtualizedView();
+  m_current_status = std::to_string(rows().size()) + " entries match.";
+  m_redraw.requestRedraw();
+  return true;
+}
+
+/**
+ * @brief Clears active filter and shows the whole listing again
  *
- * If no backup exists (m_all_files is empty), only resets the filter state.
+ * Resets filter state to None, disables full path display and keeps the
+ * selected entry selected in the listing. The listing itself was never
+ * replaced, so nothing has to be restored.
  *
  * @see showDuplicates()
  * @see showZeroByteFiles()
  */
 void FileManagerUI::clearFilter() {
-  if (m_all_files.empty()) {
-    m_current_filter_state = FilterState::None;
+  m_search_typing = false;
+  if (m_current_filter_state == FilterState::None) {
+    return;
+  }
+  if (m_cross_root_view) {
+    m_current_status = "Cross-root view closed.";
+    loadDirectoryAsync(m_panel_path);
     return;
   }
 
-  // Restore original files
-  m_file_infos = m_all_files;
-  m_all_files.clear();
+  const auto *selected = safe_at(m_visible_indices, m_menu_selected);
+  const bool keep_selection = selected != nullptr;
+  const FileIndex::Id selected_id = keep_selection ? *selected : 0;
 
-  // IMPORTANT: back
   m_current_filter_state = FilterState::None;
   m_show_full_paths = false;
 
-  updateMenuStrings(m_file_infos, m_panel_files);
-  updateVirtualizedView();
   m_selected = 0;
-  m_current_status = "Filter cleared. Showing " +
-                     std::to_string(m_file_infos.size()) + " entries.";
-  m_screen.RequestAnimationFrame();
+  if (keep_selection) {
+    selectEntry(selected_id);
+  }
+  updateVirtualizedView();
+  m_current_status = "Filter cleared. Showing " + std::to_string(m_index.size()) +
+                     " entries.";
+  m_redraw.requestRedraw();
+}
+
+/**
+ * @brief Rows of the file panel for the current filter state
+ *
+ * @see FileIndex::view()
+ */
+const std::vector<FileIndex::Id> &FileManagerUI::rows() const {
+  switch (m_current_filter_state) {
+  case FilterState::DuplicatesOnly:
+    return m_index.view(FileIndex::View::Duplicates);
+  case FilterState::ZeroBytesOnly:
+    return m_index.view(FileIndex::View::ZeroBytes);
+  case FilterState::NameMatches:
+    return m_index.view(FileIndex::View::Matches);
+  default:
+    return m_index.view(FileIndex::View::All);
+  }
+}
+
+/**
+ * @brief Moves m_selected to the row of an entry
+ *
+ * Linear in the number of rows; the selection stays unchanged if the
+ * entry is not shown.
+ *
+ * @param id Entry of m_index
+ */
+void FileManagerUI::selectEntry(FileIndex::Id id) {
+  const auto &ids = rows();
+  const auto it = std::find(ids.begin(), ids.end(), id);
+  if (it != ids.end()) {
+    m_selected = static_cast<int>(it - ids.begin());
+  }
 }
 
 // ============================================================================
@@ -203,18 +591,26 @@ void FileManagerUI::clearFilter() {
  * @brief Loads directory contents asynchronously in a background thread
  *
  * Implementation flow:
- * 1. Waits for any existing async operation to complete
- * 2. Sets loading flags and clears current file lists
- * 3. Starts animation thread for visual feedback
- * 4. Launches async task using std::async:
+ * 1. Supersedes a running scan (new m_load_generation) without waiting:
+ *    m_loader stops it through its StopToken after its current entry
+ * 2. Ends an active filter, watches the new directory, sets loading flags
+ *    and clears current file lists
+ * 3. Starts animation thread for visual feedback; a directory held by
+ *    m_snapshot is shown from it instead (see loadSnapshotListing())
+ * 4. Runs the load on m_loader:
  *    - Creates FileProcessorAdapter for the path
- *    - Scans directory with progress callback (updates m_loaded_count)
- *    - Posts results back to UI thread via m_screen.Post()
- *    - Calls updateUIAfterLoad() and stops animation
+ *    - Streams the directory with progress callback (updates m_loaded_count)
+ *    - Posts every batch to the UI thread via m_screen.Post(), where
+ *      appendLoadedBatch() shows it right away
+ *    - Finally posts updateUIAfterLoad() (sorting) and stops animation
  * 5. Handles exceptions by displaying error status
  *
  * The operation is fully asynchronous - the UI remains responsive during
- * directory scanning.
+ * directory scanning, and the first rows appear after the first batch
+ * (at most FileScanner::BATCH_INTERVAL), whatever the directory size.
+ * Navigating on before a scan finished never waits for it.
+ *
+ * @see TaskRunner
  *
  * @param path The directory path to scan asynchronously
  *
@@ -223,72 +619,387 @@ void FileManagerUI::clearFilter() {
  * @see stopAnimation()
  */
 void FileManagerUI::loadDirectoryAsync(const std::filesystem::path &path) {
-  if (m_load_future.valid()) {
-    m_load_future.wait();
-  }
+  const unsigned generation = ++m_load_generation;
+
+  // Results of a running duplicate search refer to the old directory
+  cancelDuplicateSearch();
+
+  // A new listing ends any filter of the old one
+  m_current_filter_state = FilterState::None;
+  m_show_full_paths = false;
+  m_cross_root_view = false;
+  m_search_typing = false;
+
+  // Watch before scanning: changes during the scan are queued, not lost
+  m_pending_events.clear();
+  m_carried_digests.clear();
+  m_watcher.watch(path.string());
 
   m_loading = true;
   m_loaded_count = 0;
   m_loading_message = "Scanning directory...";
 
-  m_file_infos.clear();
-  m_panel_files.clear();
-  m_visible_files.clear();
+  m_index.clear();
+  m_marked.clear();
+  m_selected = 0;
+  updateVirtualizedView();
 
   startAnimation();
 
-  m_load_future = std::async(std::launch::async, [this, path]() {
+  if (m_snapshot && loadSnapshotListing(path, generation)) {
+    return;
+  }
+
+  m_loader.run([this, path, generation](const StopToken &stop) {
     try {
       FileProcessorAdapter fp(path);
+      fp.setStopToken(stop);
 
-      auto progress_callback = [this](int count) { m_loaded_count = count; };
+      auto progress_callback = [this, generation](int count) {
+        if (m_load_generation == generation) {
+          m_loaded_count = count;
+        }
+      };
 
-      // FIXIT include_parent_dir, recursive, ?
-      auto files = fp.scanDirectory(true, false, progress_callback);
+      auto batch_callback = [this, generation](std::vector<FileInfo> &&batch) {
+        if (m_load_generation != generation) {
+          return false; // superseded by a newer load
+        }
+        m_screen.Post([this, generation, batch = std::move(batch)]() mutable {
+          if (m_load_generation == generation) {
+            appendLoadedBatch(std::move(batch));
+          }
+        });
+        return true;
+      };
 
-      m_screen.Post([this, files = std::move(files)]() mutable {
-        m_file_infos = std::move(files);
+      // FIXIT include_parent_dir, recursive, ?
+      fp.scanDirectoryStreaming(true, false, batch_callback, progress_callback);
 
+      m_screen.Post([this, generation]() {
+        if (m_load_generation != generation) {
+          return;
+        }
         updateUIAfterLoad();
         m_loading = false;
+        if (!m_pending_events.empty()) {
+          applyWatchEvents(std::exchange(m_pending_events, {}));
+        }
 
         stopAnimation();
       });
 
-      return files;
-
     } catch (const std::exception &e) {
-      m_screen.Post([this]() {
+      m_screen.Post([this, generation]() {
+        if (m_load_generation != generation) {
+          return;
+        }
         m_current_status = "Error loading directory";
         m_loading = false;
         stopAnimation();
       });
+    }
+  });
+}
+
+/**
+ * @brief Shows a directory from m_snapshot and revalidates it
+ *
+ * Implementation details:
+ * 1. ScanSnapshot::list() materializes only this directory (no scan, no
+ *    per-entry parsing of the rest of the file); entries come sorted
+ * 2. Stored digests of a duplicate search regroup in m_index, which then
+ *    counts as searched. Only duplicates within this directory are shown,
+ *    as after searching a scanned directory: a file whose copies all lie
+ *    elsewhere in the tree is not marked
+ * 3. m_loading stays set, so watcher events are queued meanwhile; m_loader
+ *    scans the directory and diffs the stored listing against it
+ * 4. The differences and the queued events are applied by
+ *    applyWatchEvents(), which re-checks the duplicates of changed sizes
+ *
+ * A directory that does not exist on this host (a snapshot from another
+ * machine) keeps its stored listing.
+ *
+ * @see ScanSnapshot
+ * @see ListingPatch::diff()
+ */
+bool FileManagerUI::loadSnapshotListing(const std::filesystem::path &path,
+                                        unsigned generation) {
+  // 1. Stored listing
+  std::vector<FileInfo> listing;
+  if (!m_snapshot->list(path.string(), true, listing)) {
+    return false;
+  }
 
-      return std::vector<FileInfo>();
+  // 2. Duplicates within the directory, from the stored digests
+  m_index.append(std::vector<FileInfo>(listing));
+  m_index.setDuplicatesKnown(m_snapshot->duplicatesSearched());
+  m_current_status = "Loaded " + std::to_string(m_index.size()) + " items from snapshot";
+  m_loading_message = "Revalidating snapshot...";
+  updateVirtualizedView();
+  m_redraw.requestRedraw();
+
+  // 3. Revalidation
+  m_loader.run([this, path, generation, listing = std::move(listing)](const StopToken &stop) {
+    std::error_code ec;
+    const bool present = std::filesystem::is_directory(path, ec);
+    std::vector<DirectoryWatcher::Event> events;
+    if (present) {
+      FileProcessorAdapter fp(path);
+      fp.setStopToken(stop);
+      events = ListingPatch::diff(listing, fp.scanDirectory(false));
     }
+
+    m_screen.Post([this, generation, present, events = std::move(events)]() mutable {
+      if (m_load_generation != generation) {
+        return;
+      }
+      m_loading = false;
+      m_loading_message = "";
+      m_current_status = present ? "Loaded " + std::to_string(m_index.size()) +
+                                       " items from snapshot, " +
+                                       std::to_string(events.size()) + " changed since"
+                                 : "Snapshot listing (directory not available here)";
+
+      // 4. Differences, then what the watcher reported meanwhile
+      events.insert(events.end(), m_pending_events.begin(), m_pending_events.end());
+      m_pending_events.clear();
+      if (!events.empty()) {
+        applyWatchEvents(std::move(events));
+      }
+      stopAnimation();
+    });
   });
+  return true;
+}
+
+/**
+ * @brief Appends a streamed batch of entries while the directory loads
+ *
+ * Runs on the UI thread. The entries move into m_index, so a directory
+ * of n entries costs O(n) over all batches; the visible window is
+ * refreshed so the first rows appear immediately.
+ *
+ * @param batch Unsorted entries delivered by the scanner
+ *
+ * @see loadDirectoryAsync()
+ * @see updateUIAfterLoad()
+ */
+void FileManagerUI::appendLoadedBatch(std::vector<FileInfo> &&batch) {
+  m_index.append(std::move(batch));
+  updateVirtualizedView();
+  m_redraw.requestRedraw();
 }
 
 /**
  * @brief Updates UI components after async directory load completes
  *
  * Called from the UI thread after the async directory scan finishes.
- * Updates menu strings from file info objects, refreshes the virtualized
- * view window, resets selection to first item, updates status message with
- * item count, and clears the loading message.
+ * Sorts the streamed entries (they arrive unsorted; by name, or by
+ * cumulative size in the disk usage view), keeps the entry
+ * selected during loading selected, refreshes the virtualized view window,
+ * updates status message with item count, and clears the loading message.
  *
  * @see loadDirectoryAsync()
- * @see updateMenuStrings()
+ * @see sortListing()
  * @see updateVirtualizedView()
  */
 void FileManagerUI::updateUIAfterLoad() {
-  updateMenuStrings(m_file_infos, m_panel_files);
-  updateVirtualizedView();
-  m_selected = 0;
-  m_current_status = "Loaded " + std::to_string(m_file_infos.size()) + " items";
+  // The user may already have moved the selection while entries streamed in
+  sortListing();
+  m_current_status = "Loaded " + std::to_string(m_index.size()) + " items";
+  if (m_usage_tree) {
+    m_current_status += ". " + usageSummary();
+  }
   m_loading_message = "";
 }
 
+// ============================================================================
+// LIVE UPDATES
+// ============================================================================
+
+/**
+ * @brief Applies directory changes to the loaded model (UI thread only)
+ *
+ * Implementation details:
+ * 1. Drops events of a previously listed directory (already posted when
+ *    the directory changed); queues events while a load is running
+ * 2. Patches m_index with ListingPatch::apply(); an Overflow starts a
+ *    rescan instead. The views follow the index: changed entries are
+ *    re-evaluated for the zero-byte view, deleted and changed files leave
+ *    their duplicate group, which is dissolved below two files (no I/O).
+ *    In the disk usage view new entries are appended, so the listing is
+ *    sorted by size again
+ * 3. Copies a consolidation replaced get their digest and Verified mark
+ *    back (restoreCarriedDigest()). Once the listing was searched for
+ *    duplicates, sizes of other new or changed files that now collide are
+ *    re-checked in background, also while the duplicate filter is not
+ *    shown
+ * 4. Refreshes the window; the selection keeps its row, so after a
+ *    delete the next entry is selected
+ *
+ * The status line is left alone: it still shows the result of the action
+ * that caused the change.
+ *
+ * @param events Changes reported by m_watcher (or by a delete)
+ *
+ * @see DirectoryWatcher
+ * @see ListingPatch
+ * @see refreshDuplicateSizes()
+ */
+void FileManagerUI::applyWatchEvents(std::vector<DirectoryWatcher::Event> &&events) {
+  // 1. Only events of the listed directory; the cross-root view is not
+  //    watched and only drops the entries a deletion removed
+  events.erase(std::remove_if(events.begin(), events.end(),
+                              [this](const DirectoryWatcher::Event &event) {
+                                if (m_cross_root_view) {
+                                  return event.type != DirectoryWatcher::Event::Type::Deleted;
+                                }
+                                if (event.type == DirectoryWatcher::Event::Type::Overflow) {
+                                  return event.path != m_panel_path;
+                                }
+                                const std::size_t slash = event.path.rfind('/');
+                                const std::string parent =
+                                    slash == 0 ? "/" : event.path.substr(0, slash);
+                                return parent != m_panel_path;
+                              }),
+               events.end());
+  if (events.empty()) {
+    return;
+  }
+  if (m_loading) {
+    m_pending_events.insert(m_pending_events.end(), events.begin(), events.end());
+    return;
+  }
+
+  // 2. Listing and its views
+  auto result = ListingPatch::apply(m_index, events, true);
+  if (result.rescan) {
+    m_current_status = "Directory changed, reloading.";
+    loadDirectoryAsync(m_panel_path);
+    return;
+  }
+  if (m_usage_tree && !result.entries.empty()) {
+    sortListing(); // inserts were appended to the size order
+  }
+
+  // 3. Duplicate groups; consolidated copies keep theirs
+  std::unordered_set<std::string> carried;
+  if (!m_carried_digests.empty()) {
+    for (const auto &info : result.entries) {
+      const std::string path = info.getPath();
+      if (restoreCarriedDigest(path)) {
+        carried.insert(path);
+      }
+    }
+  }
+  if (m_index.duplicatesKnown()) {
+    std::unordered_map<long long, std::size_t> size_count;
+    for (FileIndex::Id id : m_index.view(FileIndex::View::All)) {
+      const FileInfo &info = m_index.at(id);
+      if (!info.isDirectory() && info.getFileSize() > 0) {
+        ++size_count[info.getFileSize()];
+      }
+    }
+    std::vector<long long> sizes;
+    for (const auto &info : result.entries) {
+      if (!info.isDirectory() && info.getFileSize() > 0 &&
+          size_count[info.getFileSize()] > 1 && !carried.count(info.getPath())) {
+        sizes.push_back(info.getFileSize());
+      }
+    }
+    if (!sizes.empty()) {
+      refreshDuplicateSizes(std::move(sizes));
+    }
+  }
+
+  // 4. Window
+  updateVirtualizedView();
+  m_redraw.requestRedraw();
+}
+
+/**
+ * @brief Searches the duplicates of some file sizes again in background
+ *
+ * Implementation details:
+ * 1. Cancels a running refresh; its sizes are searched by this one
+ * 2. Copies the files of the requested sizes from m_index
+ * 3. Runs the staged search over them on a HashPipeline (the hash cache
+ *    keeps unchanged files from being read again)
+ * 4. Posts the result back unless a newer refresh started; every
+ *    candidate still listed with the same size gets its new digest (or
+ *    none), and m_index regroups it
+ *
+ * @param sizes File sizes whose groups may have changed
+ *
+ * @see applyWatchEvents()
+ */
+void FileManagerUI::refreshDuplicateSizes(std::vector<long long> sizes) {
+  if (!m_duplicate_hasher) {
+    return;
+  }
+
+  // 1. Supersede a running refresh (it stops after its current file)
+  if (m_refresh_pipeline) {
+    m_refresh_pipeline->cancel();
+    m_refresh_pipeline.reset();
+  }
+  sizes.insert(sizes.end(), m_refresh_sizes.begin(), m_refresh_sizes.end());
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+  m_refresh_sizes = sizes;
+
+  // 2. Candidates: every file of those sizes
+  const std::unordered_set<long long> wanted(sizes.begin(), sizes.end());
+  std::vector<FileInfo> candidates;
+  for (FileIndex::Id id : m_index.view(FileIndex::View::All)) {
+    const FileInfo &info = m_index.at(id);
+    if (!info.isDirectory() && wanted.count(info.getFileSize()) > 0) {
+      candidates.push_back(info);
+      candidates.back().setDigest(HashDigest());
+      candidates.back().setDuplicate(false);
+    }
+  }
+
+  // 3. Background search
+  auto pipeline = std::make_shared<HashPipeline>(*m_duplicate_hasher);
+  m_refresh_pipeline = pipeline;
+  m_refresh_runner.run(
+      [this, pipeline, candidates = std::move(candidates)](const StopToken &stop) mutable {
+        pipeline->setStopToken(stop);
+        DuplicateFinder::findDuplicates(candidates, *pipeline);
+
+        // 4. Merge on the UI thread
+        m_screen.Post([this, pipeline, candidates = std::move(candidates)]() {
+          if (pipeline != m_refresh_pipeline || pipeline->isCancelled()) {
+            return;
+          }
+          m_refresh_pipeline.reset();
+          m_refresh_sizes.clear();
+
+          for (const auto &candidate : candidates) {
+            FileIndex::Id id;
+            if (m_index.find(candidate.getPath(), id) &&
+                m_index.at(id).getFileSize() == candidate.getFileSize()) {
+              m_index.setDigest(id, candidate.isDuplicate() ? candidate.getDigest()
+                                                            : HashDigest());
+            }
+          }
+          if (m_current_filter_state != FilterState::DuplicatesOnly) {
+            return;
+          }
+
+          updateVirtualizedView();
+          m_current_status =
+              "Showing " +
+              std::to_string(m_index.view(FileIndex::View::Duplicates).size()) +
+              " duplicates (" + formatBytes(m_index.wastedSpace()) +
+              " wasted). Press 'c' to clear filter.";
+        });
+        m_redraw.requestRedraw();
+      });
+}
+
 // ============================================================================
 // VIRTUALIZATION
 // ============================================================================
@@ -305,23 +1016,31 @@ void FileManagerUI::updateUIAfterLoad() {
  * 3. Adjusts for boundaries (start >= 0, end <= total_items)
  * 4. Handles end-of-list case by shifting window backwards
  * 5. Sets m_virtual_offset to track window position
- * 6. Copies visible window subset to m_visible_files for rendering
+ * 6. Copies the labels of the visible window only (full path or display
+ *    name, see FileIndex::label()) into m_visible_files and records each
+ *    row's m_index entry in m_visible_indices
+ * 7. Points the menu selection at the selected row inside the window
  *
  * This ensures constant-time rendering regardless of total file count.
  *
  * @see VISIBLE_ITEMS
  * @see m_virtual_offset
  * @see m_visible_files
+ * @see m_visible_indices
  */
 void FileManagerUI::updateVirtualizedView() {
-  if (m_panel_files.empty()) {
+  const auto &ids = rows();
+  if (ids.empty()) {
     m_visible_files.clear();
+    m_visible_indices.clear();
     m_virtual_offset = 0;
+    m_menu_selected = 0;
     return;
   }
 
   // Calculate visible window
-  int total_items = m_panel_files.size();
+  int total_items = static_cast<int>(ids.size());
+  m_selected = std::clamp(m_selected, 0, total_items - 1);
 
   // Center selection in visible window
   int start = std::max(0, m_selected - VISIBLE_ITEMS / 2);
@@ -334,18 +1053,41 @@ void FileManagerUI::updateVirtualizedView() {
 
   m_virtual_offset = start;
 
-  // Copy visible items
-  m_visible_files.clear();
-  m_visible_files.reserve(end - start);
-  for (int i = start; i < end; ++i) {
-    m_visible_files.push_back(m_panel_files[i]);
+  // Labels of the visible items; the row strings keep their capacity, so
+  // moving the selection copies from m_index's label arena without
+  // allocating
+  const auto count = static_cast<std::size_t>(end - start);
+  m_visible_files.resize(count);
+  m_visible_indices.resize(count);
+  for (std::size_t row = 0; row < count; ++row) {
+    const FileIndex::Id id = ids[static_cast<std::size_t>(start) + row];
+    m_visible_files[row].assign(m_index.label(id, m_show_full_paths));
+    m_visible_indices[row] = id;
   }
+
+  m_menu_selected = m_selected - m_virtual_offset;
 }
 
 // ============================================================================
 // UI SETUP
 // ============================================================================
 
+/**
+ * @brief Lists directories from a scan snapshot
+ *
+ * Starts at the snapshot root unless the working directory is stored in it.
+ *
+ * @see loadSnapshotListing()
+ */
+void FileManagerUI::setSnapshot(std::shared_ptr<const ScanSnapshot> snapshot) {
+  m_snapshot = std::move(snapshot);
+  std::vector<FileInfo> listing;
+  if (m_snapshot && !m_snapshot->list(m_current_dir, true, listing)) {
+    m_current_dir = m_snapshot->root();
+    m_panel_path = m_current_dir;
+  }
+}
+
 /**
  * @brief Initializes the file manager UI components
  *
@@ -397,18 +1139,16 @@ void FileManagerUI::initialize() {
  */
 void FileManagerUI::setupFilePanels() {
   auto menu_option = MenuOption::Vertical();
+  // Selection and highlight follow the same (window-relative) row
+  menu_option.focused_entry = &m_menu_selected;
   menu_option.entries_option.transform = [this](EntryState state) {
+    // Row -> FileInfo in O(1); labels may repeat, indices do not
     const FileInfo *info = nullptr;
-
-    for (const auto &file_info : m_file_infos) {
-      std::string label_to_compare =
-          m_show_full_paths ? file_info.getPath() : file_info.getDisplayName();
-
-      if (label_to_compare == state.label) {
-        info = &file_info;
-        break;
-      }
-    }
+    bool marked = false;
+    if (const auto *id = safe_at(m_visible_indices, state.index)) {
+      info = m_index.contains(*id) ? &m_index.at(*id) : nullptr;
+      marked = m_marked.count(*id) > 0;
+    }
 
     auto name_element = text(state.label);
     Element size_element = text("");
@@ -433,6 +1173,17 @@ void FileManagerUI::setupFilePanels() {
 
       size_element =
           text(formatBytes(info->getFileSize())) | color(Color::GrayLight);
+      if (m_usage_tree && info->isDirectory() && !info->isParentDir()) {
+        // Cumulative size from the disk usage scan
+        size_element = text(formatBytes(usageSize(*info))) | color(Color::Cyan);
+      }
+      if (info->isVerified()) {
+        size_element = hbox({text("✓ ") | color(Color::Green), size_element});
+      }
+    }
+
+    if (marked) {
+      name_element = hbox({text("* ") | bold | color(Color::Magenta), name_element});
     }
 
     auto row = hbox({name_element | size(WIDTH, EQUAL, 60), filler(),
@@ -445,18 +1196,30 @@ void FileManagerUI::setupFilePanels() {
     return row;
   };
 
-  // Use m_visible_files!
-  m_menu = Menu(&m_visible_files, &m_selected, menu_option);
+  // Use m_visible_files! The menu works on window-relative rows.
+  auto menu = Menu(&m_visible_files, &m_menu_selected, menu_option);
 
-  m_menu = m_menu | CatchEvent([this](Event event) {
+  m_menu = menu | CatchEvent([this, menu](Event event) {
              bool needs_update = false;
 
-             if (event == Event::Return && !m_file_infos.empty()) {
-               if (auto *selected_info = safe_at(m_file_infos, m_selected)) {
-                 needs_update = handleFileSelection(*selected_info);
+             if (event == Event::Return && !m_index.empty()) {
+               if (auto *id = safe_at(rows(), m_selected)) {
+                 // Copy: the selection may reload the listing
+                 const FileInfo selected_info = m_index.at(*id);
+                 needs_update = handleFileSelection(selected_info);
                }
              } else if (event.is_character()) {
                needs_update = (event.character()[0]);
+             } else {
+               // Navigation: let the menu move its row, then translate the
+               // row back to an absolute index and re-center the window.
+               bool handled = menu->OnEvent(event);
+               const int row = m_virtual_offset + m_menu_selected;
+               if (safe_at(m_visible_indices, m_menu_selected) && row != m_selected) {
+                 m_selected = row;
+                 updateVirtualizedView();
+               }
+               return handled;
              }
 
              if (needs_update) {
@@ -474,13 +1237,14 @@ void FileManagerUI::setupFilePanels() {
  *
  * Constructs the main file panel renderer with two display modes:
  *
- * Loading State:
+ * Loading State (until the first streamed batch arrives):
  * - Shows animated spinner (10 frames cycling)
  * - Displays loading message and progress count
  * - Updates automatically via animation thread
  *
  * Normal State:
  * - Shows path with pagination info (e.g., "[2/5]" for large directories)
+ *   and the item count while a load is still streaming in
  * - Renders table header with "Name" (or "Full Path") and "Size" columns
  * - Displays menu with vertical scroll indicator
  * - Adapts height based on terminal size (minimum 5 lines)
@@ -497,12 +1261,13 @@ Component FileManagerUI::createPanelWithTable() {
     int terminal_height = Terminal::Size().dimy;
     int available_height = std::max(5, terminal_height - 9);
 
-    // LOADING STATE
-    if (m_loading) {
+    // LOADING STATE (until the first batch arrives)
+    if (m_loading && m_index.empty()) {
       static const std::vector<std::string> spinner = {"⠋", "⠙", "⠹", "⠸", "⠼",
                                                        "⠴", "⠦", "⠧", "⠇", "⠏"};
-      static size_t frame = 0;
-      frame = (frame + 1) % spinner.size();
+      // Phase from the clock, not the frame count: rate-limited redraws
+      // must not slow the spinner down (or speed it up)
+      const size_t frame = spinnerFrame() % spinner.size();
 
       return vbox({text(m_panel_path) | bold | color(Color::Green), separator(),
                    vbox({text("") | flex,
@@ -525,13 +1290,20 @@ Component FileManagerUI::createPanelWithTable() {
 
     // Show paging info if needed
     std::string path_display = m_panel_path;
-    if (m_file_infos.size() > VISIBLE_ITEMS) {
+    const std::size_t row_count = rows().size();
+    if (row_count > VISIBLE_ITEMS) {
       int current_page = m_selected / VISIBLE_ITEMS + 1;
-      int total_pages =
-          (m_file_infos.size() + VISIBLE_ITEMS - 1) / VISIBLE_ITEMS;
+      int total_pages = (row_count + VISIBLE_ITEMS - 1) / VISIBLE_ITEMS;
       path_display += " [" + std::to_string(current_page) + "/" +
                       std::to_string(total_pages) + "]";
     }
+    if (m_loading) {
+      path_display += " (loading, " + std::to_string(m_loaded_count.load()) +
+                      " items)";
+    }
+    if (m_current_filter_state == FilterState::NameMatches) {
+      path_display += "  /" + m_index.nameFilter() + (m_search_typing ? "_" : "");
+    }
 
     auto header = hbox({text(header_name) | bold | size(WIDTH, EQUAL, 60),
                         filler(), text("Size") | bold | align_right}) |
@@ -613,6 +1385,9 @@ bool FileManagerUI::handleFileSelection(const FileInfo &selected_info) {
  */
 void FileManagerUI::run() {
   auto global_handler = CatchEvent(m_document, [this](Event event) {
+    if (m_search_typing && handleSearchKey(event)) {
+      return true;
+    }
     if (event.is_character()) {
       return handleGlobalShortcut(event.character()[0]);
     }
@@ -687,46 +1462,42 @@ void FileManagerUI::setupTopMenu() {
  * 4. Status bar at bottom showing m_current_status
  *
  * Components are arranged in a vertical container that fills the terminal.
+ * Building the frame is timed as Stats::Timer::Frame (terminal output is
+ * not included), and the Stats overlay is drawn on top when enabled.
  *
  * @see m_document
+ * @see statsOverlay()
  * @see m_top_menu
  * @see m_main_view
  */
 void FileManagerUI::setupMainLayout() {
-  m_document =
+  auto layout =
       Container::Vertical({m_top_menu, Renderer([] { return separator(); }),
                            m_main_view | flex, Renderer([this] {
                              return text("STATUS: " + m_current_status) |
                                     color(Color::GrayLight) | hcenter;
                            })});
+
+  m_document = Renderer(layout, [this, layout] {
+    TMF_STATS_TIMER(Frame);
+    Element frame = layout->Render();
+    if (!m_show_stats) {
+      return frame;
+    }
+    return dbox({frame, statsOverlay() | clear_under | center});
+  });
 }
 
-/**
- * @brief Updates menu string representations from FileInfo objects
- *
- * Converts a vector of FileInfo objects to formatted strings for display
- * in menus and lists. Clears the target vector and repopulates it with
- * either full paths or display names depending on m_show_full_paths flag.
- *
- * @param infos Source vector of FileInfo objects to convert
- * @param target Target vector to fill with formatted strings (cleared first)
- *
- * @see FileInfo::getPath()
- * @see FileInfo::getDisplayName()
- * @see m_show_full_paths
- */
-void FileManagerUI::updateMenuStrings(const std::vector<FileInfo> &infos,
-                                      std::vector<std::string> &target) {
-  target.clear();
-  target.reserve(infos.size());
-
-  for (const auto &info : infos) {
-    if (m_show_full_paths) {
-      target.push_back(info.getPath()); // fullPath
-    } else {
-      target.push_back(info.getDisplayName()); // file name
+Element FileManagerUI::statsOverlay() const {
+  Elements lines;
+  if (Stats::ENABLED) {
+    for (const auto &line : Stats::global().snapshot().lines()) {
+      lines.push_back(text(line));
     }
+  } else {
+    lines.push_back(text("Built without ENABLE_STATS."));
   }
+  return window(text(" Stats (s to close) "), vbox(std::move(lines)));
 }
 
 /**
@@ -767,21 +1538,21 @@ ActionID FileManagerUI::getActionIdByIndex(int index) {
  * - 'd': Show/toggle duplicate files filter
  * - 'c': Clear active filter
  * - '0': Show/toggle zero-byte files filter
- * - 'D': Delete marked/selected file with safety checks
+ * - 'D': Delete marked entries (or the selected one) with safety checks
+ * - 'm': Mark/unmark the selected entry
+ * - 'M': Mark all but one file of every duplicate group (or clear marks)
+ * - 's': Show/hide the Stats overlay
+ * - 'v': Verify the found duplicates byte for byte
+ * - 'l': Link verified duplicate copies to one kept file
+ * - 'u': Show/close cumulative directory sizes (disk usage)
  *
- * For delete operations:
- * 1. Validates file selection
- * 2. Shows confirmation dialog with FileSafety checks
- * 3. Calls deleteFile() or deleteDirectory() based on type
- * 4. Refreshes directory asynchronously on success
+ * Delete operations run through deleteMarked().
  *
  * @param key_pressed The character key that was pressed
  * @return true if the shortcut was recognized and handled, false otherwise
  *
  * @see ActionMap
- * @see showDeleteConfirmation()
- * @see deleteFile()
- * @see deleteDirectory()
+ * @see deleteMarked()
  */
 bool FileManagerUI::handleGlobalShortcut(char key_pressed) {
   for (const auto &pair : ActionMap) {
@@ -804,37 +1575,48 @@ bool FileManagerUI::handleGlobalShortcut(char key_pressed) {
         showZeroByteFiles();
         return true;
 
-      // ========================================
-      // DELETE FUNCTION
-      // ========================================
-      case ActionID::DeleteMarkedFiles: { // ← This is where the case begins
-        if (m_file_infos.empty() || m_selected < 0 ||
-            m_selected >= static_cast<int>(m_file_infos.size())) {
-          m_current_status = "No file selected.";
-          return true;
-        }
+      case ActionID::ToggleStats:
+        m_show_stats = !m_show_stats;
+        return true;
 
-        const FileInfo &selected = m_file_infos[m_selected];
+      case ActionID::VerifyDuplicates:
+        verifyDuplicates();
+        return true;
 
-        if (showDeleteConfirmation(selected)) {
-          bool success;
+      case ActionID::ConsolidateDuplicates:
+        consolidateDuplicates();
+        return true;
 
-          if (selected.isDirectory()) {
-            success = deleteDirectory(selected, true);
-          } else {
-            success = deleteFile(selected);
-          }
+      case ActionID::DiskUsage:
+        toggleDiskUsage();
+        return true;
 
-          if (success) {
-            // Async refresh (instead of blocking!)
-            loadDirectoryAsync(m_panel_path);
-          }
+      case ActionID::AddRoot:
+        addRoot();
+        return true;
 
-        } else {
-          m_current_status = "Delete cancelled.";
-        }
+      case ActionID::CrossRootDuplicates:
+        toggleCrossRootDuplicates();
+        return true;
+
+      case ActionID::SearchNames:
+        startNameSearch();
+        return true;
+
+      // ========================================
+      // DELETE FUNCTION
+      // ========================================
+      case ActionID::DeleteMarkedFiles:
+        deleteMarked();
+        return true;
+
+      case ActionID::ToggleMark:
+        toggleMark();
+        return true;
+
+      case ActionID::MarkDuplicateCopies:
+        markDuplicateCopies();
         return true;
-      } // ← This is where the case ends.
 
       default:
         m_current_status = "Global shortcut: '" + std::string(1, key_pressed) +
@@ -851,123 +1633,216 @@ bool FileManagerUI::handleGlobalShortcut(char key_pressed) {
 // ============================================================================
 
 /**
- * @brief Deletes a regular file from the filesystem
+ * @brief Marks or unmarks the selected entry
  *
- * Attempts to delete the file at the path specified in the FileInfo object.
- * Updates the status bar with success or error message.
- *
- * @param file The FileInfo object representing the file to delete
- * @return true if deletion succeeded, false if an error occurred
+ * The parent entry ("..") cannot be marked. Marks belong to the listing
+ * and are cleared when another directory is loaded.
+ */
+void FileManagerUI::toggleMark() {
+  const auto *selected_id = safe_at(rows(), m_selected);
+  if (!selected_id || m_index.at(*selected_id).isParentDir()) {
+    m_current_status = "No file selected.";
+    return;
+  }
+
+  if (!m_marked.erase(*selected_id)) {
+    m_marked.insert(*selected_id);
+  }
+  m_current_status = std::to_string(m_marked.size()) + " marked. Press 'D' to delete.";
+}
+
+/**
+ * @brief Marks every duplicate except the first of its group
  *
- * @note Does not perform safety checks - caller must call
- * showDeleteConfirmation() first
- * @see showDeleteConfirmation()
- * @see FileSafety
+ * "First" is the first in listing order, so the kept copy is predictable.
+ * Needs the groups of a duplicate search; clears all marks if any are set.
  */
-bool FileManagerUI::deleteFile(const FileInfo &file) {
-  try {
-    std::filesystem::remove(file.getPath());
-    m_current_status = "✓ Deleted: " + file.getPath();
-    return true;
-  } catch (const std::filesystem::filesystem_error &e) {
-    m_current_status = "✗ Error deleting file: " + std::string(e.what());
-    return false;
+void FileManagerUI::markDuplicateCopies() {
+  if (!m_marked.empty()) {
+    m_marked.clear();
+    m_current_status = "Marks cleared.";
+    return;
   }
+  if (!m_index.duplicatesKnown()) {
+    m_current_status = "Search duplicates first ('d').";
+    return;
+  }
+
+  std::unordered_set<HashDigest, HashDigestHasher> kept;
+  for (FileIndex::Id id : m_index.view(FileIndex::View::Duplicates)) {
+    if (!kept.insert(m_index.at(id).getDigest()).second) {
+      m_marked.insert(id);
+    }
+  }
+  m_current_status = "Marked " + std::to_string(m_marked.size()) +
+                     " copies, one file of every group kept. Press 'D' to delete.";
 }
 
 /**
- * @brief Deletes a directory from the filesystem
- *
- * Deletes the directory specified in the FileInfo object. Can operate in
- * two modes:
- *
- * Recursive mode (recursive=true):
- * - Counts total items in directory tree
- * - Shows progress in status bar
- * - Uses std::filesystem::remove_all() to delete all contents
- * - Displays total deleted item count on success
- *
- * Non-recursive mode (recursive=false):
- * - Only deletes empty directories
- * - Uses std::filesystem::remove()
- * - Fails if directory is not empty
- *
- * @param dir The FileInfo object representing the directory to delete
- * @param recursive If true, recursively delete all contents; if false, only
- * delete if empty
- * @return true if deletion succeeded, false if an error occurred
- *
- * @note Does not perform safety checks - caller must call
- * showDeleteConfirmation() first
- * @see showDeleteConfirmation()
- * @see FileSafety
+ * @brief Deletes the marked entries (or the selected one) in background
+ *
+ * Implementation details:
+ * 1. Batch: all marked entries, or the selected entry if none is marked
+ * 2. Safety pass on m_delete_runner: one FileSafety evaluation over the
+ *    batch with a shared mount snapshot (DeletionEngine::plan())
+ * 3. The plan is posted back and confirmed by showDeleteConfirmation()
+ * 4. runDeletion() deletes in parallel; applyDeletionReport() patches
+ *    the model (no rescan)
+ *
+ * @see DeletionEngine
  */
-bool FileManagerUI::deleteDirectory(const FileInfo &dir, bool recursive) {
-  try {
-    if (recursive) {
-      // Count items
-      uintmax_t total = 0;
-      for (const auto &entry :
-           std::filesystem::recursive_directory_iterator(dir.getPath())) {
-        total++;
-      }
+void FileManagerUI::deleteMarked() {
+  if (m_deleting) {
+    m_current_status = "A deletion is still running.";
+    return;
+  }
+  if (m_consolidating) {
+    m_current_status = "A consolidation is still running.";
+    return;
+  }
 
-      // Update status during deletion (simplified)
-      m_current_status = "Deleting " + std::to_string(total) + " items...";
+  // 1. Batch (copies: the model may change meanwhile)
+  std::vector<FileInfo> batch;
+  if (m_marked.empty()) {
+    const auto *selected_id = safe_at(rows(), m_selected);
+    if (!selected_id) {
+      m_current_status = "No file selected.";
+      return;
+    }
+    batch.push_back(m_index.at(*selected_id));
+  } else {
+    batch.reserve(m_marked.size());
+    for (FileIndex::Id id : m_index.view(FileIndex::View::All)) {
+      if (m_marked.count(id) > 0) {
+        batch.push_back(m_index.at(id));
+      }
+    }
+  }
 
-      std::filesystem::remove_all(dir.getPath());
-      m_current_status = "✓ Deleted directory (recursive, " +
-                         std::to_string(total) + " items): " + dir.getPath();
-    } else {
-      std::filesystem::remove(dir.getPath());
-      m_current_status = "✓ Deleted empty directory: " + dir.getPath();
+  // 2. Safety pass
+  m_deleting = true;
+  m_current_status = "Checking " + std::to_string(batch.size()) + " entries...";
+  m_delete_runner.run([this, batch = std::move(batch)](const StopToken &stop) {
+    auto plan = DeletionEngine::plan(batch);
+    if (stop.stopRequested()) {
+      return;
     }
-    return true;
-  } catch (const std::filesystem::filesystem_error &e) {
-    m_current_status = "✗ Error: " + std::string(e.what());
-    return false;
+
+    // 3. Confirmation on the UI thread
+    m_screen.Post([this, plan = std::move(plan)]() mutable {
+      if (showDeleteConfirmation(plan)) {
+        runDeletion(std::move(plan));
+        return;
+      }
+      m_deleting = false;
+      if (!plan.targets.empty()) {
+        m_current_status = "Delete cancelled.";
+      }
+    });
+    m_redraw.requestRedraw();
+  });
+}
+
+/**
+ * @brief Deletes a confirmed plan on m_delete_runner
+ *
+ * Progress (entries done and removed) is posted to the status line.
+ *
+ * @see DeletionEngine::run()
+ */
+void FileManagerUI::runDeletion(DeletionEngine::Plan plan) {
+  m_current_status = "Deleting " + std::to_string(plan.targets.size()) + " entries...";
+  m_delete_runner.run([this, plan = std::move(plan)](const StopToken &stop) {
+    DeletionEngine engine;
+    engine.setStopToken(stop);
+    engine.setProgressCallback([this](const DeletionEngine::Progress &progress) {
+      std::string text = "Deleting " + std::to_string(progress.targets_done) + "/" +
+                         std::to_string(progress.targets_total) + " entries (" +
+                         std::to_string(progress.items_removed) + " removed)...";
+      m_screen.Post([this, text]() {
+        if (m_deleting) {
+          m_current_status = text;
+        }
+      });
+      m_redraw.requestRedraw();
+    });
+
+    auto report = engine.run(plan);
+    m_screen.Post([this, report = std::move(report)]() { applyDeletionReport(report); });
+    m_redraw.requestRedraw();
+  });
+}
+
+/**
+ * @brief Applies a finished deletion (UI thread only)
+ *
+ * Deleted paths are removed from the model right away (the same change
+ * reported later by the watcher is then a no-op), so nothing is rescanned.
+ *
+ * @see applyWatchEvents()
+ */
+void FileManagerUI::applyDeletionReport(const DeletionEngine::Report &report) {
+  m_deleting = false;
+
+  std::vector<DirectoryWatcher::Event> deleted;
+  deleted.reserve(report.deleted.size());
+  for (const auto &path : report.deleted) {
+    deleted.push_back({DirectoryWatcher::Event::Type::Deleted, path});
+  }
+  m_marked.clear();
+  if (!deleted.empty()) {
+    applyWatchEvents(std::move(deleted));
+  }
+
+  m_current_status = "✓ Deleted " + std::to_string(report.deleted.size()) + " entries (" +
+                     std::to_string(report.items_removed) + " items)";
+  if (!report.failed.empty()) {
+    m_current_status = "✗ Deleted " + std::to_string(report.deleted.size()) + ", " +
+                       std::to_string(report.failed.size()) +
+                       " failed: " + report.failed.front().path + ": " +
+                       report.failed.front().message;
+  } else if (report.stopped) {
+    m_current_status += ", stopped";
   }
+  m_current_status += ".";
+  m_redraw.requestRedraw();
 }
 
 /**
- * @brief Displays confirmation dialog before file deletion
+ * @brief Displays confirmation dialog before deletion
  *
- * Shows an interactive confirmation dialog with safety checks before allowing
- * file deletion. The dialog includes:
+ * Shows an interactive confirmation dialog for the result of the safety
+ * pass (DeletionEngine::plan()); FileSafety is not consulted again.
  *
  * Safety checks:
- * 1. Uses FileSafety::checkDeletion() to validate path
- * 2. Blocks deletion if status is not Allowed or WarningRemovableMedia
+ * 1. If every entry was blocked, shows the first reason in the status bar
+ * 2. Blocked entries of a larger batch are listed as skipped
  * 3. Shows special warning for removable media
  *
  * Dialog contents:
- * - Warning text (red): "DELETE FILE?" or "DELETE DIRECTORY? (RECURSIVE)"
- * - File path (yellow)
- * - File size
- * - Removable media warning (magenta) if applicable
+ * - Warning text (red): "DELETE FILE?", "DELETE DIRECTORY? (RECURSIVE)" or
+ *   "DELETE N ENTRIES?"
+ * - Path (single entry) or entry count (yellow)
+ * - Size of the files
+ * - Skipped entries and removable media warning (magenta) if applicable
  * - Instructions: 'y' to confirm, 'n' or ESC to cancel
  *
  * User input handling:
  * - 'y'/'Y': Confirms deletion
  * - 'n'/'N'/ESC: Cancels deletion
  *
- * @param file The FileInfo object for the file to be deleted
- * @return true if user confirmed deletion and safety checks passed, false
+ * @param plan Result of the safety pass
+ * @return true if user confirmed deletion and some entry is allowed, false
  * otherwise
  *
- * @see FileSafety::checkDeletion()
+ * @see DeletionEngine::plan()
  * @see FileSafety::getStatusMessage()
- * @see deleteFile()
- * @see deleteDirectory()
  */
-bool FileManagerUI::showDeleteConfirmation(const FileInfo &file) {
-  // Safety check via FileSafety class
-  auto status = FileSafety::checkDeletion(file.getPath());
-
-  // Block if not allowed
-  if (status != FileSafety::DeletionStatus::Allowed &&
-      status != FileSafety::DeletionStatus::WarningRemovableMedia) {
-    m_current_status = FileSafety::getStatusMessage(status, file.getPath());
+bool FileManagerUI::showDeleteConfirmation(const DeletionEngine::Plan &plan) {
+  // Block if nothing is allowed
+  if (plan.targets.empty()) {
+    m_current_status = plan.blocked.empty() ? "No file selected."
+                                            : plan.blocked.front().message;
     return false;
   }
 
@@ -977,17 +1852,35 @@ bool FileManagerUI::showDeleteConfirmation(const FileInfo &file) {
   auto dialog_screen = ScreenInteractive::TerminalOutput();
 
   // Extra warning for removable media
-  bool is_removable =
-      (status == FileSafety::DeletionStatus::WarningRemovableMedia);
+  bool is_removable = plan.removable_media;
+
+  // Scanners flag symlinks to directories as directories; only the link goes
+  std::error_code link_ec;
+  const bool is_link = plan.targets.size() == 1 && plan.targets.front().isDirectory() &&
+                       std::filesystem::is_symlink(plan.targets.front().getPath(), link_ec);
 
   auto dialog_renderer = Renderer([&] {
+    const bool single = plan.targets.size() == 1;
+    const FileInfo &file = plan.targets.front();
     std::string warning =
-        file.isDirectory() ? "DELETE DIRECTORY? (RECURSIVE)" : "DELETE FILE?";
+        !single ? "DELETE " + std::to_string(plan.targets.size()) + " ENTRIES?"
+        : is_link ? "DELETE LINK? (TARGET IS KEPT)"
+        : file.isDirectory() ? "DELETE DIRECTORY? (RECURSIVE)"
+                             : "DELETE FILE?";
 
     std::vector<Element> content = {
         text(warning) | bold | color(Color::Red) | hcenter, separator(),
-        text("Path: " + file.getPath()) | color(Color::Yellow),
-        text("Size: " + formatBytes(file.getFileSize()))};
+        text(single ? "Path: " + file.getPath()
+                    : std::to_string(plan.targets.size()) + " entries") |
+            color(Color::Yellow),
+        text("Size: " + formatBytes(plan.bytes))};
+
+    if (!plan.blocked.empty()) {
+      content.push_back(separator());
+      content.push_back(text(std::to_string(plan.blocked.size()) +
+                             " entries skipped: " + plan.blocked.front().message) |
+                        color(Color::Magenta));
+    }
 
     if (is_removable) {
       content.push_back(separator());
@@ -1031,64 +1924,683 @@ bool FileManagerUI::showDeleteConfirmation(const FileInfo &file) {
 }
 
 // ============================================================================
-// ANIMATION THREAD
+// CONSOLIDATION
+// ============================================================================
+
+/**
+ * @brief Links verified duplicate copies to one kept file in background
+ *
+ * Implementation details:
+ * 1. Needs byte-for-byte verified duplicates ('v'); unverified ones are
+ *    never touched
+ * 2. Copies them in listing order, so the first of every group is kept
+ *    (the same file 'M' keeps)
+ * 3. Confirmation dialog with the number of copies and their size
+ * 4. Consolidator::run() on m_delete_runner, progress in the status line
+ * 5. applyConsolidationReport() shows the result. The watcher re-lists
+ *    the replaced files; they keep their group and Verified mark through
+ *    m_carried_digests instead of being searched again
+ *
+ * @see Consolidator
+ */
+void FileManagerUI::consolidateDuplicates() {
+  if (m_consolidating) {
+    m_current_status = "A consolidation is still running.";
+    return;
+  }
+  if (m_deleting) {
+    m_current_status = "A deletion is still running.";
+    return;
+  }
+
+  // 1. + 2. Verified duplicates, grouped by digest in listing order
+  std::vector<FileInfo> files;
+  std::map<HashDigest, std::size_t> group_sizes;
+  for (FileIndex::Id id : m_index.view(FileIndex::View::Duplicates)) {
+    const FileInfo &file = m_index.at(id);
+    if (file.isVerified()) {
+      files.push_back(file);
+      ++group_sizes[file.getDigest()];
+    }
+  }
+  if (files.empty()) {
+    m_current_status = "Verify duplicates first ('v').";
+    return;
+  }
+
+  std::size_t copies = 0;
+  long long bytes = 0;
+  std::unordered_set<HashDigest, HashDigestHasher> kept;
+  for (const auto &file : files) {
+    if (group_sizes[file.getDigest()] > 1 && !kept.insert(file.getDigest()).second) {
+      ++copies;
+      bytes += file.getFileSize();
+    }
+  }
+  if (copies == 0) {
+    m_current_status = "No verified copies to link.";
+    return;
+  }
+
+  // 3. Confirmation
+  if (!showConsolidateConfirmation(copies, bytes)) {
+    m_current_status = "Consolidation cancelled.";
+    return;
+  }
+
+  // 4. Consolidate
+  m_consolidating = true;
+  m_current_status = "Linking " + std::to_string(copies) + " copies...";
+  m_delete_runner.run([this, files = std::move(files)](const StopToken &stop) mutable {
+    std::map<HashDigest, DuplicateFinder::DuplicateGroup> by_digest;
+    std::vector<HashDigest> order;
+    for (auto &file : files) {
+      auto &group = by_digest[file.getDigest()];
+      if (group.files.empty()) {
+        order.push_back(file.getDigest());
+      }
+      group.files.push_back(&file);
+    }
+    std::vector<DuplicateFinder::DuplicateGroup> groups;
+    groups.reserve(order.size());
+    for (const auto &digest : order) {
+      auto &group = by_digest[digest];
+      if (group.files.size() > 1) {
+        group.hash = digest.toHex();
+        group.verified = true;
+        groups.push_back(std::move(group));
+      }
+    }
+
+    Consolidator consolidator(Consolidator::Method::Auto);
+    consolidator.setStopToken(stop);
+    consolidator.setProgressCallback([this](const Consolidator::Progress &progress) {
+      std::string text = "Linking copies: " + std::to_string(progress.groups_done) + "/" +
+                         std::to_string(progress.groups_total) + " groups (" +
+                         std::to_string(progress.files_replaced) + " replaced)...";
+      m_screen.Post([this, text]() {
+        if (m_consolidating) {
+          m_current_status = text;
+        }
+      });
+      m_redraw.requestRedraw();
+    });
+
+    auto report = consolidator.run(groups);
+
+    // 5. Result on the UI thread, with the state the replaced copies carry
+    std::unordered_map<std::string, HashDigest> digests;
+    for (const auto &file : files) {
+      digests.emplace(file.getPath(), file.getDigest());
+    }
+    std::unordered_map<std::string, CarriedDigest> carried;
+    for (const auto &path : report.replaced) {
+      struct stat st;
+      if (::stat(path.c_str(), &st) == 0) {
+        carried[path] = {digests[path], static_cast<long long>(st.st_size),
+                         static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                             st.st_mtim.tv_nsec};
+      }
+    }
+    m_screen.Post([this, report = std::move(report), carried = std::move(carried)]() mutable {
+      applyConsolidationReport(report, std::move(carried));
+    });
+    m_redraw.requestRedraw();
+  });
+}
+
+/**
+ * @brief Applies a finished consolidation (UI thread only)
+ *
+ * Paths are unchanged, so the listing needs no patching; the renames
+ * reach the model through the directory watcher. Their events may come
+ * before or after this report: copies already re-listed get their group
+ * back here, the others in applyWatchEvents().
+ */
+void FileManagerUI::applyConsolidationReport(
+    const Consolidator::Report &report, std::unordered_map<std::string, CarriedDigest> carried) {
+  m_consolidating = false;
+
+  for (auto &[path, state] : carried) {
+    m_carried_digests[path] = state;
+    FileIndex::Id id;
+    if (m_index.find(path, id) && m_index.at(id).getDigest().empty()) {
+      restoreCarriedDigest(path);
+    }
+  }
+
+  std::string linked = std::to_string(report.hardlinked) + " hardlinked";
+  if (report.reflinked > 0) {
+    linked += ", " + std::to_string(report.reflinked) + " reflinked";
+  }
+  m_current_status = "✓ Linked " + std::to_string(report.replaced.size()) + " copies (" +
+                     linked + "), " + formatBytes(report.reclaimed) + " reclaimed";
+  if (!report.failed.empty()) {
+    m_current_status = "✗ Linked " + std::to_string(report.replaced.size()) + ", " +
+                       std::to_string(report.failed.size()) +
+                       " failed: " + report.failed.front().path + ": " +
+                       report.failed.front().message;
+  } else if (report.stopped) {
+    m_current_status += ", stopped";
+  }
+  m_current_status += ".";
+  m_redraw.requestRedraw();
+}
+
+/**
+ * @brief Matches the entry against the state recorded after the rename
+ *
+ * A size or mtime other than right after the replacement means the file
+ * changed since; its record is dropped and the usual re-check applies.
+ */
+bool FileManagerUI::restoreCarriedDigest(const std::string &path) {
+  auto it = m_carried_digests.find(path);
+  FileIndex::Id id;
+  if (it == m_carried_digests.end() || !m_index.find(path, id)) {
+    return false;
+  }
+  const FileInfo &info = m_index.at(id);
+  if (info.getFileSize() != it->second.size || info.getModifiedTime() != it->second.mtime_ns) {
+    m_carried_digests.erase(it);
+    return false;
+  }
+  m_index.setDigest(id, it->second.digest);
+  m_index.setVerified(id, true);
+  return true;
+}
+
+/**
+ * @brief Displays confirmation dialog before consolidation
+ *
+ * User input handling:
+ * - 'y'/'Y': Confirms
+ * - 'n'/'N'/ESC: Cancels
+ *
+ * @param copies Files about to be replaced
+ * @param bytes Their total size
+ * @return true if user confirmed
+ */
+bool FileManagerUI::showConsolidateConfirmation(std::size_t copies, long long bytes) {
+  m_dialog_active = true;
+  bool confirmed = false;
+  auto dialog_screen = ScreenInteractive::TerminalOutput();
+
+  auto dialog_renderer = Renderer([&] {
+    return vbox({text("LINK " + std::to_string(copies) + " COPIES?") | bold |
+                     color(Color::Yellow) | hcenter,
+                 separator(),
+                 text("Size: " + formatBytes(bytes)),
+                 text("Every path stays; copies share the kept file's storage.") |
+                     color(Color::GrayLight),
+                 text("Hardlinked copies also share owner, mode and later edits.") |
+                     color(Color::Magenta),
+                 separator(),
+                 text("") | size(HEIGHT, EQUAL, 1),
+                 hbox({text("Press ") | color(Color::GrayLight),
+                       text("'y'") | bold | color(Color::Green),
+                       text(" to confirm, ") | color(Color::GrayLight),
+                       text("'n'") | bold | color(Color::Red),
+                       text(" or ") | color(Color::GrayLight), text("ESC") | bold,
+                       text(" to cancel") | color(Color::GrayLight)}) |
+                     hcenter}) |
+           border | center;
+  });
+
+  auto dialog_handler = CatchEvent(dialog_renderer, [&](Event event) {
+    if (event == Event::Character('y') || event == Event::Character('Y')) {
+      confirmed = true;
+      dialog_screen.Exit();
+      return true;
+    }
+    if (event == Event::Character('n') || event == Event::Character('N') ||
+        event == Event::Escape) {
+      dialog_screen.Exit();
+      return true;
+    }
+    return false;
+  });
+
+  dialog_screen.Loop(dialog_handler);
+  m_dialog_active = false;
+
+  return confirmed;
+}
+
+// ============================================================================
+// DISK USAGE
 // ============================================================================
 
+namespace {
+
+/** @brief Directory path as DirectoryTree stores it (no trailing slash) */
+std::string treePath(std::string path) {
+  while (path.size() > 1 && path.back() == '/') {
+    path.pop_back();
+  }
+  return path;
+}
+
+} // namespace
+
 /**
- * @brief Starts the animation thread for visual feedback
+ * @brief Starts, cancels or ends the disk usage view
  *
- * Launches a background thread that continuously requests UI animation frames
- * to keep the display updated during long-running operations (like directory
- * loading with spinner animation).
+ * Implementation flow:
+ * 1. A running scan is cancelled (new m_usage_generation); a shown tree
+ *    is dropped and the listing sorted by name again
+ * 2. Otherwise the listed directory is scanned recursively with all
+ *    cores on m_usage_runner. Every batch is counted into the tree right
+ *    away; only the non-empty files are kept for step 4
+ * 3. The rolled-up tree is posted to applyUsageTree() and shown
+ * 4. The kept files run through the staged duplicate search (sizes
+ *    first, digests from m_hash_cache where possible); a copy of the
+ *    tree with the duplicate bytes replaces the shown one
+ *
+ * Sizes are those of the scan; files changed later are not followed.
+ *
+ * @see DirectoryTree
+ * @see applyUsageTree()
+ */
+void FileManagerUI::toggleDiskUsage() {
+  // 1. Cancel, or end the view
+  if (m_usage_scanning) {
+    ++m_usage_generation;
+    m_usage_runner.cancel();
+    m_usage_scanning = false;
+    m_current_status = m_usage_tree ? "Duplicate pass of the disk usage scan cancelled."
+                                    : "Disk usage scan cancelled.";
+    return;
+  }
+  if (m_usage_tree) {
+    m_usage_tree.reset();
+    sortListing();
+    m_current_status = "Disk usage view closed.";
+    return;
+  }
+
+  if (!m_hash_cache && !m_duplicate_hasher) {
+    m_hash_cache = HashCache::openDefault();
+  }
+  std::shared_ptr<IHashCalculator> hasher =
+      createHashCalculator(HashAlgorithm::FNV1A, m_hash_cache);
+
+  m_usage_scanning = true;
+  const unsigned generation = ++m_usage_generation;
+  const std::string root = treePath(m_panel_path);
+  m_current_status = "Scanning " + root + " for disk usage... Press 'u' to cancel.";
+
+  // 2. Walk and aggregate
+  m_usage_runner.run([this, root, generation, hasher](const StopToken &stop) {
+    auto post_status = [this, generation](std::string text) {
+      m_screen.Post([this, generation, text = std::move(text)]() {
+        if (m_usage_generation == generation) {
+          m_current_status = text;
+        }
+      });
+      m_redraw.requestRedraw();
+    };
+
+    FileScanner scanner;
+    scanner.setThreadCount(0);
+    scanner.setStopToken(stop);
+
+    auto tree = std::make_shared<DirectoryTree>(root);
+    std::vector<FileInfo> files;
+    auto last_progress = std::chrono::steady_clock::now();
+    scanner.scanDirectoryStreaming(
+        root, true, false,
+        [&](std::vector<FileInfo> &&batch) {
+          tree->add(batch);
+          for (auto &info : batch) {
+            if (!info.isDirectory() && info.getFileSize() > 0) {
+              files.push_back(std::move(info));
+            }
+          }
+          return !stop.stopRequested();
+        },
+        [&](int count) {
+          const auto now = std::chrono::steady_clock::now();
+          if (now - last_progress >= HashPipeline::PROGRESS_INTERVAL) {
+            last_progress = now;
+            post_status("Disk usage: " + std::to_string(count) +
+                        " entries scanned. Press 'u' to cancel.");
+          }
+        });
+    if (stop.stopRequested()) {
+      return;
+    }
+
+    // 3. Sizes first
+    tree->rollUp();
+    m_screen.Post([this, generation, tree]() { applyUsageTree(generation, tree, false); });
+    m_redraw.requestRedraw();
+
+    // 4. Duplicate bytes
+    HashPipeline pipeline(*hasher);
+    pipeline.setStopToken(stop);
+    pipeline.setProgressCallback([&](const HashPipeline::Progress &progress) {
+      post_status("Disk usage: hashing " + std::to_string(progress.files_done) + "/" +
+                  std::to_string(progress.files_total) +
+                  " files for duplicates. Press 'u' to stop.");
+    });
+    DuplicateFinder::findDuplicates(files, pipeline);
+    if (pipeline.isCancelled()) {
+      return;
+    }
+    if (m_hash_cache) {
+      m_hash_cache->flush();
+    }
+
+    auto complete = std::make_shared<DirectoryTree>(*tree);
+    complete->setDuplicates(files);
+    complete->rollUp();
+    m_screen.Post([this, generation, complete]() { applyUsageTree(generation, complete, true); });
+    m_redraw.requestRedraw();
+  });
+}
+
+/**
+ * @brief Shows a usage tree and sorts the listing by cumulative size
  *
- * The thread runs a tight loop that:
- * 1. Sleeps for 10ms between frames (~100 FPS)
- * 2. Requests animation frame from FTXUI screen
- * 3. Continues until m_animating flag is set to false
+ * Trees of a cancelled or superseded scan are discarded.
+ *
+ * @see toggleDiskUsage()
+ */
+void FileManagerUI::applyUsageTree(unsigned generation,
+                                   std::shared_ptr<const DirectoryTree> tree, bool complete) {
+  if (generation != m_usage_generation) {
+    return;
+  }
+  m_usage_tree = std::move(tree);
+  if (complete) {
+    m_usage_scanning = false;
+  }
+  sortListing();
+  m_current_status = usageSummary();
+  if (!complete) {
+    m_current_status += " Searching duplicates...";
+  }
+  m_redraw.requestRedraw();
+}
+
+long long FileManagerUI::usageSize(const FileInfo &info) const {
+  if (!info.isDirectory()) {
+    return info.getAllocatedSize();
+  }
+  DirectoryTree::NodeId id;
+  if (m_usage_tree && m_usage_tree->find(info.getPath(), id)) {
+    return m_usage_tree->node(id).total.bytes;
+  }
+  return 0;
+}
+
+std::string FileManagerUI::usageSummary() const {
+  if (!m_usage_tree) {
+    return "";
+  }
+  DirectoryTree::NodeId id;
+  if (!m_usage_tree->find(treePath(m_panel_path), id)) {
+    return "Disk usage: outside of the scanned " +
+           m_usage_tree->node(m_usage_tree->root()).path + ".";
+  }
+
+  const auto &total = m_usage_tree->node(id).total;
+  std::string summary = "Disk usage: " + formatBytes(total.bytes) + " in " +
+                        std::to_string(total.files) + " files, " +
+                        std::to_string(total.directories) + " directories";
+  if (total.zero_files > 0) {
+    summary += ", " + std::to_string(total.zero_files) + " empty";
+  }
+  if (total.duplicate_bytes > 0) {
+    summary += ", " + formatBytes(total.duplicate_bytes) + " in duplicates";
+  }
+  return summary + ".";
+}
+
+/**
+ * @brief Sorts the listing and moves the selection along
  *
- * If animation is already running, this function returns immediately without
- * starting a new thread.
+ * The entry selected before stays selected, unless the first row was
+ * (then the first row stays selected).
+ */
+void FileManagerUI::sortListing() {
+  const auto *selected = m_selected > 0 ? safe_at(rows(), m_selected) : nullptr;
+  const bool keep_selection = selected != nullptr;
+  const FileIndex::Id selected_id = keep_selection ? *selected : 0;
+
+  if (m_usage_tree) {
+    m_index.sortBySize([this](const FileInfo &info) { return usageSize(info); });
+  } else {
+    m_index.sort(true);
+  }
+
+  m_selected = 0;
+  if (keep_selection) {
+    selectEntry(selected_id);
+  }
+  updateVirtualizedView();
+  m_redraw.requestRedraw();
+}
+
+// ============================================================================
+// CROSS-ROOT DUPLICATES
+// ============================================================================
+
+void FileManagerUI::addRoot() {
+  const std::string path = treePath(m_panel_path);
+  switch (m_roots.addRoot(path)) {
+  case MultiRootScanner::AddResult::Added:
+    m_current_status = "Root added: " + path + " (" + std::to_string(m_roots.roots().size()) +
+                       " roots). Press 'x' for duplicates across roots.";
+    break;
+  case MultiRootScanner::AddResult::Covered:
+    m_current_status = path + " is already covered by a root.";
+    break;
+  case MultiRootScanner::AddResult::Invalid:
+    m_current_status = "Cannot add " + path + " as a root.";
+    break;
+  }
+}
+
+/**
+ * @brief Starts, cancels or ends the cross-root duplicate view
  *
- * @see stopAnimation()
- * @see m_animating
- * @see m_animation_thread
- * @see loadDirectoryAsync()
+ * Implementation flow:
+ * 1. A running search is cancelled (new m_cross_root_generation); a
+ *    shown view returns to the listed directory
+ * 2. The listed directory joins a copy of m_roots; m_roots stays as it
+ *    is for the next search
+ * 3. MultiRootScanner walks all roots on m_cross_root_runner, one
+ *    scheduler per disk; only the non-empty files are kept
+ * 4. The staged duplicate search runs over all of them (digests from
+ *    m_hash_cache where possible), MultiRootScanner::crossRoot() drops
+ *    the groups within one root
+ * 5. The members of the remaining groups are posted to
+ *    applyCrossRootResult()
+ *
+ * @see MultiRootScanner
  */
-void FileManagerUI::startAnimation() {
-  if (m_animating)
+void FileManagerUI::toggleCrossRootDuplicates() {
+  // 1. Cancel, or end the view
+  if (m_cross_root_scanning) {
+    ++m_cross_root_generation;
+    m_cross_root_runner.cancel();
+    m_cross_root_scanning = false;
+    m_current_status = "Cross-root search cancelled.";
     return;
+  }
+  if (m_cross_root_view) {
+    clearFilter();
+    return;
+  }
+
+  // 2. Roots of this search
+  MultiRootScanner scanner = m_roots;
+  scanner.addRoot(treePath(m_panel_path));
+  if (scanner.roots().size() < 2) {
+    m_current_status = "Add another root with 'r' first.";
+    return;
+  }
+  scanner.setThreadCount(0);
 
-  m_animating = true;
-  m_animation_thread = std::thread([this]() {
-    while (m_animating) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      if (m_animating) {
-        m_screen.RequestAnimationFrame(); // Force UI refresh
+  if (!m_hash_cache && !m_duplicate_hasher) {
+    m_hash_cache = HashCache::openDefault();
+  }
+  std::shared_ptr<IHashCalculator> hasher =
+      createHashCalculator(HashAlgorithm::FNV1A, m_hash_cache);
+
+  m_cross_root_scanning = true;
+  const unsigned generation = ++m_cross_root_generation;
+  m_current_status = "Scanning " + std::to_string(scanner.roots().size()) +
+                     " roots... Press 'x' to cancel.";
+
+  m_cross_root_runner.run([this, scanner = std::move(scanner), generation,
+                           hasher](const StopToken &stop) mutable {
+    auto post_status = [this, generation](std::string text) {
+      m_screen.Post([this, generation, text = std::move(text)]() {
+        if (m_cross_root_generation == generation) {
+          m_current_status = text;
+        }
+      });
+      m_redraw.requestRedraw();
+    };
+
+    // 3. Walk all roots
+    scanner.setStopToken(stop);
+    std::vector<FileInfo> files;
+    auto last_progress = std::chrono::steady_clock::now();
+    scanner.scan(
+        [&](std::vector<FileInfo> &&batch) {
+          for (auto &info : batch) {
+            if (!info.isDirectory() && info.getFileSize() > 0) {
+              files.push_back(std::move(info));
+            }
+          }
+          return !stop.stopRequested();
+        },
+        [&](int count) {
+          const auto now = std::chrono::steady_clock::now();
+          if (now - last_progress >= HashPipeline::PROGRESS_INTERVAL) {
+            last_progress = now;
+            post_status("Cross-root: " + std::to_string(count) +
+                        " entries scanned. Press 'x' to cancel.");
+          }
+        });
+    if (stop.stopRequested()) {
+      return;
+    }
+
+    // 4. One duplicate search over all roots
+    HashPipeline pipeline(*hasher);
+    pipeline.setStopToken(stop);
+    pipeline.setProgressCallback([&](const HashPipeline::Progress &progress) {
+      post_status("Cross-root: hashing " + std::to_string(progress.files_done) + "/" +
+                  std::to_string(progress.files_total) + " files. Press 'x' to cancel.");
+    });
+    const auto groups = MultiRootScanner::crossRoot(
+        DuplicateFinder::findDuplicates(files, pipeline), scanner);
+    if (pipeline.isCancelled()) {
+      return;
+    }
+    if (m_hash_cache) {
+      m_hash_cache->flush();
+    }
+
+    // 5. Members only
+    std::vector<FileInfo> members;
+    for (const auto &group : groups) {
+      for (const FileInfo *file : group.files) {
+        members.push_back(*file);
       }
     }
+    m_screen.Post([this, generation, members = std::move(members),
+                   count = groups.size()]() mutable {
+      applyCrossRootResult(generation, std::move(members), count);
+    });
+    m_redraw.requestRedraw();
   });
 }
 
 /**
- * @brief Stops the animation thread
- *
- * Signals the animation thread to terminate by setting m_animating to false,
- * then waits for the thread to finish using join(). Requests one final
- * animation frame to ensure the UI is updated after stopping.
+ * @brief Replaces the listing with the cross-root groups
  *
- * Safe to call even if animation is not running.
+ * The directory watcher is stopped and a running load or duplicate
+ * search of the listing is dropped: m_index now holds files of several
+ * trees. Deleting, verifying and linking work on it as on a listing;
+ * deleted files leave the view. Clearing the filter lists m_panel_path
+ * again.
  *
- * @see startAnimation()
- * @see m_animating
- * @see m_animation_thread
+ * @see toggleCrossRootDuplicates()
  */
-void FileManagerUI::stopAnimation() {
-  m_animating = false;
-  if (m_animation_thread.joinable()) {
-    m_animation_thread.join();
+void FileManagerUI::applyCrossRootResult(unsigned generation, std::vector<FileInfo> &&files,
+                                         std::size_t groups) {
+  if (generation != m_cross_root_generation) {
+    return;
   }
+  m_cross_root_scanning = false;
+  if (groups == 0) {
+    m_current_status = "No duplicates across roots found.";
+    return;
+  }
+
+  m_watcher.unwatch();
+  ++m_load_generation;
+  cancelDuplicateSearch();
+  if (m_loading) {
+    m_loading = false;
+    stopAnimation();
+  }
+  m_pending_events.clear();
+
+  m_index.clear();
+  m_marked.clear();
+  m_index.append(std::move(files));
+  m_index.sort(false);
+  m_index.setDuplicatesKnown(true);
+
+  m_cross_root_view = true;
+  m_current_filter_state = FilterState::DuplicatesOnly;
+  m_show_full_paths = true;
+  m_selected = 0;
+  updateVirtualizedView();
 
-  // CRITICAL: Request final frame redraw to clear spinner
-  // Without this, the last spinner frame stays visible on screen
-  m_screen.RequestAnimationFrame();
+  m_current_status = "Showing " + std::to_string(groups) + " groups across roots (" +
+                     formatBytes(m_index.wastedSpace()) +
+                     " wasted). Press 'c' to return to the directory.";
+  m_redraw.requestRedraw();
 }
+
+// ============================================================================
+// ANIMATION
+// ============================================================================
+
+/**
+ * @brief Starts redrawing the loading indicators
+ *
+ * The fingerprint combines the loaded item count and the spinner phase
+ * (see spinnerFrame()), so the scheduler requests a frame only when the
+ * counter moved or the spinner advanced: at most REDRAW_FPS frames per
+ * second, and no more than SPINNER_FPS while a slow scan finds nothing.
+ * Bursts of progress updates are coalesced into one frame.
+ *
+ * @see stopAnimation()
+ * @see RedrawScheduler::watch()
+ * @see loadDirectoryAsync()
+ */
+void FileManagerUI::startAnimation() {
+  m_redraw.watch([this]() {
+    return (static_cast<std::uint64_t>(m_loaded_count.load()) << 8) |
+           spinnerFrame();
+  });
+}
+
+/**
+ * @brief Stops redrawing the loading indicators
+ *
+ * The scheduler requests one final frame to clear the spinner. Safe to
+ * call even if no animation is running.
+ *
+ * @see startAnimation()
+ * @see RedrawScheduler::unwatch()
+ */
+void FileManagerUI::stopAnimation() { m_redraw.unwatch(); }
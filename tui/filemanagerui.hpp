@@ -12,13 +12,24 @@
  * - Duplicate file detection and filtering
  * - Zero-byte file filtering
  * - File deletion with safety confirmations
+ * - Live listing: changes in the directory are applied as diffs (inotify)
  * - Full-screen terminal UI using FTXUI library
  *
  * @see FileInfo
  * @see FileProcessorAdapter
  */
 
+#include "consolidator.hpp"
+#include "deletionengine.hpp"
+#include "directorytree.hpp"
+#include "directorywatcher.hpp"
+#include "fileindex.hpp"
 #include "fileprocessoradapter.hpp"
+#include "hashpipeline.hpp"
+#include "multirootscanner.hpp"
+#include "redrawscheduler.hpp"
+#include "scansnapshot.hpp"
+#include "taskrunner.hpp"
 #include "uicontrol.hpp"
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
@@ -28,7 +39,9 @@
 
 #include <atomic>
 #include <chrono>
-#include <future>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "utils.hpp"
 
@@ -45,8 +58,11 @@ using namespace ftxui;
  * Architecture:
  * - Asynchronous loading: Directory scans run in background threads to keep UI responsive
  * - Virtualized rendering: Only renders visible portion of large file lists (100 items)
- * - Multi-threaded: Uses std::future for async operations and std::atomic for thread safety
+ * - Multi-threaded: Uses TaskRunner threads for async operations and std::atomic for thread safety
  * - Filter states: None, DuplicatesOnly, ZeroBytesOnly (enum-based state machine)
+ * - Live model: a DirectoryWatcher reports changes of the listed directory,
+ *   which are patched into the listing and the active filter; only a lost
+ *   event queue causes a rescan
  *
  * @see FileInfo
  * @see FileProcessorAdapter
@@ -56,7 +72,7 @@ class FileManagerUI {
 private:
   // ===== UI State =====
 
-  /** @brief Index of currently selected item in the file list */
+  /** @brief Row of the currently selected item in the shown view */
   int m_selected = 0;
 
   /** @brief Index of selected item in the right panel (if applicable) */
@@ -65,6 +81,9 @@ private:
   /** @brief Display full file paths instead of just filenames */
   bool m_show_full_paths = false;
 
+  /** @brief Show the Stats overlay (toggled with 's') */
+  bool m_show_stats = false;
+
   /**
    * @enum FilterState
    * @brief File filtering mode for the UI
@@ -73,12 +92,19 @@ private:
    * - None: Show all files (no filtering)
    * - DuplicatesOnly: Show only files marked as duplicates
    * - ZeroBytesOnly: Show only zero-byte files
+   * - NameMatches: Show only entries matching the search query
    */
-  enum class FilterState { None, DuplicatesOnly, ZeroBytesOnly };
+  enum class FilterState { None, DuplicatesOnly, ZeroBytesOnly, NameMatches };
 
   /** @brief Current active filter state */
   FilterState m_current_filter_state = FilterState::None;
 
+  /**
+   * @brief True while keys edit the search query instead of running
+   *        shortcuts (from '/' until Enter or Escape)
+   */
+  bool m_search_typing = false;
+
   // ===== Paths and Files =====
 
   /** @brief Current working directory path */
@@ -87,17 +113,14 @@ private:
   /** @brief Path displayed in the file panel */
   std::string m_panel_path;
 
-  /** @brief Currently displayed file information objects */
-  std::vector<FileInfo> m_file_infos;
-
-  /** @brief String representations of files for UI rendering */
-  std::vector<std::string> m_panel_files;
-
-  /** @brief Backup of all files before filtering is applied */
-  std::vector<FileInfo> m_all_files;
-
-  /** @brief Temporary storage for file information during operations */
-  std::vector<FileInfo> m_store_files;
+  /**
+   * @brief Entries of the listed directory, held once
+   *
+   * The filters show views of it (id lists, see rows()) instead of copies,
+   * and its duplicate groups stay valid while filters are toggled and the
+   * directory changes.
+   */
+  FileIndex m_index;
 
   // ===== UI Components =====
 
@@ -123,6 +146,12 @@ private:
    */
   Component createPanelWithTable();
 
+  /**
+   * @brief Builds the overlay with the current Stats counters and timers
+   * @return Bordered window, or a hint if the build has no ENABLE_STATS
+   */
+  Element statsOverlay() const;
+
   /** @brief Current status message displayed in the UI */
   std::string m_current_status = "Ready.";
 
@@ -134,8 +163,22 @@ private:
 
   // ===== Threading and Async Operations =====
 
-  /** @brief Future for asynchronous directory loading operation */
-  std::future<std::vector<FileInfo>> m_load_future;
+  /**
+   * @brief Thread of the directory loads
+   *
+   * A new load stops the running scan through its StopToken instead of
+   * waiting for it, and runs on the same thread once the old scan
+   * returned (within one entry).
+   */
+  TaskRunner m_loader;
+
+  /**
+   * @brief Identifies the current directory load
+   *
+   * Incremented by every load (and on shutdown); batches and results
+   * posted by an outdated scan are discarded.
+   */
+  std::atomic<unsigned> m_load_generation{0};
 
   /** @brief Thread-safe flag indicating if a directory load is in progress */
   std::atomic<bool> m_loading{false};
@@ -143,6 +186,141 @@ private:
   /** @brief Thread-safe counter for number of items loaded so far */
   std::atomic<int> m_loaded_count{0};
 
+  /**
+   * @brief Scan snapshot listed instead of scanning (null if none)
+   *
+   * Directories found in it are shown at once and revalidated against a
+   * fresh scan in background.
+   *
+   * @see loadSnapshotListing()
+   */
+  std::shared_ptr<const ScanSnapshot> m_snapshot;
+
+  /**
+   * @brief Persistent digest cache; makes searching an unchanged
+   *        directory again metadata-only (nullptr if unavailable)
+   */
+  std::shared_ptr<HashCache> m_hash_cache;
+
+  /** @brief Hash implementation shared by all duplicate searches */
+  std::unique_ptr<IHashCalculator> m_duplicate_hasher;
+
+  /**
+   * @brief Hashing stage of the running duplicate search (null when idle)
+   *
+   * Also identifies the search: results posted by an older search (e.g.
+   * after a directory change) no longer match and are discarded.
+   */
+  std::shared_ptr<HashPipeline> m_duplicate_pipeline;
+
+  /** @brief Thread of the duplicate searches */
+  TaskRunner m_duplicate_runner;
+
+  /**
+   * @brief Hashing stage of the running size-group refresh (null when idle)
+   *
+   * Re-checks the duplicate groups of file sizes touched by created or
+   * modified files while the duplicate filter is shown.
+   *
+   * @see refreshDuplicateSizes()
+   */
+  std::shared_ptr<HashPipeline> m_refresh_pipeline;
+
+  /** @brief Sizes the running refresh searches (merged into the next one) */
+  std::vector<long long> m_refresh_sizes;
+
+  /** @brief Thread of the size-group refreshes */
+  TaskRunner m_refresh_runner;
+
+  /** @brief Entries marked for the next deletion ('m', 'M') */
+  std::unordered_set<FileIndex::Id> m_marked;
+
+  /** @brief Thread of deletion safety passes, deletions and consolidations */
+  TaskRunner m_delete_runner;
+
+  /** @brief True from the safety pass of a deletion until its report */
+  bool m_deleting = false;
+
+  /** @brief True while a consolidation runs on m_delete_runner */
+  bool m_consolidating = false;
+
+  /** @brief Group state of a copy replaced by a consolidation */
+  struct CarriedDigest {
+    HashDigest digest;    ///< Digest of the kept file (and the copy)
+    long long size;       ///< Size after the replacement
+    std::int64_t mtime_ns; ///< Modification time after the replacement
+  };
+
+  /**
+   * @brief Consolidated copies by path (UI thread only)
+   *
+   * The renames reach m_index as watcher events, which re-list the paths
+   * without digest and Verified mark. applyWatchEvents() gives them back
+   * to entries whose size and mtime are still those after the
+   * replacement. Cleared when a directory loads.
+   */
+  std::unordered_map<std::string, CarriedDigest> m_carried_digests;
+
+  /** @brief True while a verification runs on m_duplicate_runner */
+  bool m_verifying = false;
+
+  /**
+   * @brief Identifies the current verification (UI thread only)
+   *
+   * Incremented when a verification starts or is cancelled; an outdated
+   * result is discarded.
+   */
+  unsigned m_verify_generation = 0;
+
+  /**
+   * @brief Cumulative sizes of the disk usage view (null while it is off)
+   *
+   * Listings below its root show the subtree size of every directory and
+   * are sorted by size; navigating reuses the tree instead of rescanning.
+   */
+  std::shared_ptr<const DirectoryTree> m_usage_tree;
+
+  /** @brief True while the usage scan or its duplicate pass runs */
+  bool m_usage_scanning = false;
+
+  /**
+   * @brief Identifies the current usage scan (UI thread only)
+   *
+   * Incremented when a scan starts or is cancelled; an outdated tree is
+   * discarded.
+   */
+  unsigned m_usage_generation = 0;
+
+  /** @brief Thread of the usage scans */
+  TaskRunner m_usage_runner;
+
+  /**
+   * @brief Roots added with 'r' for the cross-root duplicate search
+   *
+   * The listed directory joins them when the search starts.
+   */
+  MultiRootScanner m_roots;
+
+  /** @brief True while the cross-root scan or its duplicate search runs */
+  bool m_cross_root_scanning = false;
+
+  /**
+   * @brief True while m_index holds cross-root duplicates instead of the
+   *        listing of m_panel_path
+   */
+  bool m_cross_root_view = false;
+
+  /**
+   * @brief Identifies the current cross-root search (UI thread only)
+   *
+   * Incremented when a search starts or is cancelled; an outdated result
+   * is discarded.
+   */
+  unsigned m_cross_root_generation = 0;
+
+  /** @brief Thread of the cross-root searches */
+  TaskRunner m_cross_root_runner;
+
   /** @brief Loading status message displayed during async operations */
   std::string m_loading_message = "";
 
@@ -154,9 +332,30 @@ private:
   /** @brief Starting index for the currently visible window of items */
   int m_virtual_offset = 0;
 
-  /** @brief Subset of files currently visible in the UI (virtualized view) */
+  /**
+   * @brief Labels of the rows currently visible (virtualized view)
+   *
+   * FTXUI's Menu needs owning strings, so these are row buffers that keep
+   * their capacity and are refilled from FileIndex::label().
+   */
   std::vector<std::string> m_visible_files;
 
+  /**
+   * @brief m_index entry for each row of m_visible_files
+   *
+   * Lets the row renderer resolve its FileInfo in constant time (via
+   * EntryState::index) instead of searching by label.
+   */
+  std::vector<FileIndex::Id> m_visible_indices;
+
+  /**
+   * @brief Selected row inside the visible window (menu-relative)
+   *
+   * m_selected is the absolute row in rows();
+   * m_menu_selected == m_selected - m_virtual_offset.
+   */
+  int m_menu_selected = 0;
+
   // ===== Asynchronous Operations =====
 
   /**
@@ -164,27 +363,94 @@ private:
    *
    * Initiates an async directory scan operation that runs in a separate thread
    * to avoid blocking the UI. Updates m_loaded_count atomically as items are
-   * discovered for progress tracking.
+   * discovered for progress tracking. Entries are streamed to the UI in
+   * batches (see appendLoadedBatch()), so the first rows show up while the
+   * scan is still running.
    *
    * @param path The directory path to scan asynchronously
    *
+   * @see appendLoadedBatch()
    * @see updateUIAfterLoad()
-   * @see m_load_future
+   * @see m_loader
    * @see m_loading
    */
   void loadDirectoryAsync(const std::filesystem::path &path);
 
+  /**
+   * @brief Shows a directory from m_snapshot and revalidates it
+   *
+   * Called by loadDirectoryAsync() after its setup. The stored listing
+   * goes into m_index right away (with its duplicate groups if the
+   * snapshot carries a duplicate search); the scan on m_loader is only
+   * compared with it, and the differences are applied like watcher events.
+   *
+   * @param path Directory to list
+   * @param generation Load generation of the calling load
+   * @return false if m_snapshot does not hold the directory (scan it)
+   *
+   * @see ListingPatch::diff()
+   * @see applyWatchEvents()
+   */
+  bool loadSnapshotListing(const std::filesystem::path &path, unsigned generation);
+
+  /**
+   * @brief Appends a streamed batch of entries (UI thread only)
+   *
+   * Entries are shown in arrival order; sorting is deferred to
+   * updateUIAfterLoad().
+   *
+   * @param batch Unsorted entries of the running scan
+   *
+   * @see FileScanner::scanDirectoryStreaming()
+   */
+  void appendLoadedBatch(std::vector<FileInfo> &&batch);
+
   /**
    * @brief Updates UI components after async directory load completes
    *
-   * Called when the async directory loading operation finishes. Retrieves
-   * results from m_load_future, updates file lists, resets loading flags,
-   * and refreshes the UI display.
+   * Called when the async directory loading operation finishes. Sorts the
+   * streamed entries, rebuilds the menu strings (keeping the selected entry
+   * selected) and refreshes the UI display.
    *
    * @see loadDirectoryAsync()
    */
   void updateUIAfterLoad();
 
+  // ===== Live Updates =====
+
+  /**
+   * @brief Events received while a load was running
+   *
+   * Applied once the load is sorted, since the scan may or may not have
+   * seen the change.
+   */
+  std::vector<DirectoryWatcher::Event> m_pending_events;
+
+  /**
+   * @brief Applies directory changes to the loaded model (UI thread only)
+   *
+   * Patches m_index; its views follow: zero-byte entries are re-evaluated,
+   * duplicate groups lose deleted or changed files without any I/O and
+   * re-check only the sizes of new or changed files. An Overflow event
+   * starts a full rescan instead.
+   *
+   * @param events Changes of the listed directory
+   *
+   * @see ListingPatch::apply()
+   * @see refreshDuplicateSizes()
+   */
+  void applyWatchEvents(std::vector<DirectoryWatcher::Event> &&events);
+
+  /**
+   * @brief Searches the duplicates of some file sizes again in background
+   *
+   * Runs the staged search over the files of these sizes only and stores
+   * the new digests in m_index, which regroups the entries.
+   *
+   * @param sizes File sizes whose groups may have changed
+   */
+  void refreshDuplicateSizes(std::vector<long long> sizes);
+
   // ===== Virtualization =====
 
   /**
@@ -197,6 +463,7 @@ private:
    * @see VISIBLE_ITEMS
    * @see m_virtual_offset
    * @see m_visible_files
+   * @see m_visible_indices
    */
   void updateVirtualizedView();
 
@@ -268,32 +535,74 @@ private:
   void getMenuEntries();
 
   /**
-   * @brief Updates menu string representations from FileInfo objects
+   * @brief Rows of the file panel: the m_index view of the active filter
    *
-   * Converts a vector of FileInfo objects to formatted strings suitable
-   * for display in menus and lists.
+   * @return Ids in listing order, valid until m_index changes
    *
-   * @param i Source vector of FileInfo objects
-   * @param t Target vector to fill with formatted strings
-   *
-   * @see FileInfo
+   * @see FilterState
    */
-  void updateMenuStrings(const std::vector<FileInfo> &i,
-                         std::vector<std::string> &t);
+  const std::vector<FileIndex::Id> &rows() const;
+
+  /**
+   * @brief Selects the row of an entry if it is shown
+   * @param id Entry of m_index
+   */
+  void selectEntry(FileIndex::Id id);
 
   // ===== Filtering Functions =====
 
   /**
    * @brief Filters file list to show only duplicate files
    *
-   * Updates the display to show only files that have been marked as
-   * duplicates. Sets filter state to DuplicatesOnly.
+   * Starts a background duplicate search; the filter is applied by
+   * applyDuplicateResult() once it completes. Calling it again while the
+   * search runs cancels the search. Once a listing was searched, the
+   * filter switches to the kept groups of m_index without searching again.
+   * Sets filter state to DuplicatesOnly.
    *
    * @see FilterState
    * @see FileInfo::isDuplicate()
+   * @see HashPipeline
    */
   void showDuplicates();
 
+  /**
+   * @brief Applies a finished duplicate search (UI thread only)
+   *
+   * @param pipeline Pipeline of the finished search; ignored if it is no
+   *        longer m_duplicate_pipeline
+   * @param files Searched copy of m_index with duplicates marked
+   * @param ids m_index id of every entry of files
+   */
+  void applyDuplicateResult(const std::shared_ptr<HashPipeline> &pipeline,
+                            const std::vector<FileInfo> &files,
+                            const std::vector<FileIndex::Id> &ids);
+
+  /**
+   * @brief Cancels a running duplicate search without waiting for it
+   */
+  void cancelDuplicateSearch();
+
+  /**
+   * @brief Confirms the found duplicates byte for byte
+   *
+   * Compares the files of every duplicate group on m_duplicate_runner
+   * (see DuplicateFinder::verifyGroups()); the result is applied by
+   * applyVerifyResult(). Calling it again while it runs cancels it.
+   */
+  void verifyDuplicates();
+
+  /**
+   * @brief Applies a finished verification (UI thread only)
+   *
+   * @param generation m_verify_generation when it started; ignored if
+   *        outdated
+   * @param files Compared copies of the duplicates, verified ones flagged
+   * @param ids m_index id of every entry of files
+   */
+  void applyVerifyResult(unsigned generation, const std::vector<FileInfo> &files,
+                         const std::vector<FileIndex::Id> &ids);
+
   /**
    * @brief Filters file list to show only zero-byte files
    *
@@ -305,6 +614,29 @@ private:
    */
   void showZeroByteFiles();
 
+  /**
+   * @brief Starts typing a name search ('/')
+   *
+   * Shows View::Matches of m_index with an empty query, replacing another
+   * filter; in the cross-root view the search covers its files. Keys then
+   * go to handleSearchKey().
+   *
+   * @see FileIndex::setNameFilter()
+   */
+  void startNameSearch();
+
+  /**
+   * @brief Edits the search query while m_search_typing is set
+   *
+   * Characters extend the query and Backspace shortens it; every change
+   * refines the matches of the previous query (see NameSearch). Enter
+   * keeps the filter, Escape drops it. Other keys (navigation) pass.
+   *
+   * @param event Key event
+   * @return true if the event was consumed
+   */
+  bool handleSearchKey(const ftxui::Event &event);
+
   /**
    * @brief Clears all active filters and shows all files
    *
@@ -317,74 +649,207 @@ private:
   // ===== Deletion Functionality =====
 
   /**
-   * @brief Displays confirmation dialog before file deletion
+   * @brief Marks or unmarks the selected entry for deletion
+   */
+  void toggleMark();
+
+  /**
+   * @brief Marks all but the first file of every duplicate group
    *
-   * Shows a confirmation dialog to the user before proceeding with file
-   * deletion. May include safety warnings from FileSafety checks.
+   * Clears all marks instead if some are set.
+   */
+  void markDuplicateCopies();
+
+  /**
+   * @brief Deletes the marked entries, or the selected one if none is
    *
-   * @param file The FileInfo object for the file to be deleted
-   * @return true if user confirmed deletion, false if cancelled
+   * Runs the safety pass (DeletionEngine::plan()) on m_delete_runner;
+   * its result is confirmed by showDeleteConfirmation() and deleted by
+   * runDeletion(). Nothing runs on the UI thread but the dialog.
+   */
+  void deleteMarked();
+
+  /**
+   * @brief Displays confirmation dialog before deletion
+   *
+   * Shows a confirmation dialog for the targets of a safety pass,
+   * including blocked entries and removable media warnings.
+   *
+   * @param plan Result of DeletionEngine::plan()
+   * @return true if user confirmed deletion, false if cancelled or
+   *         everything was blocked
    *
    * @see FileSafety
    */
-  bool showDeleteConfirmation(const FileInfo &file);
+  bool showDeleteConfirmation(const DeletionEngine::Plan &plan);
 
   /**
-   * @brief Deletes a regular file from the filesystem
+   * @brief Deletes the targets of a confirmed plan on m_delete_runner
+   * @param plan Confirmed result of DeletionEngine::plan()
+   */
+  void runDeletion(DeletionEngine::Plan plan);
+
+  /**
+   * @brief Applies a finished deletion (UI thread only)
    *
-   * Performs safety checks and deletes the specified file if allowed.
+   * Patches the listing with the deleted paths instead of rescanning.
    *
-   * @param file The FileInfo object representing the file to delete
-   * @return true if deletion succeeded, false if it failed or was blocked
+   * @param report Result of DeletionEngine::run()
+   */
+  void applyDeletionReport(const DeletionEngine::Report &report);
+
+  // ===== Consolidation =====
+
+  /**
+   * @brief Replaces verified duplicate copies with links to one kept file
    *
-   * @see FileSafety::checkDeletion()
+   * After a confirmation dialog, runs Consolidator (Method::Auto: reflinks
+   * where the file system supports them, else hardlinks) over the verified
+   * groups on m_delete_runner; the result is applied by
+   * applyConsolidationReport(). Every path stays in place.
+   */
+  void consolidateDuplicates();
+
+  /**
+   * @brief Asks before consolidating
+   * @param copies Files about to be replaced
+   * @param bytes Their total size
+   * @return true if the user confirmed
+   */
+  bool showConsolidateConfirmation(std::size_t copies, long long bytes);
+
+  /**
+   * @brief Applies a finished consolidation (UI thread only)
+   * @param report Result of Consolidator::run()
+   * @param carried Group state of the replaced copies, by path
    */
-  bool deleteFile(const FileInfo &file);
+  void applyConsolidationReport(const Consolidator::Report &report,
+                                std::unordered_map<std::string, CarriedDigest> carried);
 
   /**
-   * @brief Deletes a directory from the filesystem
+   * @brief Gives a re-listed consolidated copy its digest back
+   * @param path Path of an entry of m_index
+   * @return true if the entry is a consolidated copy, unchanged since
+   */
+  bool restoreCarriedDigest(const std::string &path);
+
+  // ===== Disk usage =====
+
+  /**
+   * @brief Toggles the disk usage view
    *
-   * Performs safety checks and deletes the specified directory. Can operate
-   * recursively to delete non-empty directories.
+   * Scans the listed directory recursively once on m_usage_runner,
+   * aggregating it into a DirectoryTree as the batches arrive; the tree is
+   * shown as soon as the walk ended. A second pass then hashes the size
+   * collisions of the scanned files to fill in the duplicate bytes.
+   * Calling it while the scan runs cancels it, afterwards it ends the view.
+   */
+  void toggleDiskUsage();
+
+  /**
+   * @brief Shows a tree of a usage scan (UI thread only)
+   * @param generation m_usage_generation when the scan started
+   * @param tree Rolled-up tree
+   * @param complete False for the tree before the duplicate pass
+   */
+  void applyUsageTree(unsigned generation, std::shared_ptr<const DirectoryTree> tree,
+                      bool complete);
+
+  /**
+   * @brief Size an entry sorts by in the disk usage view
+   * @return Subtree bytes of a directory in m_usage_tree (0 if unknown),
+   *         allocated bytes of a file
+   */
+  long long usageSize(const FileInfo &info) const;
+
+  /** @brief Totals of m_panel_path in m_usage_tree for the status line */
+  std::string usageSummary() const;
+
+  // ===== Cross-root duplicates =====
+
+  /**
+   * @brief Adds the listed directory to m_roots ('r')
    *
-   * @param dir The FileInfo object representing the directory to delete
-   * @param recursive If true, delete directory contents recursively
-   * @return true if deletion succeeded, false if it failed or was blocked
+   * Directories already covered by a root are reported, not added; one
+   * above existing roots replaces them.
+   */
+  void addRoot();
+
+  /**
+   * @brief Toggles the duplicates across m_roots and the listed directory
    *
-   * @see FileSafety::checkDeletion()
+   * Scans all roots with a MultiRootScanner on m_cross_root_runner (one
+   * scheduler per disk) and hashes the size collisions; only groups with
+   * files below at least two roots are kept. They replace the listing in
+   * the duplicate view, with full paths. Calling it while the search runs
+   * cancels it, afterwards it returns to the listed directory.
    */
-  bool deleteDirectory(const FileInfo &dir, bool recursive);
+  void toggleCrossRootDuplicates();
+
+  /**
+   * @brief Shows the result of a cross-root search (UI thread only)
+   * @param generation m_cross_root_generation when the search started
+   * @param files Members of the cross-root groups, digests set
+   * @param groups Number of groups
+   */
+  void applyCrossRootResult(unsigned generation, std::vector<FileInfo> &&files,
+                            std::size_t groups);
+
+  /**
+   * @brief Sorts m_index for the current view, keeping the selected entry
+   *
+   * By name (FileIndex::sort()), or by usageSize() while m_usage_tree is
+   * set (FileIndex::sortBySize()).
+   */
+  void sortListing();
 
   // ===== Dialog State =====
 
   /** @brief Flag indicating whether a modal dialog is currently active */
   bool m_dialog_active = false;
 
-  // ===== Animation Thread =====
+  // ===== Redraw Scheduling =====
+
+  /** @brief Maximum frame rate of the UI */
+  static constexpr unsigned REDRAW_FPS = 30;
 
-  /** @brief Background thread for UI animations (e.g., loading spinner) */
-  std::thread m_animation_thread;
+  /**
+   * @brief Rate-limited redraw requests (one timer thread for the UI's
+   *        lifetime); declared after m_screen, which it draws to
+   */
+  RedrawScheduler m_redraw{[this]() { m_screen.RequestAnimationFrame(); },
+                           REDRAW_FPS};
 
-  /** @brief Thread-safe flag indicating if animation is currently running */
-  std::atomic<bool> m_animating{false};
+  /**
+   * @brief Watches the listed directory; events are posted to the UI
+   *        thread (declared after m_screen and m_redraw, which it uses)
+   *
+   * @see applyWatchEvents()
+   */
+  DirectoryWatcher m_watcher{[this](std::vector<DirectoryWatcher::Event> &&events) {
+    m_screen.Post([this, events = std::move(events)]() mutable {
+      applyWatchEvents(std::move(events));
+    });
+    m_redraw.requestRedraw();
+  }};
 
   /**
-   * @brief Starts the animation thread for visual feedback
+   * @brief Starts redrawing the loading indicators
    *
-   * Launches the background animation thread for displaying loading
-   * indicators or progress animations.
+   * Watches the item counter and the spinner phase; a frame is requested
+   * only when one of them changed, at most REDRAW_FPS times per second.
    *
-   * @see m_animation_thread
+   * @see m_redraw
    * @see stopAnimation()
    */
   void startAnimation();
 
   /**
-   * @brief Stops the animation thread
+   * @brief Stops redrawing the loading indicators
    *
-   * Signals the animation thread to terminate and waits for it to finish.
+   * Requests one final frame, which removes the spinner.
    *
-   * @see m_animation_thread
+   * @see m_redraw
    * @see startAnimation()
    */
   void stopAnimation();
@@ -405,6 +870,16 @@ public:
       : m_current_dir(std::filesystem::current_path()),
         m_panel_path(m_current_dir) {};
 
+  /**
+   * @brief Lists directories from a scan snapshot (tfm --snapshot)
+   *
+   * If the working directory is not in the snapshot, the UI starts at its
+   * root. Must be called before initialize().
+   *
+   * @param snapshot Opened snapshot (see ScanSnapshot::isOpen())
+   */
+  void setSnapshot(std::shared_ptr<const ScanSnapshot> snapshot);
+
   /**
    * @brief Destructor for FileManagerUI
    *
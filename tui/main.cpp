@@ -1,8 +1,31 @@
 #include "filemanagerui.hpp"
 
-int main() {
+int main(int argc, char *argv[]) {
+  std::shared_ptr<const ScanSnapshot> snapshot;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--snapshot" && i + 1 < argc) {
+      auto opened = std::make_shared<ScanSnapshot>(argv[i + 1]);
+      if (!opened->isOpen()) {
+        std::cerr << "Error: " << opened->error() << std::endl;
+        return 1;
+      }
+      snapshot = std::move(opened);
+      i++;
+    }
+
+    if (arg == "-h" || arg == "--help") {
+      std::cout << "[--snapshot file (list directories from a tmf-cli "
+                   "--snapshot scan, revalidated in background) ]\n";
+      return 0;
+    }
+  }
+
   try {
     FileManagerUI ui;
+    if (snapshot) {
+      ui.setSnapshot(std::move(snapshot));
+    }
     ui.initialize();
     ui.run();
   } catch (const std::exception &e) {
@@ -0,0 +1,203 @@
+/**
+ * @file redrawscheduler.hpp
+ * @brief Rate-limited, change-driven redraw requests for the TUI
+ *
+ * Replaces a free-running animation loop: frames are requested only when
+ * something visible changed, and never more often than a configurable
+ * frame rate.
+ *
+ * @see RedrawScheduler
+ */
+
+#ifndef REDRAW_SCHEDULER_HPP
+#define REDRAW_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class RedrawScheduler
+ * @brief Coalesces redraw requests on one long-lived timer thread
+ *
+ * Two sources trigger a frame:
+ * - requestRedraw(): explicit "state changed" notifications; any number of
+ *   requests within one frame interval result in a single frame
+ * - watch(): a fingerprint of polled state (e.g. a progress counter and
+ *   the spinner phase), sampled once per frame interval; a frame is
+ *   requested only if the value changed
+ *
+ * The thread sleeps on a condition variable while nothing is watched or
+ * pending, so an idle UI costs no wake-ups.
+ *
+ * Example usage:
+ * @code
+ * RedrawScheduler redraw([&] { screen.RequestAnimationFrame(); }, 30);
+ * redraw.watch([&] { return static_cast<std::uint64_t>(counter.load()); });
+ * // ... long operation updating counter ...
+ * redraw.unwatch(); // one final frame
+ * @endcode
+ *
+ * @note All methods are thread-safe. The callbacks run on the scheduler
+ *       thread and must not call back into the scheduler.
+ */
+class RedrawScheduler {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /** @brief Requests a frame from the UI (e.g. RequestAnimationFrame()) */
+  using RedrawCallback = std::function<void()>;
+
+  /** @brief Summarizes polled visible state; a new value means "redraw" */
+  using Fingerprint = std::function<std::uint64_t()>;
+
+  /** @brief Frame rate used when none is given */
+  static constexpr unsigned DEFAULT_FPS = 30;
+
+  /**
+   * @param redraw Called (on the scheduler thread) for every frame
+   * @param fps Maximum frames per second (at least 1)
+   */
+  explicit RedrawScheduler(RedrawCallback redraw, unsigned fps = DEFAULT_FPS)
+      : m_redraw(std::move(redraw)) {
+    setFps(fps);
+    m_thread = std::thread([this]() { run(); });
+  }
+
+  ~RedrawScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+  }
+
+  RedrawScheduler(const RedrawScheduler &) = delete;
+  RedrawScheduler &operator=(const RedrawScheduler &) = delete;
+
+  /**
+   * @brief Sets the maximum frame rate
+   * @param fps Frames per second; 0 is treated as 1
+   */
+  void setFps(unsigned fps) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_interval = std::chrono::duration_cast<clock::duration>(std::chrono::seconds(1)) /
+                 (fps > 0 ? fps : 1);
+  }
+
+  /** @brief Minimum time between two frames */
+  clock::duration getInterval() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_interval;
+  }
+
+  /**
+   * @brief Marks the visible state as changed
+   *
+   * The frame follows immediately if the last one is at least one interval
+   * old, otherwise when the interval has elapsed.
+   */
+  void requestRedraw() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_dirty = true;
+    }
+    m_cv.notify_one();
+  }
+
+  /**
+   * @brief Polls a fingerprint once per frame interval until unwatch()
+   *
+   * Replaces a previously watched fingerprint. The current value counts as
+   * already drawn.
+   *
+   * @param fingerprint Cheap function over the polled state
+   */
+  void watch(Fingerprint fingerprint) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_fingerprint = std::move(fingerprint);
+      m_last_fingerprint = m_fingerprint ? m_fingerprint() : 0;
+    }
+    m_cv.notify_one();
+  }
+
+  /**
+   * @brief Stops polling and requests one final frame
+   *
+   * The final frame removes transient indicators such as a spinner.
+   */
+  void unwatch() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_fingerprint = nullptr;
+      m_dirty = true;
+    }
+    m_cv.notify_one();
+  }
+
+  /** @brief Number of frames requested so far (for diagnostics) */
+  std::uint64_t getFrameCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frames;
+  }
+
+private:
+  RedrawCallback m_redraw;
+  Fingerprint m_fingerprint;
+  std::uint64_t m_last_fingerprint = 0;
+  std::uint64_t m_frames = 0;
+  clock::duration m_interval{};
+  clock::time_point m_last_frame{};
+  bool m_dirty = false;
+  bool m_stop = false;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_thread; // last: started after all other members exist
+
+  void run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+      if (!m_dirty && !m_fingerprint) {
+        m_cv.wait(lock, [this] { return m_stop || m_dirty || m_fingerprint; });
+        continue;
+      }
+
+      // Rate limit; requests arriving meanwhile are coalesced
+      const clock::time_point next = m_last_frame + m_interval;
+      if (clock::now() < next) {
+        m_cv.wait_until(lock, next, [this] { return m_stop; });
+        continue;
+      }
+
+      bool changed = m_dirty;
+      if (m_fingerprint) {
+        const std::uint64_t value = m_fingerprint();
+        if (value != m_last_fingerprint) {
+          m_last_fingerprint = value;
+          changed = true;
+        }
+      }
+
+      if (!changed) {
+        // Watched state unchanged: sample again one interval later
+        m_cv.wait_for(lock, m_interval, [this] { return m_stop || m_dirty; });
+        continue;
+      }
+
+      m_dirty = false;
+      m_last_frame = clock::now();
+      ++m_frames;
+
+      lock.unlock();
+      m_redraw();
+      lock.lock();
+    }
+  }
+};
+
+#endif // REDRAW_SCHEDULER_HPP
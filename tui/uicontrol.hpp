@@ -55,6 +55,15 @@ struct ActionInfo {
  * - FindDuplicates: Filter to show only duplicate files
  * - ClearFilter: Remove active filters and show all files
  * - DeleteMarkedFiles: Delete selected/marked files with safety checks
+ * - ToggleMark: Mark/unmark the selected entry for deletion
+ * - MarkDuplicateCopies: Mark all but one file of every duplicate group
+ * - ToggleStats: Show/hide the performance counter overlay
+ * - VerifyDuplicates: Confirm found duplicates byte for byte
+ * - ConsolidateDuplicates: Replace verified copies with hardlinks/reflinks
+ * - DiskUsage: Show cumulative directory sizes, largest first
+ * - AddRoot: Add the listed directory to the cross-root search
+ * - CrossRootDuplicates: Show duplicates between the added roots
+ * - SearchNames: Filter the listing by typed name fragments
  * - Quit: Exit the application
  *
  * @see ActionInfo
@@ -75,6 +84,33 @@ enum class ActionID {
   /** @brief Delete marked/selected files (shortcut: 'D') */
   DeleteMarkedFiles,
 
+  /** @brief Mark/unmark the selected entry for deletion (shortcut: 'm') */
+  ToggleMark,
+
+  /** @brief Mark all but one file of every duplicate group (shortcut: 'M') */
+  MarkDuplicateCopies,
+
+  /** @brief Show/hide the performance counter overlay (shortcut: 's') */
+  ToggleStats,
+
+  /** @brief Compare found duplicates byte for byte (shortcut: 'v') */
+  VerifyDuplicates,
+
+  /** @brief Link verified copies to one kept file (shortcut: 'l') */
+  ConsolidateDuplicates,
+
+  /** @brief Toggle the disk usage view (shortcut: 'u') */
+  DiskUsage,
+
+  /** @brief Add the listed directory as a search root (shortcut: 'r') */
+  AddRoot,
+
+  /** @brief Toggle the duplicates across roots (shortcut: 'x') */
+  CrossRootDuplicates,
+
+  /** @brief Type a name search filter (shortcut: '/') */
+  SearchNames,
+
   /** @brief Quit the application (shortcut: 'q') */
   Quit
 };
@@ -94,6 +130,15 @@ enum class ActionID {
  * - FindDuplicates: 'd' -> "(d) Show Duplicates"
  * - ClearFilter: 'c' -> "(c) Clear Filter"
  * - DeleteMarkedFiles: 'D' -> "(D) Delete Marked"
+ * - ToggleMark: 'm' -> "(m) Mark"
+ * - MarkDuplicateCopies: 'M' -> "(M) Mark Copies"
+ * - ToggleStats: 's' -> "(s) Stats"
+ * - VerifyDuplicates: 'v' -> "(v) Verify"
+ * - ConsolidateDuplicates: 'l' -> "(l) Link Copies"
+ * - DiskUsage: 'u' -> "(u) Disk Usage"
+ * - AddRoot: 'r' -> "(r) Add Root"
+ * - CrossRootDuplicates: 'x' -> "(x) Across Roots"
+ * - SearchNames: '/' -> "(/) Search"
  * - Quit: 'q' -> "(q) Quit"
  *
  * @see ActionID
@@ -109,6 +154,15 @@ inline const std::map<ActionID, ActionInfo> ActionMap = {
     {ActionID::FindDuplicates, {'d', "(d) Show Duplicates"}},
     {ActionID::ClearFilter, {'c', "(c) Clear Filter"}},
     {ActionID::DeleteMarkedFiles, {'D', "(D) Delete Marked"}},
+    {ActionID::ToggleMark, {'m', "(m) Mark"}},
+    {ActionID::MarkDuplicateCopies, {'M', "(M) Mark Copies"}},
+    {ActionID::ToggleStats, {'s', "(s) Stats"}},
+    {ActionID::VerifyDuplicates, {'v', "(v) Verify"}},
+    {ActionID::ConsolidateDuplicates, {'l', "(l) Link Copies"}},
+    {ActionID::DiskUsage, {'u', "(u) Disk Usage"}},
+    {ActionID::AddRoot, {'r', "(r) Add Root"}},
+    {ActionID::CrossRootDuplicates, {'x', "(x) Across Roots"}},
+    {ActionID::SearchNames, {'/', "(/) Search"}},
     {ActionID::Quit, {'q', "(q) Quit"}}};
 
 /**
@@ -124,6 +178,7 @@ inline const std::map<ActionID, ActionInfo> ActionMap = {
  * - "(d) Show Duplicates"
  * - "(c) Clear Filter"
  * - "(D) Delete Marked"
+ * - "(s) Stats"
  * - "(q) Quit"
  *
  * @return std::vector<std::string> Vector of formatted menu entry strings